@@ -0,0 +1,34 @@
+// Replacement of the global operator new/delete for wave_hotpath_bench:
+// counts every operator new call of the process (including the linked
+// dot11_mac.cpp and wave_app.cpp).
+//
+// Kept in its own translation unit so that the replacements are not inlined
+// next to the allocations they serve.
+
+#include <cstdlib>
+#include <new>
+
+unsigned long long int numberOperatorNewCalls = 0;
+
+void* operator new(std::size_t sizeBytes)
+{
+    numberOperatorNewCalls++;
+
+    void* memoryPtr = std::malloc((sizeBytes == 0) ? 1 : sizeBytes);
+
+    if (memoryPtr == nullptr) {
+        throw std::bad_alloc();
+    }//if//
+
+    return memoryPtr;
+}
+
+void operator delete(void* memoryPtr) noexcept
+{
+    std::free(memoryPtr);
+}
+
+void operator delete(void* memoryPtr, std::size_t) noexcept
+{
+    std::free(memoryPtr);
+}
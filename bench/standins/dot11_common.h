@@ -0,0 +1,197 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// Dot11 namespace imports, MAC addresses and transmission parameters.
+
+#ifndef DOT11_COMMON_H
+#define DOT11_COMMON_H
+
+#include "scensim_engine.h"
+#include "scensim_netsim.h"
+
+#include <array>
+#include <bitset>
+
+namespace Dot11 {
+
+using std::shared_ptr;
+using std::unique_ptr;
+using std::enable_shared_from_this;
+using std::move;
+using std::vector;
+using std::string;
+using std::map;
+using std::set;
+using std::list;
+using std::pair;
+using std::make_pair;
+using std::array;
+using std::bitset;
+using std::min;
+using std::max;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+using std::istringstream;
+
+using ScenSim::SimTime;
+using ScenSim::ZERO_TIME;
+using ScenSim::INFINITE_TIME;
+using ScenSim::NANO_SECOND;
+using ScenSim::MICRO_SECOND;
+using ScenSim::MILLI_SECOND;
+using ScenSim::SECOND;
+using ScenSim::NodeId;
+using ScenSim::InterfaceId;
+using ScenSim::InterfaceOrInstanceId;
+using ScenSim::ParameterDatabaseReader;
+using ScenSim::SimulationEngineInterface;
+using ScenSim::SimulationEvent;
+using ScenSim::EventRescheduleTicket;
+using ScenSim::CounterStatistic;
+using ScenSim::RealStatistic;
+using ScenSim::RandomNumberGenerator;
+using ScenSim::RandomNumberGeneratorSeed;
+using ScenSim::HashInputsToMakeSeed;
+using ScenSim::Packet;
+using ScenSim::PacketId;
+using ScenSim::PacketPriority;
+using ScenSim::NetworkAddress;
+using ScenSim::GenericMacAddress;
+using ScenSim::EtherTypeField;
+using ScenSim::NetToHost16;
+using ScenSim::HostToNet16;
+using ScenSim::ConvertTimeToStringSecs;
+using ScenSim::ConvertToString;
+using ScenSim::ConvertStringToLowerCase;
+using ScenSim::MakeLowerCaseString;
+using ScenSim::DeleteTrailingSpaces;
+
+const string parameterNamePrefix = "dot11-";
+
+typedef long long int DatarateBitsPerSec;
+
+//--------------------------------------------------------------------------------------------------
+
+enum ModulationAndCodingSchemesType {
+    McsBpsk1Over2,
+    McsBpsk3Over4,
+    McsQpsk1Over2,
+    McsQpsk3Over4,
+    Mcs16Qam1Over2,
+    Mcs16Qam3Over4,
+    Mcs64Qam2Over3,
+    Mcs64Qam3Over4,
+    NumberModulationAndCodingSchemes,
+    InvalidModulationAndCodingScheme = NumberModulationAndCodingSchemes,
+};
+
+struct TransmissionParameters {
+    unsigned int firstChannelNumber;
+    unsigned int channelBandwidthMhz;
+    ModulationAndCodingSchemesType modulationAndCodingScheme;
+    unsigned int numberSpatialStreams;
+    bool isHighThroughputFrame;
+
+    TransmissionParameters()
+        :
+        firstChannelNumber(0),
+        channelBandwidthMhz(10),
+        modulationAndCodingScheme(McsBpsk1Over2),
+        numberSpatialStreams(1),
+        isHighThroughputFrame(false)
+    {}
+};
+
+//--------------------------------------------------------------------------------------------------
+
+// 6 byte MAC address: node id in the low 4 bytes, an interface selector byte
+// and a flag byte (0xFF: broadcast, 0x01: multicast).
+
+class MacAddress {
+public:
+    static const unsigned int numberMacAddressBytes = 6;
+
+    static const MacAddress invalidMacAddress;
+
+    static MacAddress GetBroadcastAddress()
+    {
+        MacAddress broadcastAddress;
+        std::fill(broadcastAddress.addressBytes, (broadcastAddress.addressBytes + numberMacAddressBytes), 0xFF);
+        return broadcastAddress;
+    }
+
+    MacAddress() { (*this).Clear(); }
+
+    MacAddress(const NodeId& theNodeId, const unsigned char interfaceSelectorByte)
+    {
+        (*this).Clear();
+        (*this).SetLowerBitsWithNodeId(theNodeId);
+        (*this).SetInterfaceSelectorByte(interfaceSelectorByte);
+    }
+
+    void Clear() { std::fill(addressBytes, (addressBytes + numberMacAddressBytes), 0); }
+
+    void SetLowerBitsWithNodeId(const NodeId& theNodeId)
+    {
+        for(unsigned int i = 0; (i < 4); i++) {
+            addressBytes[numberMacAddressBytes - 1 - i] = static_cast<unsigned char>(theNodeId >> (8 * i));
+        }//for//
+    }
+
+    void SetInterfaceSelectorByte(const unsigned char interfaceSelectorByte)
+        { addressBytes[1] = interfaceSelectorByte; }
+
+    void SetToAMulticastAddress(const unsigned int multicastGroupNumber)
+    {
+        (*this).Clear();
+        addressBytes[0] = 0x01;
+        (*this).SetLowerBitsWithNodeId(multicastGroupNumber);
+    }
+
+    NodeId ExtractNodeId() const
+    {
+        NodeId theNodeId = 0;
+
+        for(unsigned int i = 2; (i < numberMacAddressBytes); i++) {
+            theNodeId = ((theNodeId << 8) | addressBytes[i]);
+        }//for//
+
+        return theNodeId;
+    }
+
+    bool IsABroadcastAddress() const { return (addressBytes[0] == 0xFF); }
+    bool IsAMulticastAddress() const { return (addressBytes[0] == 0x01); }
+    bool IsABroadcastOrAMulticastAddress() const { return ((*this).IsABroadcastAddress() || (*this).IsAMulticastAddress()); }
+
+    GenericMacAddress ConvertToGenericMacAddress() const
+    {
+        GenericMacAddress genericAddress = 0;
+
+        for(unsigned int i = 0; (i < numberMacAddressBytes); i++) {
+            genericAddress = ((genericAddress << 8) | addressBytes[i]);
+        }//for//
+
+        return genericAddress;
+    }
+
+    bool operator==(const MacAddress& right) const
+        { return (std::equal(addressBytes, (addressBytes + numberMacAddressBytes), right.addressBytes)); }
+
+    bool operator!=(const MacAddress& right) const { return (!((*this) == right)); }
+
+    bool operator<(const MacAddress& right) const
+    {
+        return (std::lexicographical_compare(
+            addressBytes, (addressBytes + numberMacAddressBytes),
+            right.addressBytes, (right.addressBytes + numberMacAddressBytes)));
+    }
+
+private:
+    unsigned char addressBytes[numberMacAddressBytes];
+
+};//MacAddress//
+
+inline const MacAddress MacAddress::invalidMacAddress;
+
+}//namespace//
+
+#endif
@@ -0,0 +1,220 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// 802.11 frame layouts (plain structs, copied into packets as headers).
+
+#ifndef DOT11_HEADERS_H
+#define DOT11_HEADERS_H
+
+#include "dot11_common.h"
+
+namespace Dot11 {
+
+typedef unsigned short int DurationField;
+
+const DurationField MaxDurationFieldValue = 32767;
+
+typedef unsigned short int AssociationId;
+
+enum FrameTypeCodes {
+    ASSOCIATION_REQUEST_FRAME_TYPE_CODE = 0x00,
+    ASSOCIATION_RESPONSE_FRAME_TYPE_CODE = 0x01,
+    REASSOCIATION_REQUEST_FRAME_TYPE_CODE = 0x02,
+    REASSOCIATION_RESPONSE_FRAME_TYPE_CODE = 0x03,
+    BEACON_FRAME_TYPE_CODE = 0x08,
+    DISASSOCIATION_FRAME_TYPE_CODE = 0x0A,
+    AUTHENTICATION_FRAME_TYPE_CODE = 0x0B,
+    BLOCK_ACK_REQUEST_FRAME_TYPE_CODE = 0x18,
+    BLOCK_ACK_FRAME_TYPE_CODE = 0x19,
+    POWER_SAVE_POLL_FRAME_TYPE_CODE = 0x1A,
+    RTS_FRAME_TYPE_CODE = 0x1B,
+    CTS_FRAME_TYPE_CODE = 0x1C,
+    ACK_FRAME_TYPE_CODE = 0x1D,
+    QOS_DATA_FRAME_TYPE_CODE = 0x28,
+    NULL_FRAME_TYPE_CODE = 0x2C,
+};
+
+inline
+bool IsAManagementFrameTypeCode(const unsigned char frameTypeCode)
+{
+    return ((frameTypeCode >> 4) == 0);
+}
+
+inline
+string ConvertToDot11FrameTypeName(const unsigned char frameTypeCode)
+{
+    switch (frameTypeCode) {
+    case ASSOCIATION_REQUEST_FRAME_TYPE_CODE: return "AssociationRequest";
+    case ASSOCIATION_RESPONSE_FRAME_TYPE_CODE: return "AssociationResponse";
+    case REASSOCIATION_REQUEST_FRAME_TYPE_CODE: return "ReassociationRequest";
+    case REASSOCIATION_RESPONSE_FRAME_TYPE_CODE: return "ReassociationResponse";
+    case BEACON_FRAME_TYPE_CODE: return "Beacon";
+    case DISASSOCIATION_FRAME_TYPE_CODE: return "Disassociation";
+    case AUTHENTICATION_FRAME_TYPE_CODE: return "Authentication";
+    case BLOCK_ACK_REQUEST_FRAME_TYPE_CODE: return "BlockAckRequest";
+    case BLOCK_ACK_FRAME_TYPE_CODE: return "BlockAck";
+    case POWER_SAVE_POLL_FRAME_TYPE_CODE: return "PowerSavePoll";
+    case RTS_FRAME_TYPE_CODE: return "RTS";
+    case CTS_FRAME_TYPE_CODE: return "CTS";
+    case ACK_FRAME_TYPE_CODE: return "ACK";
+    case QOS_DATA_FRAME_TYPE_CODE: return "QoSData";
+    case NULL_FRAME_TYPE_CODE: return "Null";
+    default: return "Unknown";
+    }//switch//
+}
+
+struct FrameControlField {
+    unsigned char frameTypeAndSubtype;
+    unsigned char isRetry:1;
+    unsigned char powerManagement:1;
+    unsigned char notUsed:6;
+
+    FrameControlField() : frameTypeAndSubtype(0), isRetry(0), powerManagement(0), notUsed(0) { }
+};
+
+struct CommonFrameHeader {
+    FrameControlField theFrameControlField;
+    DurationField duration;
+    MacAddress receiverAddress;
+};
+
+struct SequenceControlField {
+    unsigned short int sequenceNumber;
+
+    SequenceControlField() : sequenceNumber(0) { }
+};
+
+struct QosControlField {
+    unsigned char trafficId;
+    unsigned char notUsed;
+
+    QosControlField() : trafficId(0), notUsed(0) { }
+};
+
+struct LogicalLinkControlHeader {
+    unsigned char notUsed[6];
+    unsigned short int etherType;
+
+    LogicalLinkControlHeader() : etherType(0) { std::fill(notUsed, (notUsed + 6), 0); }
+};
+
+struct RequestToSendFrame {
+    CommonFrameHeader header;
+    MacAddress transmitterAddress;
+};
+
+struct ClearToSendFrame {
+    CommonFrameHeader header;
+};
+
+struct AcknowledgementAkaAckFrame {
+    CommonFrameHeader header;
+};
+
+struct PowerSavePollFrame {
+    CommonFrameHeader header;
+    MacAddress transmitterAddress;
+};
+
+struct QosDataFrameHeader {
+    CommonFrameHeader header;
+    MacAddress transmitterAddress;
+    MacAddress multiHopSourceAddress;
+    SequenceControlField theSequenceControlField;
+    QosControlField qosControlField;
+    LogicalLinkControlHeader linkLayerHeader;
+};
+
+struct QosNullFrameHeader {
+    CommonFrameHeader header;
+    MacAddress transmitterAddress;
+    MacAddress multiHopSourceAddress;
+    SequenceControlField theSequenceControlField;
+    QosControlField qosControlField;
+};
+
+struct ManagementFrameHeader {
+    CommonFrameHeader header;
+    MacAddress transmitterAddress;
+    MacAddress bssid;
+    SequenceControlField theSequenceControlField;
+};
+
+struct HtCapabilitiesFrameElement {
+    bool aggregateMpdusAreEnabled;
+
+    HtCapabilitiesFrameElement() : aggregateMpdusAreEnabled(false) { }
+};
+
+struct AssociationRequestFrame {
+    ManagementFrameHeader managementHeader;
+    HtCapabilitiesFrameElement theHtCapabilitiesFrameElement;
+};
+
+struct ReassociationRequestFrame {
+    ManagementFrameHeader managementHeader;
+    MacAddress currentApAddress;
+    HtCapabilitiesFrameElement theHtCapabilitiesFrameElement;
+};
+
+struct AssociationResponseFrame {
+    ManagementFrameHeader managementHeader;
+    AssociationId theAssociationId;
+    HtCapabilitiesFrameElement theHtCapabilitiesFrameElement;
+};
+
+struct ReassociationResponseFrame {
+    ManagementFrameHeader managementHeader;
+    AssociationId theAssociationId;
+    HtCapabilitiesFrameElement theHtCapabilitiesFrameElement;
+};
+
+struct DisassociationFrame {
+    ManagementFrameHeader managementHeader;
+};
+
+struct AuthenticationFrame {
+    ManagementFrameHeader managementHeader;
+};
+
+struct MpduDelimiterFrame {
+    unsigned short int lengthBytes;
+    unsigned short int notUsed;
+
+    MpduDelimiterFrame() : lengthBytes(0), notUsed(0) { }
+};
+
+const unsigned int BlockAckBitMapNumBits = 64;
+
+struct BlockAckRequestControlField {
+    unsigned char trafficId;
+
+    BlockAckRequestControlField() : trafficId(0) { }
+};
+
+struct BlockAcknowledgementRequestFrame {
+    CommonFrameHeader header;
+    MacAddress transmitterAddress;
+    BlockAckRequestControlField blockAckRequestControl;
+    unsigned short int startingSequenceControl;
+};
+
+struct BlockAcknowledgementFrame {
+    CommonFrameHeader header;
+    MacAddress transmitterAddress;
+    BlockAckRequestControlField blockAckControl;
+    unsigned short int startingSequenceControl;
+    std::bitset<BlockAckBitMapNumBits> blockAckBitmap;
+
+    bool IsAcked(const unsigned short int sequenceNumber) const
+    {
+        const int difference =
+            ScenSim::CalcTwelveBitSequenceNumberDifference(sequenceNumber, startingSequenceControl);
+
+        return ((difference >= 0) &&
+                (difference < static_cast<int>(BlockAckBitMapNumBits)) &&
+                (blockAckBitmap[BlockAckBitMapNumBits - difference - 1]));
+    }
+};
+
+}//namespace//
+
+#endif
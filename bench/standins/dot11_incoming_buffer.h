@@ -0,0 +1,83 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// Duplicate detection on the last sequence number per transmitter and traffic
+// id; no reordering and no block ack window.
+
+#ifndef DOT11_INCOMING_BUFFER_H
+#define DOT11_INCOMING_BUFFER_H
+
+#include "dot11_common.h"
+#include "dot11_headers.h"
+
+namespace Dot11 {
+
+class IncomingFrameBuffer {
+public:
+    void ProcessIncomingFrame(
+        const Packet& aFrame,
+        const MacAddress& transmitterAddress,
+        const PacketPriority& trafficId,
+        const unsigned short int sequenceNumber,
+        bool& frameIsInOrder,
+        bool& haveAlreadySeenThisFrame,
+        vector<unique_ptr<Packet> >& bufferedPacketsToSendUp)
+    {
+        (*this).ProcessIncomingNonDataFrame(
+            transmitterAddress, trafficId, sequenceNumber, haveAlreadySeenThisFrame, bufferedPacketsToSendUp);
+
+        frameIsInOrder = !haveAlreadySeenThisFrame;
+    }
+
+    void ProcessIncomingSubframe(
+        unique_ptr<Packet>& subframePtr,
+        const MacAddress& transmitterAddress,
+        const PacketPriority& trafficId,
+        const unsigned short int sequenceNumber,
+        bool& frameIsInOrder,
+        bool& haveAlreadySeenThisFrame,
+        vector<unique_ptr<Packet> >& bufferedPacketsToSendUp)
+    {
+        (*this).ProcessIncomingFrame(
+            *subframePtr, transmitterAddress, trafficId, sequenceNumber,
+            frameIsInOrder, haveAlreadySeenThisFrame, bufferedPacketsToSendUp);
+    }
+
+    void ProcessIncomingNonDataFrame(
+        const MacAddress& transmitterAddress,
+        const PacketPriority& trafficId,
+        const unsigned short int sequenceNumber,
+        bool& haveAlreadySeenThisFrame,
+        vector<unique_ptr<Packet> >& bufferedPacketsToSendUp)
+    {
+        typedef map<pair<MacAddress, PacketPriority>, unsigned short int>::iterator IterType;
+
+        const pair<MacAddress, PacketPriority> key(transmitterAddress, trafficId);
+
+        IterType iter = lastSequenceNumbers.find(key);
+
+        haveAlreadySeenThisFrame = ((iter != lastSequenceNumbers.end()) && (iter->second == sequenceNumber));
+
+        lastSequenceNumbers[key] = sequenceNumber;
+    }
+
+    void ProcessBlockAckRequestFrame(
+        const BlockAcknowledgementRequestFrame& blockAckRequestFrame,
+        vector<unique_ptr<Packet> >& bufferedPacketsToSendUp) { }
+
+    void GetBlockAckInfo(
+        const MacAddress& transmitterAddress,
+        const PacketPriority& trafficId,
+        bool& success,
+        unsigned short int& startingSequenceControlNum,
+        bitset<BlockAckBitMapNumBits>& blockAckBitmap) const
+    {
+        success = false;
+    }
+
+private:
+    map<pair<MacAddress, PacketPriority>, unsigned short int> lastSequenceNumbers;
+
+};//IncomingFrameBuffer//
+
+}//namespace//
+
+#endif
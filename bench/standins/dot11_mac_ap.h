@@ -0,0 +1,36 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// Only ad-hoc operation is supported by the benchmark stand-ins; constructing
+// an access point controller is an error.
+
+#ifndef DOT11_MAC_AP_H
+#define DOT11_MAC_AP_H
+
+#include "dot11_common.h"
+#include "dot11_headers.h"
+
+namespace Dot11 {
+
+class Dot11ApManagementController {
+public:
+    template<typename... Args>
+    Dot11ApManagementController(const Args&... notUsed)
+    {
+        cerr << "Error: Access point mode is not supported by the benchmark stand-ins." << endl;
+        exit(1);
+    }
+
+    template<typename... Args> bool StationIsAsleep(const Args&...) const { return false; }
+    template<typename... Args> bool IsAnAssociatedStaAddress(const Args&...) const { return false; }
+    template<typename... Args> void BufferPacketForSleepingStation(Args&&...) { }
+    template<typename... Args> void BufferManagementFrameForSleepingStation(Args&&...) { }
+    template<typename... Args> void GetBufferedTopPacketInfo(Args&&...) const { }
+    template<typename... Args> void GetPowerSaveBufferedPacket(Args&&...) { }
+    template<typename... Args> void LookupAssociatedNodeMacAddress(Args&&...) const { }
+    template<typename... Args> void ProcessManagementFrame(Args&&...) { }
+    template<typename... Args> void ReceiveFramePowerManagementBit(Args&&...) { }
+
+};//Dot11ApManagementController//
+
+}//namespace//
+
+#endif
@@ -0,0 +1,29 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// Only ad-hoc operation is supported by the benchmark stand-ins; constructing
+// an infrastructure station controller is an error.
+
+#ifndef DOT11_MAC_STA_H
+#define DOT11_MAC_STA_H
+
+#include "dot11_common.h"
+#include "dot11_headers.h"
+
+namespace Dot11 {
+
+class Dot11StaManagementController {
+public:
+    template<typename... Args>
+    Dot11StaManagementController(const Args&... notUsed)
+    {
+        cerr << "Error: Infrastructure station mode is not supported by the benchmark stand-ins." << endl;
+        exit(1);
+    }
+
+    template<typename... Args> void GetCurrentAccessPointAddress(Args&&...) const { }
+    template<typename... Args> void ProcessManagementFrame(Args&&...) { }
+
+};//Dot11StaManagementController//
+
+}//namespace//
+
+#endif
@@ -0,0 +1,500 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// Half-duplex OFDM PHY with 802.11p (10 MHz) timing on a single collision
+// domain: no path loss, any overlap of two signals corrupts both, and a node
+// cannot receive while it transmits.  Frame aggregation is not modeled.
+
+#ifndef DOT11_PHY_H
+#define DOT11_PHY_H
+
+#include "scensim_engine.h"
+#include "scensim_netsim.h"
+#include "scensim_prop.h"
+
+#include "dot11_common.h"
+
+namespace Dot11 {
+
+using ScenSim::MacAndPhyInfoInterface;
+using ScenSim::SimplePropagationModelForNode;
+
+class Dot11MacInterfaceForPhy {
+public:
+    virtual ~Dot11MacInterfaceForPhy() { }
+
+    virtual void BusyChannelAtPhysicalLayerNotification() = 0;
+    virtual void ClearChannelAtPhysicalLayerNotification() = 0;
+    virtual void TransmissionIsCompleteNotification() = 0;
+    virtual void DoSuccessfulTransmissionPostProcessing(const bool wasJustTransmitting) = 0;
+
+    virtual void ReceiveFrameFromPhy(
+        const Packet& aFrame,
+        const TransmissionParameters& receivedFrameTxParameters) = 0;
+
+    virtual void ReceiveAggregatedSubframeFromPhy(
+        unique_ptr<Packet>& subframePtr,
+        const TransmissionParameters& receivedFrameTxParameters,
+        const unsigned int aggregateFrameSubframeIndex,
+        const unsigned int numberSubframes) = 0;
+
+    virtual void NotifyThatPhyReceivedCorruptedFrame() = 0;
+
+    virtual void NotifyThatPhyReceivedCorruptedAggregatedSubframe(
+        const TransmissionParameters& receivedFrameTxParameters,
+        const unsigned int aggregateFrameSubframeIndex,
+        const unsigned int numberSubframes) = 0;
+
+    virtual bool AggregatedSubframeIsForThisNode(const Packet& frame) const = 0;
+
+};//Dot11MacInterfaceForPhy//
+
+
+
+struct Dot11PropFrame {
+    shared_ptr<Packet> macFramePtr;
+    TransmissionParameters txParameters;
+    double txPowerDbm;
+};
+
+
+
+class Dot11Phy : public SimplePropagationModelForNode<Dot11PropFrame>::SignalHandler {
+public:
+    typedef Dot11PropFrame PropFrame;
+
+    typedef SimplePropagationModelForNode<PropFrame> PropModelInterface;
+
+    static const unsigned int defaultChannelCount = 7;
+    static const unsigned int baseChannelBandwidthMhz = 10;
+
+    Dot11Phy(
+        const ParameterDatabaseReader& theParameterDatabaseReader,
+        const shared_ptr<SimulationEngineInterface>& initSimEngineInterfacePtr,
+        const shared_ptr<PropModelInterface>& initPropModelInterfacePtr,
+        const InterfaceId& initPhyDeviceName);
+
+    ~Dot11Phy() { propModelInterfacePtr->SetSignalHandler(nullptr); }
+
+    void SetMacInterfaceForPhy(const shared_ptr<Dot11MacInterfaceForPhy>& newMacInterfacePtr);
+
+    shared_ptr<MacAndPhyInfoInterface> GetDot11InfoInterface() const { return infoInterfacePtr; }
+    const InterfaceId& GetInterfaceId() const { return phyDeviceName; }
+    shared_ptr<PropModelInterface> GetPropModelInterface() const { return propModelInterfacePtr; }
+
+    const map<DatarateBitsPerSec, ModulationAndCodingSchemesType>& GetModulationAndCodingShemeMap() const
+        { return modulationAndCodingSchemeMap; }
+
+    unsigned int GetChannelCount() const { return channelCount; }
+    unsigned int GetBaseChannelBandwidthMhz() const { return baseChannelBandwidthMhz; }
+
+    unsigned int GetCurrentChannelNumber() const
+    {
+        assert(!currentBondedChannelList.empty());
+        return (currentBondedChannelList[0]);
+    }
+
+    const vector<unsigned int>& GetCurrentBondedChannelList() const { return currentBondedChannelList; }
+
+    void SwitchToChannelNumber(const unsigned int channelNumber)
+        { (*this).SwitchToChannels(vector<unsigned int>(1, channelNumber)); }
+
+    void SwitchToChannels(const vector<unsigned int>& newBondedChannelList);
+
+    SimTime GetShortInterframeSpaceDuration() const { return (32 * MICRO_SECOND); }
+    SimTime GetSlotDuration() const { return (13 * MICRO_SECOND); }
+    SimTime GetRxTxTurnaroundTime() const { return (2 * MICRO_SECOND); }
+    SimTime GetPhyRxStartDelay() const { return (preambleAndSignalDuration); }
+
+    SimTime CalculateFrameDataDuration(
+        const unsigned int frameLengthBytes,
+        const TransmissionParameters& txParameters) const;
+
+    SimTime CalculateFrameTransmitDuration(
+        const unsigned int frameLengthBytes,
+        const TransmissionParameters& txParameters) const
+    {
+        return (preambleAndSignalDuration + (*this).CalculateFrameDataDuration(frameLengthBytes, txParameters));
+    }
+
+    void StartReceivingFrames() { receivingIsEnabled = true; }
+    void StopReceivingFrames() { receivingIsEnabled = false; }
+    bool IsNotReceivingFrames() const { return (!receivingIsEnabled); }
+
+    bool IsTransmittingAFrame() const { return (isTransmitting); }
+    bool IsReceivingAFrame() const { return (!incomingSignals.empty()); }
+    bool ChannelIsClear() const { return ((!isTransmitting) && (incomingSignals.empty())); }
+
+    SimTime GetOutgoingTransmissionEndTime() const { return (outgoingTransmissionEndTime); }
+
+    double GetRssiOfLastFrameDbm() const { return (lastReceivedFrameRssiDbm); }
+
+    void TransmitFrame(
+        unique_ptr<Packet>& macFramePtr,
+        const TransmissionParameters& txParameters,
+        const double transmitPowerDbm,
+        const SimTime& delayUntilAirborne);
+
+    void TransmitAggregateFrame(
+        unique_ptr<vector<unique_ptr<Packet> > >& aggregateFramePtr,
+        const bool isAMpduAggregate,
+        const TransmissionParameters& txParameters,
+        const double transmitPowerDbm,
+        const SimTime& delayUntilAirborne)
+    {
+        cerr << "Error: Frame aggregation is not supported by the Dot11Phy stand-in." << endl;
+        exit(1);
+    }
+
+    void TakeOwnershipOfLastTransmittedFrame(unique_ptr<Packet>& macFramePtr)
+    {
+        assert(lastTransmittedFramePtr != nullptr);
+        macFramePtr.reset(new Packet(*lastTransmittedFramePtr->macFramePtr));
+    }
+
+    void TakeOwnershipOfLastTransmittedAggregateFrame(
+        unique_ptr<vector<unique_ptr<Packet> > >& aggregateFramePtr)
+    {
+        assert(false && "Frame aggregation is not supported by the Dot11Phy stand-in."); abort();
+    }
+
+    virtual void ProcessSignalArrivalFromChannel(
+        const unsigned int channelNumber,
+        const shared_ptr<const PropFrame>& framePtr,
+        const SimTime& signalEndTime) override;
+
+private:
+    static constexpr SimTime preambleAndSignalDuration = (40 * MICRO_SECOND);
+    static constexpr SimTime ofdmSymbolDuration = (8 * MICRO_SECOND);
+    static constexpr unsigned int serviceAndTailBits = (16 + 6);
+
+    static const double fixedPathLossDb;
+
+    class SignalStartEvent : public SimulationEvent {
+    public:
+        SignalStartEvent(Dot11Phy* initPhyPtr) : phyPtr(initPhyPtr) { }
+        void ExecuteEvent() { phyPtr->StartTransmission(); }
+    private:
+        Dot11Phy* phyPtr;
+    };
+
+    class SignalEndEvent : public SimulationEvent {
+    public:
+        SignalEndEvent(Dot11Phy* initPhyPtr) : phyPtr(initPhyPtr) { }
+        void ExecuteEvent() { phyPtr->EndTransmission(); }
+    private:
+        Dot11Phy* phyPtr;
+    };
+
+    class IncomingSignalEndEvent : public SimulationEvent {
+    public:
+        IncomingSignalEndEvent(Dot11Phy* initPhyPtr, const unsigned long long int initSignalSequenceNumber)
+            : phyPtr(initPhyPtr), signalSequenceNumber(initSignalSequenceNumber) { }
+        void ExecuteEvent() { phyPtr->EndIncomingSignal(signalSequenceNumber); }
+    private:
+        Dot11Phy* phyPtr;
+        unsigned long long int signalSequenceNumber;
+    };
+
+    struct IncomingSignal {
+        unsigned long long int signalSequenceNumber;
+        shared_ptr<const PropFrame> framePtr;
+        bool isCorrupted;
+    };
+
+    shared_ptr<SimulationEngineInterface> simEngineInterfacePtr;
+    shared_ptr<PropModelInterface> propModelInterfacePtr;
+    shared_ptr<MacAndPhyInfoInterface> infoInterfacePtr;
+    shared_ptr<Dot11MacInterfaceForPhy> macLayerPtr;
+
+    InterfaceId phyDeviceName;
+    unsigned int channelCount;
+    vector<unsigned int> currentBondedChannelList;
+
+    map<DatarateBitsPerSec, ModulationAndCodingSchemesType> modulationAndCodingSchemeMap;
+
+    bool receivingIsEnabled;
+
+    // The MAC considers the medium busy (sent a busy notification or started a transmission)
+    // and is owed a clear notification.
+
+    bool macIsOwedClearNotification;
+
+    bool isTransmitting;
+    SimTime outgoingTransmissionEndTime;
+    shared_ptr<PropFrame> lastTransmittedFramePtr;
+    shared_ptr<SignalStartEvent> signalStartEventPtr;
+    shared_ptr<SignalEndEvent> signalEndEventPtr;
+
+    vector<IncomingSignal> incomingSignals;
+    unsigned long long int nextSignalSequenceNumber;
+    double lastReceivedFrameRssiDbm;
+
+    // Frames lost to overlapping signals (collisions) while receiving.
+
+    shared_ptr<ScenSim::CounterStatistic> corruptedFramesStatPtr;
+
+    void StartTransmission();
+    void EndTransmission();
+    void EndIncomingSignal(const unsigned long long int signalSequenceNumber);
+    void NotifyClearChannelIfIdle();
+
+};//Dot11Phy//
+
+inline const double Dot11Phy::fixedPathLossDb = 80.0;
+
+
+inline
+unsigned int GetNumberOfDataBitsPerOfdmSymbol(const ModulationAndCodingSchemesType& modulationAndCodingScheme)
+{
+    static const unsigned int dataBitsPerSymbol[NumberModulationAndCodingSchemes] =
+        { 24, 36, 48, 72, 96, 144, 192, 216 };
+
+    assert(modulationAndCodingScheme < NumberModulationAndCodingSchemes);
+
+    return (dataBitsPerSymbol[modulationAndCodingScheme]);
+}
+
+
+inline
+Dot11Phy::Dot11Phy(
+    const ParameterDatabaseReader& theParameterDatabaseReader,
+    const shared_ptr<SimulationEngineInterface>& initSimEngineInterfacePtr,
+    const shared_ptr<PropModelInterface>& initPropModelInterfacePtr,
+    const InterfaceId& initPhyDeviceName)
+    :
+    simEngineInterfacePtr(initSimEngineInterfacePtr),
+    propModelInterfacePtr(initPropModelInterfacePtr),
+    infoInterfacePtr(new MacAndPhyInfoInterface()),
+    phyDeviceName(initPhyDeviceName),
+    channelCount(defaultChannelCount),
+    receivingIsEnabled(true),
+    macIsOwedClearNotification(false),
+    isTransmitting(false),
+    outgoingTransmissionEndTime(ZERO_TIME),
+    signalStartEventPtr(new SignalStartEvent(this)),
+    signalEndEventPtr(new SignalEndEvent(this)),
+    nextSignalSequenceNumber(0),
+    lastReceivedFrameRssiDbm(0.0),
+    corruptedFramesStatPtr(
+        simEngineInterfacePtr->CreateCounterStat("Dot11Phy_" + phyDeviceName + "_CorruptedFramesReceived"))
+{
+    const NodeId theNodeId = propModelInterfacePtr->GetNodeId();
+
+    if (theParameterDatabaseReader.ParameterExists("dot11-channel-count", theNodeId, phyDeviceName)) {
+        channelCount =
+            theParameterDatabaseReader.ReadNonNegativeInt("dot11-channel-count", theNodeId, phyDeviceName);
+    }//if//
+
+    for(unsigned int i = 0; (i < NumberModulationAndCodingSchemes); i++) {
+        const ModulationAndCodingSchemesType modulationAndCodingScheme =
+            static_cast<ModulationAndCodingSchemesType>(i);
+
+        const DatarateBitsPerSec datarateBitsPerSec =
+            (GetNumberOfDataBitsPerOfdmSymbol(modulationAndCodingScheme) * SECOND) / ofdmSymbolDuration;
+
+        modulationAndCodingSchemeMap[datarateBitsPerSec] = modulationAndCodingScheme;
+    }//for//
+
+    propModelInterfacePtr->SetSignalHandler(this);
+
+}//Dot11Phy//
+
+
+inline
+void Dot11Phy::SetMacInterfaceForPhy(const shared_ptr<Dot11MacInterfaceForPhy>& newMacInterfacePtr)
+{
+    // Keep busy/clear notifications balanced per MAC interface.
+
+    if ((macLayerPtr != nullptr) && (macIsOwedClearNotification) && (!isTransmitting)) {
+        macIsOwedClearNotification = false;
+        macLayerPtr->ClearChannelAtPhysicalLayerNotification();
+    }//if//
+
+    macLayerPtr = newMacInterfacePtr;
+
+}//SetMacInterfaceForPhy//
+
+
+inline
+void Dot11Phy::SwitchToChannels(const vector<unsigned int>& newBondedChannelList)
+{
+    assert(!isTransmitting);
+    assert(!newBondedChannelList.empty());
+
+    currentBondedChannelList = newBondedChannelList;
+
+    // Signals in progress on the old channel are lost.
+
+    incomingSignals.clear();
+
+    (*this).NotifyClearChannelIfIdle();
+
+}//SwitchToChannels//
+
+
+inline
+SimTime Dot11Phy::CalculateFrameDataDuration(
+    const unsigned int frameLengthBytes,
+    const TransmissionParameters& txParameters) const
+{
+    const unsigned int dataBitsPerSymbol =
+        GetNumberOfDataBitsPerOfdmSymbol(txParameters.modulationAndCodingScheme);
+
+    const unsigned int numberSymbols =
+        (serviceAndTailBits + (8 * frameLengthBytes) + dataBitsPerSymbol - 1) / dataBitsPerSymbol;
+
+    return (numberSymbols * ofdmSymbolDuration);
+
+}//CalculateFrameDataDuration//
+
+
+inline
+void Dot11Phy::TransmitFrame(
+    unique_ptr<Packet>& macFramePtr,
+    const TransmissionParameters& txParameters,
+    const double transmitPowerDbm,
+    const SimTime& delayUntilAirborne)
+{
+    assert(!isTransmitting);
+    assert(!currentBondedChannelList.empty());
+
+    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+
+    lastTransmittedFramePtr.reset(new PropFrame());
+    lastTransmittedFramePtr->macFramePtr.reset(macFramePtr.release());
+    lastTransmittedFramePtr->txParameters = txParameters;
+    lastTransmittedFramePtr->txPowerDbm = transmitPowerDbm;
+
+    isTransmitting = true;
+    macIsOwedClearNotification = true;
+
+    outgoingTransmissionEndTime =
+        currentTime + delayUntilAirborne +
+        (*this).CalculateFrameTransmitDuration(
+            static_cast<unsigned int>(lastTransmittedFramePtr->macFramePtr->LengthBytes()), txParameters);
+
+    // Half duplex: anything being received is lost.
+
+    for(size_t i = 0; (i < incomingSignals.size()); i++) {
+        incomingSignals[i].isCorrupted = true;
+    }//for//
+
+    if (delayUntilAirborne == ZERO_TIME) {
+        (*this).StartTransmission();
+    }
+    else {
+        simEngineInterfacePtr->ScheduleEvent(signalStartEventPtr, (currentTime + delayUntilAirborne));
+    }//if//
+
+}//TransmitFrame//
+
+
+inline
+void Dot11Phy::StartTransmission()
+{
+    simEngineInterfacePtr->ScheduleEvent(signalEndEventPtr, outgoingTransmissionEndTime);
+
+    propModelInterfacePtr->TransmitSignal(
+        currentBondedChannelList[0], lastTransmittedFramePtr, outgoingTransmissionEndTime);
+
+}//StartTransmission//
+
+
+inline
+void Dot11Phy::EndTransmission()
+{
+    isTransmitting = false;
+
+    macLayerPtr->TransmissionIsCompleteNotification();
+
+    (*this).NotifyClearChannelIfIdle();
+
+}//EndTransmission//
+
+
+inline
+void Dot11Phy::ProcessSignalArrivalFromChannel(
+    const unsigned int channelNumber,
+    const shared_ptr<const PropFrame>& framePtr,
+    const SimTime& signalEndTime)
+{
+    if ((!receivingIsEnabled) ||
+        (macLayerPtr == nullptr) ||
+        (currentBondedChannelList.empty()) ||
+        (channelNumber != currentBondedChannelList[0])) {
+        return;
+    }//if//
+
+    IncomingSignal newSignal;
+    newSignal.signalSequenceNumber = nextSignalSequenceNumber;
+    newSignal.framePtr = framePtr;
+    newSignal.isCorrupted = (isTransmitting || (!incomingSignals.empty()));
+
+    for(size_t i = 0; (i < incomingSignals.size()); i++) {
+        incomingSignals[i].isCorrupted = true;
+    }//for//
+
+    incomingSignals.push_back(newSignal);
+    nextSignalSequenceNumber++;
+
+    simEngineInterfacePtr->ScheduleEvent(
+        shared_ptr<SimulationEvent>(new IncomingSignalEndEvent(this, newSignal.signalSequenceNumber)),
+        signalEndTime);
+
+    if ((!isTransmitting) && (!macIsOwedClearNotification)) {
+        macIsOwedClearNotification = true;
+        macLayerPtr->BusyChannelAtPhysicalLayerNotification();
+    }//if//
+
+}//ProcessSignalArrivalFromChannel//
+
+
+inline
+void Dot11Phy::EndIncomingSignal(const unsigned long long int signalSequenceNumber)
+{
+    size_t signalIndex = 0;
+
+    while ((signalIndex < incomingSignals.size()) &&
+           (incomingSignals[signalIndex].signalSequenceNumber != signalSequenceNumber)) {
+        signalIndex++;
+    }//while//
+
+    if (signalIndex == incomingSignals.size()) {
+        // Dropped by a channel switch.
+        return;
+    }//if//
+
+    const IncomingSignal endedSignal = incomingSignals[signalIndex];
+
+    incomingSignals.erase(incomingSignals.begin() + signalIndex);
+
+    if (!isTransmitting) {
+        if (endedSignal.isCorrupted) {
+            corruptedFramesStatPtr->IncrementCounter();
+            macLayerPtr->NotifyThatPhyReceivedCorruptedFrame();
+        }
+        else {
+            lastReceivedFrameRssiDbm = (endedSignal.framePtr->txPowerDbm - fixedPathLossDb);
+
+            macLayerPtr->ReceiveFrameFromPhy(
+                *endedSignal.framePtr->macFramePtr, endedSignal.framePtr->txParameters);
+        }//if//
+    }//if//
+
+    (*this).NotifyClearChannelIfIdle();
+
+}//EndIncomingSignal//
+
+
+inline
+void Dot11Phy::NotifyClearChannelIfIdle()
+{
+    if ((macIsOwedClearNotification) && (!isTransmitting) && (incomingSignals.empty())) {
+        macIsOwedClearNotification = false;
+        macLayerPtr->ClearChannelAtPhysicalLayerNotification();
+    }//if//
+
+}//NotifyClearChannelIfIdle//
+
+}//namespace//
+
+#endif
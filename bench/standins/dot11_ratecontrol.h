@@ -0,0 +1,159 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// Fixed rate controller: one modulation and coding scheme for data frames and
+// one for management/control frames, no adaptation on ACK success or failure.
+
+#ifndef DOT11_RATECONTROL_H
+#define DOT11_RATECONTROL_H
+
+#include "scensim_engine.h"
+#include "dot11_common.h"
+
+namespace Dot11 {
+
+inline
+ModulationAndCodingSchemesType ConvertNameToModulationAndCodingScheme(
+    const string& modulationAndCodingName,
+    const string& parameterNameForErrorOutput)
+{
+    static const char* const names[NumberModulationAndCodingSchemes] = {
+        "bpsk_0.5", "bpsk_0.75", "qpsk_0.5", "qpsk_0.75",
+        "16qam_0.5", "16qam_0.75", "64qam_0.67", "64qam_0.75",
+    };
+
+    const string lowerCaseName = MakeLowerCaseString(modulationAndCodingName);
+
+    for(unsigned int i = 0; (i < NumberModulationAndCodingSchemes); i++) {
+        if (lowerCaseName == names[i]) {
+            return (static_cast<ModulationAndCodingSchemesType>(i));
+        }//if//
+    }//for//
+
+    cerr << "Error: Unknown modulation and coding \"" << modulationAndCodingName
+         << "\" for parameter " << parameterNameForErrorOutput << endl;
+    exit(1);
+
+}//ConvertNameToModulationAndCodingScheme//
+
+
+
+class AdaptiveRateController {
+public:
+    AdaptiveRateController(
+        const ParameterDatabaseReader& theParameterDatabaseReader,
+        const NodeId& theNodeId,
+        const InterfaceId& theInterfaceId,
+        const unsigned int initBaseChannelBandwidthMhz);
+
+    virtual ~AdaptiveRateController() { }
+
+    void SetModulationAndCondingMapForDatarateSpecifiedFrame(
+        const map<DatarateBitsPerSec, ModulationAndCodingSchemesType>& initModulationAndCodingSchemeMap)
+    {
+        modulationAndCodingSchemeMap = initModulationAndCodingSchemeMap;
+    }
+
+    ModulationAndCodingSchemesType GetLowestModulationAndCoding() const { return McsBpsk1Over2; }
+
+    virtual void GetDataRateInfoForDataFrameToStation(
+        const MacAddress& macAddress,
+        TransmissionParameters& txParameters) const
+    {
+        txParameters.channelBandwidthMhz = baseChannelBandwidthMhz;
+        txParameters.modulationAndCodingScheme = dataFrameModulationAndCodingScheme;
+    }
+
+    virtual void GetDataRateInfoForManagementFrameToStation(
+        const MacAddress& macAddress,
+        TransmissionParameters& txParameters) const
+    {
+        txParameters.channelBandwidthMhz = baseChannelBandwidthMhz;
+        txParameters.modulationAndCodingScheme = managementFrameModulationAndCodingScheme;
+    }
+
+    virtual void GetDataRateInfoForAckFrame(
+        const MacAddress& macAddress,
+        const TransmissionParameters& receivedFrameTxParameters,
+        TransmissionParameters& ackTxParameters) const
+    {
+        (*this).GetDataRateInfoForManagementFrameToStation(macAddress, ackTxParameters);
+        ackTxParameters.channelBandwidthMhz = receivedFrameTxParameters.channelBandwidthMhz;
+    }
+
+    void GetDataRateInfoForDatarateSpecifiedFrame(
+        const DatarateBitsPerSec& datarateBitsPerSec,
+        TransmissionParameters& txParameters) const
+    {
+        typedef map<DatarateBitsPerSec, ModulationAndCodingSchemesType>::const_iterator IterType;
+
+        IterType iter = modulationAndCodingSchemeMap.find(datarateBitsPerSec);
+
+        if (iter == modulationAndCodingSchemeMap.end()) {
+            cerr << "Error: Datarate " << datarateBitsPerSec
+                 << " bps does not match any modulation and coding scheme." << endl;
+            exit(1);
+        }//if//
+
+        txParameters.channelBandwidthMhz = baseChannelBandwidthMhz;
+        txParameters.modulationAndCodingScheme = iter->second;
+    }
+
+    virtual void NotifyAckReceived(const MacAddress& macAddress) { }
+    virtual void NotifyAckFailed(const MacAddress& macAddress) { }
+
+private:
+    unsigned int baseChannelBandwidthMhz;
+    ModulationAndCodingSchemesType dataFrameModulationAndCodingScheme;
+    ModulationAndCodingSchemesType managementFrameModulationAndCodingScheme;
+
+    map<DatarateBitsPerSec, ModulationAndCodingSchemesType> modulationAndCodingSchemeMap;
+
+};//AdaptiveRateController//
+
+
+inline
+AdaptiveRateController::AdaptiveRateController(
+    const ParameterDatabaseReader& theParameterDatabaseReader,
+    const NodeId& theNodeId,
+    const InterfaceId& theInterfaceId,
+    const unsigned int initBaseChannelBandwidthMhz)
+    :
+    baseChannelBandwidthMhz(initBaseChannelBandwidthMhz),
+    dataFrameModulationAndCodingScheme(McsBpsk1Over2),
+    managementFrameModulationAndCodingScheme(McsBpsk1Over2)
+{
+    if (theParameterDatabaseReader.ParameterExists("dot11-modulation-and-coding", theNodeId, theInterfaceId)) {
+        dataFrameModulationAndCodingScheme =
+            ConvertNameToModulationAndCodingScheme(
+                theParameterDatabaseReader.ReadString("dot11-modulation-and-coding", theNodeId, theInterfaceId),
+                "dot11-modulation-and-coding");
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+        "dot11-modulation-and-coding-for-management-frames", theNodeId, theInterfaceId)) {
+
+        managementFrameModulationAndCodingScheme =
+            ConvertNameToModulationAndCodingScheme(
+                theParameterDatabaseReader.ReadString(
+                    "dot11-modulation-and-coding-for-management-frames", theNodeId, theInterfaceId),
+                "dot11-modulation-and-coding-for-management-frames");
+    }//if//
+
+}//AdaptiveRateController//
+
+
+inline
+shared_ptr<AdaptiveRateController> CreateAdaptiveRateController(
+    const shared_ptr<SimulationEngineInterface>& simulationEngineInterfacePtr,
+    const ParameterDatabaseReader& theParameterDatabaseReader,
+    const NodeId& theNodeId,
+    const InterfaceId& theInterfaceId,
+    const unsigned int baseChannelBandwidthMhz)
+{
+    return (shared_ptr<AdaptiveRateController>(
+        new AdaptiveRateController(
+            theParameterDatabaseReader, theNodeId, theInterfaceId, baseChannelBandwidthMhz)));
+}
+
+}//namespace//
+
+#endif
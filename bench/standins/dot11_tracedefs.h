@@ -0,0 +1,87 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// Binary trace output is always off in the stand-in engine, so the record
+// sizes are simply the struct sizes.
+
+#ifndef DOT11_TRACEDEFS_H
+#define DOT11_TRACEDEFS_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Dot11 {
+
+struct MacFrameReceiveTraceRecord {
+    uint64_t sourceNodeSequenceNumber;
+    uint32_t sourceNodeId;
+    uint16_t frameType;
+    uint16_t packetLengthBytes;
+};
+const size_t MAC_FRAME_RECEIVE_TRACE_RECORD_BYTES = sizeof(MacFrameReceiveTraceRecord);
+
+struct MacIfsAndBackoffStartTraceRecord {
+    long long int duration;
+    uint32_t accessCategory;
+    bool frameCorrupt;
+};
+const size_t MAC_IFS_AND_BACKOFF_START_TRACE_RECORD_BYTES = sizeof(MacIfsAndBackoffStartTraceRecord);
+
+struct MacIfsAndBackoffPauseTraceRecord {
+    long long int leftDuration;
+    uint32_t accessCategory;
+};
+const size_t MAC_IFS_AND_BACKOFF_PAUSE_TRACE_RECORD_BYTES = sizeof(MacIfsAndBackoffPauseTraceRecord);
+
+struct MacPacketDequeueTraceRecord {
+    uint64_t sourceNodeSequenceNumber;
+    uint32_t sourceNodeId;
+    uint32_t accessCategory;
+};
+const size_t MAC_PACKET_DEQUEUE_TRACE_RECORD_BYTES = sizeof(MacPacketDequeueTraceRecord);
+
+struct MacTxRtsTraceRecord {
+    uint32_t accessCategory;
+    uint32_t retry;
+};
+const size_t MAC_TX_RTS_TRACE_RECORD_BYTES = sizeof(MacTxRtsTraceRecord);
+
+struct MacTxUnicastDataTraceRecord {
+    uint64_t sourceNodeSequenceNumber;
+    uint32_t sourceNodeId;
+    uint32_t accessCategory;
+    uint32_t shortFrameRetry;
+    uint32_t longFrameRetry;
+};
+const size_t MAC_TX_UNICAST_DATA_TRACE_RECORD_BYTES = sizeof(MacTxUnicastDataTraceRecord);
+
+struct MacTxBroadcastDataTraceRecord {
+    uint64_t sourceNodeSequenceNumber;
+    uint32_t sourceNodeId;
+    uint32_t accessCategory;
+};
+const size_t MAC_TX_BROADCAST_DATA_TRACE_RECORD_BYTES = sizeof(MacTxBroadcastDataTraceRecord);
+
+struct Dot11MacTxManagementTraceRecord {
+    uint64_t sourceNodeSequenceNumber;
+    uint32_t sourceNodeId;
+    uint32_t frameType;
+};
+const size_t DOT11_MAC_TX_MANAGEMENT_TRACE_RECORD_BYTES = sizeof(Dot11MacTxManagementTraceRecord);
+
+struct MacCtsOrAckTimeoutTraceRecord {
+    uint32_t accessCategory;
+    uint32_t windowSlot;
+    uint32_t shortFrameRetry;
+    uint32_t longFrameRetry;
+    bool shortFrameOrNot;
+};
+const size_t MAC_CTSORACK_TIMEOUT_TRACE_RECORD_BYTES = sizeof(MacCtsOrAckTimeoutTraceRecord);
+
+struct MacPacketRetryExceededTraceRecord {
+    uint64_t sourceNodeSequenceNumber;
+    uint32_t sourceNodeId;
+};
+const size_t MAC_PACKET_RETRY_EXCEEDED_TRACE_RECORD_BYTES = sizeof(MacPacketRetryExceededTraceRecord);
+
+}//namespace//
+
+#endif
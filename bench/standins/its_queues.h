@@ -0,0 +1,263 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// One FIFO per packet priority; each entry carries the next hop, ether type,
+// enqueue time, retry count and an optional per-packet datarate/tx power.
+
+#ifndef ITS_QUEUES_H
+#define ITS_QUEUES_H
+
+#include "scensim_engine.h"
+#include "scensim_netsim.h"
+#include "dot11_common.h"
+
+#include <deque>
+
+namespace Dot11 {
+
+using ScenSim::InterfaceOutputQueue;
+using ScenSim::EnqueueResultType;
+using ScenSim::ENQUEUE_SUCCESS;
+using ScenSim::ENQUEUE_FAILURE_BY_MAX_PACKETS;
+using ScenSim::ETHERTYPE_IS_NOT_SPECIFIED;
+
+class ItsOutputQueueWithPrioritySubqueues : public InterfaceOutputQueue {
+public:
+    static const unsigned int defaultMaxNumberPacketsPerSubqueue = 1000;
+
+    ItsOutputQueueWithPrioritySubqueues(
+        const ParameterDatabaseReader& theParameterDatabaseReader,
+        const InterfaceId& theInterfaceId,
+        const shared_ptr<SimulationEngineInterface>& initSimEngineInterfacePtr,
+        const PacketPriority& maximumPriority);
+
+    virtual bool IsFull(const PacketPriority priority) const override
+        { return (subqueues.at(priority).size() >= maxNumberPacketsPerSubqueue); }
+
+    virtual PacketPriority MaxPossiblePacketPriority() const override
+        { return (static_cast<PacketPriority>(subqueues.size() - 1)); }
+
+    virtual void Insert(
+        unique_ptr<Packet>& packetPtr,
+        const NetworkAddress& nextHopAddress,
+        const PacketPriority priority,
+        EnqueueResultType& enqueueResult,
+        unique_ptr<Packet>& packetToDropPtr,
+        const EtherTypeField etherType = ETHERTYPE_IS_NOT_SPECIFIED) override
+    {
+        (*this).InsertEntry(
+            packetPtr, nextHopAddress, priority, etherType, false, 0, 0.0, enqueueResult, packetToDropPtr);
+    }
+
+    void InsertWithEtherTypeAndDatarateAndTxPower(
+        unique_ptr<Packet>& packetPtr,
+        const NetworkAddress& nextHopAddress,
+        const PacketPriority priority,
+        const EtherTypeField etherType,
+        const DatarateBitsPerSec& datarateBitsPerSec,
+        const double& txPowerDbm,
+        EnqueueResultType& enqueueResult,
+        unique_ptr<Packet>& packetToDropPtr)
+    {
+        (*this).InsertEntry(
+            packetPtr, nextHopAddress, priority, etherType,
+            true, datarateBitsPerSec, txPowerDbm, enqueueResult, packetToDropPtr);
+    }
+
+    bool HasPacketWithPriority(const PacketPriority priority) const
+        { return (!subqueues.at(priority).empty()); }
+
+    const Packet& TopPacket(const PacketPriority priority) const
+        { return (*subqueues.at(priority).front().packetPtr); }
+
+    const NetworkAddress& NextHopForTopPacket(const PacketPriority priority) const
+        { return (subqueues.at(priority).front().nextHopAddress); }
+
+    void DequeuePacketWithPriority(
+        const PacketPriority priority,
+        unique_ptr<Packet>& packetPtr,
+        NetworkAddress& nextHopAddress,
+        EtherTypeField& etherType,
+        SimTime& timestamp,
+        unsigned int& retryTxCount)
+    {
+        bool notUsedDatarateAndTxPowerAreSpecified;
+        DatarateBitsPerSec notUsedDatarateBitsPerSec;
+        double notUsedTxPowerDbm;
+
+        (*this).DequeuePacketWithEtherTypeAndDatarateAndTxPower(
+            priority, packetPtr, nextHopAddress, timestamp, retryTxCount, etherType,
+            notUsedDatarateAndTxPowerAreSpecified, notUsedDatarateBitsPerSec, notUsedTxPowerDbm);
+    }
+
+    void DequeuePacketWithEtherTypeAndDatarateAndTxPower(
+        const PacketPriority priority,
+        unique_ptr<Packet>& packetPtr,
+        NetworkAddress& nextHopAddress,
+        SimTime& timestamp,
+        unsigned int& retryTxCount,
+        EtherTypeField& etherType,
+        bool& datarateAndTxPowerAreSpecified,
+        DatarateBitsPerSec& datarateBitsPerSec,
+        double& txPowerDbm);
+
+    void RequeueAtFront(
+        unique_ptr<Packet>& packetPtr,
+        const NetworkAddress& nextHopAddress,
+        const PacketPriority priority,
+        const EtherTypeField etherType,
+        const SimTime& timestamp,
+        const unsigned int retryTxCount,
+        const bool datarateAndTxPowerAreSpecified,
+        const DatarateBitsPerSec& datarateBitsPerSec,
+        const double& txPowerDbm);
+
+private:
+    struct OutputQueueRecord {
+        unique_ptr<Packet> packetPtr;
+        NetworkAddress nextHopAddress;
+        EtherTypeField etherType;
+        SimTime timestamp;
+        unsigned int retryTxCount;
+        bool datarateAndTxPowerAreSpecified;
+        DatarateBitsPerSec datarateBitsPerSec;
+        double txPowerDbm;
+    };
+
+    shared_ptr<SimulationEngineInterface> simEngineInterfacePtr;
+    unsigned int maxNumberPacketsPerSubqueue;
+
+    vector<std::deque<OutputQueueRecord> > subqueues;
+
+    void InsertEntry(
+        unique_ptr<Packet>& packetPtr,
+        const NetworkAddress& nextHopAddress,
+        const PacketPriority priority,
+        const EtherTypeField etherType,
+        const bool datarateAndTxPowerAreSpecified,
+        const DatarateBitsPerSec& datarateBitsPerSec,
+        const double& txPowerDbm,
+        EnqueueResultType& enqueueResult,
+        unique_ptr<Packet>& packetToDropPtr);
+
+};//ItsOutputQueueWithPrioritySubqueues//
+
+
+inline
+ItsOutputQueueWithPrioritySubqueues::ItsOutputQueueWithPrioritySubqueues(
+    const ParameterDatabaseReader& theParameterDatabaseReader,
+    const InterfaceId& theInterfaceId,
+    const shared_ptr<SimulationEngineInterface>& initSimEngineInterfacePtr,
+    const PacketPriority& maximumPriority)
+    :
+    simEngineInterfacePtr(initSimEngineInterfacePtr),
+    maxNumberPacketsPerSubqueue(defaultMaxNumberPacketsPerSubqueue),
+    subqueues(maximumPriority + 1)
+{
+    const NodeId theNodeId = simEngineInterfacePtr->GetNodeId();
+
+    if (theParameterDatabaseReader.ParameterExists(
+        "interface-output-queue-max-packets-per-subq", theNodeId, theInterfaceId)) {
+
+        maxNumberPacketsPerSubqueue =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                "interface-output-queue-max-packets-per-subq", theNodeId, theInterfaceId);
+    }//if//
+
+}//ItsOutputQueueWithPrioritySubqueues//
+
+
+inline
+void ItsOutputQueueWithPrioritySubqueues::InsertEntry(
+    unique_ptr<Packet>& packetPtr,
+    const NetworkAddress& nextHopAddress,
+    const PacketPriority priority,
+    const EtherTypeField etherType,
+    const bool datarateAndTxPowerAreSpecified,
+    const DatarateBitsPerSec& datarateBitsPerSec,
+    const double& txPowerDbm,
+    EnqueueResultType& enqueueResult,
+    unique_ptr<Packet>& packetToDropPtr)
+{
+    if ((*this).IsFull(priority)) {
+        enqueueResult = ENQUEUE_FAILURE_BY_MAX_PACKETS;
+        packetToDropPtr = move(packetPtr);
+        return;
+    }//if//
+
+    OutputQueueRecord record;
+    record.packetPtr = move(packetPtr);
+    record.nextHopAddress = nextHopAddress;
+    record.etherType = etherType;
+    record.timestamp = simEngineInterfacePtr->CurrentTime();
+    record.retryTxCount = 0;
+    record.datarateAndTxPowerAreSpecified = datarateAndTxPowerAreSpecified;
+    record.datarateBitsPerSec = datarateBitsPerSec;
+    record.txPowerDbm = txPowerDbm;
+
+    subqueues[priority].push_back(move(record));
+
+    enqueueResult = ENQUEUE_SUCCESS;
+
+}//InsertEntry//
+
+
+inline
+void ItsOutputQueueWithPrioritySubqueues::DequeuePacketWithEtherTypeAndDatarateAndTxPower(
+    const PacketPriority priority,
+    unique_ptr<Packet>& packetPtr,
+    NetworkAddress& nextHopAddress,
+    SimTime& timestamp,
+    unsigned int& retryTxCount,
+    EtherTypeField& etherType,
+    bool& datarateAndTxPowerAreSpecified,
+    DatarateBitsPerSec& datarateBitsPerSec,
+    double& txPowerDbm)
+{
+    std::deque<OutputQueueRecord>& subqueue = subqueues.at(priority);
+
+    assert(!subqueue.empty());
+
+    OutputQueueRecord& record = subqueue.front();
+
+    packetPtr = move(record.packetPtr);
+    nextHopAddress = record.nextHopAddress;
+    timestamp = record.timestamp;
+    retryTxCount = record.retryTxCount;
+    etherType = record.etherType;
+    datarateAndTxPowerAreSpecified = record.datarateAndTxPowerAreSpecified;
+    datarateBitsPerSec = record.datarateBitsPerSec;
+    txPowerDbm = record.txPowerDbm;
+
+    subqueue.pop_front();
+
+}//DequeuePacketWithEtherTypeAndDatarateAndTxPower//
+
+
+inline
+void ItsOutputQueueWithPrioritySubqueues::RequeueAtFront(
+    unique_ptr<Packet>& packetPtr,
+    const NetworkAddress& nextHopAddress,
+    const PacketPriority priority,
+    const EtherTypeField etherType,
+    const SimTime& timestamp,
+    const unsigned int retryTxCount,
+    const bool datarateAndTxPowerAreSpecified,
+    const DatarateBitsPerSec& datarateBitsPerSec,
+    const double& txPowerDbm)
+{
+    OutputQueueRecord record;
+    record.packetPtr = move(packetPtr);
+    record.nextHopAddress = nextHopAddress;
+    record.etherType = etherType;
+    record.timestamp = timestamp;
+    record.retryTxCount = retryTxCount;
+    record.datarateAndTxPowerAreSpecified = datarateAndTxPowerAreSpecified;
+    record.datarateBitsPerSec = datarateBitsPerSec;
+    record.txPowerDbm = txPowerDbm;
+
+    subqueues.at(priority).push_front(move(record));
+
+}//RequeueAtFront//
+
+}//namespace//
+
+#endif
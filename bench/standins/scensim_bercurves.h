@@ -0,0 +1,6 @@
+// Minimal stand-in for the Scenargie header of the same name.
+
+#ifndef SCENSIM_BERCURVES_H
+#define SCENSIM_BERCURVES_H
+
+#endif
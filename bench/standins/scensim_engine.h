@@ -0,0 +1,657 @@
+// Minimal stand-in for the Scenargie engine header of the same name.
+// Only what the WAVE/802.11p model headers and the hot path benchmark use:
+// a sequential event queue, statistics, parameters and random numbers.
+
+#ifndef SCENSIM_ENGINE_H
+#define SCENSIM_ENGINE_H
+
+#include <cassert>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <list>
+#include <queue>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <random>
+
+namespace ScenSim {
+
+using std::string;
+using std::vector;
+using std::map;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+using std::istringstream;
+
+//--------------------------------------------------------------------------------------------------
+
+typedef long long int SimTime;
+
+const SimTime ZERO_TIME = 0;
+const SimTime NANO_SECOND = 1;
+const SimTime MICRO_SECOND = 1000 * NANO_SECOND;
+const SimTime MILLI_SECOND = 1000 * MICRO_SECOND;
+const SimTime SECOND = 1000 * MILLI_SECOND;
+const SimTime MINUTE = 60 * SECOND;
+const SimTime HOUR = 60 * MINUTE;
+const SimTime INFINITE_TIME = std::numeric_limits<SimTime>::max();
+const SimTime EPSILON_TIME = NANO_SECOND;
+
+inline
+double ConvertTimeToDoubleSecs(const SimTime& time)
+{
+    return (static_cast<double>(time) / SECOND);
+}
+
+inline
+SimTime ConvertDoubleSecsToTime(const double& timeSecs)
+{
+    return (static_cast<SimTime>(timeSecs * SECOND));
+}
+
+inline
+string ConvertTimeToStringSecs(const SimTime& time)
+{
+    ostringstream outStream;
+    outStream << std::fixed << std::setprecision(9) << ConvertTimeToDoubleSecs(time);
+    return (outStream.str());
+}
+
+inline
+void ConvertTimeToStringSecs(const SimTime& time, string& timeString)
+{
+    timeString = ConvertTimeToStringSecs(time);
+}
+
+typedef unsigned int NodeId;
+
+const NodeId InvalidNodeId = 0;
+const NodeId ANY_NODEID = std::numeric_limits<NodeId>::max();
+
+typedef string InterfaceId;
+typedef string InterfaceOrInstanceId;
+
+//--------------------------------------------------------------------------------------------------
+// String and number conversion helpers
+
+inline
+void ConvertStringToLowerCase(string& aString)
+{
+    for(size_t i = 0; (i < aString.size()); i++) {
+        aString[i] = static_cast<char>(tolower(aString[i]));
+    }//for//
+}
+
+inline
+string MakeLowerCaseString(const string& aString)
+{
+    string lowerCaseString = aString;
+    ConvertStringToLowerCase(lowerCaseString);
+    return lowerCaseString;
+}
+
+inline
+void DeleteTrailingSpaces(string& aString)
+{
+    const size_t position = aString.find_last_not_of(" \t\r\n");
+
+    if (position == string::npos) {
+        aString.clear();
+    }
+    else {
+        aString.erase(position + 1);
+    }//if//
+}
+
+inline
+void ConvertStringToInt(const string& aString, int& intValue, bool& success)
+{
+    char* endPtr = nullptr;
+    const long value = strtol(aString.c_str(), &endPtr, 10);
+
+    success = ((!aString.empty()) && (*endPtr == '\0'));
+    intValue = static_cast<int>(value);
+}
+
+inline
+void ConvertStringToDouble(const string& aString, double& doubleValue, bool& success)
+{
+    char* endPtr = nullptr;
+    doubleValue = strtod(aString.c_str(), &endPtr);
+
+    success = ((!aString.empty()) && (*endPtr == '\0'));
+}
+
+template<typename T> inline
+string ConvertToString(const T& value)
+{
+    ostringstream outStream;
+    outStream << value;
+    return outStream.str();
+}
+
+template<typename T> inline
+void ConvertAStringSequenceOfANumericTypeIntoAVector(
+    const string& aString,
+    bool& success,
+    vector<T>& numberVector)
+{
+    numberVector.clear();
+
+    string numbers = aString;
+    std::replace(numbers.begin(), numbers.end(), ',', ' ');
+
+    istringstream inStream(numbers);
+    long double value;
+
+    while (inStream >> value) {
+        numberVector.push_back(static_cast<T>(value));
+    }//while//
+
+    success = (inStream.eof());
+}
+
+inline
+unsigned int RoundToUint(const double& value)
+{
+    return (static_cast<unsigned int>(value + 0.5));
+}
+
+inline
+unsigned char ConvertToUChar(const unsigned int value)
+{
+    assert(value <= UCHAR_MAX);
+    return (static_cast<unsigned char>(value));
+}
+
+inline
+unsigned char ConvertToUChar(const unsigned int value, const char* /*errorMessage*/)
+{
+    return (ConvertToUChar(value));
+}
+
+inline
+unsigned short int ConvertToUShortInt(const unsigned int value)
+{
+    assert(value <= USHRT_MAX);
+    return (static_cast<unsigned short int>(value));
+}
+
+inline
+unsigned short int ConvertToUShortInt(const unsigned int value, const char* /*errorMessage*/)
+{
+    return (ConvertToUShortInt(value));
+}
+
+inline
+unsigned int RoundUpToNearestIntDivisibleBy4(const unsigned int value)
+{
+    return (((value + 3) / 4) * 4);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Random numbers
+
+typedef uint32_t RandomNumberGeneratorSeed;
+
+inline
+RandomNumberGeneratorSeed HashInputsToMakeSeed(
+    const RandomNumberGeneratorSeed& seed,
+    const unsigned long long int input1,
+    const unsigned long long int input2 = 0,
+    const unsigned long long int input3 = 0)
+{
+    unsigned long long int hash = seed;
+
+    hash = ((hash * 1000003ULL) ^ input1);
+    hash = ((hash * 1000003ULL) ^ input2);
+    hash = ((hash * 1000003ULL) ^ input3);
+
+    return (static_cast<RandomNumberGeneratorSeed>(hash ^ (hash >> 32)));
+}
+
+inline
+RandomNumberGeneratorSeed HashInputsToMakeSeed(
+    const RandomNumberGeneratorSeed& seed,
+    const string& input1,
+    const unsigned long long int input2 = 0)
+{
+    return (HashInputsToMakeSeed(seed, std::hash<string>()(input1), input2));
+}
+
+class RandomNumberGenerator {
+public:
+    RandomNumberGenerator() { }
+    explicit RandomNumberGenerator(const RandomNumberGeneratorSeed& seed) : engine(seed) { }
+
+    void SetSeed(const RandomNumberGeneratorSeed& seed) { engine.seed(seed); }
+
+    // [0, 1)
+    double GenerateRandomDouble()
+        { return (std::uniform_real_distribution<double>(0.0, 1.0)(engine)); }
+
+    // [lowest, highest]
+    int GenerateRandomInt(const int lowest, const int highest)
+        { return (std::uniform_int_distribution<int>(lowest, highest)(engine)); }
+
+private:
+    std::mt19937 engine;
+
+};//RandomNumberGenerator//
+
+//--------------------------------------------------------------------------------------------------
+// Statistics
+
+class CounterStatistic {
+public:
+    CounterStatistic(const string& initName) : name(initName), counterValue(0) { }
+
+    void IncrementCounter() { counterValue++; }
+    void IncrementCounter(const long long int increment) { counterValue += increment; }
+
+    const string& GetName() const { return name; }
+    long long int GetCounterValue() const { return counterValue; }
+
+private:
+    string name;
+    long long int counterValue;
+
+};//CounterStatistic//
+
+class RealStatistic {
+public:
+    RealStatistic(const string& initName) : name(initName), numberValues(0), sumOfValues(0.0) { }
+
+    void RecordStatValue(const double& value) { numberValues++; sumOfValues += value; }
+
+    const string& GetName() const { return name; }
+    long long int GetNumberValues() const { return numberValues; }
+    double GetSumOfValues() const { return sumOfValues; }
+
+private:
+    string name;
+    long long int numberValues;
+    double sumOfValues;
+
+};//RealStatistic//
+
+//--------------------------------------------------------------------------------------------------
+// Parameters (flat name -> value table, node and interface qualifiers are ignored)
+
+class ParameterDatabaseReader {
+public:
+    void AddParameter(const string& parameterName, const string& value)
+        { parameters[MakeLowerCaseString(parameterName)] = value; }
+
+    bool ParameterExists(const string& parameterName) const
+        { return (parameters.find(MakeLowerCaseString(parameterName)) != parameters.end()); }
+
+    bool ParameterExists(const string& parameterName, const NodeId& /*nodeId*/) const
+        { return ((*this).ParameterExists(parameterName)); }
+
+    bool ParameterExists(
+        const string& parameterName,
+        const NodeId& /*nodeId*/,
+        const InterfaceOrInstanceId& /*instanceId*/) const
+        { return ((*this).ParameterExists(parameterName)); }
+
+    bool ParameterExists(const string& parameterName, const InterfaceOrInstanceId& /*instanceId*/) const
+        { return ((*this).ParameterExists(parameterName)); }
+
+    string ReadString(const string& parameterName) const
+    {
+        const map<string, string>::const_iterator iter =
+            parameters.find(MakeLowerCaseString(parameterName));
+
+        if (iter == parameters.end()) {
+            cerr << "Error: parameter " << parameterName << " is not defined." << endl;
+            exit(1);
+        }//if//
+
+        return (iter->second);
+    }
+
+    bool ReadBool(const string& parameterName) const
+    {
+        const string value = MakeLowerCaseString((*this).ReadString(parameterName));
+
+        if ((value == "yes") || (value == "true") || (value == "on") || (value == "1")) {
+            return true;
+        }
+        else if ((value == "no") || (value == "false") || (value == "off") || (value == "0")) {
+            return false;
+        }//if//
+
+        cerr << "Error: bad boolean parameter " << parameterName << ": " << value << endl;
+        exit(1);
+    }
+
+    long long int ReadBigInt(const string& parameterName) const
+        { return (strtoll((*this).ReadString(parameterName).c_str(), nullptr, 10)); }
+
+    int ReadInt(const string& parameterName) const
+        { return (static_cast<int>((*this).ReadBigInt(parameterName))); }
+
+    unsigned int ReadNonNegativeInt(const string& parameterName) const
+    {
+        const long long int value = (*this).ReadBigInt(parameterName);
+
+        if (value < 0) {
+            cerr << "Error: parameter " << parameterName << " must be non-negative." << endl;
+            exit(1);
+        }//if//
+
+        return (static_cast<unsigned int>(value));
+    }
+
+    double ReadDouble(const string& parameterName) const
+        { return (strtod((*this).ReadString(parameterName).c_str(), nullptr)); }
+
+    // Value in seconds (e.g. "0.05") or with unit suffix ns, us, ms, s.
+
+    SimTime ReadTime(const string& parameterName) const
+    {
+        const string value = MakeLowerCaseString((*this).ReadString(parameterName));
+
+        char* endPtr = nullptr;
+        const double number = strtod(value.c_str(), &endPtr);
+        const string unit = endPtr;
+
+        if (unit == "ns") {
+            return (static_cast<SimTime>(number * NANO_SECOND));
+        }
+        else if (unit == "us") {
+            return (static_cast<SimTime>(number * MICRO_SECOND));
+        }
+        else if (unit == "ms") {
+            return (static_cast<SimTime>(number * MILLI_SECOND));
+        }
+        else if (unit == "inf") {
+            return INFINITE_TIME;
+        }//if//
+
+        return (ConvertDoubleSecsToTime(number));
+    }
+
+#define STANDIN_PARAMETER_READER_QUALIFIED_OVERLOADS(ReturnType, FunctionName) \
+    ReturnType FunctionName(const string& parameterName, const NodeId& /*nodeId*/) const \
+        { return ((*this).FunctionName(parameterName)); } \
+    ReturnType FunctionName( \
+        const string& parameterName, \
+        const NodeId& /*nodeId*/, \
+        const InterfaceOrInstanceId& /*instanceId*/) const \
+        { return ((*this).FunctionName(parameterName)); } \
+    ReturnType FunctionName(const string& parameterName, const InterfaceOrInstanceId& /*instanceId*/) const \
+        { return ((*this).FunctionName(parameterName)); }
+
+    STANDIN_PARAMETER_READER_QUALIFIED_OVERLOADS(string, ReadString)
+    STANDIN_PARAMETER_READER_QUALIFIED_OVERLOADS(bool, ReadBool)
+    STANDIN_PARAMETER_READER_QUALIFIED_OVERLOADS(long long int, ReadBigInt)
+    STANDIN_PARAMETER_READER_QUALIFIED_OVERLOADS(int, ReadInt)
+    STANDIN_PARAMETER_READER_QUALIFIED_OVERLOADS(unsigned int, ReadNonNegativeInt)
+    STANDIN_PARAMETER_READER_QUALIFIED_OVERLOADS(double, ReadDouble)
+    STANDIN_PARAMETER_READER_QUALIFIED_OVERLOADS(SimTime, ReadTime)
+
+#undef STANDIN_PARAMETER_READER_QUALIFIED_OVERLOADS
+
+    NodeId GetPossibleNodeIdRemap(const NodeId& nodeId) const { return nodeId; }
+
+private:
+    map<string, string> parameters;
+
+};//ParameterDatabaseReader//
+
+//--------------------------------------------------------------------------------------------------
+// Events
+
+class SimulationEvent {
+public:
+    virtual ~SimulationEvent() { }
+    virtual void ExecuteEvent() = 0;
+};
+
+class SimulationEngine;
+
+class EventRescheduleTicket {
+public:
+    EventRescheduleTicket() { }
+
+    bool IsNull() const { return (entryPtr == nullptr); }
+    void Clear() { entryPtr.reset(); }
+
+private:
+    friend class SimulationEngine;
+
+    struct EventEntry {
+        SimTime eventTime;
+        unsigned long long int sequenceNumber;
+        shared_ptr<SimulationEvent> eventPtr;
+        bool isCanceled;
+    };
+
+    shared_ptr<EventEntry> entryPtr;
+
+};//EventRescheduleTicket//
+
+enum TraceTag {
+    TraceMac,
+    TracePhy,
+    TraceNetwork,
+    TraceTransport,
+    TraceApplication,
+    TraceMobility,
+};
+
+class SimulationEngineInterface;
+
+// Sequential engine shared by all node interfaces.
+
+class SimulationEngine {
+public:
+    SimulationEngine() : currentTime(ZERO_TIME), nextSequenceNumber(0), numberExecutedEvents(0) { }
+
+    shared_ptr<SimulationEngineInterface> GetSimulationEngineInterface(const NodeId& nodeId);
+
+    SimTime CurrentTime() const { return currentTime; }
+
+    unsigned long long int GetNumberExecutedEvents() const { return numberExecutedEvents; }
+
+    void RunSimulationUntil(const SimTime& endTime)
+    {
+        while (!eventQueue.empty()) {
+            const shared_ptr<EventEntry> entryPtr = eventQueue.top();
+
+            if (entryPtr->eventTime > endTime) {
+                break;
+            }//if//
+
+            eventQueue.pop();
+
+            if (entryPtr->isCanceled) {
+                continue;
+            }//if//
+
+            assert(entryPtr->eventTime >= currentTime);
+
+            currentTime = entryPtr->eventTime;
+            entryPtr->isCanceled = true;
+            numberExecutedEvents++;
+
+            entryPtr->eventPtr->ExecuteEvent();
+        }//while//
+
+        if ((endTime != INFINITE_TIME) && (currentTime < endTime)) {
+            currentTime = endTime;
+        }//if//
+    }
+
+    void ScheduleEvent(
+        const shared_ptr<SimulationEvent>& eventPtr,
+        const SimTime& eventTime,
+        EventRescheduleTicket& eventTicket)
+    {
+        assert(eventTime >= currentTime);
+
+        eventTicket.entryPtr.reset(new EventEntry());
+        eventTicket.entryPtr->eventTime = eventTime;
+        eventTicket.entryPtr->sequenceNumber = nextSequenceNumber++;
+        eventTicket.entryPtr->eventPtr = eventPtr;
+        eventTicket.entryPtr->isCanceled = false;
+
+        eventQueue.push(eventTicket.entryPtr);
+    }
+
+    void RescheduleEvent(EventRescheduleTicket& eventTicket, const SimTime& eventTime)
+    {
+        assert(!eventTicket.IsNull());
+
+        const shared_ptr<SimulationEvent> eventPtr = eventTicket.entryPtr->eventPtr;
+
+        (*this).CancelEvent(eventTicket);
+        (*this).ScheduleEvent(eventPtr, eventTime, eventTicket);
+    }
+
+    void CancelEvent(EventRescheduleTicket& eventTicket)
+    {
+        assert(!eventTicket.IsNull());
+
+        eventTicket.entryPtr->isCanceled = true;
+        eventTicket.Clear();
+    }
+
+private:
+    typedef EventRescheduleTicket::EventEntry EventEntry;
+
+    struct EventEntryIsLater {
+        bool operator()(const shared_ptr<EventEntry>& left, const shared_ptr<EventEntry>& right) const
+        {
+            if (left->eventTime != right->eventTime) {
+                return (left->eventTime > right->eventTime);
+            }//if//
+
+            return (left->sequenceNumber > right->sequenceNumber);
+        }
+    };
+
+    SimTime currentTime;
+    unsigned long long int nextSequenceNumber;
+    unsigned long long int numberExecutedEvents;
+
+    std::priority_queue<shared_ptr<EventEntry>, vector<shared_ptr<EventEntry> >, EventEntryIsLater> eventQueue;
+
+};//SimulationEngine//
+
+// Per node view of the engine. Tracing is always off.
+
+class SimulationEngineInterface {
+public:
+    SimulationEngineInterface(SimulationEngine* initSimulationEnginePtr, const NodeId& initNodeId)
+        :
+        simulationEnginePtr(initSimulationEnginePtr),
+        theNodeId(initNodeId),
+        numberLookaheadTimeIndices(0)
+    {}
+
+    NodeId GetNodeId() const { return theNodeId; }
+
+    SimTime CurrentTime() const { return (simulationEnginePtr->CurrentTime()); }
+
+    void ScheduleEvent(
+        const shared_ptr<SimulationEvent>& eventPtr,
+        const SimTime& eventTime,
+        EventRescheduleTicket& eventTicket)
+    {
+        simulationEnginePtr->ScheduleEvent(eventPtr, eventTime, eventTicket);
+    }
+
+    void ScheduleEvent(const shared_ptr<SimulationEvent>& eventPtr, const SimTime& eventTime)
+    {
+        EventRescheduleTicket eventTicketNotUsed;
+        simulationEnginePtr->ScheduleEvent(eventPtr, eventTime, eventTicketNotUsed);
+    }
+
+    void RescheduleEvent(EventRescheduleTicket& eventTicket, const SimTime& eventTime)
+        { simulationEnginePtr->RescheduleEvent(eventTicket, eventTime); }
+
+    void CancelEvent(EventRescheduleTicket& eventTicket)
+        { simulationEnginePtr->CancelEvent(eventTicket); }
+
+    shared_ptr<CounterStatistic> CreateCounterStat(const string& statName)
+    {
+        const shared_ptr<CounterStatistic> statPtr(new CounterStatistic(statName));
+        counterStatPtrs.push_back(statPtr);
+        return statPtr;
+    }
+
+    shared_ptr<RealStatistic> CreateRealStat(const string& statName)
+    {
+        const shared_ptr<RealStatistic> statPtr(new RealStatistic(statName));
+        realStatPtrs.push_back(statPtr);
+        return statPtr;
+    }
+
+    shared_ptr<CounterStatistic> CreateCounterStatWithDefaultValue(const string& statName)
+        { return ((*this).CreateCounterStat(statName)); }
+
+    const vector<shared_ptr<CounterStatistic> >& GetCounterStats() const { return counterStatPtrs; }
+
+    bool TraceIsOn(const TraceTag& /*traceTag*/) const { return false; }
+    bool BinaryOutputIsOn() const { return false; }
+
+    void OutputTrace(
+        const string& /*modelName*/,
+        const InterfaceOrInstanceId& /*instanceId*/,
+        const string& /*eventName*/,
+        const string& /*traceString*/) const
+    {}
+
+    void OutputTraceInBinary(
+        const string& /*modelName*/,
+        const InterfaceOrInstanceId& /*instanceId*/,
+        const string& /*eventName*/) const
+    {}
+
+    template<typename T>
+    void OutputTraceInBinary(
+        const string& /*modelName*/,
+        const InterfaceOrInstanceId& /*instanceId*/,
+        const string& /*eventName*/,
+        const T& /*traceRecord*/) const
+    {}
+
+    unsigned int AllocateLookaheadTimeIndex() { return (numberLookaheadTimeIndices++); }
+    void SetALookaheadTimeForThisNode(const SimTime& /*lookahead*/, const unsigned int /*index*/) { }
+
+private:
+    SimulationEngine* simulationEnginePtr;
+    NodeId theNodeId;
+    unsigned int numberLookaheadTimeIndices;
+
+    vector<shared_ptr<CounterStatistic> > counterStatPtrs;
+    vector<shared_ptr<RealStatistic> > realStatPtrs;
+
+};//SimulationEngineInterface//
+
+inline
+shared_ptr<SimulationEngineInterface> SimulationEngine::GetSimulationEngineInterface(const NodeId& nodeId)
+{
+    return (shared_ptr<SimulationEngineInterface>(new SimulationEngineInterface(this, nodeId)));
+}
+
+}//namespace//
+
+#endif
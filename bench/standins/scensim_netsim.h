@@ -0,0 +1,597 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// Packets, addresses and the layer interfaces the WAVE/802.11p models plug into.
+
+#ifndef SCENSIM_NETSIM_H
+#define SCENSIM_NETSIM_H
+
+#include "scensim_engine.h"
+
+#include <climits>
+
+namespace ScenSim {
+
+using std::unique_ptr;
+using std::move;
+
+typedef unsigned char PacketPriority;
+
+const PacketPriority MAX_AVAILABLE_PACKET_PRIORITY = 7;
+
+typedef unsigned long long int GenericMacAddress;
+
+typedef unsigned short int EtherTypeField;
+
+const EtherTypeField ETHERTYPE_IS_NOT_SPECIFIED = 0;
+const EtherTypeField ETHERTYPE_IP = 0x0800;
+const EtherTypeField ETHERTYPE_ARP = 0x0806;
+const EtherTypeField ETHERTYPE_IPV6 = 0x86DD;
+const EtherTypeField ETHERTYPE_WSMP = 0x88DC;
+
+enum EnqueueResultType {
+    ENQUEUE_SUCCESS,
+    ENQUEUE_FAILURE_BY_MAX_PACKETS,
+    ENQUEUE_FAILURE_BY_MAX_BYTES,
+    ENQUEUE_FAILURE_BY_OUT_OF_SCOPE,
+};
+
+inline
+string ConvertToEnqueueResultString(const EnqueueResultType& enqueueResult)
+{
+    switch (enqueueResult) {
+    case ENQUEUE_SUCCESS: return "Success";
+    case ENQUEUE_FAILURE_BY_MAX_PACKETS: return "MaxPackets";
+    case ENQUEUE_FAILURE_BY_MAX_BYTES: return "MaxBytes";
+    case ENQUEUE_FAILURE_BY_OUT_OF_SCOPE: return "OutOfScope";
+    default: return "Unknown";
+    }//switch//
+}
+
+inline
+unsigned short int NetToHost16(const unsigned short int value)
+{
+    return (static_cast<unsigned short int>((value >> 8) | (value << 8)));
+}
+
+inline
+unsigned short int HostToNet16(const unsigned short int value)
+{
+    return (NetToHost16(value));
+}
+
+// 12 bit (802.11) sequence numbers.
+
+inline
+void IncrementTwelveBitSequenceNumber(unsigned short int& sequenceNumber)
+{
+    sequenceNumber = static_cast<unsigned short int>((sequenceNumber + 1) & 0x0FFF);
+}
+
+inline
+int CalcTwelveBitSequenceNumberDifference(
+    const unsigned short int sequenceNumber1,
+    const unsigned short int sequenceNumber2)
+{
+    int difference = (static_cast<int>(sequenceNumber1) - static_cast<int>(sequenceNumber2));
+
+    if (difference > 2048) {
+        difference -= 4096;
+    }
+    else if (difference < -2048) {
+        difference += 4096;
+    }//if//
+
+    return difference;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Addresses (IPv4 style: node id in the low bits, subnet in the upper bits)
+
+class NetworkAddress {
+public:
+    static const NetworkAddress invalidAddress;
+    static const NetworkAddress anyAddress;
+    static const NetworkAddress broadcastAddress;
+
+    static const unsigned int maxMulticastGroupNumber = 0x00FFFFFF;
+
+    NetworkAddress() : highBits(0), lowBits(0) { }
+    explicit NetworkAddress(const unsigned long long int initLowBits) : highBits(0), lowBits(initLowBits) { }
+    NetworkAddress(const unsigned long long int initHighBits, const unsigned long long int initLowBits)
+        : highBits(initHighBits), lowBits(initLowBits) { }
+    NetworkAddress(const NetworkAddress& subnetAddress, const NetworkAddress& hostAddress)
+        : highBits(subnetAddress.highBits | hostAddress.highBits), lowBits(subnetAddress.lowBits | hostAddress.lowBits) { }
+
+    unsigned long long int GetRawAddressLowBits() const { return lowBits; }
+    unsigned long long int GetRawAddressHighBits() const { return highBits; }
+    unsigned int GetRawAddressLow32Bits() const { return (static_cast<unsigned int>(lowBits)); }
+
+    bool IsTheBroadcastAddress() const { return ((*this) == broadcastAddress); }
+
+    bool IsABroadcastAddress(const NetworkAddress& subnetMask) const
+    {
+        return ((*this).IsTheBroadcastAddress() ||
+                ((lowBits | subnetMask.lowBits) == broadcastAddress.lowBits));
+    }
+
+    bool IsAMulticastAddress() const { return ((!(*this).IsTheBroadcastAddress()) && ((lowBits >> 28) == 0xE)); }
+
+    bool IsABroadcastOrAMulticastAddress(const NetworkAddress& subnetMask) const
+        { return ((*this).IsABroadcastAddress(subnetMask) || (*this).IsAMulticastAddress()); }
+
+    unsigned int GetMulticastGroupNumber() const
+        { return (static_cast<unsigned int>(lowBits & maxMulticastGroupNumber)); }
+
+    NodeId ExtractNodeId(const NetworkAddress& subnetMask) const
+        { return (static_cast<NodeId>(lowBits & ~subnetMask.lowBits)); }
+
+    NetworkAddress MakeAddressWithZeroedSubnetBits(const NetworkAddress& subnetMask) const
+        { return (NetworkAddress(0, (lowBits & ~subnetMask.lowBits))); }
+
+    bool operator==(const NetworkAddress& right) const
+        { return ((highBits == right.highBits) && (lowBits == right.lowBits)); }
+
+    bool operator!=(const NetworkAddress& right) const { return (!((*this) == right)); }
+
+    bool operator<(const NetworkAddress& right) const
+    {
+        if (highBits != right.highBits) {
+            return (highBits < right.highBits);
+        }//if//
+
+        return (lowBits < right.lowBits);
+    }
+
+private:
+    unsigned long long int highBits;
+    unsigned long long int lowBits;
+
+};//NetworkAddress//
+
+inline const NetworkAddress NetworkAddress::invalidAddress(0);
+inline const NetworkAddress NetworkAddress::anyAddress(0);
+inline const NetworkAddress NetworkAddress::broadcastAddress(0xFFFFFFFFULL);
+
+//--------------------------------------------------------------------------------------------------
+// Packets
+
+class PacketId {
+public:
+    PacketId() : sourceNodeId(InvalidNodeId), sourceNodeSequenceNumber(0) { }
+    PacketId(const NodeId& initSourceNodeId, const unsigned long long int initSequenceNumber)
+        : sourceNodeId(initSourceNodeId), sourceNodeSequenceNumber(initSequenceNumber) { }
+
+    NodeId GetSourceNodeId() const { return sourceNodeId; }
+    unsigned long long int GetSourceNodeSequenceNumber() const { return sourceNodeSequenceNumber; }
+
+    bool operator==(const PacketId& right) const
+    {
+        return ((sourceNodeId == right.sourceNodeId) &&
+                (sourceNodeSequenceNumber == right.sourceNodeSequenceNumber));
+    }
+
+private:
+    NodeId sourceNodeId;
+    unsigned long long int sourceNodeSequenceNumber;
+
+};//PacketId//
+
+inline
+std::ostream& operator<<(std::ostream& outStream, const PacketId& thePacketId)
+{
+    outStream << thePacketId.GetSourceNodeId() << '-' << thePacketId.GetSourceNodeSequenceNumber();
+    return outStream;
+}
+
+typedef string ExtrinsicPacketInfoId;
+
+class ExtrinsicPacketInformation {
+public:
+    virtual ~ExtrinsicPacketInformation() { }
+    virtual shared_ptr<ExtrinsicPacketInformation> Clone() = 0;
+};
+
+// Headers are prepended at the front of a single byte buffer; the payload
+// starts at "payloadOffset".
+
+class Packet {
+public:
+    template<typename T>
+    static unique_ptr<Packet> CreatePacket(SimulationEngineInterface& simEngineInterface, const T& payload)
+    {
+        unique_ptr<Packet> packetPtr(new Packet(simEngineInterface));
+        packetPtr->AddPlainStructHeader(payload);
+        return packetPtr;
+    }
+
+    static unique_ptr<Packet> CreatePacket(
+        SimulationEngineInterface& simEngineInterface,
+        const vector<unsigned char>& payload)
+    {
+        unique_ptr<Packet> packetPtr(new Packet(simEngineInterface));
+        packetPtr->AddRawHeader(payload.data(), static_cast<unsigned int>(payload.size()));
+        return packetPtr;
+    }
+
+    static unique_ptr<Packet> CreatePacket(
+        SimulationEngineInterface& simEngineInterface,
+        const unsigned char* payload,
+        const unsigned int payloadLengthBytes)
+    {
+        unique_ptr<Packet> packetPtr(new Packet(simEngineInterface));
+        packetPtr->AddRawHeader(payload, payloadLengthBytes);
+        return packetPtr;
+    }
+
+    Packet(const Packet& right)
+        :
+        packetData(right.packetData),
+        payloadOffset(right.payloadOffset),
+        thePacketId(right.thePacketId)
+    {
+        for(size_t i = 0; (i < right.extrinsicPacketInfos.size()); i++) {
+            extrinsicPacketInfos.push_back(
+                std::make_pair(
+                    right.extrinsicPacketInfos[i].first,
+                    right.extrinsicPacketInfos[i].second->Clone()));
+        }//for//
+    }
+
+    unsigned int LengthBytes() const
+        { return (static_cast<unsigned int>(packetData.size() - payloadOffset)); }
+
+    const PacketId& GetPacketId() const { return thePacketId; }
+
+    bool IsAcked() const { return false; }
+
+    template<typename T>
+    void AddPlainStructHeader(const T& header)
+    {
+        (*this).AddRawHeader(reinterpret_cast<const unsigned char*>(&header), sizeof(T));
+    }
+
+    void AddRawHeader(const unsigned char* header, const unsigned int headerLengthBytes)
+    {
+        if (payloadOffset < headerLengthBytes) {
+            const size_t growBytes = (headerLengthBytes - payloadOffset) + reservedHeaderBytes;
+
+            packetData.insert(packetData.begin(), growBytes, 0);
+            payloadOffset += static_cast<unsigned int>(growBytes);
+        }//if//
+
+        payloadOffset -= headerLengthBytes;
+
+        if (headerLengthBytes > 0) {
+            std::memcpy(&packetData[payloadOffset], header, headerLengthBytes);
+        }//if//
+    }
+
+    void DeleteHeader(const unsigned int headerLengthBytes)
+    {
+        assert(headerLengthBytes <= (*this).LengthBytes());
+        payloadOffset += headerLengthBytes;
+    }
+
+    void AddTrailingPadding(const unsigned int paddingLengthBytes)
+        { packetData.resize(packetData.size() + paddingLengthBytes, 0); }
+
+    void RemoveTrailingPadding(const unsigned int paddingLengthBytes)
+    {
+        assert(paddingLengthBytes <= (*this).LengthBytes());
+        packetData.resize(packetData.size() - paddingLengthBytes);
+    }
+
+    template<typename T>
+    T& GetAndReinterpretPayloadData(const unsigned int offset = 0)
+    {
+        assert((offset + sizeof(T)) <= (*this).LengthBytes());
+        return (*reinterpret_cast<T*>(&packetData[payloadOffset + offset]));
+    }
+
+    template<typename T>
+    const T& GetAndReinterpretPayloadData(const unsigned int offset = 0) const
+    {
+        assert((offset + sizeof(T)) <= (*this).LengthBytes());
+        return (*reinterpret_cast<const T*>(&packetData[payloadOffset + offset]));
+    }
+
+    unsigned char* GetRawPayloadData() { return (packetData.data() + payloadOffset); }
+    const unsigned char* GetRawPayloadData() const { return (packetData.data() + payloadOffset); }
+
+    const unsigned char* GetRawPayloadData(const unsigned int offset, const unsigned int lengthBytes) const
+    {
+        assert((offset + lengthBytes) <= (*this).LengthBytes());
+        return (packetData.data() + payloadOffset + offset);
+    }
+
+    void AddExtrinsicPacketInformation(
+        const ExtrinsicPacketInfoId& infoId,
+        const shared_ptr<ExtrinsicPacketInformation>& infoPtr)
+    {
+        extrinsicPacketInfos.push_back(std::make_pair(infoId, infoPtr));
+    }
+
+    template<typename T>
+    T& GetExtrinsicPacketInformation(const ExtrinsicPacketInfoId& infoId) const
+    {
+        for(size_t i = 0; (i < extrinsicPacketInfos.size()); i++) {
+            if (extrinsicPacketInfos[i].first == infoId) {
+                return (static_cast<T&>(*extrinsicPacketInfos[i].second));
+            }//if//
+        }//for//
+
+        cerr << "Error: no extrinsic packet information " << infoId << endl;
+        exit(1);
+    }
+
+private:
+    static const unsigned int reservedHeaderBytes = 64;
+
+    explicit Packet(SimulationEngineInterface& simEngineInterface)
+        :
+        payloadOffset(0),
+        thePacketId(simEngineInterface.GetNodeId(), (*this).NextSequenceNumber())
+    {}
+
+    static unsigned long long int NextSequenceNumber()
+    {
+        static unsigned long long int sequenceNumber = 0;
+        return (++sequenceNumber);
+    }
+
+    vector<unsigned char> packetData;
+    unsigned int payloadOffset;
+    PacketId thePacketId;
+
+    vector<std::pair<ExtrinsicPacketInfoId, shared_ptr<ExtrinsicPacketInformation> > > extrinsicPacketInfos;
+
+};//Packet//
+
+//--------------------------------------------------------------------------------------------------
+// Mobility
+
+class ObjectMobilityPosition {
+public:
+    ObjectMobilityPosition()
+        :
+        xPositionMeters(0.0),
+        yPositionMeters(0.0),
+        heightFromGroundMeters(0.0),
+        velocityMetersPerSecond(0.0),
+        velocityAzimuthFromNorthClockwiseDegrees(0.0)
+    {}
+
+    double X_PositionMeters() const { return xPositionMeters; }
+    double Y_PositionMeters() const { return yPositionMeters; }
+    double HeightFromGroundMeters() const { return heightFromGroundMeters; }
+    double VelocityMetersPerSecond() const { return velocityMetersPerSecond; }
+    double VelocityAzimuthFromNorthClockwiseDegrees() const { return velocityAzimuthFromNorthClockwiseDegrees; }
+
+    void SetX_PositionMeters(const double value) { xPositionMeters = value; }
+    void SetY_PositionMeters(const double value) { yPositionMeters = value; }
+    void SetHeightFromGroundMeters(const double value) { heightFromGroundMeters = value; }
+    void SetVelocityMetersPerSecond(const double value) { velocityMetersPerSecond = value; }
+    void SetVelocityAzimuthFromNorthClockwiseDegrees(const double value)
+        { velocityAzimuthFromNorthClockwiseDegrees = value; }
+
+private:
+    double xPositionMeters;
+    double yPositionMeters;
+    double heightFromGroundMeters;
+    double velocityMetersPerSecond;
+    double velocityAzimuthFromNorthClockwiseDegrees;
+
+};//ObjectMobilityPosition//
+
+class ObjectMobilityModel {
+public:
+    virtual ~ObjectMobilityModel() { }
+
+    virtual void GetPositionForTime(const SimTime& snapshotTime, ObjectMobilityPosition& position) = 0;
+};
+
+//--------------------------------------------------------------------------------------------------
+// Layers
+
+class MacAndPhyInfoInterface {
+public:
+    virtual ~MacAndPhyInfoInterface() { }
+};
+
+template<typename MacAddressType>
+class MacAddressResolver {
+public:
+    virtual ~MacAddressResolver() { }
+
+    virtual void GetMacAddress(
+        const NetworkAddress& aNetworkAddress,
+        const NetworkAddress& networkAddressMask,
+        bool& wasFound,
+        MacAddressType& resolvedMacAddress) = 0;
+
+    virtual void GetNetworkAddressIfAvailable(
+        const MacAddressType& macAddress,
+        const NetworkAddress& subnetNetworkAddress,
+        bool& wasFound,
+        NetworkAddress& resolvedNetworkAddress) = 0;
+};
+
+// Resolvers are protocol specific (e.g. ARP); the stand-in has none, so the
+// MAC falls back to its own resolver.
+
+class NullMacAddressResolverPtr {
+public:
+    template<typename MacAddressType>
+    operator MacAddressResolver<MacAddressType>*() const { return nullptr; }
+};
+
+class NetworkInterfaceManager {
+public:
+    NullMacAddressResolverPtr CreateMacAddressResolver() const { return NullMacAddressResolverPtr(); }
+};
+
+class MacLayer {
+public:
+    virtual ~MacLayer() { }
+
+    virtual void NetworkLayerQueueChangeNotification() = 0;
+    virtual void DisconnectFromOtherLayers() = 0;
+    virtual GenericMacAddress GetGenericMacAddress() const { return 0; }
+};
+
+class InterfaceOutputQueue {
+public:
+    virtual ~InterfaceOutputQueue() { }
+
+    virtual bool IsFull(const PacketPriority priority) const = 0;
+
+    virtual void Insert(
+        unique_ptr<Packet>& packetPtr,
+        const NetworkAddress& nextHopAddress,
+        const PacketPriority priority,
+        EnqueueResultType& enqueueResult,
+        unique_ptr<Packet>& packetToDropPtr,
+        const EtherTypeField etherType = ETHERTYPE_IS_NOT_SPECIFIED) = 0;
+
+    virtual PacketPriority MaxPossiblePacketPriority() const = 0;
+};
+
+class SimpleMacPacketHandler {
+public:
+    virtual ~SimpleMacPacketHandler() { }
+
+    virtual void ReceivePacketFromMac(
+        unique_ptr<Packet>& packetPtr,
+        const GenericMacAddress& transmitterAddress) = 0;
+};
+
+// Single interface network layer; packets that reach it are counted and dropped.
+
+class NetworkLayer {
+public:
+    NetworkLayer()
+        :
+        subnetAddress(0xC0A80000ULL),
+        subnetMask(0xFFFF0000ULL),
+        numberReceivedPackets(0),
+        numberUndeliveredPackets(0)
+    {}
+
+    virtual ~NetworkLayer() { }
+
+    shared_ptr<NetworkInterfaceManager> GetNetworkInterfaceManagerPtr(const unsigned int /*interfaceIndex*/)
+        { return shared_ptr<NetworkInterfaceManager>(); }
+
+    NetworkAddress GetSubnetAddress(const unsigned int /*interfaceIndex*/) const { return subnetAddress; }
+    NetworkAddress GetSubnetMask(const unsigned int /*interfaceIndex*/) const { return subnetMask; }
+
+    void SetInterfaceMacLayer(const unsigned int /*interfaceIndex*/, const shared_ptr<MacLayer>& initMacLayerPtr)
+        { macLayerPtr = initMacLayerPtr; }
+
+    void SetInterfaceOutputQueue(
+        const unsigned int /*interfaceIndex*/,
+        const shared_ptr<InterfaceOutputQueue>& initOutputQueuePtr)
+    {
+        outputQueuePtr = initOutputQueuePtr;
+    }
+
+    void GetNextHopAddressAndInterfaceIndexForNetworkPacket(
+        const Packet& /*aPacket*/,
+        bool& nextHopWasFound,
+        NetworkAddress& nextHopAddress,
+        unsigned int& interfaceIndex) const
+    {
+        nextHopWasFound = false;
+        nextHopAddress = NetworkAddress::invalidAddress;
+        interfaceIndex = 0;
+    }
+
+    void ReceivePacketFromMac(
+        const unsigned int /*interfaceIndex*/,
+        unique_ptr<Packet>& packetPtr,
+        const NetworkAddress& /*lastHopAddress*/,
+        const EtherTypeField& /*etherType*/)
+    {
+        numberReceivedPackets++;
+        packetPtr.reset();
+    }
+
+    void ReceiveUndeliveredPacketFromMac(
+        const unsigned int /*interfaceIndex*/,
+        unique_ptr<Packet>& packetPtr,
+        const NetworkAddress& /*nextHopAddress*/)
+    {
+        numberUndeliveredPackets++;
+        packetPtr.reset();
+    }
+
+    void ProcessLinkIsUpNotification(const unsigned int /*interfaceIndex*/) { }
+    void ProcessLinkIsDownNotification(const unsigned int /*interfaceIndex*/) { }
+
+    void ProcessNewLinkToANodeNotification(
+        const unsigned int /*interfaceIndex*/,
+        const GenericMacAddress& /*macAddress*/)
+    {}
+
+    unsigned long long int GetNumberReceivedPackets() const { return numberReceivedPackets; }
+    unsigned long long int GetNumberUndeliveredPackets() const { return numberUndeliveredPackets; }
+
+private:
+    NetworkAddress subnetAddress;
+    NetworkAddress subnetMask;
+
+    shared_ptr<MacLayer> macLayerPtr;
+    shared_ptr<InterfaceOutputQueue> outputQueuePtr;
+
+    unsigned long long int numberReceivedPackets;
+    unsigned long long int numberUndeliveredPackets;
+
+};//NetworkLayer//
+
+//--------------------------------------------------------------------------------------------------
+// Applications
+
+typedef string ApplicationId;
+
+class Application {
+public:
+    Application(
+        const shared_ptr<SimulationEngineInterface>& initSimulationEngineInterfacePtr,
+        const ApplicationId& initApplicationId)
+        :
+        simulationEngineInterfacePtr(initSimulationEngineInterfacePtr),
+        theApplicationId(initApplicationId)
+    {}
+
+    virtual ~Application() { }
+
+    const ApplicationId& GetApplicationId() const { return theApplicationId; }
+
+protected:
+    shared_ptr<SimulationEngineInterface> simulationEngineInterfacePtr;
+    ApplicationId theApplicationId;
+
+};//Application//
+
+struct ApplicationSendTraceRecord {
+    unsigned long long int sourceNodeSequenceNumber;
+    NodeId sourceNodeId;
+    NodeId destinationNodeId;
+    int packetSequenceNumber;
+};
+
+const size_t APPLICATION_SEND_TRACE_RECORD_BYTES = sizeof(ApplicationSendTraceRecord);
+
+struct ApplicationReceiveTraceRecord {
+    unsigned long long int sourceNodeSequenceNumber;
+    SimTime delay;
+    unsigned int receivedPackets;
+    NodeId sourceNodeId;
+    int packetSequenceNumber;
+    unsigned short int packetLengthBytes;
+};
+
+const size_t APPLICATION_RECEIVE_TRACE_RECORD_BYTES = sizeof(ApplicationReceiveTraceRecord);
+
+}//namespace//
+
+#endif
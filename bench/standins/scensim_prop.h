@@ -0,0 +1,109 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// A single collision domain: every signal reaches every other node interface
+// of the same propagation model instance (no path loss, no propagation delay).
+
+#ifndef SCENSIM_PROP_H
+#define SCENSIM_PROP_H
+
+#include "scensim_engine.h"
+
+namespace ScenSim {
+
+template<typename FrameType> class SimplePropagationModelForNode;
+
+template<typename FrameType>
+class SimplePropagationModel {
+public:
+    SimplePropagationModel(const InterfaceOrInstanceId& initInstanceId)
+        : instanceId(MakeLowerCaseString(initInstanceId)) { }
+
+    const InterfaceOrInstanceId& GetInstanceId() const { return instanceId; }
+
+    shared_ptr<SimplePropagationModelForNode<FrameType> > GetNewPropagationModelInterface(
+        const NodeId& theNodeId,
+        const InterfaceId& theInterfaceId)
+    {
+        return (shared_ptr<SimplePropagationModelForNode<FrameType> >(
+            new SimplePropagationModelForNode<FrameType>(this, theNodeId, theInterfaceId)));
+    }
+
+private:
+    friend class SimplePropagationModelForNode<FrameType>;
+
+    InterfaceOrInstanceId instanceId;
+
+    vector<SimplePropagationModelForNode<FrameType>*> nodeInterfacePtrs;
+
+};//SimplePropagationModel//
+
+template<typename FrameType>
+class SimplePropagationModelForNode {
+public:
+    class SignalHandler {
+    public:
+        virtual ~SignalHandler() { }
+
+        virtual void ProcessSignalArrivalFromChannel(
+            const unsigned int channelNumber,
+            const shared_ptr<const FrameType>& framePtr,
+            const SimTime& signalEndTime) = 0;
+    };
+
+    SimplePropagationModelForNode(
+        SimplePropagationModel<FrameType>* initPropagationModelPtr,
+        const NodeId& initNodeId,
+        const InterfaceId& initInterfaceId)
+        :
+        propagationModelPtr(initPropagationModelPtr),
+        theNodeId(initNodeId),
+        theInterfaceId(initInterfaceId),
+        signalHandlerPtr(nullptr)
+    {
+        propagationModelPtr->nodeInterfacePtrs.push_back(this);
+    }
+
+    ~SimplePropagationModelForNode()
+    {
+        vector<SimplePropagationModelForNode<FrameType>*>& nodeInterfacePtrs =
+            propagationModelPtr->nodeInterfacePtrs;
+
+        nodeInterfacePtrs.erase(
+            std::remove(nodeInterfacePtrs.begin(), nodeInterfacePtrs.end(), this),
+            nodeInterfacePtrs.end());
+    }
+
+    const InterfaceOrInstanceId& GetInstanceId() const { return (propagationModelPtr->GetInstanceId()); }
+    NodeId GetNodeId() const { return theNodeId; }
+    const InterfaceId& GetInterfaceId() const { return theInterfaceId; }
+
+    void SetSignalHandler(SignalHandler* initSignalHandlerPtr) { signalHandlerPtr = initSignalHandlerPtr; }
+
+    void TransmitSignal(
+        const unsigned int channelNumber,
+        const shared_ptr<const FrameType>& framePtr,
+        const SimTime& signalEndTime)
+    {
+        const vector<SimplePropagationModelForNode<FrameType>*>& nodeInterfacePtrs =
+            propagationModelPtr->nodeInterfacePtrs;
+
+        for(size_t i = 0; (i < nodeInterfacePtrs.size()); i++) {
+            SimplePropagationModelForNode<FrameType>& nodeInterface = *nodeInterfacePtrs[i];
+
+            if ((&nodeInterface != this) && (nodeInterface.signalHandlerPtr != nullptr)) {
+                nodeInterface.signalHandlerPtr->ProcessSignalArrivalFromChannel(
+                    channelNumber, framePtr, signalEndTime);
+            }//if//
+        }//for//
+    }
+
+private:
+    SimplePropagationModel<FrameType>* propagationModelPtr;
+    NodeId theNodeId;
+    InterfaceId theInterfaceId;
+    SignalHandler* signalHandlerPtr;
+
+};//SimplePropagationModelForNode//
+
+}//namespace//
+
+#endif
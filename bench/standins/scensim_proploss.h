@@ -0,0 +1,6 @@
+// Minimal stand-in for the Scenargie header of the same name.
+
+#ifndef SCENSIM_PROPLOSS_H
+#define SCENSIM_PROPLOSS_H
+
+#endif
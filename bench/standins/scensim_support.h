@@ -0,0 +1,21 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// The wave_*.h headers use these standard names unqualified in namespace Wave
+// without their own using-declarations, so the stand-ins provide them at
+// global scope.
+
+#ifndef SCENSIM_SUPPORT_H
+#define SCENSIM_SUPPORT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <array>
+
+using std::string;
+using std::vector;
+using std::map;
+using std::set;
+using std::array;
+
+#endif
@@ -0,0 +1,42 @@
+// Minimal stand-in for the Scenargie header of the same name.
+// Binary trace output is always off in the stand-in engine, so the record
+// sizes are simply the struct sizes.
+
+#ifndef WAVE_TRACEDEFS_H
+#define WAVE_TRACEDEFS_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Wave {
+
+struct WaveNewChIntervalTraceRecord {
+    uint32_t previousChannelCategory;
+    uint32_t previousChannelNumber;
+    uint32_t nextChannelCategory;
+    uint32_t nextChannelNumber;
+};
+const size_t WAVE_NEW_CH_INTERVAL_TRACE_RECORD_BYTES = sizeof(WaveNewChIntervalTraceRecord);
+
+struct WavePhyChSwitchTraceRecord {
+    uint32_t channelCategory;
+    uint32_t channelNumber;
+};
+const size_t WAVE_PHY_CH_SWITCH_TRACE_RECORD_BYTES = sizeof(WavePhyChSwitchTraceRecord);
+
+struct WsmpPacketTraceRecord {
+    uint64_t sourceNodeSequenceNumber;
+    uint32_t sourceNodeId;
+};
+const size_t WSMP_PACKET_TRACE_RECORD_BYTES = sizeof(WsmpPacketTraceRecord);
+
+struct WsmpFullQueueDropTraceRecord {
+    uint64_t sourceNodeSequenceNumber;
+    uint32_t sourceNodeId;
+    uint16_t enqueueResult;
+};
+const size_t WSMP_FULL_QUEUE_DROP_TRACE_RECORD_BYTES = sizeof(WsmpFullQueueDropTraceRecord);
+
+}//namespace//
+
+#endif
@@ -0,0 +1,1016 @@
+// Standalone benchmark of the WAVE/802.11p hot paths.
+//
+// Builds against the minimal engine, parameter database and PHY stand-ins in
+// bench/standins instead of the Scenargie engine.
+//
+// Per-function microbenchmarks (ns, operator new calls and read/write system
+// calls per operation) on a three node network with continuous CCH access:
+//
+//   Dot11Mac::RecalcRandomBackoff
+//   Dot11Mac::ProcessInterframeSpaceAndBackoffTimeout  (one queued frame per call)
+//   DsrcMessageApplication::PeriodicallyTransmitBasicSafetyMessage
+//   DsrcMessageApplication::ReceiveBasicSafetyMessage
+//   WsmpLayer::SendWsm / ReceiveWsm                     (application excluded)
+//   WsmpLayer::EncodeWsaServiceInfo / EncodeWsaChannelAndRoutingInfo  (WSA Write*)
+//   WsmpLayer::ReceiveWsa                               (WSA Read*, parsed and repeated)
+//
+// Only the call itself is timed; engine runs that deliver or drain frames
+// between calls are not. The BSM application functions include its research
+// log file I/O (tmp*.txt), which shows up in their system call count.
+//
+// End-to-end scenarios, each a small single collision domain network driven
+// by the stand-in event engine:
+//
+//   bsm-*  DsrcMessageApplication BSM send/receive over WsmpLayer SendWsm/ReceiveWsm,
+//          with the Dot11Mac EDCA contention path (RecalcRandomBackoff,
+//          ProcessInterframeSpaceAndBackoffTimeout) under alternating CCH/SCH access.
+//          bsm-*-1400B uses frames long enough to be held at the CCH interval
+//          end; bsm-*-restart restarts the held frames with a random backoff
+//          (dot11-random-backoff-after-transmission-permission-end).
+//          bsm-*-clock runs all nodes' interval timers on one shared
+//          WaveMac::IntervalClock (its-wave-use-global-interval-clock).
+//          Collisions are the frames the PHYs received corrupted.
+//   wsa    Periodic WSA encoding (service, channel and routing info elements) on
+//          node 1 (the only provider; providers drop WSAs) and WSA decoding on
+//          every other node.
+//
+// The BSM application writes per-node research logs (tmp*.txt) and debug lines
+// to std::cout; that I/O stays in the measured time, but it is redirected to a
+// scratch directory under /tmp and a discarded stream.
+//
+// Usage: wave_hotpath_bench [number-nodes] [simulated-seconds]
+
+// The microbenchmarks call private member functions of the measured classes.
+// The standard headers are included first so that only the repo classes (and
+// the stand-ins) are compiled with everything public.
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define private public
+#define protected public
+#include "wave_app.h"
+#undef protected
+#undef private
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Number of operator new calls of the process (operator_new_counter.cpp).
+
+extern unsigned long long int numberOperatorNewCalls;
+
+
+
+namespace WaveBench {
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::cerr;
+using std::endl;
+
+using ScenSim::SimTime;
+using ScenSim::SECOND;
+using ScenSim::NodeId;
+using ScenSim::ParameterDatabaseReader;
+using ScenSim::SimulationEngine;
+using ScenSim::SimulationEngineInterface;
+using ScenSim::SimplePropagationModel;
+using ScenSim::NetworkLayer;
+using ScenSim::NetworkAddress;
+using ScenSim::ObjectMobilityModel;
+using ScenSim::ObjectMobilityPosition;
+using ScenSim::CounterStatistic;
+using ScenSim::ConvertToString;
+using ScenSim::Packet;
+using ScenSim::PacketPriority;
+using ScenSim::GenericMacAddress;
+using ScenSim::SimpleMacPacketHandler;
+using ScenSim::MILLI_SECOND;
+using std::unique_ptr;
+using std::move;
+
+using Dot11::Dot11Phy;
+using Dot11::Dot11Mac;
+
+using Wave::WaveMac;
+using Wave::WaveMacPhyInput;
+using Wave::WsmpLayer;
+using Wave::DsrcMessageApplication;
+using Wave::ChannelNumberIndexType;
+
+const string phyDeviceName = "wave";
+
+class StationaryMobilityModel : public ObjectMobilityModel {
+public:
+    StationaryMobilityModel(const double xPositionMeters)
+    {
+        position.SetX_PositionMeters(xPositionMeters);
+        position.SetHeightFromGroundMeters(1.5);
+    }
+
+    virtual void GetPositionForTime(const SimTime& snapshotTime, ObjectMobilityPosition& aPosition) override
+        { aPosition = position; }
+
+private:
+    ObjectMobilityPosition position;
+
+};//StationaryMobilityModel//
+
+
+
+struct ScenarioConfig {
+    string name;
+    SimTime bsmInterval;
+    unsigned int bsmPayloadSizeBytes;
+    bool bsmIsEnabled;
+    bool wsaIsEnabled;
+    bool globalIntervalClockIsEnabled;
+    bool heldAccessCategoryRestartIsEnabled;
+};
+
+
+
+struct WaveNode {
+    shared_ptr<SimulationEngineInterface> simEngineInterfacePtr;
+    shared_ptr<Dot11Phy::PropModelInterface> propModelInterfacePtr;
+    shared_ptr<Dot11Phy> phyPtr;
+    shared_ptr<NetworkLayer> networkLayerPtr;
+    shared_ptr<WaveMac> waveMacPtr;
+    shared_ptr<ObjectMobilityModel> mobilityModelPtr;
+    shared_ptr<WsmpLayer> wsmpLayerPtr;
+    shared_ptr<DsrcMessageApplication> bsmAppPtr;
+};
+
+
+
+inline
+void SetBaseParameters(const ScenarioConfig& config, const SimTime& endTime, ParameterDatabaseReader& parameterDatabase)
+{
+    // IEEE 1609.4 channel timing.
+
+    parameterDatabase.AddParameter("its-wave-sync-tolerance", "0.000002");
+    parameterDatabase.AddParameter("its-wave-max-channel-switching-time", "0.002");
+    parameterDatabase.AddParameter("its-wave-cch-interval", "0.05");
+    parameterDatabase.AddParameter("its-wave-sch-interval", "0.05");
+
+    if (config.globalIntervalClockIsEnabled) {
+        parameterDatabase.AddParameter("its-wave-use-global-interval-clock", "true");
+    }//if//
+
+    parameterDatabase.AddParameter("dot11-node-type", "ad-hoc");
+    parameterDatabase.AddParameter("dot11-modulation-and-coding", "QPSK_0.5");
+    parameterDatabase.AddParameter("dot11-modulation-and-coding-for-management-frames", "BPSK_0.5");
+    parameterDatabase.AddParameter("dot11-tx-power-specified-by", "UpperLayer");
+    parameterDatabase.AddParameter("dot11-default-tx-power-dbm-when-not-specified", "20");
+
+    if (config.heldAccessCategoryRestartIsEnabled) {
+        parameterDatabase.AddParameter("dot11-random-backoff-after-transmission-permission-end", "true");
+    }//if//
+
+    parameterDatabase.AddParameter("its-wsmp-default-datarate-bits-per-second", "6000000");
+    parameterDatabase.AddParameter("its-wsmp-default-tx-power", "20");
+
+    const SimTime bsmStartTime = (config.bsmIsEnabled ? (SECOND / 10) : endTime);
+
+    parameterDatabase.AddParameter("its-bsm-app-traffic-start-time", ConvertToString(ScenSim::ConvertTimeToDoubleSecs(bsmStartTime)));
+    parameterDatabase.AddParameter("its-bsm-app-traffic-start-time-max-jitter", ConvertToString(ScenSim::ConvertTimeToDoubleSecs(config.bsmInterval)));
+    parameterDatabase.AddParameter("its-bsm-app-traffic-end-time", ConvertToString(ScenSim::ConvertTimeToDoubleSecs(endTime)));
+    parameterDatabase.AddParameter("its-bsm-app-traffic-interval", ConvertToString(ScenSim::ConvertTimeToDoubleSecs(config.bsmInterval)));
+    parameterDatabase.AddParameter("its-bsm-app-packet-priority", "3");
+    parameterDatabase.AddParameter("its-bsm-app-packet-payload-size-bytes", ConvertToString(config.bsmPayloadSizeBytes));
+
+}//SetBaseParameters//
+
+
+
+inline
+void CreateNode(
+    const ParameterDatabaseReader& parameterDatabase,
+    SimulationEngine& simulationEngine,
+    SimplePropagationModel<Dot11Phy::PropFrame>& propagationModel,
+    const NodeId& theNodeId,
+    const shared_ptr<WaveMac::IntervalClock>& intervalClockPtr,
+    WaveNode& node)
+{
+    const ScenSim::RandomNumberGeneratorSeed nodeSeed = ScenSim::HashInputsToMakeSeed(12345, theNodeId);
+
+    node.simEngineInterfacePtr = simulationEngine.GetSimulationEngineInterface(theNodeId);
+    node.propModelInterfacePtr = propagationModel.GetNewPropagationModelInterface(theNodeId, phyDeviceName);
+
+    node.phyPtr.reset(
+        new Dot11Phy(parameterDatabase, node.simEngineInterfacePtr, node.propModelInterfacePtr, phyDeviceName));
+
+    node.networkLayerPtr.reset(new NetworkLayer());
+
+    WaveMacPhyInput phyInput;
+    phyInput.phyDeviceName = phyDeviceName;
+    phyInput.phyPtr = node.phyPtr;
+    phyInput.channelNumberIds[Wave::CHANNEL_CATEGORY_CCH].push_back(Wave::CHANNEL_NUMBER_178);
+
+    for(int i = Wave::CHANNEL_NUMBER_172; (i <= Wave::CHANNEL_NUMBER_184); i++) {
+        if (i != Wave::CHANNEL_NUMBER_178) {
+            phyInput.channelNumberIds[Wave::CHANNEL_CATEGORY_SCH].push_back(ChannelNumberIndexType(i));
+        }//if//
+    }//for//
+
+    node.waveMacPtr.reset(
+        new WaveMac(
+            parameterDatabase,
+            node.simEngineInterfacePtr,
+            theNodeId,
+            phyDeviceName,
+            0,
+            node.networkLayerPtr,
+            vector<WaveMacPhyInput>(1, phyInput),
+            nodeSeed,
+            intervalClockPtr));
+
+    node.mobilityModelPtr.reset(new StationaryMobilityModel(10.0 * theNodeId));
+
+    node.wsmpLayerPtr.reset(
+        new WsmpLayer(
+            parameterDatabase,
+            node.simEngineInterfacePtr,
+            theNodeId,
+            phyDeviceName,
+            nodeSeed,
+            node.mobilityModelPtr,
+            node.networkLayerPtr,
+            node.waveMacPtr));
+
+    node.bsmAppPtr.reset(
+        new DsrcMessageApplication(
+            parameterDatabase,
+            node.simEngineInterfacePtr,
+            node.wsmpLayerPtr,
+            theNodeId,
+            nodeSeed,
+            node.mobilityModelPtr));
+
+}//CreateNode//
+
+
+
+inline
+void AddWsaServiceInfos(const NodeId& theNodeId, WsmpLayer& wsmpLayer)
+{
+    const uint64_t allServiceInfoExtensions =
+        ((uint64_t(1) << Wave::EXTENSION_PROVIDER_SERVICE_CONTEXT) |
+         (uint64_t(1) << Wave::EXTENSION_IPV6_ADDRESS) |
+         (uint64_t(1) << Wave::EXTENSION_SERVICE_PORT) |
+         (uint64_t(1) << Wave::EXTENSION_PROVIDER_MAC_ADDRESS) |
+         (uint64_t(1) << Wave::EXTENSION_RCPI_THRESHOLD) |
+         (uint64_t(1) << Wave::EXTENSION_WSA_COUNT_THRESHOLD) |
+         (uint64_t(1) << Wave::EXTENSION_WSA_COUNT_THRESHOLD_INTERVAL));
+
+    wsmpLayer.SetWsaHeaderExtension(
+        (uint64_t(1) << Wave::EXTENSION_REPEAT_RATE) |
+        (uint64_t(1) << Wave::EXTENSION_TX_POWER) |
+        (uint64_t(1) << Wave::EXTENSION_2D_LOCATION));
+
+    const int numberServiceInfos = 4;
+    const int numberTransmissionPer5sec = 50;
+
+    for(int i = 0; (i < numberServiceInfos); i++) {
+        wsmpLayer.AddOrUpdateWsaServiceInfo(
+            i,
+            Wave::ConvertToProviderServiceIdString(0x10 + i),
+            uint8_t(i),
+            ChannelNumberIndexType(Wave::CHANNEL_NUMBER_172 + i),
+            Wave::CHANNEL_ACCESS_ALTERNATING,
+            numberTransmissionPer5sec,
+            allServiceInfoExtensions,
+            "bench-service-" + ConvertToString(i),
+            NetworkAddress(0xFE800000ULL, theNodeId),
+            static_cast<unsigned short>(5000 + i),
+            theNodeId,
+            uint8_t(10),
+            uint8_t(2),
+            uint8_t(5));
+    }//for//
+
+}//AddWsaServiceInfos//
+
+
+
+// Counters whose name ends with "statNameSuffix".
+
+inline
+long long int SumCounters(const vector<WaveNode>& nodes, const string& statNameSuffix)
+{
+    long long int total = 0;
+
+    for(size_t i = 0; (i < nodes.size()); i++) {
+        const vector<shared_ptr<CounterStatistic> >& counterStatPtrs =
+            nodes[i].simEngineInterfacePtr->GetCounterStats();
+
+        for(size_t j = 0; (j < counterStatPtrs.size()); j++) {
+            const string& statName = counterStatPtrs[j]->GetName();
+
+            if ((statName.size() >= statNameSuffix.size()) &&
+                (statName.compare(
+                    (statName.size() - statNameSuffix.size()), statNameSuffix.size(), statNameSuffix) == 0)) {
+                total += counterStatPtrs[j]->GetCounterValue();
+            }//if//
+        }//for//
+    }//for//
+
+    return total;
+
+}//SumCounters//
+
+
+
+inline
+void RunScenario(const ScenarioConfig& config, const unsigned int numberNodes, const SimTime& endTime)
+{
+    ParameterDatabaseReader parameterDatabase;
+    SetBaseParameters(config, endTime, parameterDatabase);
+
+    SimulationEngine simulationEngine;
+    SimplePropagationModel<Dot11Phy::PropFrame> propagationModel("dsrc");
+
+    // Shared by all nodes; runs on a non-node engine context (sequential engine).
+
+    shared_ptr<WaveMac::IntervalClock> intervalClockPtr;
+
+    if (config.globalIntervalClockIsEnabled) {
+        intervalClockPtr.reset(
+            new WaveMac::IntervalClock(
+                simulationEngine.GetSimulationEngineInterface(ScenSim::InvalidNodeId)));
+    }//if//
+
+    vector<WaveNode> nodes(numberNodes);
+
+    for(unsigned int i = 0; (i < numberNodes); i++) {
+        CreateNode(parameterDatabase, simulationEngine, propagationModel, (i + 1), intervalClockPtr, nodes[i]);
+
+        if ((config.wsaIsEnabled) && (i == 0)) {
+            AddWsaServiceInfos((i + 1), *nodes[i].wsmpLayerPtr);
+        }//if//
+    }//for//
+
+    std::ostream discardedStream(nullptr);
+    std::streambuf* coutBufferPtr = std::cout.rdbuf(discardedStream.rdbuf());
+
+    const std::chrono::steady_clock::time_point wallStartTime = std::chrono::steady_clock::now();
+
+    simulationEngine.RunSimulationUntil(endTime);
+
+    const double wallSecs =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStartTime).count();
+
+    for(unsigned int i = 0; (i < numberNodes); i++) {
+        nodes[i].waveMacPtr->DisconnectFromOtherLayers();
+    }//for//
+
+    std::cout.rdbuf(coutBufferPtr);
+
+    const unsigned long long int numberEvents = simulationEngine.GetNumberExecutedEvents();
+
+    std::printf(
+        "%-22s nodes=%-4u sim=%6.2fs wall=%9.3fms events=%-10llu events/s=%-12.0f "
+        "bsm-sent=%-8lld bsm-recv=%-8lld wsmp-sent=%-8lld wsmp-recv=%-8lld "
+        "collisions=%-8lld mac-drops=%-6lld queue-drops=%lld\n",
+        config.name.c_str(),
+        numberNodes,
+        ScenSim::ConvertTimeToDoubleSecs(endTime),
+        (wallSecs * 1000.0),
+        numberEvents,
+        (wallSecs > 0.0) ? (numberEvents / wallSecs) : 0.0,
+        SumCounters(nodes, "BsmApp_PacketsSent"),
+        SumCounters(nodes, "BsmApp_PacketsReceived"),
+        SumCounters(nodes, "Wsmp_PacketsSent"),
+        SumCounters(nodes, "Wsmp_PacketsReceived"),
+        SumCounters(nodes, "_CorruptedFramesReceived"),
+        SumCounters(nodes, "_FramesDropped"),
+        SumCounters(nodes, "_QueueDrops"));
+
+}//RunScenario//
+
+
+
+//--------------------------------------------------------------------------
+// Per-function microbenchmarks
+//--------------------------------------------------------------------------
+
+// Read and write family system calls of the process ("syscr" + "syscw" of
+// /proc/self/io). Other system calls such as open and close are not counted
+// by the kernel. Returns -1 if the file is not available.
+
+inline
+long long int ReadNumberReadWriteSyscalls()
+{
+    char buffer[1024];
+
+    const int fileDescriptor = open("/proc/self/io", O_RDONLY);
+
+    if (fileDescriptor < 0) {
+        return -1;
+    }//if//
+
+    const ssize_t numberReadBytes = read(fileDescriptor, buffer, (sizeof(buffer) - 1));
+
+    close(fileDescriptor);
+
+    if (numberReadBytes <= 0) {
+        return -1;
+    }//if//
+
+    buffer[numberReadBytes] = '\0';
+
+    const char* fieldNames[] = {"syscr:", "syscw:"};
+    long long int numberSyscalls = 0;
+
+    for(size_t i = 0; (i < (sizeof(fieldNames) / sizeof(fieldNames[0]))); i++) {
+        const char* fieldPtr = std::strstr(buffer, fieldNames[i]);
+
+        if (fieldPtr == nullptr) {
+            return -1;
+        }//if//
+
+        numberSyscalls += std::strtoll((fieldPtr + std::strlen(fieldNames[i])), nullptr, 10);
+    }//for//
+
+    return numberSyscalls;
+
+}//ReadNumberReadWriteSyscalls//
+
+
+
+// Accumulates time, operator new calls and read/write system calls over the
+// Start()/Stop() sections of one function. The counters are sampled outside
+// of the timed section; the read of /proc/self/io by the start sample is
+// counted by the stop sample and subtracted.
+
+class FunctionCounter {
+public:
+    FunctionCounter(const string& initFunctionName)
+        :
+        functionName(initFunctionName),
+        numberOperations(0),
+        elapsedNanoseconds(0),
+        numberAllocations(0),
+        numberSyscalls(0),
+        syscallsAreAvailable(true),
+        startAllocations(0),
+        startSyscalls(0)
+    {}
+
+    void Start()
+    {
+        startSyscalls = ReadNumberReadWriteSyscalls();
+        startAllocations = numberOperatorNewCalls;
+        startTime = std::chrono::steady_clock::now();
+    }
+
+    void Stop(const unsigned int numberStoppedOperations)
+    {
+        const std::chrono::steady_clock::time_point stopTime = std::chrono::steady_clock::now();
+        const unsigned long long int stopAllocations = numberOperatorNewCalls;
+        const long long int stopSyscalls = ReadNumberReadWriteSyscalls();
+
+        numberOperations += numberStoppedOperations;
+        elapsedNanoseconds +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(stopTime - startTime).count();
+        numberAllocations += (stopAllocations - startAllocations);
+
+        if ((startSyscalls < 0) || (stopSyscalls < 0)) {
+            syscallsAreAvailable = false;
+        }
+        else {
+            numberSyscalls += (stopSyscalls - startSyscalls - 1);
+        }//if//
+    }
+
+    void Output() const
+    {
+        const double divisor = ((numberOperations > 0) ? double(numberOperations) : 1.0);
+
+        std::printf(
+            "%-62s ops=%-8llu ns/op=%10.1f allocs/op=%7.2f ",
+            functionName.c_str(),
+            numberOperations,
+            (elapsedNanoseconds / divisor),
+            (numberAllocations / divisor));
+
+        if (syscallsAreAvailable) {
+            std::printf("rw-syscalls/op=%.2f\n", (numberSyscalls / divisor));
+        }
+        else {
+            std::printf("rw-syscalls/op=n/a\n");
+        }//if//
+    }
+
+private:
+    string functionName;
+
+    unsigned long long int numberOperations;
+    long long int elapsedNanoseconds;
+    unsigned long long int numberAllocations;
+    long long int numberSyscalls;
+    bool syscallsAreAvailable;
+
+    std::chrono::steady_clock::time_point startTime;
+    unsigned long long int startAllocations;
+    long long int startSyscalls;
+
+};//FunctionCounter//
+
+
+
+// Keeps the first WSM and WSA a node receives from its MAC.
+
+class CapturingMacPacketHandler : public SimpleMacPacketHandler {
+public:
+    CapturingMacPacketHandler() : wsmTransmitterAddress(0), wsaTransmitterAddress(0) {}
+
+    virtual void ReceivePacketFromMac(
+        unique_ptr<Packet>& packetPtr,
+        const GenericMacAddress& transmitterAddress) override
+    {
+        const unsigned char version = packetPtr->GetRawPayloadData(0, 1)[0];
+
+        if ((version == 2) && (wsmPacketPtr == nullptr)) {
+            wsmPacketPtr = move(packetPtr);
+            wsmTransmitterAddress = transmitterAddress;
+        }
+        else if (((version >> 2) == 1) && (wsaPacketPtr == nullptr)) {
+            wsaPacketPtr = move(packetPtr);
+            wsaTransmitterAddress = transmitterAddress;
+        }//if//
+
+        packetPtr = nullptr;
+    }
+
+    unique_ptr<Packet> wsmPacketPtr;
+    GenericMacAddress wsmTransmitterAddress;
+    unique_ptr<Packet> wsaPacketPtr;
+    GenericMacAddress wsaTransmitterAddress;
+
+};//CapturingMacPacketHandler//
+
+
+
+class CapturingWsmApplicationHandler : public WsmpLayer::WsmApplicationHandler {
+public:
+    virtual void ReceiveWsm(unique_ptr<Packet>& packetPtr) override
+    {
+        if (capturedPacketPtr == nullptr) {
+            capturedPacketPtr = move(packetPtr);
+        }//if//
+
+        packetPtr = nullptr;
+    }
+
+    unique_ptr<Packet> capturedPacketPtr;
+
+};//CapturingWsmApplicationHandler//
+
+
+
+class DiscardingWsmApplicationHandler : public WsmpLayer::WsmApplicationHandler {
+public:
+    virtual void ReceiveWsm(unique_ptr<Packet>& packetPtr) override { packetPtr = nullptr; }
+
+};//DiscardingWsmApplicationHandler//
+
+
+
+inline
+void CopyPackets(const Packet& originalPacket, vector<unique_ptr<Packet> >& packetPtrs)
+{
+    for(size_t i = 0; (i < packetPtrs.size()); i++) {
+        packetPtrs[i].reset(new Packet(originalPacket));
+    }//for//
+
+}//CopyPackets//
+
+
+
+inline
+void RunSimulationFor(SimulationEngine& simulationEngine, const SimTime& duration)
+{
+    simulationEngine.RunSimulationUntil(simulationEngine.CurrentTime() + duration);
+}
+
+
+
+inline
+void RunPerFunctionBenchmarks()
+{
+    // Node 1 transmits, node 2 runs the receive side functions and node 3
+    // captures the frames they are fed with. The BSM application does not
+    // transmit by itself (traffic end time before the first transmission).
+
+    const unsigned int numberNodes = 3;
+    const SimTime settleTime = (10 * MILLI_SECOND);
+    const SimTime drainTime = (50 * MILLI_SECOND);
+    const SimTime frameDrainTime = (5 * MILLI_SECOND);
+
+    const ScenarioConfig config = { "functions", (100 * MILLI_SECOND), 200, false, false, false, false };
+
+    ParameterDatabaseReader parameterDatabase;
+    SetBaseParameters(config, MILLI_SECOND, parameterDatabase);
+
+    SimulationEngine simulationEngine;
+    SimplePropagationModel<Dot11Phy::PropFrame> propagationModel("dsrc");
+
+    vector<WaveNode> nodes(numberNodes);
+
+    for(unsigned int i = 0; (i < numberNodes); i++) {
+        CreateNode(
+            parameterDatabase, simulationEngine, propagationModel, (i + 1),
+            shared_ptr<WaveMac::IntervalClock>(), nodes[i]);
+
+        nodes[i].waveMacPtr->SetContinuousAccess(Wave::CHANNEL_NUMBER_178);
+    }//for//
+
+    WaveNode& txNode = nodes[0];
+    WaveNode& rxNode = nodes[1];
+    WaveNode& captureNode = nodes[2];
+
+    Dot11Mac& txMac = *txNode.waveMacPtr->channelEntities.at(Wave::CHANNEL_NUMBER_178).macPtr;
+
+    const DsrcMessageApplication::BasicSafetyMessageInfo& bsmInfo = txNode.bsmAppPtr->basicSafetyMessageInfo;
+    const string benchProviderServiceId = Wave::ConvertToProviderServiceIdString(0x20);
+    const vector<unsigned char> benchPayload(bsmInfo.extendedPayloadSizeBytes, 0);
+
+    shared_ptr<CapturingMacPacketHandler> capturingMacPacketHandlerPtr(new CapturingMacPacketHandler());
+    captureNode.waveMacPtr->SetWsmpPacketHandler(capturingMacPacketHandlerPtr);
+
+    std::ostream discardedStream(nullptr);
+    std::streambuf* coutBufferPtr = std::cout.rdbuf(discardedStream.rdbuf());
+
+    simulationEngine.RunSimulationUntil(settleTime);
+
+    vector<FunctionCounter> counters;
+
+    // Dot11Mac::RecalcRandomBackoff (backoff state restored afterwards).
+
+    {
+        FunctionCounter counter("Dot11Mac::RecalcRandomBackoff");
+
+        const size_t numberAccessCategories = txMac.accessCategories.size();
+        vector<int> savedNumberBackoffSlots(numberAccessCategories);
+        vector<SimTime> savedBackoffDurations(numberAccessCategories);
+
+        for(size_t i = 0; (i < numberAccessCategories); i++) {
+            savedNumberBackoffSlots[i] = txMac.accessCategories[i].currentNumOfBackoffSlots;
+            savedBackoffDurations[i] = txMac.accessCategories[i].currentNonExtendedBackoffDuration;
+        }//for//
+
+        const unsigned int numberOperations = 1000000;
+
+        counter.Start();
+        for(unsigned int i = 0; (i < numberOperations); i++) {
+            txMac.RecalcRandomBackoff(txMac.accessCategories[i % numberAccessCategories]);
+        }//for//
+        counter.Stop(numberOperations);
+
+        for(size_t i = 0; (i < numberAccessCategories); i++) {
+            txMac.accessCategories[i].currentNumOfBackoffSlots = savedNumberBackoffSlots[i];
+            txMac.accessCategories[i].currentNonExtendedBackoffDuration = savedBackoffDurations[i];
+        }//for//
+
+        counters.push_back(counter);
+    }
+
+    // DsrcMessageApplication::PeriodicallyTransmitBasicSafetyMessage (the
+    // first BSM is also captured by node 3).
+
+    {
+        FunctionCounter counter("DsrcMessageApplication::PeriodicallyTransmitBasicSafetyMessage");
+
+        const unsigned int numberBatches = 50;
+        const unsigned int batchSize = 10;
+
+        for(unsigned int i = 0; (i < numberBatches); i++) {
+            counter.Start();
+            for(unsigned int j = 0; (j < batchSize); j++) {
+                txNode.bsmAppPtr->PeriodicallyTransmitBasicSafetyMessage();
+            }//for//
+            counter.Stop(batchSize);
+
+            RunSimulationFor(simulationEngine, drainTime);
+        }//for//
+
+        counters.push_back(counter);
+    }
+
+    if (capturingMacPacketHandlerPtr->wsmPacketPtr == nullptr) {
+        std::cout.rdbuf(coutBufferPtr);
+        cerr << "Error: No BSM was received by the capturing node." << endl;
+        exit(1);
+    }//if//
+
+    const Packet& wsmPacket = *capturingMacPacketHandlerPtr->wsmPacketPtr;
+    const GenericMacAddress txMacAddress = capturingMacPacketHandlerPtr->wsmTransmitterAddress;
+
+    // WsmpLayer::ReceiveWsm (node 2's BSM application is replaced by a
+    // discarding handler).
+
+    rxNode.wsmpLayerPtr->SetWsmApplicationHandler(
+        bsmInfo.providerServiceId,
+        shared_ptr<WsmpLayer::WsmApplicationHandler>(new DiscardingWsmApplicationHandler()));
+
+    {
+        FunctionCounter counter("WsmpLayer::ReceiveWsm");
+
+        const unsigned int numberBatches = 20;
+        vector<unique_ptr<Packet> > packetPtrs(1000);
+
+        for(unsigned int i = 0; (i < numberBatches); i++) {
+            CopyPackets(wsmPacket, packetPtrs);
+
+            counter.Start();
+            for(size_t j = 0; (j < packetPtrs.size()); j++) {
+                rxNode.wsmpLayerPtr->ReceiveWsm(packetPtrs[j], txMacAddress);
+            }//for//
+            counter.Stop(static_cast<unsigned int>(packetPtrs.size()));
+        }//for//
+
+        counters.push_back(counter);
+    }
+
+    // DsrcMessageApplication::ReceiveBasicSafetyMessage (BSM payload as
+    // delivered by WsmpLayer::ReceiveWsm of node 3).
+
+    {
+        shared_ptr<CapturingWsmApplicationHandler> capturingWsmHandlerPtr(new CapturingWsmApplicationHandler());
+
+        captureNode.wsmpLayerPtr->SetWsmApplicationHandler(bsmInfo.providerServiceId, capturingWsmHandlerPtr);
+
+        unique_ptr<Packet> packetPtr(new Packet(wsmPacket));
+        captureNode.wsmpLayerPtr->ReceivePacketFromMac(packetPtr, txMacAddress);
+
+        assert(capturingWsmHandlerPtr->capturedPacketPtr != nullptr);
+
+        FunctionCounter counter("DsrcMessageApplication::ReceiveBasicSafetyMessage");
+
+        const unsigned int numberBatches = 4;
+        vector<unique_ptr<Packet> > packetPtrs(500);
+
+        for(unsigned int i = 0; (i < numberBatches); i++) {
+            CopyPackets(*capturingWsmHandlerPtr->capturedPacketPtr, packetPtrs);
+
+            counter.Start();
+            for(size_t j = 0; (j < packetPtrs.size()); j++) {
+                rxNode.bsmAppPtr->ReceiveBasicSafetyMessage(packetPtrs[j]);
+            }//for//
+            counter.Stop(static_cast<unsigned int>(packetPtrs.size()));
+        }//for//
+
+        counters.push_back(counter);
+    }
+
+    // WsmpLayer::SendWsm (packets created before the timed section).
+
+    {
+        FunctionCounter counter("WsmpLayer::SendWsm");
+
+        const unsigned int numberBatches = 200;
+        vector<unique_ptr<Packet> > packetPtrs(50);
+
+        for(unsigned int i = 0; (i < numberBatches); i++) {
+            for(size_t j = 0; (j < packetPtrs.size()); j++) {
+                packetPtrs[j] = Packet::CreatePacket(*txNode.simEngineInterfacePtr, benchPayload);
+            }//for//
+
+            counter.Start();
+            for(size_t j = 0; (j < packetPtrs.size()); j++) {
+                txNode.wsmpLayerPtr->SendWsm(
+                    packetPtrs[j],
+                    NetworkAddress::broadcastAddress,
+                    Wave::CHANNEL_NUMBER_178,
+                    benchProviderServiceId,
+                    bsmInfo.priority);
+            }//for//
+            counter.Stop(static_cast<unsigned int>(packetPtrs.size()));
+
+            RunSimulationFor(simulationEngine, drainTime);
+        }//for//
+
+        counters.push_back(counter);
+    }
+
+    // Dot11Mac::ProcessInterframeSpaceAndBackoffTimeout: one frame is queued,
+    // the engine runs up to the backoff expiration with the MAC wakeup timer
+    // canceled, and the timeout is processed by a direct call.
+
+    {
+        FunctionCounter counter("Dot11Mac::ProcessInterframeSpaceAndBackoffTimeout");
+
+        const unsigned int numberOperations = 2000;
+        unsigned int numberSkippedOperations = 0;
+
+        for(unsigned int i = 0; (i < numberOperations); i++) {
+            unique_ptr<Packet> packetPtr = Packet::CreatePacket(*txNode.simEngineInterfacePtr, benchPayload);
+
+            txNode.wsmpLayerPtr->SendWsm(
+                packetPtr,
+                NetworkAddress::broadcastAddress,
+                Wave::CHANNEL_NUMBER_178,
+                benchProviderServiceId,
+                bsmInfo.priority);
+
+            if ((txMac.macState != Dot11Mac::WaitingForIfsAndBackoffState) ||
+                (!txMac.WakeupTimerIsActive())) {
+
+                numberSkippedOperations++;
+                RunSimulationFor(simulationEngine, frameDrainTime);
+                continue;
+            }//if//
+
+            const SimTime wakeupTime = txMac.currentWakeupTimerExpirationTime;
+
+            txMac.CancelWakeupTimer();
+            simulationEngine.RunSimulationUntil(wakeupTime);
+
+            assert(txMac.macState == Dot11Mac::WaitingForIfsAndBackoffState);
+
+            counter.Start();
+            txMac.ProcessInterframeSpaceAndBackoffTimeout();
+            counter.Stop(1);
+
+            RunSimulationFor(simulationEngine, frameDrainTime);
+        }//for//
+
+        counters.push_back(counter);
+
+        if (numberSkippedOperations > 0) {
+            std::fprintf(stderr, "ProcessInterframeSpaceAndBackoffTimeout: %u frames skipped (no backoff pending)\n", numberSkippedOperations);
+        }//if//
+    }
+
+    // WSA Write* (encoding) and Read* (ReceiveWsa) of node 1's services; the
+    // first WSA is captured by node 3.
+
+    AddWsaServiceInfos(1, *txNode.wsmpLayerPtr);
+
+    RunSimulationFor(simulationEngine, (20 * drainTime));
+
+    if (capturingMacPacketHandlerPtr->wsaPacketPtr == nullptr) {
+        std::cout.rdbuf(coutBufferPtr);
+        cerr << "Error: No WSA was received by the capturing node." << endl;
+        exit(1);
+    }//if//
+
+    {
+        FunctionCounter counter("WsmpLayer::EncodeWsaServiceInfo");
+
+        WsmpLayer& wsmpLayer = *txNode.wsmpLayerPtr;
+        vector<size_t> serviceInfoIndexes;
+
+        for(size_t i = 0; (i < wsmpLayer.serviceInfos.size()); i++) {
+            if (wsmpLayer.serviceInfos[i].IsEnabled()) {
+                serviceInfoIndexes.push_back(i);
+            }//if//
+        }//for//
+
+        assert(!serviceInfoIndexes.empty());
+
+        const unsigned int numberOperations = 200000;
+
+        counter.Start();
+        for(unsigned int i = 0; (i < numberOperations); i++) {
+            wsmpLayer.EncodeWsaServiceInfo(wsmpLayer.serviceInfos[serviceInfoIndexes[i % serviceInfoIndexes.size()]]);
+        }//for//
+        counter.Stop(numberOperations);
+
+        counters.push_back(counter);
+    }
+
+    {
+        FunctionCounter counter("WsmpLayer::EncodeWsaChannelAndRoutingInfo");
+
+        const unsigned int numberOperations = 200000;
+
+        counter.Start();
+        for(unsigned int i = 0; (i < numberOperations); i++) {
+            txNode.wsmpLayerPtr->EncodeWsaChannelAndRoutingInfo();
+        }//for//
+        counter.Stop(numberOperations);
+
+        counters.push_back(counter);
+    }
+
+    const Packet& wsaPacket = *capturingMacPacketHandlerPtr->wsaPacketPtr;
+    const GenericMacAddress providerMacAddress = capturingMacPacketHandlerPtr->wsaTransmitterAddress;
+
+    for(int repeatedWsaIsCached = 0; (repeatedWsaIsCached <= 1); repeatedWsaIsCached++) {
+        FunctionCounter counter(
+            repeatedWsaIsCached ? "WsmpLayer::ReceiveWsa (repeated WSA)" : "WsmpLayer::ReceiveWsa (parsed)");
+
+        WsmpLayer& wsmpLayer = *rxNode.wsmpLayerPtr;
+
+        const unsigned int numberBatches = 20;
+        vector<unique_ptr<Packet> > packetPtrs(1000);
+
+        for(unsigned int i = 0; (i < numberBatches); i++) {
+            CopyPackets(wsaPacket, packetPtrs);
+
+            counter.Start();
+            for(size_t j = 0; (j < packetPtrs.size()); j++) {
+                if (!repeatedWsaIsCached) {
+                    wsmpLayer.lastParsedWsaElementsAreValid = false;
+                }//if//
+
+                wsmpLayer.ReceiveWsa(packetPtrs[j], providerMacAddress);
+            }//for//
+            counter.Stop(static_cast<unsigned int>(packetPtrs.size()));
+        }//for//
+
+        counters.push_back(counter);
+    }//for//
+
+    for(unsigned int i = 0; (i < numberNodes); i++) {
+        nodes[i].waveMacPtr->DisconnectFromOtherLayers();
+    }//for//
+
+    std::cout.rdbuf(coutBufferPtr);
+
+    for(size_t i = 0; (i < counters.size()); i++) {
+        counters[i].Output();
+    }//for//
+
+}//RunPerFunctionBenchmarks//
+
+}//namespace//
+
+
+
+int main(int argc, char* argv[])
+{
+    using namespace WaveBench;
+
+    unsigned int numberNodes = 20;
+    double simulatedSecs = 10.0;
+
+    if (argc > 1) {
+        numberNodes = static_cast<unsigned int>(std::atoi(argv[1]));
+    }//if//
+
+    if (argc > 2) {
+        simulatedSecs = std::atof(argv[2]);
+    }//if//
+
+    if ((numberNodes < 2) || (simulatedSecs <= 0.0)) {
+        cerr << "Usage: " << argv[0] << " [number-nodes (>= 2)] [simulated-seconds (> 0)]" << endl;
+        return 1;
+    }//if//
+
+    const SimTime endTime = static_cast<SimTime>(simulatedSecs * SECOND);
+
+    char scratchDirName[] = "/tmp/wave_hotpath_bench_XXXXXX";
+
+    if ((mkdtemp(scratchDirName) == nullptr) || (chdir(scratchDirName) != 0)) {
+        cerr << "Error: Could not create scratch directory " << scratchDirName << "." << endl;
+        return 1;
+    }//if//
+
+    std::printf("scratch-dir=%s\n", scratchDirName);
+
+    RunPerFunctionBenchmarks();
+
+    const ScenarioConfig scenarios[] = {
+        { "bsm-100ms", (100 * ScenSim::MILLI_SECOND), 200, true, false, false, false },
+        { "bsm-20ms", (20 * ScenSim::MILLI_SECOND), 200, true, false, false, false },
+        { "bsm-20ms-clock", (20 * ScenSim::MILLI_SECOND), 200, true, false, true, false },
+        { "bsm-20ms-1400B", (20 * ScenSim::MILLI_SECOND), 1400, true, false, false, false },
+        { "bsm-20ms-1400B-restart", (20 * ScenSim::MILLI_SECOND), 1400, true, false, false, true },
+        { "wsa", (100 * ScenSim::MILLI_SECOND), 200, false, true, false, false },
+    };
+
+    for(size_t i = 0; (i < (sizeof(scenarios) / sizeof(scenarios[0]))); i++) {
+        RunScenario(scenarios[i], numberNodes, endTime);
+    }//for//
+
+    return 0;
+
+}//main//
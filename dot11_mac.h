@@ -48,8 +48,13 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace Dot11 {
 
 using std::queue;
@@ -94,6 +99,22 @@ using ScenSim::SimpleMacPacketHandler;
 //--------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------
 
+inline
+unsigned int LowestSetBitPosition(const unsigned int bitMask)
+{
+    assert(bitMask != 0);
+
+#if defined(_MSC_VER)
+    unsigned long position;
+    _BitScanForward(&position, bitMask);
+    return (static_cast<unsigned int>(position));
+#else
+    return (static_cast<unsigned int>(__builtin_ctz(bitMask)));
+#endif
+
+}//LowestSetBitPosition//
+
+
 inline
 void AddMpduDelimiterAndPaddingToFrame(Packet& aFrame)
 {
@@ -166,6 +187,63 @@ private:
 //--------------------------------------------------------------------------------------------------
 
 
+// Per access category "<prefix>edca-category-<i>-*" parameter names are built once
+// and shared by all MACs (instead of per node with ostringstream).
+
+struct EdcaCategoryParameterNames {
+    string prefix;
+    string numAifsSlots;
+    string contentionWindowMinSlots;
+    string contentionWindowMaxSlots;
+    string priorityList;
+    string frameLifetime;
+    string contentionWindowController;
+    string contentionWindowControllerLowBusyRatio;
+    string contentionWindowControllerHighBusyRatio;
+    string downlinkTxopDuration;
+};
+
+const unsigned int MaxNumberAccessCategories = 4;
+
+inline
+vector<EdcaCategoryParameterNames> MakeEdcaCategoryParameterNames()
+{
+    vector<EdcaCategoryParameterNames> parameterNames(MaxNumberAccessCategories);
+
+    for(unsigned int i = 0; (i < parameterNames.size()); i++) {
+        ostringstream prefixStream;
+        prefixStream << parameterNamePrefix << "edca-category-" << i << '-';
+
+        EdcaCategoryParameterNames& names = parameterNames[i];
+
+        names.prefix = prefixStream.str();
+        names.numAifsSlots = names.prefix + "num-aifs-slots";
+        names.contentionWindowMinSlots = names.prefix + "contention-window-min-slots";
+        names.contentionWindowMaxSlots = names.prefix + "contention-window-max-slots";
+        names.priorityList = names.prefix + "priority-list";
+        names.frameLifetime = names.prefix + "frame-lifetime";
+        names.contentionWindowController = names.prefix + "contention-window-controller";
+        names.contentionWindowControllerLowBusyRatio = names.prefix + "contention-window-controller-low-busy-ratio";
+        names.contentionWindowControllerHighBusyRatio = names.prefix + "contention-window-controller-high-busy-ratio";
+        names.downlinkTxopDuration = names.prefix + "downlink-txop-duration";
+    }//for//
+
+    return (parameterNames);
+
+}//MakeEdcaCategoryParameterNames//
+
+
+inline
+const EdcaCategoryParameterNames& GetEdcaCategoryParameterNames(const size_t accessCategoryIndex)
+{
+    static const vector<EdcaCategoryParameterNames> parameterNames = MakeEdcaCategoryParameterNames();
+
+    return (parameterNames.at(accessCategoryIndex));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
 class Dot11MacAccessPointScheduler {
 public:
     virtual ~Dot11MacAccessPointScheduler() { }
@@ -234,9 +312,7 @@ FixedTxopScheduler::FixedTxopScheduler(
     txopDurations.resize(numberAccessCategories, ZERO_TIME);
 
     for(size_t i = 0; (i < txopDurations.size()); i++) {
-        ostringstream nameStream;
-        nameStream << parameterNamePrefix << "edca-category-" << i << "-downlink-txop-duration";
-        const string parmName = nameStream.str();
+        const string& parmName = GetEdcaCategoryParameterNames(i).downlinkTxopDuration;
 
         //objtypeに"edca-category-0-downlink-txop-duration"というように書いていく？？
         //これはdot11限定機能っぽい？
@@ -266,1395 +342,2328 @@ public:
 
     CongestionMonitoringHandler() {}
 
+    virtual ~CongestionMonitoringHandler() {}
+
     virtual void ScanAReceivedFrame(
         const Packet& aFrame,
         const SimTime& scannedTime) = 0;
 
-private:
+    // Physical carrier sense transitions (default: ignored).
 
+    virtual void ChannelBecameBusy(const SimTime& /*busyTime*/) {}
+    virtual void ChannelBecameClear(const SimTime& /*clearTime*/) {}
 
+private:
 
-};//CongestionMonitoringHandler//
 
 
-//-------------------------------------------------------------------------------------------------
-//--------------------------------------------------------------------------------------------------
+};//CongestionMonitoringHandler//
 
-enum Dot11MacOperationMode {
-    AdhocMode,
-    ApMode,
-    InfrastructureMode
-};
 
 //--------------------------------------------------------------------------------------------------
-//--------------------------------------------------------------------------------------------------
-//--------------------------------------------------------------------------------------------------
 
+// Sliding window channel busy ratio (CBR) and received frame rate. The window is a ring
+// of fixed duration bins, so each event only touches the current bin (amortized O(1)).
 
-class Dot11Mac : public MacLayer,
-    public enable_shared_from_this<Dot11Mac> {
+class ChannelBusyRatioEstimator : public CongestionMonitoringHandler {
 public:
-    static const string modelName;
 
-    static const unsigned char AdhocModeAddressSelectorByte = UCHAR_MAX;
+    ChannelBusyRatioEstimator(
+        const SimTime& initWindowDuration,
+        const unsigned int initNumberBins);
 
-    static const SimTime maxTransmitOpportunityAkaTxopDuration = 8160 * MICRO_SECOND;
+    void ScanAReceivedFrame(
+        const Packet& aFrame,
+        const SimTime& scannedTime) override;
 
-    static const unsigned int transmitOpportunityNumberPacketNoLimitValue = 0;
+    void ChannelBecameBusy(const SimTime& busyTime) override;
+    void ChannelBecameClear(const SimTime& clearTime) override;
 
-    typedef Dot11Phy::PropFrame PropFrame;
+    double GetChannelBusyRatio(const SimTime& currentTime);
+    double GetFrameRatePerSecond(const SimTime& currentTime);
 
-    static shared_ptr<Dot11Mac> Create(
-        const ParameterDatabaseReader& theParameterDatabaseReader,
-        const shared_ptr<SimulationEngineInterface>& simulationEngineInterfacePtr,
-        const NodeId& theNodeId,
-        const InterfaceId& theInterfaceId,
-        const unsigned int interfaceIndex,
-        const shared_ptr<NetworkLayer>& networkLayerPtr,
-        const shared_ptr<Dot11Phy>& physicalLayerPtr,
-        const RandomNumberGeneratorSeed& nodeSeed)
-    {
-        shared_ptr<Dot11Mac> macPtr(
-            new Dot11Mac(
-                theParameterDatabaseReader,
-                simulationEngineInterfacePtr,
-                theNodeId,
-                theInterfaceId,
-                interfaceIndex,
-                networkLayerPtr,
-                physicalLayerPtr,
-                nodeSeed));
+private:
 
-        macPtr->CompleteInitialization(theParameterDatabaseReader, nodeSeed);
-        return (macPtr);
+    struct BinInfo {
+        SimTime busyDuration;
+        unsigned int numberFrames;
 
-    }//Create//
+        BinInfo() : busyDuration(ZERO_TIME), numberFrames(0) {}
+    };
 
+    SimTime binDuration;
+    vector<BinInfo> bins;
 
-    ~Dot11Mac();
+    long long int currentBinNumber;
 
-    void SetMacPacketHandler(
-        const EtherTypeField& etherType,
-        const shared_ptr<SimpleMacPacketHandler>& initMacPacketHandlerPtr) {
-        macPacketHandlerPtrs[etherType] = initMacPacketHandlerPtr;
-    }
+    // Sums over all bins (excluding the not yet accounted current busy period).
 
-    void SetNetworkOutputQueue(
-        const shared_ptr<ItsOutputQueueWithPrioritySubqueues> initNetworkOutputQueuePtr) {
-        networkOutputQueuePtr = initNetworkOutputQueuePtr;
-    }
+    SimTime windowBusyDuration;
+    unsigned int windowNumberFrames;
 
-    void SetEdcaParameter(
-        const size_t accessCategoryIndex,
-        const bool admissionControlIsEnabled,
-        const int arbitrationInterframeSpaceNumber,
-        const int contentionWindowMin,
-        const int contentionWindowMax,
-        const SimTime& txopDuration);
+    bool channelIsBusy;
+    SimTime busyPeriodAccountedUntilTime;
 
-    void SetCustomAdaptiveRateController(
-        const shared_ptr<Dot11::AdaptiveRateController>& rateControllerPtr)
-    {
-        this->theAdaptiveRateControllerPtr = rateControllerPtr;
-    }
+    void AdvanceToTime(const SimTime& currentTime);
+    SimTime CalcWindowElapsedDuration(const SimTime& currentTime) const;
 
-    void SetCongestionMonitoringHandler(
-        const shared_ptr<CongestionMonitoringHandler>& initCongestionMonitoringHandlerPtr)
-    {
-        this->congestionMonitoringHandlerPtr = initCongestionMonitoringHandlerPtr;
-    }
+};//ChannelBusyRatioEstimator//
 
-    PacketPriority GetMaxPacketPriority() const { return maxPacketPriority; }
 
-    shared_ptr<MacAndPhyInfoInterface> GetMacAndPhyInfoInterface() const
-        { return physicalLayerPtr->GetDot11InfoInterface(); }
+inline
+ChannelBusyRatioEstimator::ChannelBusyRatioEstimator(
+    const SimTime& initWindowDuration,
+    const unsigned int initNumberBins)
+    :
+    binDuration(initWindowDuration / initNumberBins),
+    bins(initNumberBins),
+    currentBinNumber(0),
+    windowBusyDuration(ZERO_TIME),
+    windowNumberFrames(0),
+    channelIsBusy(false),
+    busyPeriodAccountedUntilTime(ZERO_TIME)
+{
+    assert(initNumberBins > 0);
+    assert(binDuration > ZERO_TIME);
+}
 
-    shared_ptr<Dot11MacInterfaceForPhy> CreateInterfaceForPhy() {
-        return shared_ptr<InterfaceForPhy>(new InterfaceForPhy(this));
-    }
 
-    // Network Layer Interface:
+inline
+void ChannelBusyRatioEstimator::AdvanceToTime(const SimTime& currentTime)
+{
+    const long long int newBinNumber = (currentTime / binDuration);
 
-    virtual void NetworkLayerQueueChangeNotification() override;
+    if (newBinNumber <= currentBinNumber) {
+        return;
+    }//if//
 
-    virtual void DisconnectFromOtherLayers() override {
-        physicalLayerPtr.reset();
-        networkLayerPtr.reset();
-        apControllerPtr.reset();
-        staControllerPtr.reset();
-        macPacketHandlerPtrs.clear();
-    }
+    if ((newBinNumber - currentBinNumber) > static_cast<long long int>(bins.size())) {
 
-    virtual GenericMacAddress GetGenericMacAddress() const override {
-        return (myMacAddress.ConvertToGenericMacAddress());
-    }
+        // Whole window has elapsed since the last event.
 
-    void SuspendTransmissionFunction();
-    void ResumeTransmissionFunction(const SimTime& initTransmissionPermissionEndTime);
+        windowBusyDuration = ZERO_TIME;
+        windowNumberFrames = 0;
 
-    MacAddress GetMacAddress() const { return (myMacAddress); }
+        for(unsigned int i = 0; (i < bins.size()); i++) {
+            bins[i] = BinInfo();
 
-    Dot11MacOperationMode GetOperationMode() const;
+            if (channelIsBusy) {
+                bins[i].busyDuration = binDuration;
+                windowBusyDuration += binDuration;
+            }//if//
+        }//for//
 
-    bool GetIpMulticastAddressToMacAddressMappingIsEnabled() const
-        { return (ipMulticastAddressToMacAddressMappingIsEnabled); }
+        currentBinNumber = newBinNumber;
 
-    void SendManagementFrame(unique_ptr<Packet>& framePtr);
+        BinInfo& currentBin = bins[currentBinNumber % bins.size()];
 
-    unsigned int GetNumberOfChannels() const { return (physicalLayerPtr->GetChannelCount()); }
-    unsigned int GetCurrentChannelId() const { return (physicalLayerPtr->GetCurrentChannelNumber()); }
+        windowBusyDuration -= currentBin.busyDuration;
+        currentBin.busyDuration = ZERO_TIME;
 
-    const vector<unsigned int>& GetCurrentBondedChannelList()
-    {
-        return (physicalLayerPtr->GetCurrentBondedChannelList());
-    }
+        busyPeriodAccountedUntilTime = (currentBinNumber * binDuration);
+        return;
+    }//if//
 
-    double GetRssiOfLastFrameDbm() const { return (physicalLayerPtr->GetRssiOfLastFrameDbm()); }
+    while (currentBinNumber < newBinNumber) {
+        const SimTime binEndTime = ((currentBinNumber + 1) * binDuration);
 
-    void SendAssociationRequest(const MacAddress& apAddress);
+        if (channelIsBusy) {
+            const SimTime busyDuration = (binEndTime - busyPeriodAccountedUntilTime);
 
-    void SendReassociationRequest(
-        const MacAddress& apAddress,
-        const MacAddress& currentApAddress);
+            bins[currentBinNumber % bins.size()].busyDuration += busyDuration;
+            windowBusyDuration += busyDuration;
+            busyPeriodAccountedUntilTime = binEndTime;
+        }//if//
 
-    void SendAssociationResponse(
-        const MacAddress& staAddress,
-        const AssociationId& theAssociationId);
+        currentBinNumber++;
 
-    void SendReassociationResponse(
-        const MacAddress& staAddress,
-        const AssociationId& theAssociationId);
+        BinInfo& expiredBin = bins[currentBinNumber % bins.size()];
 
-    void SendDisassociation(const MacAddress& receiverAddress);
+        windowBusyDuration -= expiredBin.busyDuration;
+        windowNumberFrames -= expiredBin.numberFrames;
+        expiredBin = BinInfo();
+    }//while//
 
-    void StopReceivingFrames() { physicalLayerPtr->StopReceivingFrames(); }
-    void StartReceivingFrames() { physicalLayerPtr->StartReceivingFrames(); }
-    bool IsNotReceivingFrames() const { return (physicalLayerPtr->IsNotReceivingFrames()); }
+}//AdvanceToTime//
 
-    void SendAuthentication(const MacAddress& receiverAddress);
 
-    void SendPowerSaveNullFrame(
-        const MacAddress& receiverAddress,
-        const bool goingToPowerManagementMode);
+inline
+SimTime ChannelBusyRatioEstimator::CalcWindowElapsedDuration(const SimTime& currentTime) const
+{
+    const SimTime windowDuration =
+        ((static_cast<long long int>(bins.size()) - 1) * binDuration) +
+        (currentTime - (currentBinNumber * binDuration));
 
-    void SwitchToChannel(const unsigned int channelNumber);
-    void SwitchToChannels(const vector<unsigned int>& channels);
+    return (std::min(windowDuration, currentTime));
+}
 
-    // For 802.11AC primary secondary channel scheme.
 
-    unsigned int GetFirstChannelNumberForChannelBandwidth(
-        const unsigned int signalChannelBandwidthMhz) const;
+inline
+void ChannelBusyRatioEstimator::ScanAReceivedFrame(
+    const Packet& /*aFrame*/,
+    const SimTime& scannedTime)
+{
+    (*this).AdvanceToTime(scannedTime);
 
-    void RequeueBufferedPackets();
+    bins[currentBinNumber % bins.size()].numberFrames++;
+    windowNumberFrames++;
+}
 
-    void RequeueBufferedPacket(
-        unique_ptr<Packet>& packetPtr,
-        const NetworkAddress& nextHopAddress,
-        const PacketPriority priority,
-        const EtherTypeField etherType,
-        const SimTime& timestamp,
-        const unsigned int retryTxCount,
-        const bool datarateAndTxPowerAreaSpecified,
-        const DatarateBitsPerSec& theDatarateBitsPerSec,
-        const double& txPowerDbm);
 
-    void RequeueManagementFrame(unique_ptr<Packet>& framePtr);
+inline
+void ChannelBusyRatioEstimator::ChannelBecameBusy(const SimTime& busyTime)
+{
+    (*this).AdvanceToTime(busyTime);
 
-    // For other Mac Layer subsystems:
+    if (!channelIsBusy) {
+        channelIsBusy = true;
+        busyPeriodAccountedUntilTime = busyTime;
+    }//if//
+}
 
-    void SendLinkIsUpNotificationToNetworkLayer()
-        { networkLayerPtr->ProcessLinkIsUpNotification(interfaceIndex); }
 
-    void SendLinkIsDownNotificationToNetworkLayer()
-        { networkLayerPtr->ProcessLinkIsDownNotification(interfaceIndex); }
+inline
+void ChannelBusyRatioEstimator::ChannelBecameClear(const SimTime& clearTime)
+{
+    (*this).AdvanceToTime(clearTime);
 
-    void SendNewLinkToANodeNotificationToNetworkLayer(const MacAddress& macAddress) {
-        networkLayerPtr->ProcessNewLinkToANodeNotification(
-            interfaceIndex, macAddress.ConvertToGenericMacAddress());
-    }
+    if (channelIsBusy) {
+        const SimTime busyDuration = (clearTime - busyPeriodAccountedUntilTime);
 
-    void LookupMacAddressForNeighbor(const NodeId targetNodeId, bool& wasFound, MacAddress& macAddress);
+        bins[currentBinNumber % bins.size()].busyDuration += busyDuration;
+        windowBusyDuration += busyDuration;
 
-    bool MpduFrameAggregationIsEnabled() const { return (maxAggregateMpduSizeBytes > 0); }
+        channelIsBusy = false;
+    }//if//
+}
 
-    void SetMpduFrameAggregationIsEnabledFor(const MacAddress& destinationAddress);
 
-private:
+inline
+double ChannelBusyRatioEstimator::GetChannelBusyRatio(const SimTime& currentTime)
+{
+    (*this).AdvanceToTime(currentTime);
 
-    Dot11Mac(
-        const ParameterDatabaseReader& theParameterDatabaseReader,
-        const shared_ptr<SimulationEngineInterface>& simulationEngineInterfacePtr,
-        const NodeId& theNodeId,
-        const InterfaceId& theInterfaceId,
-        const unsigned int interfaceIndex,
-        const shared_ptr<NetworkLayer>& networkLayerPtr,
-        const shared_ptr<Dot11Phy>& physicalLayerPtr,
-        const RandomNumberGeneratorSeed& nodeSeed);
+    const SimTime elapsedDuration = (*this).CalcWindowElapsedDuration(currentTime);
 
-    void CompleteInitialization(
-        const ParameterDatabaseReader& theParameterDatabaseReader,
-        const RandomNumberGeneratorSeed& nodeSeed);
+    if (elapsedDuration <= ZERO_TIME) {
+        return 0.0;
+    }//if//
 
-    shared_ptr<SimulationEngineInterface> simEngineInterfacePtr;
-    NodeId theNodeId;
-    InterfaceId theInterfaceId;
+    SimTime busyDuration = windowBusyDuration;
 
-    Dot11MacOperationMode operationMode;
+    if (channelIsBusy) {
+        busyDuration += (currentTime - busyPeriodAccountedUntilTime);
+    }//if//
 
-    // Note only one "Management Controller" exists at one time
-    shared_ptr<Dot11ApManagementController> apControllerPtr;
-    shared_ptr<Dot11StaManagementController> staControllerPtr;
+    return (std::min(1.0, (static_cast<double>(busyDuration) / elapsedDuration)));
 
-    shared_ptr<NetworkLayer> networkLayerPtr;
-    map<EtherTypeField, shared_ptr<SimpleMacPacketHandler> > macPacketHandlerPtrs;
+}//GetChannelBusyRatio//
 
-    unsigned int interfaceIndex;
-    MacAddress myMacAddress;
 
-    bool ipMulticastAddressToMacAddressMappingIsEnabled;
-    std::set<MacAddress> myMulticastMacAddresses;
+inline
+double ChannelBusyRatioEstimator::GetFrameRatePerSecond(const SimTime& currentTime)
+{
+    (*this).AdvanceToTime(currentTime);
 
-    shared_ptr<ItsOutputQueueWithPrioritySubqueues> networkOutputQueuePtr;
+    const SimTime elapsedDuration = (*this).CalcWindowElapsedDuration(currentTime);
 
-    bool refreshNextHopOnDequeueModeIsOn;
+    if (elapsedDuration <= ZERO_TIME) {
+        return 0.0;
+    }//if//
 
-    deque<unique_ptr<Packet> > managementFrameQueue;
+    return (windowNumberFrames / ConvertTimeToDoubleSecs(elapsedDuration));
 
-    IncomingFrameBuffer theIncomingFrameBuffer;
+}//GetFrameRatePerSecond//
 
-    shared_ptr<AdaptiveRateController> theAdaptiveRateControllerPtr;
-    shared_ptr<AdaptiveTxPowerController> theAdaptiveTxPowerControllerPtr;
 
-    shared_ptr<Dot11Phy> physicalLayerPtr;
+//--------------------------------------------------------------------------------------------------
 
-    unique_ptr<MacAddressResolver<MacAddress> > theMacAddressResolverPtr;
+// Decides an access category's contention window (CW) after each EDCA outcome.
+// CW values are in slots and are expected to be of the form (2^n - 1).
 
-    shared_ptr<CongestionMonitoringHandler> congestionMonitoringHandlerPtr;
+enum ContentionWindowEventType {
+    ContentionWindowTransmissionSucceeded,
+    ContentionWindowTransmissionFailed,
+    ContentionWindowInternalCollision,
+    ContentionWindowPacketDropped
+};
 
-    unique_ptr<Dot11MacAccessPointScheduler> macSchedulerPtr;
 
-    //-----------------------------------------------------
+class ContentionWindowController {
+public:
 
-    // Acronyms: AIFS,DIFS,EIFS,SIFS: {Arbitration, Distributed, Extended, Short} InterFrame Space
+    virtual ~ContentionWindowController() {}
 
-    // EDCA = "Enhanced Distributed Channel Access" for QoS (added in 802.11e)
-    // DCF = "Distributed Coordination Function" (802.11 classic access protocol).
+    virtual unsigned int CalcNextContentionWindowSlots(
+        const ContentionWindowEventType& contentionWindowEvent,
+        const unsigned int currentContentionWindowSlots,
+        const unsigned int minContentionWindowSlots,
+        const unsigned int maxContentionWindowSlots,
+        const double channelBusyRatio) const = 0;
 
-    // Mac Non-EDCA specific parameters:
+    virtual bool UsesChannelBusyRatio() const { return false; }
 
-    unsigned int rtsThresholdSizeBytes;
+};//ContentionWindowController//
 
-    unsigned int shortFrameRetryLimit;
-    unsigned int longFrameRetryLimit;
 
-    // "Short Interframe Space" = SIFS
+// Standard 802.11 binary exponential backoff.
 
-    SimTime aShortInterframeSpaceTime;
-    SimTime aSlotTime;
+class BinaryExponentialContentionWindowController : public ContentionWindowController {
+public:
 
-    // Cannot detect an incoming signal while switching to transmission mode.
+    unsigned int CalcNextContentionWindowSlots(
+        const ContentionWindowEventType& contentionWindowEvent,
+        const unsigned int currentContentionWindowSlots,
+        const unsigned int minContentionWindowSlots,
+        const unsigned int maxContentionWindowSlots,
+        const double /*channelBusyRatio*/) const override
+    {
+        if ((contentionWindowEvent == ContentionWindowTransmissionSucceeded) ||
+            (contentionWindowEvent == ContentionWindowPacketDropped)) {
 
-    SimTime aRxTxTurnaroundTime;
+            return (minContentionWindowSlots);
+        }//if//
 
-    // Extra interframe delay is added if last frame was corrupted (and thus virtual carrier sense
-    // is disabled).
+        // Double contention window up to the maximum size.
+        // (Actual sequence is CW(n) = (2^n - 1) ) {1,3,7,15,31,63,...}
 
-    SimTime additionalDelayForExtendedInterframeSpaceMode;
+        return (std::min(((currentContentionWindowSlots * 2) + 1), maxContentionWindowSlots));
+    }
 
-    SimTime clearToSendTimeoutDuration;
-    SimTime ackTimeoutDuration;
+};//BinaryExponentialContentionWindowController//
 
-    int contentionWindowSlotsMin;
-    int contentionWindowSlotsMax;
 
-    enum AckDatarateSelectionType {
-        SameAsData,
-        Lowest
-    };
+// Density adaptive: the CW floor grows (in 2^n - 1 steps) from CWmin to CWmax as the channel
+// busy ratio goes from lowBusyRatio to highBusyRatio. Also adapts for broadcast (no ACK) traffic.
 
-    // To make this (counter-intuitive) behavior explicit.
+class ChannelBusyRatioContentionWindowController : public ContentionWindowController {
+public:
 
-    bool allowFrameAggregationWithTxopZero;
+    ChannelBusyRatioContentionWindowController(
+        const double initLowBusyRatio,
+        const double initHighBusyRatio)
+        :
+        lowBusyRatio(initLowBusyRatio),
+        highBusyRatio(initHighBusyRatio)
+    {
+        assert(lowBusyRatio < highBusyRatio);
+    }
 
-    bool protectAggregateFramesWithSingleAckedFrame;
+    unsigned int CalcNextContentionWindowSlots(
+        const ContentionWindowEventType& contentionWindowEvent,
+        const unsigned int currentContentionWindowSlots,
+        const unsigned int minContentionWindowSlots,
+        const unsigned int maxContentionWindowSlots,
+        const double channelBusyRatio) const override
+    {
+        const double fraction =
+            std::max(0.0, std::min(1.0, ((channelBusyRatio - lowBusyRatio) / (highBusyRatio - lowBusyRatio))));
 
-    unsigned int maxAggregateMpduSizeBytes;
+        const unsigned int targetSlots =
+            static_cast<unsigned int>(
+                minContentionWindowSlots + (fraction * (maxContentionWindowSlots - minContentionWindowSlots)));
 
-    AckDatarateSelectionType ackDatarateSelection;
+        unsigned int floorSlots = minContentionWindowSlots;
+        while (floorSlots < targetSlots) {
+            floorSlots = std::min(((floorSlots * 2) + 1), maxContentionWindowSlots);
+        }//while//
 
-    RandomNumberGenerator aRandomNumberGenerator;
+        if ((contentionWindowEvent == ContentionWindowTransmissionSucceeded) ||
+            (contentionWindowEvent == ContentionWindowPacketDropped)) {
 
-    enum MacStateType {
-        IdleState,
-        BusyMediumState,
-        CtsOrAckTransmissionState,
-        WaitingForNavExpirationState,
-        WaitingForIfsAndBackoffState,
-        WaitingForCtsState,
-        WaitingForAckState,
-        ChangingChannelsState,
-        TransientState,
-    };
+            return (floorSlots);
+        }//if//
 
-    MacStateType macState;
+        return (
+            std::max(
+                floorSlots,
+                std::min(((currentContentionWindowSlots * 2) + 1), maxContentionWindowSlots)));
+    }
 
-    enum class SentFrameType {
-        ShortFrame,
-        RequestToSendFrame,
-        LongFrame,
-        AggregateFrame,
-        BlockAckRequestFrame,
-        PowerSavePollResponse,
-    };
+    bool UsesChannelBusyRatio() const override { return true; }
 
-    SentFrameType lastSentFrameWasAn;
+private:
 
-    MacAddress lastSentDataFrameDestinationMacAddress;
+    double lowBusyRatio;
+    double highBusyRatio;
 
-    unsigned int powerSavePollResponsePacketTxCount;
+};//ChannelBusyRatioContentionWindowController//
 
-    SimTime mediumReservedUntilTimeAkaNAV;
 
-    bool lastFrameReceivedWasCorrupt;
+//-------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
 
-    SimTime transmissionPermissionEndTime; // for receiving only mode
+// Block of pre-generated uniform variates for backoff slot draws. Refilled by
+// numberLanes independent xorshift128+ streams kept as structure of arrays so the
+// refill loop can be vectorized by the compiler. Deterministic for a given seed.
 
-    // Used by block ack processing.
+class BackoffRandomNumberPool {
+public:
 
-    MacAddress currentIncomingAggregateFramesSourceMacAddress;
-    PacketPriority currentIncomingAggregateFramesTrafficId;
-    unsigned int numSubframesReceivedFromCurrentAggregateFrame;
+    explicit BackoffRandomNumberPool(const RandomNumberGeneratorSeed& seed);
 
-    //-----------------------------------------------------
+    // Uniform integer in [0, maxValue] (multiply-shift scaling).
 
-    struct EdcaAccessCategoryInfo {
-        // Parameters
-        vector<PacketPriority> listOfPriorities;
-        unsigned int minContentionWindowSlots;
-        unsigned int maxContentionWindowSlots;
-        unsigned int arbitrationInterframeSpaceDurationSlots;
-        SimTime transmitOpportunityDurationAkaTxop;
-        SimTime frameLifetime;//dot11EDCATableMSDULifetime//
+    unsigned int GenerateRandomInt(const unsigned int maxValue)
+    {
+        if (nextIndex == poolSize) {
+            (*this).Refill();
+        }//if//
 
-        // State variables
-        unsigned int currentContentionWindowSlots;
-        unsigned int currentNumOfBackoffSlots;
+        const uint64_t variate = pool[nextIndex];
+        nextIndex++;
 
-        // Calculated backoff duration without dynamically added Extended Interframe space.
-        SimTime currentNonExtendedBackoffDuration;
+        return (static_cast<unsigned int>((variate * (static_cast<uint64_t>(maxValue) + 1)) >> 32));
+    }
 
-        bool tryingToJumpOnMediumWithoutABackoff;
-        bool hasPacketToSend;
+private:
 
-        unsigned int currentShortFrameRetryCount;
-        unsigned int currentLongFrameRetryCount;
-        unsigned int currentAggregateFrameRetryCount;
+    static const unsigned int numberLanes = 8;
+    static const unsigned int poolSize = 256;
 
-        SimTime ifsAndBackoffStartTime;
+    uint64_t laneStates0[numberLanes];
+    uint64_t laneStates1[numberLanes];
 
-        // currentPacketPtr (non-aggregate) sent before aggregate frame.
+    uint32_t pool[poolSize];
+    unsigned int nextIndex;
 
-        unique_ptr<Packet> currentPacketPtr;
-        unique_ptr<vector<unique_ptr<Packet> > > currentAggregateFramePtr;
-        bool currentAggregateFrameIsAMpduAggregate;
+    void Refill();
 
-        bool currentPacketIsAManagementFrame;
-        NetworkAddress currentPacketsNextHopNetworkAddress;
-        MacAddress currentPacketsDestinationMacAddress;
-        unsigned short int currentPacketSequenceNumber;
-        PacketPriority currentPacketPriorityAkaTrafficId;
-        EtherTypeField currentPacketsEtherType;
-        SimTime currentPacketsTimestamp;
+};//BackoffRandomNumberPool//
 
-        SimTime timeLeftInCurrentTransmitOpportunity;
 
-        bool currentPacketDatarateAndTxPowerAreSpecified;
-        DatarateBitsPerSec specifiedPacketDatarateBitsPerSec;
-        double specifiedPacketTxPowerDbm;
+inline
+BackoffRandomNumberPool::BackoffRandomNumberPool(const RandomNumberGeneratorSeed& seed)
+    :
+    nextIndex(poolSize)
+{
+    // SplitMix64 expansion of the seed into non-zero lane states.
 
-        EdcaAccessCategoryInfo()
-            :
-            currentNumOfBackoffSlots(0),
-            currentNonExtendedBackoffDuration(INFINITE_TIME),
-            currentShortFrameRetryCount(0),
-            currentLongFrameRetryCount(0),
-            currentAggregateFrameRetryCount(0),
-            currentPacketsTimestamp(ZERO_TIME),
-            hasPacketToSend(false),
-            currentPacketSequenceNumber(0),
-            currentPacketPriorityAkaTrafficId(0),
-            currentPacketsEtherType(ETHERTYPE_IS_NOT_SPECIFIED),
-            tryingToJumpOnMediumWithoutABackoff(false),
-            frameLifetime(INFINITE_TIME),
-            transmitOpportunityDurationAkaTxop(ZERO_TIME),
-            timeLeftInCurrentTransmitOpportunity(ZERO_TIME),
-            currentPacketIsAManagementFrame(false),
-            ifsAndBackoffStartTime(INFINITE_TIME),
-            currentAggregateFrameIsAMpduAggregate(true),
-            currentPacketDatarateAndTxPowerAreSpecified(false),
-            specifiedPacketDatarateBitsPerSec(0),
-            specifiedPacketTxPowerDbm(0.0)
-        {}
+    uint64_t splitMixState = static_cast<uint64_t>(seed);
 
-        void operator=(EdcaAccessCategoryInfo&& right)
-        {
-            assert(this != &right);
+    for(unsigned int i = 0; (i < numberLanes); i++) {
+        for(unsigned int j = 0; (j < 2); j++) {
+            splitMixState += 0x9E3779B97F4A7C15ULL;
 
-            listOfPriorities = right.listOfPriorities;
-            minContentionWindowSlots = right.minContentionWindowSlots;
-            maxContentionWindowSlots = right.maxContentionWindowSlots;
-            arbitrationInterframeSpaceDurationSlots = right.arbitrationInterframeSpaceDurationSlots;
-            transmitOpportunityDurationAkaTxop = right.transmitOpportunityDurationAkaTxop;
-            frameLifetime = right.frameLifetime;
-            currentContentionWindowSlots = right.currentContentionWindowSlots;
-            currentNumOfBackoffSlots = right.currentNumOfBackoffSlots;
-            currentNonExtendedBackoffDuration = right.currentNonExtendedBackoffDuration;
-            tryingToJumpOnMediumWithoutABackoff = right.tryingToJumpOnMediumWithoutABackoff;
-            hasPacketToSend = right.hasPacketToSend;
-            currentShortFrameRetryCount = right.currentShortFrameRetryCount;
-            currentLongFrameRetryCount = right.currentLongFrameRetryCount;
-            currentAggregateFrameRetryCount = right.currentAggregateFrameRetryCount;
-            ifsAndBackoffStartTime = right.ifsAndBackoffStartTime;
-            currentPacketPtr = move(right.currentPacketPtr);
-            currentAggregateFramePtr = move(right.currentAggregateFramePtr);
-            currentAggregateFrameIsAMpduAggregate = right.currentAggregateFrameIsAMpduAggregate;
-            currentPacketIsAManagementFrame = right.currentPacketIsAManagementFrame;
-            currentPacketsNextHopNetworkAddress = right.currentPacketsNextHopNetworkAddress;
-            currentPacketsDestinationMacAddress = right.currentPacketsDestinationMacAddress;
-            currentPacketSequenceNumber = right.currentPacketSequenceNumber;
-            currentPacketPriorityAkaTrafficId = right.currentPacketPriorityAkaTrafficId;
-            currentPacketsEtherType = right.currentPacketsEtherType;
-            currentPacketsTimestamp = right.currentPacketsTimestamp;
-            currentPacketDatarateAndTxPowerAreSpecified = right.currentPacketDatarateAndTxPowerAreSpecified;
-            specifiedPacketDatarateBitsPerSec = right.specifiedPacketDatarateBitsPerSec;
-            specifiedPacketTxPowerDbm = right.specifiedPacketTxPowerDbm;
-        }//=//
+            uint64_t z = splitMixState;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z = z ^ (z >> 31);
 
-        EdcaAccessCategoryInfo(EdcaAccessCategoryInfo&& right) { (*this) = move(right); }
+            if (j == 0) {
+                laneStates0[i] = z;
+            }
+            else {
+                laneStates1[i] = (z | 1);
+            }//if//
+        }//for//
+    }//for//
+}
 
-    };//EdcaAccessCatagoryInfo//
 
+inline
+void BackoffRandomNumberPool::Refill()
+{
+    for(unsigned int i = 0; (i < poolSize); i += numberLanes) {
+        for(unsigned int lane = 0; (lane < numberLanes); lane++) {
+            uint64_t s1 = laneStates0[lane];
+            const uint64_t s0 = laneStates1[lane];
 
-    //-----------------------------------------------------
+            laneStates0[lane] = s0;
+            s1 ^= (s1 << 23);
+            laneStates1[lane] = (s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26));
 
-    PacketPriority maxPacketPriority;
+            pool[i + lane] = static_cast<uint32_t>((laneStates1[lane] + s0) >> 32);
+        }//for//
+    }//for//
 
-    vector<EdcaAccessCategoryInfo> accessCategories;
+    nextIndex = 0;
 
-    unsigned int numberAccessCategories;
+}//Refill//
 
-    unsigned int accessCategoryIndexForLastSentFrame;
 
-    unsigned int accessCategoryIndexForManagementFrames;
+//-------------------------------------------------------------------------------------------------
 
-    SimTime currentTransmitOpportunityAkaTxopStartTime;
-    SimTime currentTransmitOpportunityAkaTxopEndTime;
+// Restricts MAC trace output to selected nodes, access categories and a time window.
+// Parameters are parsed once at startup so each trace point is only a few comparisons
+// (before any trace record or string is built).
 
-    unsigned int currentTransmitOpportunityAckedFrameCount;
+class MacTraceFilter {
+public:
 
-    vector<unsigned int> switchingToThisChannelList;
+    MacTraceFilter()
+        :
+        nodeIsSelected(true),
+        startTime(ZERO_TIME),
+        endTime(INFINITE_TIME),
+        accessCategoryBitMask(UINT_MAX)
+    {}
 
-    bool disabledToJumpOnMediumWithoutBackoff;
+    void ReadParameters(
+        const ParameterDatabaseReader& theParameterDatabaseReader,
+        const NodeId& theNodeId,
+        const InterfaceId& theInterfaceId);
 
-    //-------------------------------------------------------------------------
+    bool IsOn(const SimTime& currentTime) const
+    {
+        return ((nodeIsSelected) && (startTime <= currentTime) && (currentTime < endTime));
+    }
 
-    class WakeupTimerEvent : public SimulationEvent {
-    public:
-        WakeupTimerEvent(Dot11Mac* initMacPtr) : macPtr(initMacPtr) { }
-        void ExecuteEvent() { macPtr->ProcessWakeupTimerEvent(); }
-    private:
-        Dot11Mac* macPtr;
-    };
+    bool IsOn(const SimTime& currentTime, const unsigned int accessCategoryIndex) const
+    {
+        return (((*this).IsOn(currentTime)) && ((accessCategoryBitMask & (1U << accessCategoryIndex)) != 0));
+    }
 
+private:
 
-    shared_ptr<WakeupTimerEvent> wakeupTimerEventPtr;
-    EventRescheduleTicket wakeupTimerEventTicket;
-    SimTime currentWakeupTimerExpirationTime;
+    bool nodeIsSelected;
+    SimTime startTime;
+    SimTime endTime;
+    unsigned int accessCategoryBitMask;
 
-    //-------------------------------------------------------------------------
+};//MacTraceFilter//
 
-    SimTime mediumBecameIdleTime;
 
-    struct AddressAndTrafficIdMapKey {
-        MacAddress transmitterAddress;
-        PacketPriority trafficId;
+inline
+void MacTraceFilter::ReadParameters(
+    const ParameterDatabaseReader& theParameterDatabaseReader,
+    const NodeId& theNodeId,
+    const InterfaceId& theInterfaceId)
+{
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "trace-filter-node-ids"), theNodeId, theInterfaceId)) {
 
-        AddressAndTrafficIdMapKey(
-            const MacAddress& initTransmitterAddress, const PacketPriority& initTrafficId)
-            :
-            transmitterAddress(initTransmitterAddress), trafficId(initTrafficId) {}
+        const string nodeIdsString =
+            theParameterDatabaseReader.ReadString(
+                (parameterNamePrefix + "trace-filter-node-ids"), theNodeId, theInterfaceId);
 
-        bool operator<(const AddressAndTrafficIdMapKey& right) const {
-            return ((transmitterAddress < right.transmitterAddress) ||
-                    ((transmitterAddress == right.transmitterAddress) && (trafficId < right.trafficId)));
-        }
-    };
+        bool success;
+        vector<NodeId> nodeIds;
+        ConvertAStringSequenceOfANumericTypeIntoAVector<NodeId>(nodeIdsString, success, nodeIds);
 
-    struct OutgoingLinkInfo {
-        unsigned short int outgoingSequenceNumber;
-        unsigned short int windowStartSequenceNumber;
-        // Frames at and before this sequence number will not be resent.
-        unsigned short int lastDroppedFrameSequenceNumber;
-        bool blockAckSessionIsEnabled;
-        bool blockAckRequestNeedsToBeSent;
+        if (!success) {
+            cerr << "Error in configuration parameter: " << parameterNamePrefix << "trace-filter-node-ids:" << endl;
+            cerr << "     " << nodeIdsString << endl;
+            exit(1);
+        }//if//
 
-        OutgoingLinkInfo() :
-            outgoingSequenceNumber(0),
-            lastDroppedFrameSequenceNumber(0),
-            windowStartSequenceNumber(0),
-            blockAckSessionIsEnabled(false),
-            blockAckRequestNeedsToBeSent(false) {}
-    };
+        nodeIsSelected = (std::find(nodeIds.begin(), nodeIds.end(), theNodeId) != nodeIds.end());
+    }//if//
 
-    map<AddressAndTrafficIdMapKey, OutgoingLinkInfo> outgoingLinkInfoMap;
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "trace-filter-start-time"), theNodeId, theInterfaceId)) {
 
-    struct NeighborCapabilities {
-        bool mpduFrameAggregationIsEnabled;
-
-        NeighborCapabilities() :
-            mpduFrameAggregationIsEnabled(false)
-        { }
-    };
+        startTime =
+            theParameterDatabaseReader.ReadTime(
+                (parameterNamePrefix + "trace-filter-start-time"), theNodeId, theInterfaceId);
+    }//if//
 
-    map<MacAddress, NeighborCapabilities> neighborCapabilitiesMap;
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "trace-filter-end-time"), theNodeId, theInterfaceId)) {
 
-    // Statistics:
+        endTime =
+            theParameterDatabaseReader.ReadTime(
+                (parameterNamePrefix + "trace-filter-end-time"), theNodeId, theInterfaceId);
+    }//if//
 
-    //dropped by exceeded retries
-    shared_ptr<CounterStatistic> droppedPacketsStatPtr;
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "trace-filter-access-categories"), theNodeId, theInterfaceId)) {
 
-    //data
-    shared_ptr<CounterStatistic> unicastDataFramesSentStatPtr;
-    shared_ptr<CounterStatistic> broadcastDataFramesSentStatPtr;
-    shared_ptr<CounterStatistic> unicastDataFramesResentStatPtr;
-    shared_ptr<CounterStatistic> dataFramesReceivedStatPtr;
-    shared_ptr<CounterStatistic> dataDuplicatedFramesReceivedStatPtr;
-    shared_ptr<CounterStatistic> dataAggregateFramesSentStatPtr;
-    shared_ptr<CounterStatistic> dataAggregateFramesResentStatPtr;
-    shared_ptr<CounterStatistic> dataAggregatedSubframesReceivedStatPtr;
+        const string accessCategoriesString =
+            theParameterDatabaseReader.ReadString(
+                (parameterNamePrefix + "trace-filter-access-categories"), theNodeId, theInterfaceId);
 
-    //control
-    shared_ptr<CounterStatistic> ackFramesSentStatPtr;
-    shared_ptr<CounterStatistic> ackFramesReceivedStatPtr;
+        bool success;
+        vector<unsigned int> accessCategoryIndices;
+        ConvertAStringSequenceOfANumericTypeIntoAVector<unsigned int>(
+            accessCategoriesString, success, accessCategoryIndices);
 
-    shared_ptr<CounterStatistic> blockAckFramesSentStatPtr;
-    shared_ptr<CounterStatistic> blockAckFramesReceivedStatPtr;
+        if (!success) {
+            cerr << "Error in configuration parameter: " << parameterNamePrefix << "trace-filter-access-categories:" << endl;
+            cerr << "     " << accessCategoriesString << endl;
+            exit(1);
+        }//if//
 
-    shared_ptr<CounterStatistic> rtsFramesSentStatPtr;
-    shared_ptr<CounterStatistic> rtsFramesReceivedStatPtr;
+        accessCategoryBitMask = 0;
+        for(unsigned int i = 0; (i < accessCategoryIndices.size()); i++) {
+            if (accessCategoryIndices[i] >= (sizeof(accessCategoryBitMask) * 8)) {
+                cerr << "Error: invalid access category in " << parameterNamePrefix
+                     << "trace-filter-access-categories: " << accessCategoryIndices[i] << endl;
+                exit(1);
+            }//if//
 
-    shared_ptr<CounterStatistic> ctsFramesSentStatPtr;
-    shared_ptr<CounterStatistic> ctsFramesReceivedStatPtr;
+            accessCategoryBitMask |= (1U << accessCategoryIndices[i]);
+        }//for//
+    }//if//
 
-    //management
-    shared_ptr<CounterStatistic> beaconFramesSentStatPtr;
-    shared_ptr<CounterStatistic> beaconFramesReceivedStatPtr;
+}//ReadParameters//
 
-    shared_ptr<CounterStatistic> associationRequestFramesSentStatPtr;
-    shared_ptr<CounterStatistic> associationRequestFramesReceivedStatPtr;
 
-    shared_ptr<CounterStatistic> associationResponseFramesSentStatPtr;
-    shared_ptr<CounterStatistic> associationResponseFramesReceivedStatPtr;
+//-------------------------------------------------------------------------------------------------
 
-    shared_ptr<CounterStatistic> reassociationRequestFramesSentStatPtr;
-    shared_ptr<CounterStatistic> reassociationRequestFramesReceivedStatPtr;
+enum Dot11MacOperationMode {
+    AdhocMode,
+    ApMode,
+    InfrastructureMode
+};
 
-    shared_ptr<CounterStatistic> reassociationResponseFramesSentStatPtr;
-    shared_ptr<CounterStatistic> reassociationResponseFramesReceivedStatPtr;
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
 
-    shared_ptr<CounterStatistic> disassociationFramesSentStatPtr;
-    shared_ptr<CounterStatistic> disassociationFramesReceivedStatPtr;
 
-    shared_ptr<CounterStatistic> authenticationFramesSentStatPtr;
-    shared_ptr<CounterStatistic> authenticationFramesReceivedStatPtr;
+class Dot11Mac : public MacLayer,
+    public enable_shared_from_this<Dot11Mac> {
+public:
+    static const string modelName;
 
-    // Parallelism Stuff:
+    static const unsigned char AdhocModeAddressSelectorByte = UCHAR_MAX;
 
-    unsigned int lookaheadIndex;
+    static const SimTime maxTransmitOpportunityAkaTxopDuration = 8160 * MICRO_SECOND;
 
-    //-------------------------------------------------------------------------
+    static const unsigned int transmitOpportunityNumberPacketNoLimitValue = 0;
 
+    typedef Dot11Phy::PropFrame PropFrame;
 
-    SimTime CalculateAdditionalDelayForExtendedInterframeSpace() const;
+    static shared_ptr<Dot11Mac> Create(
+        const ParameterDatabaseReader& theParameterDatabaseReader,
+        const shared_ptr<SimulationEngineInterface>& simulationEngineInterfacePtr,
+        const NodeId& theNodeId,
+        const InterfaceId& theInterfaceId,
+        const unsigned int interfaceIndex,
+        const shared_ptr<NetworkLayer>& networkLayerPtr,
+        const shared_ptr<Dot11Phy>& physicalLayerPtr,
+        const RandomNumberGeneratorSeed& nodeSeed)
+    {
+        shared_ptr<Dot11Mac> macPtr(
+            new Dot11Mac(
+                theParameterDatabaseReader,
+                simulationEngineInterfacePtr,
+                theNodeId,
+                theInterfaceId,
+                interfaceIndex,
+                networkLayerPtr,
+                physicalLayerPtr,
+                nodeSeed));
 
-    void AddPrioritiesToAnAccessCategory(
-        const string& prioritiesInAString,
-        const unsigned int accessCategoryIndex);
+        macPtr->CompleteInitialization(theParameterDatabaseReader, nodeSeed);
+        return (macPtr);
 
+    }//Create//
 
-    void InitializeAccessCategories(const ParameterDatabaseReader& theParameterDatabaseReader);
 
-    void ReadBondedChannelList(
-        const string& bondedChannelListString,
-        const string& parameterNameForErrorOutput,
-        vector<unsigned int>& bondedChannelList);
+    ~Dot11Mac();
 
-    void ReadInMulticastGroupNumberList(const ParameterDatabaseReader& theParameterDatabaseReader);
+    void SetMacPacketHandler(
+        const EtherTypeField& etherType,
+        const shared_ptr<SimpleMacPacketHandler>& initMacPacketHandlerPtr) {
+        macPacketHandlerPtrs[etherType] = initMacPacketHandlerPtr;
+    }
 
-    void SetAccessCategoriesAsEdca(const ParameterDatabaseReader& theParameterDatabaseReader);
-    void SetAccessCategoriesAsDcf(const ParameterDatabaseReader& theParameterDatabaseReader);
+    void SetNetworkOutputQueue(
+        const shared_ptr<ItsOutputQueueWithPrioritySubqueues> initNetworkOutputQueuePtr) {
+        networkOutputQueuePtr = initNetworkOutputQueuePtr;
+        possiblyNonEmptyPriorityBitMask = allPrioritiesBitMask;
+    }
 
-    bool WakeupTimerIsActive() const { return !wakeupTimerEventTicket.IsNull(); }
+    void SetEdcaParameter(
+        const size_t accessCategoryIndex,
+        const bool admissionControlIsEnabled,
+        const int arbitrationInterframeSpaceNumber,
+        const int contentionWindowMin,
+        const int contentionWindowMax,
+        const SimTime& txopDuration);
 
-    void ScheduleWakeupTimer(const SimTime& wakeupTime);
-    void CancelWakeupTimer();
+    void SetCustomAdaptiveRateController(
+        const shared_ptr<Dot11::AdaptiveRateController>& rateControllerPtr)
+    {
+        this->theAdaptiveRateControllerPtr = rateControllerPtr;
+    }
 
-    bool FrameIsForThisNode(const Packet& aFrame) const;
+    void SetCongestionMonitoringHandler(
+        const shared_ptr<CongestionMonitoringHandler>& initCongestionMonitoringHandlerPtr)
+    {
+        this->congestionMonitoringHandlerPtr = initCongestionMonitoringHandlerPtr;
+    }
 
-    bool AggregatedSubframeIsForThisNode(const Packet& frame) const;
+    shared_ptr<ChannelBusyRatioEstimator> GetChannelBusyRatioEstimator() const
+        { return channelBusyRatioEstimatorPtr; }
 
-    // Note: returns accessCategories.size() when all backoffs are INFINITE_TIME.
+    // Includes the ongoing busy period up to the current time.
 
-    unsigned int FindIndexOfAccessCategoryWithShortestBackoff() const;
-    unsigned int FindIndexOfAccessCategoryWithEarliestBackoffExpiration() const;
+    SimTime GetAccumulatedPhysicalChannelBusyDuration() const
+    {
+        if (physicalChannelIsBusy) {
+            return (accumulatedPhysicalChannelBusyDuration +
+                    (simEngineInterfacePtr->CurrentTime() - physicalChannelBusyStartTime));
+        }//if//
 
-    bool AccessCategoryIsActive(const unsigned int accessCategoryIndex) const;
+        return accumulatedPhysicalChannelBusyDuration;
+    }
 
-    bool ThereAreQueuedPacketsForAccessCategory(const unsigned int accessCategoryIndex) const;
+    // For a phy switched to another channel (WAVE channel switching): its
+    // busy/clear notifications no longer reach this MAC, so an open busy
+    // period is closed here instead of being counted until the next one.
 
-    bool NetworkLayerHasPacketForAccessCategory(const unsigned int accessCategoryIndex) const;
+    void EndPhysicalChannelBusyPeriod()
+    {
+        if (!physicalChannelIsBusy) {
+            return;
+        }//if//
 
-    void RetrievePacketFromNetworkLayerForAccessCategory(
-        const unsigned int accessCategoryIndex,
-        bool& wasRetrieved);
+        const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
 
-    SimTime CurrentBackoffDuration() const;
-    SimTime CurrentBackoffExpirationTime() const;
+        accumulatedPhysicalChannelBusyDuration += (currentTime - physicalChannelBusyStartTime);
+        physicalChannelIsBusy = false;
 
-    void RecalcRandomBackoff(EdcaAccessCategoryInfo& accessCategoryInfo);
+        if (channelBusyRatioEstimatorPtr != nullptr) {
+            channelBusyRatioEstimatorPtr->ChannelBecameClear(currentTime);
+        }//if//
+    }
 
-    void StartBackoffIfNecessary();
-    void StartBackoffForCategory(const unsigned int accessCategoryIndex);
+    // A controller that uses the channel busy ratio needs the MAC's estimator
+    // (dot11-channel-busy-ratio-window-duration).
 
-    void StartPacketSendProcessForAnAccessCategory(
+    void SetContentionWindowController(
         const unsigned int accessCategoryIndex,
-        const bool forceBackoff = false);
+        const shared_ptr<ContentionWindowController>& initContentionWindowControllerPtr)
+    {
+        if ((initContentionWindowControllerPtr->UsesChannelBusyRatio()) &&
+            (channelBusyRatioEstimatorPtr == nullptr)) {
 
-    void PauseBackoffForAnAccessCategory(const unsigned int accessCategoryIndex, const SimTime& elapsedTime);
+            cerr << "Error: Contention window controller for access category " << accessCategoryIndex
+                 << " requires " << parameterNamePrefix << "channel-busy-ratio-window-duration." << endl;
+            exit(1);
+        }//if//
 
-    void SubtractElapsedTimeFromBackoffDuration(
-        const unsigned int accessCategoryIndex,
-        const SimTime& elapsedTime);
+        accessCategories.at(accessCategoryIndex).contentionWindowControllerPtr =
+            initContentionWindowControllerPtr;
+    }
 
-    void PerformInternalCollisionBackoff(const unsigned int accessCategoryIndex);
+    unsigned int GetNumberAccessCategories() const
+        { return static_cast<unsigned int>(accessCategories.size()); }
 
-    void DoubleTheContentionWindowAndPickANewBackoff(const unsigned int accessCategoryIndex);
+    unsigned int GetCurrentContentionWindowSlots(const unsigned int accessCategoryIndex) const
+    {
+        return (accessCategories.at(accessCategoryIndex).currentContentionWindowSlots);
+    }
 
-    SimTime CalculateFrameDuration(
-        const unsigned int frameWithMacHeaderSizeBytes,
-        const TransmissionParameters& txParameters) const;
+    PacketPriority GetMaxPacketPriority() const { return maxPacketPriority; }
 
-    SimTime CalculateFrameDurationWithoutPhyHeader(
-        const unsigned int frameWithMacHeaderSizeBytes,
-        const TransmissionParameters& txParameters) const;
+    unsigned long long int GetNumberFramesDroppedByLifetimeExpiration(
+        const unsigned int accessCategoryIndex) const
+    {
+        return (numberFramesDroppedByLifetimeExpiration.at(accessCategoryIndex));
+    }
 
-    SimTime CalculateControlFrameDuration(const unsigned int frameSizeBytes);
+    // Latency breakdown histogram bin (zero when the breakdown is disabled).
+    // Stage: 0 = queueing, 1 = channel access, 2 = suspension, 3 = airtime.
+    // The bins are exported as statistics by DisconnectFromOtherLayers().
 
-    SimTime CalculateNonExtendedBackoffDuration(const EdcaAccessCategoryInfo& accessCategory) const;
-    SimTime CalculateNonExtendedDurationForJumpingOnMediumWithNoBackoff(const EdcaAccessCategoryInfo& accessCategory) const;
+    unsigned long long int GetMacLatencyHistogramBinCount(
+        const unsigned int accessCategoryIndex,
+        const unsigned int latencyStageIndex,
+        const unsigned int bucket) const
+    {
+        if (!macLatencyBreakdownIsEnabled) {
+            return 0;
+        }//if//
 
-    int NumberBackoffSlotsUsedDuringElapsedTime(
-        const EdcaAccessCategoryInfo& accessCategory,
-        const SimTime& elapsedTime) const;
+        assert(latencyStageIndex < NumberMacLatencyStages);
+        assert(bucket < numberMacLatencyHistogramBuckets);
 
-    void GoIntoWaitForExpirationOfVirtualCarrierSenseAkaNavState();
+        return (macLatencyBreakdownInfos.at(accessCategoryIndex).histogramBinCounts[latencyStageIndex][bucket]);
+    }
 
-    SimTime CalculateNavDurationForRtsFrame(
-        const MacAddress& destinationMacAddress,
-        const unsigned int packetSizeBytes,
-        const TransmissionParameters& txParameters) const;
+    shared_ptr<MacAndPhyInfoInterface> GetMacAndPhyInfoInterface() const
+        { return physicalLayerPtr->GetDot11InfoInterface(); }
 
-    SimTime CalculateNavDurationForCtsFrame(
-        const DurationField& durationFromRtsFrame,
-        const MacAddress& destinationAddress) const;
+    shared_ptr<Dot11MacInterfaceForPhy> CreateInterfaceForPhy() {
+        return shared_ptr<InterfaceForPhy>(new InterfaceForPhy(this));
+    }
 
-    SimTime CalculateNavDurationForAckedDataFrame(
-        const TransmissionParameters& txParameters) const;
+    // Network Layer Interface:
 
-    SimTime CalculateNavDurationForAckedAggregateDataFrame(
-        const TransmissionParameters& txParameters) const;
+    virtual void NetworkLayerQueueChangeNotification() override;
 
-    SimTime CalculateNextFrameSequenceDuration(const unsigned int accessCategoryIndex) const;
+    // Only wakes the access category of the priority subqueue that was inserted into.
 
-    void AddExtraNavDurationToPacketForNextFrameIfInATxop(
-        const unsigned int accessCategoryIndex,
-        const SimTime& frameTransmissionEndTime,
-        Packet& thePacket) const;
+    void NetworkLayerQueueChangeNotificationForPriority(const PacketPriority& priority);
 
-    void CalculateAndSetTransmitOpportunityDurationAkaTxop(const size_t accessCategoryIndex);
+    virtual void DisconnectFromOtherLayers() override {
+        (*this).OutputMacLatencyHistogramStats();
 
-    bool FrameTransmissionDurationExceedsTransmissionPermissionEndTime(
-        const unsigned int& frameSizeBytes,
-        const TransmissionParameters& txParameters,
-        const SimTime& delayUntilTransmitting) const;
+        physicalLayerPtr.reset();
+        networkLayerPtr.reset();
+        apControllerPtr.reset();
+        staControllerPtr.reset();
+        macPacketHandlerPtrs.clear();
+    }
 
-    void TransmitAFrame(
-        const unsigned int accessCategoryIndex,
-        const bool doNotRequestToSendAkaRts,
-        const SimTime& delayUntilTransmitting,
-        bool& packetHasBeenSentToPhy);
+    virtual GenericMacAddress GetGenericMacAddress() const override {
+        return (myMacAddress.ConvertToGenericMacAddress());
+    }
 
-    void TransmitAnAggregateFrame(
-        const unsigned int accessCategoryIndex,
-        const TransmissionParameters& txParameters,
-        const double& transmitPowerDbm,
-        const SimTime& delayUntilTransmitting);
+    void SuspendTransmissionFunction();
+    void ResumeTransmissionFunction(const SimTime& initTransmissionPermissionEndTime);
 
-    void TransmitABlockAckRequest(
-        const MacAddress& destinationAddress,
-        const PacketPriority& trafficId,
-        const SimTime& delayUntilTransmitting);
+    // Any access category is active or has a queued frame.
 
-    void DropCurrentPacketAndGoToNextPacket(const unsigned int accessCategoryIndex);
-    void DropCurrentAggregateFrameAndGoToNextPacket(const unsigned int accessCategoryIndex);
+    bool HasQueuedPacketsToSend() const;
 
-    void NeverReceivedClearToSendOrAcknowledgementAction();
+    MacAddress GetMacAddress() const { return (myMacAddress); }
 
-    void ProcessRequestToSendFrame(
-        const RequestToSendFrame& rtsFrame,
-        const TransmissionParameters& receivedFrameTxParameters);
+    Dot11MacOperationMode GetOperationMode() const;
 
-    void ProcessClearToSendFrame(const ClearToSendFrame& ctsFrame);
+    bool GetIpMulticastAddressToMacAddressMappingIsEnabled() const
+        { return (ipMulticastAddressToMacAddressMappingIsEnabled); }
 
-    void ProcessDataFrame(
-        const Packet& dataFrame,
-        const TransmissionParameters& receivedFrameTxParameters);
+    void SendManagementFrame(unique_ptr<Packet>& framePtr);
 
-    void ProcessManagementFrame(
-        const Packet& managementFrame,
-        const TransmissionParameters& receivedFrameTxParameters);
+    unsigned int GetNumberOfChannels() const { return (physicalLayerPtr->GetChannelCount()); }
+    unsigned int GetCurrentChannelId() const { return (physicalLayerPtr->GetCurrentChannelNumber()); }
 
-    void ProcessNullFrame(
-        const Packet& nullFrame,
-        const TransmissionParameters& receivedFrameTxParameters);
+    const vector<unsigned int>& GetCurrentBondedChannelList()
+    {
+        return (physicalLayerPtr->GetCurrentBondedChannelList());
+    }
 
-    void ProcessAcknowledgementFrame(const AcknowledgementAkaAckFrame& ackFrame);
+    double GetRssiOfLastFrameDbm() const { return (physicalLayerPtr->GetRssiOfLastFrameDbm()); }
 
-    void ProcessBlockAckRequestFrame(
-        const BlockAcknowledgementRequestFrame& blockAckRequestFrame,
-        const TransmissionParameters& receivedFrameTxParameters);
+    void SendAssociationRequest(const MacAddress& apAddress);
 
-    void ProcessBlockAckFrame(const BlockAcknowledgementFrame& blockAckFrame);
+    void SendReassociationRequest(
+        const MacAddress& apAddress,
+        const MacAddress& currentApAddress);
 
-    unique_ptr<Packet> CreateABlockAckRequestFrame(
-        const MacAddress& destinationAddress,
-        const PacketPriority& trafficId,
-        const unsigned short int startFrameSequenceNumber) const;
+    void SendAssociationResponse(
+        const MacAddress& staAddress,
+        const AssociationId& theAssociationId);
 
-    void ProcessPowerSavePollFrame(
-        const PowerSavePollFrame& psPollFrame,
-        const TransmissionParameters& pollFrameTxParameters);
+    void SendReassociationResponse(
+        const MacAddress& staAddress,
+        const AssociationId& theAssociationId);
 
-    void SendAckFrame(
-        const MacAddress& destinationAddress,
-        const TransmissionParameters& receivedFrameTxParameters);
+    void SendDisassociation(const MacAddress& receiverAddress);
 
-    void ProcessWakeupTimerEvent();
-    void ProcessVirtualCarrierSenseAkaNavExpiration();
-    void ProcessInterframeSpaceAndBackoffTimeout();
-    void ProcessClearToSendOrAcknowledgementTimeout();
+    void StopReceivingFrames() { physicalLayerPtr->StopReceivingFrames(); }
+    void StartReceivingFrames() { physicalLayerPtr->StartReceivingFrames(); }
+    bool IsNotReceivingFrames() const { return (physicalLayerPtr->IsNotReceivingFrames()); }
 
-    void GetNewSequenceNumber(
-        const MacAddress& destinationAddress,
-        const PacketPriority& priority,
-        const bool isNonBlockAckedFrame,
-        unsigned short int& newSequenceNumber);
+    void SendAuthentication(const MacAddress& receiverAddress);
 
-    unsigned int CalcNumberFramesLeftInSequenceNumWindow(
-        const MacAddress& destinationAddress,
-        const PacketPriority& priority) const;
+    void SendPowerSaveNullFrame(
+        const MacAddress& receiverAddress,
+        const bool goingToPowerManagementMode);
 
-    void SetSequenceNumberWindowStart(
-        const MacAddress& destinationAddress,
-        const PacketPriority& priority,
-        const unsigned short int sequenceNum);
+    void SwitchToChannel(const unsigned int channelNumber);
+    void SwitchToChannels(const vector<unsigned int>& channels);
 
-    bool BlockAckSessionIsEnabled(
-        const MacAddress& destinationAddress,
-        const PacketPriority& priority) const;
+    // For 802.11AC primary secondary channel scheme.
 
-    void CheckPriorityToAccessCategoryMapping() const;
+    unsigned int GetFirstChannelNumberForChannelBandwidth(
+        const unsigned int signalChannelBandwidthMhz) const;
 
-    void QueueOutgoingEthernetPacket(unique_ptr<Packet>& ethernetPacketPtr);
-    void QueueOutgoingPacket(
+    void RequeueBufferedPackets();
+
+    void RequeueBufferedPacket(
         unique_ptr<Packet>& packetPtr,
         const NetworkAddress& nextHopAddress,
-        const PacketPriority priority);
+        const PacketPriority priority,
+        const EtherTypeField etherType,
+        const SimTime& timestamp,
+        const unsigned int retryTxCount,
+        const bool datarateAndTxPowerAreaSpecified,
+        const DatarateBitsPerSec& theDatarateBitsPerSec,
+        const double& txPowerDbm);
 
-    // Phy interface routines
+    void RequeueManagementFrame(unique_ptr<Packet>& framePtr);
 
-    void BusyChannelAtPhysicalLayerNotification();
-    void ClearChannelAtPhysicalLayerNotification();
-    void TransmissionIsCompleteNotification();
-    void DoSuccessfulTransmissionPostProcessing(const bool wasJustTransmitting);
+    // For other Mac Layer subsystems:
 
-    void ReceiveFrameFromPhy(
-        const Packet& aFrame,
-        const TransmissionParameters& receivedFrameTxParameters);
+    void SendLinkIsUpNotificationToNetworkLayer()
+        { networkLayerPtr->ProcessLinkIsUpNotification(interfaceIndex); }
 
-    void ReceiveAggregatedSubframeFromPhy(
-        unique_ptr<Packet>& subframePtr,
-        const TransmissionParameters& receivedFrameTxParameters,
-        const unsigned int aggregateFrameSubframeIndex,
-        const unsigned int numberSubframes);
+    void SendLinkIsDownNotificationToNetworkLayer()
+        { networkLayerPtr->ProcessLinkIsDownNotification(interfaceIndex); }
 
-    void NotifyThatPhyReceivedCorruptedFrame();
+    void SendNewLinkToANodeNotificationToNetworkLayer(const MacAddress& macAddress) {
+        networkLayerPtr->ProcessNewLinkToANodeNotification(
+            interfaceIndex, macAddress.ConvertToGenericMacAddress());
+    }
 
-    void NotifyThatPhyReceivedCorruptedAggregatedSubframe(
-        const TransmissionParameters& receivedFrameTxParameters,
-        const unsigned int aggregateFrameSubframeIndex,
-        const unsigned int numberSubframes);
+    void LookupMacAddressForNeighbor(const NodeId targetNodeId, bool& wasFound, MacAddress& macAddress);
 
-    class InterfaceForPhy : public Dot11MacInterfaceForPhy {
-    public:
-        InterfaceForPhy(Dot11Mac* initMacLayerPtr) : macLayerPtr(initMacLayerPtr) { }
+    bool MpduFrameAggregationIsEnabled() const { return (maxAggregateMpduSizeBytes > 0); }
 
-        virtual void BusyChannelAtPhysicalLayerNotification() override
-            { macLayerPtr->BusyChannelAtPhysicalLayerNotification(); }
+    void SetMpduFrameAggregationIsEnabledFor(const MacAddress& destinationAddress);
 
-        virtual void ClearChannelAtPhysicalLayerNotification() override
-            { macLayerPtr->ClearChannelAtPhysicalLayerNotification(); }
+private:
 
-        virtual void TransmissionIsCompleteNotification() override
-            { macLayerPtr->TransmissionIsCompleteNotification(); }
+    Dot11Mac(
+        const ParameterDatabaseReader& theParameterDatabaseReader,
+        const shared_ptr<SimulationEngineInterface>& simulationEngineInterfacePtr,
+        const NodeId& theNodeId,
+        const InterfaceId& theInterfaceId,
+        const unsigned int interfaceIndex,
+        const shared_ptr<NetworkLayer>& networkLayerPtr,
+        const shared_ptr<Dot11Phy>& physicalLayerPtr,
+        const RandomNumberGeneratorSeed& nodeSeed);
 
-        virtual void DoSuccessfulTransmissionPostProcessing(const bool wasJustTransmitting) override
-            { macLayerPtr->DoSuccessfulTransmissionPostProcessing(wasJustTransmitting); }
+    void CompleteInitialization(
+        const ParameterDatabaseReader& theParameterDatabaseReader,
+        const RandomNumberGeneratorSeed& nodeSeed);
 
-        virtual void ReceiveFrameFromPhy(
-            const Packet& aFrame,
-            const TransmissionParameters& receivedFrameTxParameters) override
-        {
-            macLayerPtr->ReceiveFrameFromPhy(aFrame, receivedFrameTxParameters);
-        }
+    shared_ptr<SimulationEngineInterface> simEngineInterfacePtr;
+    NodeId theNodeId;
+    InterfaceId theInterfaceId;
 
-        virtual void ReceiveAggregatedSubframeFromPhy(
-            unique_ptr<Packet>& subframePtr,
-            const TransmissionParameters& receivedFrameTxParameters,
-            const unsigned int aggregateFrameSubframeIndex,
-            const unsigned int numberSubframes) override
-        {
-            macLayerPtr->ReceiveAggregatedSubframeFromPhy(
-                subframePtr, receivedFrameTxParameters, aggregateFrameSubframeIndex, numberSubframes);
-        }
+    Dot11MacOperationMode operationMode;
 
+    // Note only one "Management Controller" exists at one time
+    shared_ptr<Dot11ApManagementController> apControllerPtr;
+    shared_ptr<Dot11StaManagementController> staControllerPtr;
 
-        virtual void NotifyThatPhyReceivedCorruptedFrame() override
-            { macLayerPtr->NotifyThatPhyReceivedCorruptedFrame(); }
+    shared_ptr<NetworkLayer> networkLayerPtr;
+    map<EtherTypeField, shared_ptr<SimpleMacPacketHandler> > macPacketHandlerPtrs;
 
+    unsigned int interfaceIndex;
+    MacAddress myMacAddress;
 
-        virtual void NotifyThatPhyReceivedCorruptedAggregatedSubframe(
-            const TransmissionParameters& receivedFrameTxParameters,
-            const unsigned int aggregateFrameSubframeIndex,
-            const unsigned int numberSubframes) override
-        {
-            macLayerPtr->NotifyThatPhyReceivedCorruptedAggregatedSubframe(
-                receivedFrameTxParameters, aggregateFrameSubframeIndex, numberSubframes);
-        }
+    bool ipMulticastAddressToMacAddressMappingIsEnabled;
+    std::set<MacAddress> myMulticastMacAddresses;
 
-        bool AggregatedSubframeIsForThisNode(const Packet& frame) const override
-            { return (macLayerPtr->AggregatedSubframeIsForThisNode(frame)); }
+    shared_ptr<ItsOutputQueueWithPrioritySubqueues> networkOutputQueuePtr;
 
-    private:
-        Dot11Mac* macLayerPtr;
+    // Bit (1 << priority) is set when the priority subqueue may have packets.
+    // Set by the network layer queue change notifications, on network output
+    // queue (re)assignment and on requeue; cleared lazily when the subqueue is
+    // found empty. A packet inserted without a notification is not seen until
+    // the next one.
 
-    };//InterfaceForPhy//
+    mutable unsigned int possiblyNonEmptyPriorityBitMask;
+    unsigned int allPrioritiesBitMask;
 
-    bool FrameAggregationIsEnabledFor(const MacAddress& destinationAddress) const;
-    bool MpduFrameAggregationIsEnabledFor(const MacAddress& destinationAddress) const;
+    bool refreshNextHopOnDequeueModeIsOn;
 
-    bool NeedToSendABlockAckRequest(
-        const MacAddress& destinationAddress,
-        const PacketPriority& trafficId) const;
+    deque<unique_ptr<Packet> > managementFrameQueue;
 
-    void BuildAggregateFrameFromCurrentFrame(const unsigned int accessCategoryIndex);
+    IncomingFrameBuffer theIncomingFrameBuffer;
 
-    void SendPacketToNetworkLayer(unique_ptr<Packet>& dataFramePtr);
+    shared_ptr<AdaptiveRateController> theAdaptiveRateControllerPtr;
+    shared_ptr<AdaptiveTxPowerController> theAdaptiveTxPowerControllerPtr;
 
-    void SendBlockAcknowledgementFrame(
-        const MacAddress& destinationAddress,
-        const PacketPriority& trafficId,
-        const TransmissionParameters& receivedFrameTxParameters);
+    shared_ptr<Dot11Phy> physicalLayerPtr;
 
-    //For trace output
+    unique_ptr<MacAddressResolver<MacAddress> > theMacAddressResolverPtr;
 
-    void OutputTraceForClearChannel() const;
-    void OutputTraceForBusyChannel() const;
-    void OutputTraceForNavStart(const SimTime& expirationTime) const;
-    void OutputTraceForNavExpiration() const;
+    shared_ptr<CongestionMonitoringHandler> congestionMonitoringHandlerPtr;
 
-    void OutputTraceForIfsAndBackoffStart(const SimTime& expirationTime) const;
-    void OutputTraceForInterruptedIfsAndBackoff(
-        const unsigned int accessCategoryIndex,
-        const SimTime nonExtendedDurationLeft) const;
-    void OutputTraceForIfsAndBackoffExpiration() const;
+    // Built-in estimator (fed independently of congestionMonitoringHandlerPtr).
 
-    void OutputTraceAndStatsForFrameReceive(const Packet& aFrame) const;
+    shared_ptr<ChannelBusyRatioEstimator> channelBusyRatioEstimatorPtr;
 
-    void OutputTraceAndStatsForAggregateSubframeReceive(
-        const Packet& aFrame,
-        const QosDataFrameHeader& dataFrameHeader);
+    // Physical carrier sense busy time accumulated over the whole run.
 
-    void OutputTraceForPacketDequeue(const unsigned int accessCategoryIndex,  const SimTime delayUntilAirBorne = 0) const;
+    bool physicalChannelIsBusy;
+    SimTime physicalChannelBusyStartTime;
+    SimTime accumulatedPhysicalChannelBusyDuration;
 
-    void OutputTraceAndStatsForRtsFrameTransmission(const unsigned int accessCategoryIndex) const;
-    void OutputTraceForCtsFrameTransmission() const;
-    void OutputTraceAndStatsForAggregatedFrameTransmission(const unsigned int accessCategoryIndex) const;
-    void OutputTraceAndStatsForBroadcastDataFrameTransmission(const unsigned int accessCategoryIndex) const;
-    void OutputTraceAndStatsForUnicastDataFrameTransmission(const unsigned int accessCategoryIndex) const;
-    void OutputTraceAndStatsForManagementFrameTransmission(const unsigned int accessCategoryIndex) const;
-    void OutputTraceForAckFrameTransmission() const;
-    void OutputTraceAndStatsForBlockAckFrameTransmission() const;
+    unique_ptr<Dot11MacAccessPointScheduler> macSchedulerPtr;
 
-    void OutputTraceForCtsOrAckTimeout() const;
+    //-----------------------------------------------------
 
-    void OutputTraceAndStatsForPacketRetriesExceeded(const unsigned int accessCategoryIndex) const;
-    bool redundantTraceInformationModeIsOn;
+    // Acronyms: AIFS,DIFS,EIFS,SIFS: {Arbitration, Distributed, Extended, Short} InterFrame Space
 
-};//Dot11Mac//
+    // EDCA = "Enhanced Distributed Channel Access" for QoS (added in 802.11e)
+    // DCF = "Distributed Coordination Function" (802.11 classic access protocol).
 
-//デフォルトのContentionwindowなどの値
-const unsigned int DefaultRtsThresholdSizeBytes = UINT_MAX;
-const unsigned int DefaultShortFrameRetryLimit = 7;
-const unsigned int DefaultLongFrameRetryLimit = 4;
-const unsigned int DefaultContentionWindowSlotsMin = 15;
-const unsigned int DefaultContentionWindowSlotsMax = 1023;
-const PacketPriority DefaultMaxPacketPriority = 3;
-const unsigned int MaxNumberAccessCategories = 4;
+    // Mac Non-EDCA specific parameters:
 
-inline
-SimTime Dot11Mac::CalculateAdditionalDelayForExtendedInterframeSpace() const
-{
-    TransmissionParameters txParameters;
-    txParameters.channelBandwidthMhz = physicalLayerPtr->GetBaseChannelBandwidthMhz();
+    unsigned int rtsThresholdSizeBytes;
 
-    txParameters.modulationAndCodingScheme =
-        theAdaptiveRateControllerPtr->GetLowestModulationAndCoding();
+    unsigned int shortFrameRetryLimit;
+    unsigned int longFrameRetryLimit;
 
-    SimTime longestPossibleAckDuration =
-        CalculateFrameDuration(sizeof(AcknowledgementAkaAckFrame), txParameters);
+    // "Short Interframe Space" = SIFS
 
-    return (aShortInterframeSpaceTime + longestPossibleAckDuration);
+    SimTime aShortInterframeSpaceTime;
+    SimTime aSlotTime;
 
-}//CalculateAdditionalDelayForExtendedInterframeSpace//
+    // Cannot detect an incoming signal while switching to transmission mode.
 
+    SimTime aRxTxTurnaroundTime;
 
+    // Extra interframe delay is added if last frame was corrupted (and thus virtual carrier sense
+    // is disabled).
 
-inline
-void Dot11Mac::AddPrioritiesToAnAccessCategory(
-    const string& prioritiesInAString,
-    const unsigned int accessCategoryIndex)
-{
-    bool success;
-    vector<PacketPriority> priorityVector;
-
-    ConvertAStringSequenceOfANumericTypeIntoAVector<PacketPriority>(
-        prioritiesInAString,
-        success,
-        priorityVector);
-
-    if (!success) {
-        cerr << "Error: Configuration: Bad Priority sequence: " << prioritiesInAString << endl;
-        exit(1);
-    }//if//
-
-    EdcaAccessCategoryInfo& accessCategory = accessCategories.at(accessCategoryIndex);
-
-    accessCategory.listOfPriorities.clear();
-
-    for(unsigned int i = 0; (i < priorityVector.size()); i++) {
-        accessCategory.listOfPriorities.push_back(priorityVector[i]);
-    }//for//
+    SimTime additionalDelayForExtendedInterframeSpaceMode;
 
-}//AddPrioritiesToAnAccessCategory//
+    SimTime clearToSendTimeoutDuration;
+    SimTime ackTimeoutDuration;
 
-inline
-void Dot11Mac::CheckPriorityToAccessCategoryMapping() const
-{
-    for(PacketPriority priority = 0; (priority <= maxPacketPriority); priority++) {
-        bool found = false;
-        for(unsigned int cat = 0; (cat < numberAccessCategories); cat++) {
-            for(unsigned int i = 0; (i < accessCategories[cat].listOfPriorities.size()); i++) {
-                if (priority == accessCategories[cat].listOfPriorities[i]) {
-                    if (found) {
-                        cerr << "Error: Duplicate access category to priority mapping for "
-                             << "priority = " << priority << endl;
-                        exit(1);
-                    }//if//
-                    found = true;
-                }//if//
-                if (accessCategories[cat].listOfPriorities[i] > maxPacketPriority) {
-                    cerr << "Error: Unexpected priority mapping for "
-                         << "priority = " << int(accessCategories[cat].listOfPriorities[i])
-                         << ", max priority = " << static_cast<int>(maxPacketPriority) << endl;
-                    exit(1);
-                }//if//
-            }//for//
-        }//for//
-        if (!found) {
-            cerr << "Error: No access category to priority mapping for priority = "
-                 << priority << endl;
-            exit(1);
-        }//if//
-    }//for//
+    int contentionWindowSlotsMin;
+    int contentionWindowSlotsMax;
 
-}//CheckPriorityToAccessCategoryMapping//
+    enum AckDatarateSelectionType {
+        SameAsData,
+        Lowest
+    };
 
+    // To make this (counter-intuitive) behavior explicit.
 
+    bool allowFrameAggregationWithTxopZero;
 
+    bool protectAggregateFramesWithSingleAckedFrame;
 
-inline
-void Dot11Mac::InitializeAccessCategories(const ParameterDatabaseReader& theParameterDatabaseReader)
-{
-    string qosTypeString = "edca";
+    unsigned int maxAggregateMpduSizeBytes;
 
-    if (theParameterDatabaseReader.ParameterExists(
-            "dot11-qos-type", theNodeId, theInterfaceId)) {
+    AckDatarateSelectionType ackDatarateSelection;
 
-        qosTypeString =  MakeLowerCaseString(
-            theParameterDatabaseReader.ReadString("dot11-qos-type", theNodeId, theInterfaceId));
+    RandomNumberGenerator aRandomNumberGenerator;
 
-    }//if//
+    // Optional (default off: keeps the aRandomNumberGenerator backoff sequence).
 
-    if (qosTypeString == "edca") {
-        (*this).SetAccessCategoriesAsEdca(theParameterDatabaseReader);
-    }
-    else if (qosTypeString == "dcf") {
-        (*this).SetAccessCategoriesAsDcf(theParameterDatabaseReader);
-    }
-    else {
-        cerr << "Error: Unknown dot11-qos-type: " << qosTypeString << endl;
-        exit(1);
-    }//if//
+    static const long long int backoffRandomNumberPoolSeedHash = 30517;
 
-    CheckPriorityToAccessCategoryMapping();
+    unique_ptr<BackoffRandomNumberPool> backoffRandomNumberPoolPtr;
 
-    for(unsigned int i = 0; (i < accessCategories.size()); i++) {
-        accessCategories[i].currentContentionWindowSlots = accessCategories[i].minContentionWindowSlots;
-    }//for//
+    enum MacStateType {
+        IdleState,
+        BusyMediumState,
+        CtsOrAckTransmissionState,
+        WaitingForNavExpirationState,
+        WaitingForIfsAndBackoffState,
+        WaitingForCtsState,
+        WaitingForAckState,
+        ChangingChannelsState,
+        TransientState,
+    };
 
-    accessCategoryIndexForManagementFrames = static_cast<unsigned int>(accessCategories.size() - 1);
+    MacStateType macState;
 
-}//InitializeAccessCategories//
+    enum class SentFrameType {
+        ShortFrame,
+        RequestToSendFrame,
+        LongFrame,
+        AggregateFrame,
+        BlockAckRequestFrame,
+        PowerSavePollResponse,
+    };
 
-//EDCAの時はここを通る.
-inline
-void Dot11Mac::SetAccessCategoriesAsEdca(const ParameterDatabaseReader& theParameterDatabaseReader)
-{
-    // Set defaults for WAVE.  Maybe overidden.
+    SentFrameType lastSentFrameWasAn;
 
-    accessCategories.clear();
-    accessCategories.resize(4);
+    MacAddress lastSentDataFrameDestinationMacAddress;
 
-    //仮
-    //cout << "SetAccessCategories" << endl;
-    //最初通る
+    unsigned int powerSavePollResponsePacketTxCount;
 
-    //デフォルトのコンテンションウィンドウ
-    accessCategories.at(0).minContentionWindowSlots = contentionWindowSlotsMin;
-    accessCategories.at(0).maxContentionWindowSlots = contentionWindowSlotsMax;
-    accessCategories.at(0).arbitrationInterframeSpaceDurationSlots = 9;
+    SimTime mediumReservedUntilTimeAkaNAV;
 
-    accessCategories.at(1).minContentionWindowSlots = (contentionWindowSlotsMin+1)/2 - 1;
-    accessCategories.at(1).maxContentionWindowSlots = contentionWindowSlotsMax;
-    accessCategories.at(1).arbitrationInterframeSpaceDurationSlots = 6;
+    bool lastFrameReceivedWasCorrupt;
 
-    accessCategories.at(2).minContentionWindowSlots = (contentionWindowSlotsMin+1)/4 - 1;
-    accessCategories.at(2).maxContentionWindowSlots = (contentionWindowSlotsMin+1)/2 - 1;
-    accessCategories.at(2).arbitrationInterframeSpaceDurationSlots = 3;
+    SimTime transmissionPermissionEndTime; // for receiving only mode
 
-    accessCategories.at(3).minContentionWindowSlots = (contentionWindowSlotsMin+1)/4 - 1;
-    accessCategories.at(3).maxContentionWindowSlots = (contentionWindowSlotsMin+1)/2 - 1;
-    accessCategories.at(3).arbitrationInterframeSpaceDurationSlots = 2;
+    // Access categories whose frame did not fit before transmissionPermissionEndTime
+    // (e.g. WAVE interval end). Restarted with a fresh random backoff on resume so
+    // that nodes do not all contend at the start of the next interval.
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "num-edca-access-categories"), theNodeId, theInterfaceId)) {
+    bool heldAccessCategoryRestartIsEnabled;
+    unsigned int heldAccessCategoryBitMask;
 
-        numberAccessCategories =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                (parameterNamePrefix + "num-edca-access-categories"),
-                theNodeId,
-                theInterfaceId);
+    void RestartHeldAccessCategories();
 
-        if (numberAccessCategories > MaxNumberAccessCategories) {
-            cerr << "Error: the number of 802.11 access categories is greater than: "
-                 << MaxNumberAccessCategories << endl;
-            exit(1);
-        }//if//
+    // Used by block ack processing.
 
-        accessCategories.resize(numberAccessCategories);
+    MacAddress currentIncomingAggregateFramesSourceMacAddress;
+    PacketPriority currentIncomingAggregateFramesTrafficId;
+    unsigned int numSubframesReceivedFromCurrentAggregateFrame;
 
-    }//if//
+    //-----------------------------------------------------
 
-    assert(maxPacketPriority == 3);
+    struct EdcaAccessCategoryInfo {
+        // Parameters
+        vector<PacketPriority> listOfPriorities;
+        unsigned int priorityBitMask;
+        unsigned int minContentionWindowSlots;
+        unsigned int maxContentionWindowSlots;
+        unsigned int arbitrationInterframeSpaceDurationSlots;
+        SimTime transmitOpportunityDurationAkaTxop;
+        SimTime frameLifetime;//dot11EDCATableMSDULifetime//
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "max-packet-priority"), theNodeId, theInterfaceId)) {
+        // State variables
+        unsigned int currentContentionWindowSlots;
+        unsigned int currentNumOfBackoffSlots;
 
-        unsigned int readMaxPacketPriority =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                (parameterNamePrefix + "max-packet-priority"),
-                theNodeId,
-                theInterfaceId);
+        // Calculated backoff duration without dynamically added Extended Interframe space.
+        SimTime currentNonExtendedBackoffDuration;
 
-        if (readMaxPacketPriority > 7) {
-            cerr << "Error in parameter \"" << (parameterNamePrefix + "max-packet-priority")
-                 << "\",  maximum 802.11 priority is 7." << endl;
-            exit(1);
-        }//if//
+        bool tryingToJumpOnMediumWithoutABackoff;
+        bool hasPacketToSend;
 
-        maxPacketPriority = static_cast<PacketPriority>(readMaxPacketPriority);
+        unsigned int currentShortFrameRetryCount;
+        unsigned int currentLongFrameRetryCount;
+        unsigned int currentAggregateFrameRetryCount;
 
-    }//if//
+        SimTime ifsAndBackoffStartTime;
 
+        shared_ptr<ContentionWindowController> contentionWindowControllerPtr;
 
-    // Default simple priority mapping: Distribute priorities across categories,
-    // excess priorities in the front (low priority access categories).
+        // currentPacketPtr (non-aggregate) sent before aggregate frame.
 
-    //?????
+        unique_ptr<Packet> currentPacketPtr;
+        unique_ptr<vector<unique_ptr<Packet> > > currentAggregateFramePtr;
+        bool currentAggregateFrameIsAMpduAggregate;
 
-    const unsigned int minPriPerCategory = (maxPacketPriority+1) / numberAccessCategories;
-    //priority / accessCategory
+        // Emptied subframe container kept (with its capacity) for the next aggregate.
 
-    assert(minPriPerCategory >= 1);
+        unique_ptr<vector<unique_ptr<Packet> > > spareAggregateFrameContainerPtr;
 
-    const unsigned int excessPriorities = (maxPacketPriority+1) % numberAccessCategories;
-    //余剰priority??
+        bool currentPacketIsAManagementFrame;
+        NetworkAddress currentPacketsNextHopNetworkAddress;
+        MacAddress currentPacketsDestinationMacAddress;
+        unsigned short int currentPacketSequenceNumber;
+        PacketPriority currentPacketPriorityAkaTrafficId;
+        EtherTypeField currentPacketsEtherType;
+        SimTime currentPacketsTimestamp;
 
-    PacketPriority priority = 0;
-    for(unsigned int i = 0; (i < numberAccessCategories); i++) {
-        unsigned int numberPriorities = minPriPerCategory;
-        if (i < excessPriorities) {
-            numberPriorities++;
-        }//if//
+        SimTime timeLeftInCurrentTransmitOpportunity;
 
-        for(unsigned int j = 0; (j < numberPriorities); j++) {
-            accessCategories[i].listOfPriorities.push_back(priority);
-            //push_backは末尾に要素を追加する.
-            priority++;
-        }//for//
-    }//for//
+        bool currentPacketDatarateAndTxPowerAreSpecified;
+        DatarateBitsPerSec specifiedPacketDatarateBitsPerSec;
+        double specifiedPacketTxPowerDbm;
 
+        EdcaAccessCategoryInfo()
+            :
+            priorityBitMask(0),
+            currentNumOfBackoffSlots(0),
+            currentNonExtendedBackoffDuration(INFINITE_TIME),
+            currentShortFrameRetryCount(0),
+            currentLongFrameRetryCount(0),
+            currentAggregateFrameRetryCount(0),
+            currentPacketsTimestamp(ZERO_TIME),
+            hasPacketToSend(false),
+            currentPacketSequenceNumber(0),
+            currentPacketPriorityAkaTrafficId(0),
+            currentPacketsEtherType(ETHERTYPE_IS_NOT_SPECIFIED),
+            tryingToJumpOnMediumWithoutABackoff(false),
+            frameLifetime(INFINITE_TIME),
+            transmitOpportunityDurationAkaTxop(ZERO_TIME),
+            timeLeftInCurrentTransmitOpportunity(ZERO_TIME),
+            currentPacketIsAManagementFrame(false),
+            ifsAndBackoffStartTime(INFINITE_TIME),
+            currentAggregateFrameIsAMpduAggregate(true),
+            currentPacketDatarateAndTxPowerAreSpecified(false),
+            specifiedPacketDatarateBitsPerSec(0),
+            specifiedPacketTxPowerDbm(0.0)
+        {}
 
-    // Override defaults if parameters exist.
+        void operator=(EdcaAccessCategoryInfo&& right)
+        {
+            assert(this != &right);
 
-    for(unsigned int i = 0; (i < accessCategories.size()); i++) {
-        ostringstream prefixStream;
-        prefixStream << parameterNamePrefix << "edca-category-" << i << '-';
-        string prefix = prefixStream.str();
+            listOfPriorities = right.listOfPriorities;
+            priorityBitMask = right.priorityBitMask;
+            minContentionWindowSlots = right.minContentionWindowSlots;
+            maxContentionWindowSlots = right.maxContentionWindowSlots;
+            arbitrationInterframeSpaceDurationSlots = right.arbitrationInterframeSpaceDurationSlots;
+            transmitOpportunityDurationAkaTxop = right.transmitOpportunityDurationAkaTxop;
+            frameLifetime = right.frameLifetime;
+            currentContentionWindowSlots = right.currentContentionWindowSlots;
+            currentNumOfBackoffSlots = right.currentNumOfBackoffSlots;
+            currentNonExtendedBackoffDuration = right.currentNonExtendedBackoffDuration;
+            tryingToJumpOnMediumWithoutABackoff = right.tryingToJumpOnMediumWithoutABackoff;
+            hasPacketToSend = right.hasPacketToSend;
+            currentShortFrameRetryCount = right.currentShortFrameRetryCount;
+            currentLongFrameRetryCount = right.currentLongFrameRetryCount;
+            currentAggregateFrameRetryCount = right.currentAggregateFrameRetryCount;
+            ifsAndBackoffStartTime = right.ifsAndBackoffStartTime;
+            contentionWindowControllerPtr = move(right.contentionWindowControllerPtr);
+            currentPacketPtr = move(right.currentPacketPtr);
+            currentAggregateFramePtr = move(right.currentAggregateFramePtr);
+            currentAggregateFrameIsAMpduAggregate = right.currentAggregateFrameIsAMpduAggregate;
+            spareAggregateFrameContainerPtr = move(right.spareAggregateFrameContainerPtr);
+            currentPacketIsAManagementFrame = right.currentPacketIsAManagementFrame;
+            currentPacketsNextHopNetworkAddress = right.currentPacketsNextHopNetworkAddress;
+            currentPacketsDestinationMacAddress = right.currentPacketsDestinationMacAddress;
+            currentPacketSequenceNumber = right.currentPacketSequenceNumber;
+            currentPacketPriorityAkaTrafficId = right.currentPacketPriorityAkaTrafficId;
+            currentPacketsEtherType = right.currentPacketsEtherType;
+            currentPacketsTimestamp = right.currentPacketsTimestamp;
+            currentPacketDatarateAndTxPowerAreSpecified = right.currentPacketDatarateAndTxPowerAreSpecified;
+            specifiedPacketDatarateBitsPerSec = right.specifiedPacketDatarateBitsPerSec;
+            specifiedPacketTxPowerDbm = right.specifiedPacketTxPowerDbm;
+        }//=//
 
-        if (theParameterDatabaseReader.ParameterExists((prefix+"num-aifs-slots"), theNodeId, theInterfaceId)) {
-            accessCategories[i].arbitrationInterframeSpaceDurationSlots =
-                theParameterDatabaseReader.ReadNonNegativeInt(
-                    (prefix+"num-aifs-slots"), theNodeId, theInterfaceId);
-        }//if//
+        EdcaAccessCategoryInfo(EdcaAccessCategoryInfo&& right) { (*this) = move(right); }
 
-        //contentionwindowをobjtypeの設定から読み取っていく
+    };//EdcaAccessCatagoryInfo//
 
-        if (theParameterDatabaseReader.ParameterExists((prefix+"contention-window-min-slots"), theNodeId, theInterfaceId)) {
-            accessCategories[i].minContentionWindowSlots =
-                theParameterDatabaseReader.ReadNonNegativeInt(
-                    (prefix+"contention-window-min-slots"), theNodeId, theInterfaceId);
-        }//if//
 
-        if (theParameterDatabaseReader.ParameterExists((prefix+"contention-window-max-slots"), theNodeId, theInterfaceId)) {
-            accessCategories[i].maxContentionWindowSlots =
-                theParameterDatabaseReader.ReadNonNegativeInt(
-                    (prefix+"contention-window-max-slots"), theNodeId, theInterfaceId);
-        }//if//
+    //-----------------------------------------------------
 
-        //objtypeのpriorityを読み込んでいる.
-        if (theParameterDatabaseReader.ParameterExists((prefix+"priority-list"), theNodeId, theInterfaceId)) {
-            string prioritiesInAString =
-                theParameterDatabaseReader.ReadString((prefix+"priority-list"), theNodeId, theInterfaceId);
-            DeleteTrailingSpaces(prioritiesInAString);
-            (*this).AddPrioritiesToAnAccessCategory(prioritiesInAString, i);
-        }//if//
+    PacketPriority maxPacketPriority;
 
-        if (theParameterDatabaseReader.ParameterExists((prefix+"frame-lifetime"), theNodeId, theInterfaceId)) {
-            accessCategories[i].frameLifetime =
-                theParameterDatabaseReader.ReadTime((prefix+"frame-lifetime"), theNodeId, theInterfaceId);
-        }//if//
+    vector<EdcaAccessCategoryInfo> accessCategories;
 
-    }//for//
+    vector<unsigned int> accessCategoryIndexForPriority;
 
-}//SetAccessCategoriesAsEdca//
+    unsigned int numberAccessCategories;
 
+    unsigned int accessCategoryIndexForLastSentFrame;
 
-inline
-void Dot11Mac::SetAccessCategoriesAsDcf(const ParameterDatabaseReader& theParameterDatabaseReader)
-{
-    //Set defaults for DCF. Maybe overidden.
+    unsigned int accessCategoryIndexForManagementFrames;
 
-    accessCategories.clear();
-    accessCategories.resize(1);
+    SimTime currentTransmitOpportunityAkaTxopStartTime;
+    SimTime currentTransmitOpportunityAkaTxopEndTime;
 
-    EdcaAccessCategoryInfo& accessCategoryForDcf = accessCategories.at(0);
-    accessCategoryForDcf.minContentionWindowSlots = contentionWindowSlotsMin;
-    accessCategoryForDcf.maxContentionWindowSlots = contentionWindowSlotsMax;
-    accessCategoryForDcf.arbitrationInterframeSpaceDurationSlots = 2;
+    unsigned int currentTransmitOpportunityAckedFrameCount;
 
-    numberAccessCategories = 1;
-    maxPacketPriority = 0;
+    vector<unsigned int> switchingToThisChannelList;
 
-    accessCategoryForDcf.listOfPriorities.push_back(0);
+    bool disabledToJumpOnMediumWithoutBackoff;
 
-    // Override defaults if parameters exist.
+    //-------------------------------------------------------------------------
 
-    if (theParameterDatabaseReader.ParameterExists("dot11-dcf-num-difs-slots", theNodeId, theInterfaceId)) {
-        accessCategoryForDcf.arbitrationInterframeSpaceDurationSlots =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                "dot11-dcf-num-difs-slots", theNodeId, theInterfaceId);
-    }//if//
+    class WakeupTimerEvent : public SimulationEvent {
+    public:
+        WakeupTimerEvent(Dot11Mac* initMacPtr) : macPtr(initMacPtr) { }
+        void ExecuteEvent() { macPtr->ProcessWakeupTimerEvent(); }
+    private:
+        Dot11Mac* macPtr;
+    };
 
-    if (theParameterDatabaseReader.ParameterExists("dot11-dcf-contention-window-min-slots", theNodeId, theInterfaceId)) {
-        accessCategoryForDcf.minContentionWindowSlots  =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                "dot11-dcf-contention-window-min-slots", theNodeId, theInterfaceId);
-    }//if//
 
-    if (theParameterDatabaseReader.ParameterExists("dot11-dcf-contention-window-max-slots", theNodeId, theInterfaceId)) {
-        accessCategoryForDcf.maxContentionWindowSlots =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                "dot11-dcf-contention-window-max-slots", theNodeId, theInterfaceId);
-    }//if//
+    shared_ptr<WakeupTimerEvent> wakeupTimerEventPtr;
+    EventRescheduleTicket wakeupTimerEventTicket;
+    SimTime currentWakeupTimerExpirationTime;
 
-    if (theParameterDatabaseReader.ParameterExists("dot11-dcf-frame-lifetime", theNodeId, theInterfaceId)) {
-        accessCategoryForDcf.frameLifetime =
-            theParameterDatabaseReader.ReadTime("dot11-dcf-frame-lifetime", theNodeId, theInterfaceId);
-    }//if//
+    //-------------------------------------------------------------------------
 
-}//SetAccessCategoriesAsDcf//
+    // Frame lifetime expiration: Hashed timing wheel indexed by expiration time.
+    // A slot is a bitmask of the priority subqueues whose head frame may expire in
+    // the slot. Subqueues are FIFO so expired frames are always at the head.
 
+    static const unsigned int numberFrameLifetimeWheelSlots = 64;
 
-inline
-void Dot11Mac::ReadBondedChannelList(
-    const string& bondedChannelListString,
-    const string& parameterNameForErrorOutput,
-    vector<unsigned int>& bondedChannelList)
-{
-    bool success;
-    ConvertAStringSequenceOfANumericTypeIntoAVector<unsigned int>(
-        bondedChannelListString,
-        success,
-        bondedChannelList);
+    class FrameLifetimeWheelEvent : public SimulationEvent {
+    public:
+        FrameLifetimeWheelEvent(Dot11Mac* initMacPtr) : macPtr(initMacPtr) { }
+        void ExecuteEvent() { macPtr->ProcessFrameLifetimeWheelEvent(); }
+    private:
+        Dot11Mac* macPtr;
+    };
 
-    if ((!success) || (bondedChannelList.empty())) {
-        cerr << "Error in configuration parameter: " << parameterNameForErrorOutput << ":" << endl;
-        cerr << "     " << bondedChannelListString << endl;
-        exit(1);
-    }//if//
+    bool frameLifetimeWheelIsEnabled;
+    SimTime frameLifetimeWheelSlotDuration;
+    vector<unsigned int> frameLifetimeWheelSlots;
 
-    for(unsigned int i = 0; (i < bondedChannelList.size()); i++) {
-        if (bondedChannelList[i] >= GetNumberOfChannels()) {
-            cerr << "Error: invalid channel number: " << bondedChannelList[i] << endl;
-            exit(1);
-        }//if//
-    }//for//
+    shared_ptr<FrameLifetimeWheelEvent> frameLifetimeWheelEventPtr;
+    EventRescheduleTicket frameLifetimeWheelEventTicket;
+    SimTime frameLifetimeWheelEventTime;
 
-}//InitBondedChannel//
+    vector<unsigned long long int> numberFramesDroppedByLifetimeExpiration;
 
+    void AddPrioritiesToFrameLifetimeWheel(
+        const unsigned int priorityBitMask,
+        const SimTime& expirationTime);
 
+    void ScheduleFrameLifetimeWheelEvent(const SimTime& eventTime);
 
-inline
-void Dot11Mac::ReadInMulticastGroupNumberList(
-    const ParameterDatabaseReader& theParameterDatabaseReader)
-{
-    (*this).ipMulticastAddressToMacAddressMappingIsEnabled = false;
+    void ProcessFrameLifetimeWheelEvent();
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "map-ip-multicast-addresses"), theNodeId, theInterfaceId)) {
+    void DropExpiredFramesFromPrioritySubqueue(const PacketPriority& priority);
 
-        (*this).ipMulticastAddressToMacAddressMappingIsEnabled =
-            theParameterDatabaseReader.ReadBool(
-                (parameterNamePrefix + "map-ip-multicast-addresses"), theNodeId, theInterfaceId);
-    }//if//
+    void DropLifetimeExpiredFrame(
+        const unsigned int accessCategoryIndex,
+        unique_ptr<Packet>& packetPtr);
 
-    const string parameterName = parameterNamePrefix + "multicast-group-number-list";
+    //-------------------------------------------------------------------------
 
-    if (theParameterDatabaseReader.ParameterExists(parameterName, theNodeId, theInterfaceId)) {
+    SimTime mediumBecameIdleTime;
 
-        if (!ipMulticastAddressToMacAddressMappingIsEnabled) {
-            cerr << "Error: MAC multicast is used but "
-                 << (parameterNamePrefix + "map-ip-multicast-addresses") << " not enabled." << endl;
-            exit(1);
-        }//if//
+    struct AddressAndTrafficIdMapKey {
+        MacAddress transmitterAddress;
+        PacketPriority trafficId;
 
-        string multicastGroupNumberListString =
-            theParameterDatabaseReader.ReadString(parameterName, theNodeId, theInterfaceId);
+        AddressAndTrafficIdMapKey(
+            const MacAddress& initTransmitterAddress, const PacketPriority& initTrafficId)
+            :
+            transmitterAddress(initTransmitterAddress), trafficId(initTrafficId) {}
 
-        DeleteTrailingSpaces(multicastGroupNumberListString);
+        bool operator<(const AddressAndTrafficIdMapKey& right) const {
+            return ((transmitterAddress < right.transmitterAddress) ||
+                    ((transmitterAddress == right.transmitterAddress) && (trafficId < right.trafficId)));
+        }
+    };
 
-        istringstream listStream(multicastGroupNumberListString);
+    struct OutgoingLinkInfo {
+        unsigned short int outgoingSequenceNumber;
+        unsigned short int windowStartSequenceNumber;
+        // Frames at and before this sequence number will not be resent.
+        unsigned short int lastDroppedFrameSequenceNumber;
+        bool blockAckSessionIsEnabled;
+        bool blockAckRequestNeedsToBeSent;
 
-        while (!listStream.eof()) {
-            unsigned int multicastGroupNumber;
+        OutgoingLinkInfo() :
+            outgoingSequenceNumber(0),
+            lastDroppedFrameSequenceNumber(0),
+            windowStartSequenceNumber(0),
+            blockAckSessionIsEnabled(false),
+            blockAckRequestNeedsToBeSent(false) {}
+    };
 
-            listStream >> multicastGroupNumber;
+    map<AddressAndTrafficIdMapKey, OutgoingLinkInfo> outgoingLinkInfoMap;
 
-            if (listStream.fail()) {
-                cerr << "Error reading " << parameterName << " parameter:" << endl;
-                cerr << "   " << multicastGroupNumberListString << endl;
-                exit(1);
-            }//if//
+    struct NeighborCapabilities {
+        bool mpduFrameAggregationIsEnabled;
 
-            if (multicastGroupNumber > NetworkAddress::maxMulticastGroupNumber) {
-                cerr << "Error in " << parameterName << ": group number too large:" << endl;
-                cerr << "     " << multicastGroupNumberListString << endl;
-                exit(1);
-            }//if//
+        NeighborCapabilities() :
+            mpduFrameAggregationIsEnabled(false)
+        { }
+    };
 
-            MacAddress multicastMacAddress;
-            multicastMacAddress.SetToAMulticastAddress(multicastGroupNumber);
+    map<MacAddress, NeighborCapabilities> neighborCapabilitiesMap;
 
-            (*this).myMulticastMacAddresses.insert(multicastMacAddress);
+    // Statistics:
 
-        }//while//
-    }//if//
+    //dropped by exceeded retries
+    shared_ptr<CounterStatistic> droppedPacketsStatPtr;
 
-}//ReadInMulticastGroupNumberList//
+    //dropped by exceeded frame lifetime (per access category)
+    vector<shared_ptr<CounterStatistic> > lifetimeExpiredFramesDroppedStatPtrs;
 
+    // Per frame latency breakdown (optional):
+    // One latency stat per stage; the histogram is kept in fixed bins where
+    // bucket k counts latencies in [2^(k-1), 2^k) microseconds. Non-empty
+    // bins become counter stats at the end of the run.
 
-#pragma warning(disable:4355)
+    enum MacLatencyStageType {
+        QueueingLatencyStage,       // Enqueue to start of channel access.
+        ChannelAccessLatencyStage,  // AIFS + backoff (incl. busy medium) to backoff expiration.
+        SuspensionLatencyStage,     // Transmission suspended (channel switching) during channel access.
+        AirtimeLatencyStage,        // Backoff expiration to PHY transmission end.
+        NumberMacLatencyStages
+    };
 
-inline
-Dot11Mac::Dot11Mac(
-    const ParameterDatabaseReader& theParameterDatabaseReader,
-    const shared_ptr<SimulationEngineInterface>& simulationEngineInterfacePtr,
-    const NodeId& initNodeId,
-    const InterfaceId& initInterfaceId,
-    const unsigned int initInterfaceIndex,
-    const shared_ptr<NetworkLayer>& initNetworkLayerPtr,
-    const shared_ptr<Dot11Phy>& initPhysicalLayerPtr,
-    const RandomNumberGeneratorSeed& nodeSeed)
-    :
-    simEngineInterfacePtr(simulationEngineInterfacePtr),
-    theNodeId(initNodeId),
-    theInterfaceId(initInterfaceId),
-    operationMode(AdhocMode),
-    networkLayerPtr(initNetworkLayerPtr),
-    refreshNextHopOnDequeueModeIsOn(false),
-    interfaceIndex(initInterfaceIndex),
-    rtsThresholdSizeBytes(DefaultRtsThresholdSizeBytes),
-    shortFrameRetryLimit(DefaultShortFrameRetryLimit),
-    longFrameRetryLimit(DefaultLongFrameRetryLimit),
-    contentionWindowSlotsMin(DefaultContentionWindowSlotsMin),
-    contentionWindowSlotsMax(DefaultContentionWindowSlotsMax),
-    aShortInterframeSpaceTime(INFINITE_TIME),
-    aSlotTime(INFINITE_TIME),
-    aRxTxTurnaroundTime(INFINITE_TIME),
-    additionalDelayForExtendedInterframeSpaceMode(INFINITE_TIME),
-    maxPacketPriority(DefaultMaxPacketPriority),
-    numberAccessCategories(MaxNumberAccessCategories),
-    ackDatarateSelection(SameAsData),
-    macState(IdleState),
-    mediumReservedUntilTimeAkaNAV(ZERO_TIME),
-    mediumBecameIdleTime(ZERO_TIME),
-    currentWakeupTimerExpirationTime(INFINITE_TIME),
-    lastFrameReceivedWasCorrupt(false),
-    transmissionPermissionEndTime(INFINITE_TIME),
-    numSubframesReceivedFromCurrentAggregateFrame(0),
-    accessCategoryIndexForLastSentFrame(0),
+    static const unsigned int numberMacLatencyHistogramBuckets = 24;
+
+    struct MacLatencyBreakdownInfo {
+        SimTime channelAccessStartTime;
+        SimTime frameChannelAccessStartTime;
+        SimTime suspendedDuration;
+        SimTime phyStartTime;
+
+        shared_ptr<RealStatistic> latencyStatPtrs[NumberMacLatencyStages];
+        unsigned long long int histogramBinCounts[NumberMacLatencyStages][numberMacLatencyHistogramBuckets];
+
+        MacLatencyBreakdownInfo()
+            :
+            channelAccessStartTime(INFINITE_TIME),
+            frameChannelAccessStartTime(INFINITE_TIME),
+            suspendedDuration(ZERO_TIME),
+            phyStartTime(INFINITE_TIME)
+        {
+            for(unsigned int stage = 0; (stage < NumberMacLatencyStages); stage++) {
+                for(unsigned int bucket = 0; (bucket < numberMacLatencyHistogramBuckets); bucket++) {
+                    histogramBinCounts[stage][bucket] = 0;
+                }//for//
+            }//for//
+        }
+    };//MacLatencyBreakdownInfo//
+
+    bool macLatencyBreakdownIsEnabled;
+    SimTime transmissionSuspendedTime;
+    vector<MacLatencyBreakdownInfo> macLatencyBreakdownInfos;
+
+    static const char* GetMacLatencyStageName(const unsigned int latencyStage);
+
+    void CreateMacLatencyHistogramStats();
+    void OutputMacLatencyHistogramStats();
+
+    void RecordMacLatency(
+        const unsigned int accessCategoryIndex,
+        const MacLatencyStageType& latencyStage,
+        const SimTime& latency);
+
+    void StartMacLatencyChannelAccessIfNecessary(const unsigned int accessCategoryIndex);
+    void RecordMacLatencyForPacketDequeue(
+        const unsigned int accessCategoryIndex,
+        const SimTime& enqueueTime);
+    void RecordMacLatencyForBackoffExpiration(const unsigned int accessCategoryIndex);
+    void RecordMacLatencyForTransmissionEnd(const unsigned int accessCategoryIndex);
+
+    //data
+    shared_ptr<CounterStatistic> unicastDataFramesSentStatPtr;
+    shared_ptr<CounterStatistic> broadcastDataFramesSentStatPtr;
+    shared_ptr<CounterStatistic> unicastDataFramesResentStatPtr;
+    shared_ptr<CounterStatistic> dataFramesReceivedStatPtr;
+    shared_ptr<CounterStatistic> dataDuplicatedFramesReceivedStatPtr;
+
+    //control
+    shared_ptr<CounterStatistic> ackFramesSentStatPtr;
+    shared_ptr<CounterStatistic> ackFramesReceivedStatPtr;
+
+    // Aggregation, RTS/CTS, Block Ack and management frame counters are mostly unused
+    // (e.g. in OCB mode): their statistics can be disabled with
+    // "enable-optional-frame-statistics" and are then never created.
+
+    enum OptionalMacCounterType {
+        DataAggregateFramesSentCounter,
+        DataAggregateFramesResentCounter,
+        DataAggregatedSubframesReceivedCounter,
+        BlockAckFramesSentCounter,
+        BlockAckFramesReceivedCounter,
+        RtsFramesSentCounter,
+        RtsFramesReceivedCounter,
+        CtsFramesSentCounter,
+        CtsFramesReceivedCounter,
+        BeaconFramesSentCounter,
+        BeaconFramesReceivedCounter,
+        AssociationRequestFramesSentCounter,
+        AssociationRequestFramesReceivedCounter,
+        AssociationResponseFramesSentCounter,
+        AssociationResponseFramesReceivedCounter,
+        ReassociationRequestFramesSentCounter,
+        ReassociationRequestFramesReceivedCounter,
+        ReassociationResponseFramesSentCounter,
+        ReassociationResponseFramesReceivedCounter,
+        DisassociationFramesSentCounter,
+        DisassociationFramesReceivedCounter,
+        AuthenticationFramesSentCounter,
+        AuthenticationFramesReceivedCounter,
+        NumberOptionalMacCounters
+    };
+
+    shared_ptr<CounterStatistic> optionalMacCounterStatPtrs[NumberOptionalMacCounters];
+
+    static const char* GetOptionalMacCounterStatNameSuffix(const OptionalMacCounterType counterType)
+    {
+        static const char* const statNameSuffixes[NumberOptionalMacCounters] = {
+            "_Data_AggregateFramesSent",
+            "_Data_AggregateFramesResent",
+            "_Data_AggregatedSubframesReceived",
+            "_BlockACK_FramesSent",
+            "_BlockACK_FramesReceived",
+            "_RTS_FramesSent",
+            "_RTS_FramesReceived",
+            "_CTS_FramesSent",
+            "_CTS_FramesReceived",
+            "_Beacon_FramesSent",
+            "_Beacon_FramesReceived",
+            "_AssociationRequest_FramesSent",
+            "_AssociationRequest_FramesReceived",
+            "_AssociationResponse_FramesSent",
+            "_AssociationResponse_FramesReceived",
+            "_ReassociationRequest_FramesSent",
+            "_ReassociationRequest_FramesReceived",
+            "_ReassociationResponse_FramesSent",
+            "_ReassociationResponse_FramesReceived",
+            "_Disassociation_FramesSent",
+            "_Disassociation_FramesReceived",
+            "_Authentication_FramesSent",
+            "_Authentication_FramesReceived"
+        };
+
+        return (statNameSuffixes[counterType]);
+    }
+
+    void IncrementOptionalMacCounter(const OptionalMacCounterType counterType) const
+    {
+        const shared_ptr<CounterStatistic>& statPtr = optionalMacCounterStatPtrs[counterType];
+
+        if (statPtr != nullptr) {
+            statPtr->IncrementCounter();
+        }//if//
+    }
+
+    // Parallelism Stuff:
+
+    unsigned int lookaheadIndex;
+
+    //-------------------------------------------------------------------------
+
+
+    SimTime CalculateAdditionalDelayForExtendedInterframeSpace() const;
+
+    void AddPrioritiesToAnAccessCategory(
+        const string& prioritiesInAString,
+        const unsigned int accessCategoryIndex);
+
+
+    void InitializeAccessCategories(const ParameterDatabaseReader& theParameterDatabaseReader);
+
+    void ReadBondedChannelList(
+        const string& bondedChannelListString,
+        const string& parameterNameForErrorOutput,
+        vector<unsigned int>& bondedChannelList);
+
+    void ReadInMulticastGroupNumberList(const ParameterDatabaseReader& theParameterDatabaseReader);
+
+    void SetAccessCategoriesAsEdca(const ParameterDatabaseReader& theParameterDatabaseReader);
+    void SetAccessCategoriesAsDcf(const ParameterDatabaseReader& theParameterDatabaseReader);
+
+    bool WakeupTimerIsActive() const { return !wakeupTimerEventTicket.IsNull(); }
+
+    void ScheduleWakeupTimer(const SimTime& wakeupTime);
+    void CancelWakeupTimer();
+
+    bool FrameIsForThisNode(const Packet& aFrame) const;
+
+    bool AggregatedSubframeIsForThisNode(const Packet& frame) const;
+
+    // Note: returns accessCategories.size() when all backoffs are INFINITE_TIME.
+
+    unsigned int FindIndexOfAccessCategoryWithShortestBackoff() const;
+    unsigned int FindIndexOfAccessCategoryWithEarliestBackoffExpiration() const;
+
+    bool AccessCategoryIsActive(const unsigned int accessCategoryIndex) const;
+
+    bool ThereAreQueuedPacketsForAccessCategory(const unsigned int accessCategoryIndex) const;
+
+    bool NetworkLayerHasPacketForAccessCategory(const unsigned int accessCategoryIndex) const;
+
+    // First non-empty priority in the access category's priority list order.
+
+    bool FindNonEmptyPrioritySubqueueForAccessCategory(
+        const unsigned int accessCategoryIndex,
+        PacketPriority& priority) const;
+
+    void RetrievePacketFromNetworkLayerForAccessCategory(
+        const unsigned int accessCategoryIndex,
+        bool& wasRetrieved);
+
+    SimTime CurrentBackoffDuration() const;
+    SimTime CurrentBackoffExpirationTime() const;
+
+    void RecalcRandomBackoff(EdcaAccessCategoryInfo& accessCategoryInfo);
+
+    void StartBackoffIfNecessary();
+    void StartBackoffForCategory(const unsigned int accessCategoryIndex);
+
+    void StartPacketSendProcessForAnAccessCategory(
+        const unsigned int accessCategoryIndex,
+        const bool forceBackoff = false);
+
+    void PauseBackoffForAnAccessCategory(const unsigned int accessCategoryIndex, const SimTime& elapsedTime);
+
+    void SubtractElapsedTimeFromBackoffDuration(
+        const unsigned int accessCategoryIndex,
+        const SimTime& elapsedTime);
+
+    void PerformInternalCollisionBackoff(const unsigned int accessCategoryIndex);
+
+    void DoubleTheContentionWindowAndPickANewBackoff(const unsigned int accessCategoryIndex);
+
+    void UpdateContentionWindow(
+        const unsigned int accessCategoryIndex,
+        const ContentionWindowEventType& contentionWindowEvent);
+
+    SimTime CalculateFrameDuration(
+        const unsigned int frameWithMacHeaderSizeBytes,
+        const TransmissionParameters& txParameters) const;
+
+    SimTime CalculateFrameDurationWithoutPhyHeader(
+        const unsigned int frameWithMacHeaderSizeBytes,
+        const TransmissionParameters& txParameters) const;
+
+    SimTime CalculateControlFrameDuration(const unsigned int frameSizeBytes);
+
+    SimTime CalculateNonExtendedBackoffDuration(const EdcaAccessCategoryInfo& accessCategory) const;
+    SimTime CalculateNonExtendedDurationForJumpingOnMediumWithNoBackoff(const EdcaAccessCategoryInfo& accessCategory) const;
+
+    int NumberBackoffSlotsUsedDuringElapsedTime(
+        const EdcaAccessCategoryInfo& accessCategory,
+        const SimTime& elapsedTime) const;
+
+    void GoIntoWaitForExpirationOfVirtualCarrierSenseAkaNavState();
+
+    SimTime CalculateNavDurationForRtsFrame(
+        const MacAddress& destinationMacAddress,
+        const unsigned int packetSizeBytes,
+        const TransmissionParameters& txParameters) const;
+
+    SimTime CalculateNavDurationForCtsFrame(
+        const DurationField& durationFromRtsFrame,
+        const MacAddress& destinationAddress) const;
+
+    SimTime CalculateNavDurationForAckedDataFrame(
+        const TransmissionParameters& txParameters) const;
+
+    SimTime CalculateNavDurationForAckedAggregateDataFrame(
+        const TransmissionParameters& txParameters) const;
+
+    SimTime CalculateNextFrameSequenceDuration(const unsigned int accessCategoryIndex) const;
+
+    void AddExtraNavDurationToPacketForNextFrameIfInATxop(
+        const unsigned int accessCategoryIndex,
+        const SimTime& frameTransmissionEndTime,
+        Packet& thePacket) const;
+
+    void CalculateAndSetTransmitOpportunityDurationAkaTxop(const size_t accessCategoryIndex);
+
+    bool FrameTransmissionDurationExceedsTransmissionPermissionEndTime(
+        const unsigned int& frameSizeBytes,
+        const TransmissionParameters& txParameters,
+        const SimTime& delayUntilTransmitting) const;
+
+    void TransmitAFrame(
+        const unsigned int accessCategoryIndex,
+        const bool doNotRequestToSendAkaRts,
+        const SimTime& delayUntilTransmitting,
+        bool& packetHasBeenSentToPhy);
+
+    void TransmitAnAggregateFrame(
+        const unsigned int accessCategoryIndex,
+        const TransmissionParameters& txParameters,
+        const double& transmitPowerDbm,
+        const SimTime& delayUntilTransmitting);
+
+    void TransmitABlockAckRequest(
+        const MacAddress& destinationAddress,
+        const PacketPriority& trafficId,
+        const SimTime& delayUntilTransmitting);
+
+    void DropCurrentPacketAndGoToNextPacket(const unsigned int accessCategoryIndex);
+    void DropCurrentAggregateFrameAndGoToNextPacket(const unsigned int accessCategoryIndex);
+
+    void NeverReceivedClearToSendOrAcknowledgementAction();
+
+    void ProcessRequestToSendFrame(
+        const RequestToSendFrame& rtsFrame,
+        const TransmissionParameters& receivedFrameTxParameters);
+
+    void ProcessClearToSendFrame(const ClearToSendFrame& ctsFrame);
+
+    void ProcessDataFrame(
+        const Packet& dataFrame,
+        const TransmissionParameters& receivedFrameTxParameters);
+
+    void ProcessManagementFrame(
+        const Packet& managementFrame,
+        const TransmissionParameters& receivedFrameTxParameters);
+
+    void ProcessNullFrame(
+        const Packet& nullFrame,
+        const TransmissionParameters& receivedFrameTxParameters);
+
+    void ProcessAcknowledgementFrame(const AcknowledgementAkaAckFrame& ackFrame);
+
+    void ProcessBlockAckRequestFrame(
+        const BlockAcknowledgementRequestFrame& blockAckRequestFrame,
+        const TransmissionParameters& receivedFrameTxParameters);
+
+    void ProcessBlockAckFrame(const BlockAcknowledgementFrame& blockAckFrame);
+
+    unique_ptr<Packet> CreateABlockAckRequestFrame(
+        const MacAddress& destinationAddress,
+        const PacketPriority& trafficId,
+        const unsigned short int startFrameSequenceNumber) const;
+
+    void ProcessPowerSavePollFrame(
+        const PowerSavePollFrame& psPollFrame,
+        const TransmissionParameters& pollFrameTxParameters);
+
+    void SendAckFrame(
+        const MacAddress& destinationAddress,
+        const TransmissionParameters& receivedFrameTxParameters);
+
+    void ProcessWakeupTimerEvent();
+    void ProcessVirtualCarrierSenseAkaNavExpiration();
+    void ProcessInterframeSpaceAndBackoffTimeout();
+    void ProcessClearToSendOrAcknowledgementTimeout();
+
+    void GetNewSequenceNumber(
+        const MacAddress& destinationAddress,
+        const PacketPriority& priority,
+        const bool isNonBlockAckedFrame,
+        unsigned short int& newSequenceNumber);
+
+    unsigned int CalcNumberFramesLeftInSequenceNumWindow(
+        const MacAddress& destinationAddress,
+        const PacketPriority& priority) const;
+
+    void SetSequenceNumberWindowStart(
+        const MacAddress& destinationAddress,
+        const PacketPriority& priority,
+        const unsigned short int sequenceNum);
+
+    bool BlockAckSessionIsEnabled(
+        const MacAddress& destinationAddress,
+        const PacketPriority& priority) const;
+
+    void CheckPriorityToAccessCategoryMapping() const;
+
+    void QueueOutgoingEthernetPacket(unique_ptr<Packet>& ethernetPacketPtr);
+    void QueueOutgoingPacket(
+        unique_ptr<Packet>& packetPtr,
+        const NetworkAddress& nextHopAddress,
+        const PacketPriority priority);
+
+    // Phy interface routines
+
+    void BusyChannelAtPhysicalLayerNotification();
+    void ClearChannelAtPhysicalLayerNotification();
+    void TransmissionIsCompleteNotification();
+    void DoSuccessfulTransmissionPostProcessing(const bool wasJustTransmitting);
+
+    void ReceiveFrameFromPhy(
+        const Packet& aFrame,
+        const TransmissionParameters& receivedFrameTxParameters);
+
+    void ReceiveAggregatedSubframeFromPhy(
+        unique_ptr<Packet>& subframePtr,
+        const TransmissionParameters& receivedFrameTxParameters,
+        const unsigned int aggregateFrameSubframeIndex,
+        const unsigned int numberSubframes);
+
+    void NotifyThatPhyReceivedCorruptedFrame();
+
+    void NotifyThatPhyReceivedCorruptedAggregatedSubframe(
+        const TransmissionParameters& receivedFrameTxParameters,
+        const unsigned int aggregateFrameSubframeIndex,
+        const unsigned int numberSubframes);
+
+    class InterfaceForPhy : public Dot11MacInterfaceForPhy {
+    public:
+        InterfaceForPhy(Dot11Mac* initMacLayerPtr) : macLayerPtr(initMacLayerPtr) { }
+
+        virtual void BusyChannelAtPhysicalLayerNotification() override
+            { macLayerPtr->BusyChannelAtPhysicalLayerNotification(); }
+
+        virtual void ClearChannelAtPhysicalLayerNotification() override
+            { macLayerPtr->ClearChannelAtPhysicalLayerNotification(); }
+
+        virtual void TransmissionIsCompleteNotification() override
+            { macLayerPtr->TransmissionIsCompleteNotification(); }
+
+        virtual void DoSuccessfulTransmissionPostProcessing(const bool wasJustTransmitting) override
+            { macLayerPtr->DoSuccessfulTransmissionPostProcessing(wasJustTransmitting); }
+
+        virtual void ReceiveFrameFromPhy(
+            const Packet& aFrame,
+            const TransmissionParameters& receivedFrameTxParameters) override
+        {
+            macLayerPtr->ReceiveFrameFromPhy(aFrame, receivedFrameTxParameters);
+        }
+
+        virtual void ReceiveAggregatedSubframeFromPhy(
+            unique_ptr<Packet>& subframePtr,
+            const TransmissionParameters& receivedFrameTxParameters,
+            const unsigned int aggregateFrameSubframeIndex,
+            const unsigned int numberSubframes) override
+        {
+            macLayerPtr->ReceiveAggregatedSubframeFromPhy(
+                subframePtr, receivedFrameTxParameters, aggregateFrameSubframeIndex, numberSubframes);
+        }
+
+
+        virtual void NotifyThatPhyReceivedCorruptedFrame() override
+            { macLayerPtr->NotifyThatPhyReceivedCorruptedFrame(); }
+
+
+        virtual void NotifyThatPhyReceivedCorruptedAggregatedSubframe(
+            const TransmissionParameters& receivedFrameTxParameters,
+            const unsigned int aggregateFrameSubframeIndex,
+            const unsigned int numberSubframes) override
+        {
+            macLayerPtr->NotifyThatPhyReceivedCorruptedAggregatedSubframe(
+                receivedFrameTxParameters, aggregateFrameSubframeIndex, numberSubframes);
+        }
+
+        bool AggregatedSubframeIsForThisNode(const Packet& frame) const override
+            { return (macLayerPtr->AggregatedSubframeIsForThisNode(frame)); }
+
+    private:
+        Dot11Mac* macLayerPtr;
+
+    };//InterfaceForPhy//
+
+    bool FrameAggregationIsEnabledFor(const MacAddress& destinationAddress) const;
+    bool MpduFrameAggregationIsEnabledFor(const MacAddress& destinationAddress) const;
+
+    bool NeedToSendABlockAckRequest(
+        const MacAddress& destinationAddress,
+        const PacketPriority& trafficId) const;
+
+    void BuildAggregateFrameFromCurrentFrame(const unsigned int accessCategoryIndex);
+
+    void AllocateAggregateFrameContainer(EdcaAccessCategoryInfo& accessCategoryInfo) const;
+    void RecycleAggregateFrameContainer(EdcaAccessCategoryInfo& accessCategoryInfo) const;
+
+    void SendPacketToNetworkLayer(unique_ptr<Packet>& dataFramePtr);
+
+    void SendBlockAcknowledgementFrame(
+        const MacAddress& destinationAddress,
+        const PacketPriority& trafficId,
+        const TransmissionParameters& receivedFrameTxParameters);
+
+    //For trace output
+
+    void OutputTraceForClearChannel() const;
+    void OutputTraceForBusyChannel() const;
+    void OutputTraceForNavStart(const SimTime& expirationTime) const;
+    void OutputTraceForNavExpiration() const;
+
+    void OutputTraceForIfsAndBackoffStart(const SimTime& expirationTime) const;
+    void OutputTraceForInterruptedIfsAndBackoff(
+        const unsigned int accessCategoryIndex,
+        const SimTime nonExtendedDurationLeft) const;
+    void OutputTraceForIfsAndBackoffExpiration() const;
+
+    void OutputTraceAndStatsForFrameReceive(const Packet& aFrame) const;
+
+    void OutputTraceAndStatsForAggregateSubframeReceive(
+        const Packet& aFrame,
+        const QosDataFrameHeader& dataFrameHeader);
+
+    void OutputTraceForPacketDequeue(const unsigned int accessCategoryIndex,  const SimTime delayUntilAirBorne = 0) const;
+
+    void OutputTraceAndStatsForRtsFrameTransmission(const unsigned int accessCategoryIndex) const;
+    void OutputTraceForCtsFrameTransmission() const;
+    void OutputTraceAndStatsForAggregatedFrameTransmission(const unsigned int accessCategoryIndex) const;
+    void OutputTraceAndStatsForBroadcastDataFrameTransmission(const unsigned int accessCategoryIndex) const;
+    void OutputTraceAndStatsForUnicastDataFrameTransmission(const unsigned int accessCategoryIndex) const;
+    void OutputTraceAndStatsForManagementFrameTransmission(const unsigned int accessCategoryIndex) const;
+    void OutputTraceForAckFrameTransmission() const;
+    void OutputTraceAndStatsForBlockAckFrameTransmission() const;
+
+    void OutputTraceForCtsOrAckTimeout() const;
+
+    void OutputTraceAndStatsForPacketRetriesExceeded(const unsigned int accessCategoryIndex) const;
+    bool redundantTraceInformationModeIsOn;
+
+    MacTraceFilter macTraceFilter;
+
+    bool MacTraceIsOn() const
+    {
+        return ((simEngineInterfacePtr->TraceIsOn(TraceMac)) &&
+                (macTraceFilter.IsOn(simEngineInterfacePtr->CurrentTime())));
+    }
+
+    bool MacTraceIsOn(const unsigned int accessCategoryIndex) const
+    {
+        return ((simEngineInterfacePtr->TraceIsOn(TraceMac)) &&
+                (macTraceFilter.IsOn(simEngineInterfacePtr->CurrentTime(), accessCategoryIndex)));
+    }
+
+};//Dot11Mac//
+
+//デフォルトのContentionwindowなどの値
+const unsigned int DefaultRtsThresholdSizeBytes = UINT_MAX;
+const unsigned int DefaultShortFrameRetryLimit = 7;
+const unsigned int DefaultLongFrameRetryLimit = 4;
+const unsigned int DefaultContentionWindowSlotsMin = 15;
+const unsigned int DefaultContentionWindowSlotsMax = 1023;
+const PacketPriority DefaultMaxPacketPriority = 3;
+
+inline
+SimTime Dot11Mac::CalculateAdditionalDelayForExtendedInterframeSpace() const
+{
+    TransmissionParameters txParameters;
+    txParameters.channelBandwidthMhz = physicalLayerPtr->GetBaseChannelBandwidthMhz();
+
+    txParameters.modulationAndCodingScheme =
+        theAdaptiveRateControllerPtr->GetLowestModulationAndCoding();
+
+    SimTime longestPossibleAckDuration =
+        CalculateFrameDuration(sizeof(AcknowledgementAkaAckFrame), txParameters);
+
+    return (aShortInterframeSpaceTime + longestPossibleAckDuration);
+
+}//CalculateAdditionalDelayForExtendedInterframeSpace//
+
+
+
+inline
+void Dot11Mac::AddPrioritiesToAnAccessCategory(
+    const string& prioritiesInAString,
+    const unsigned int accessCategoryIndex)
+{
+    bool success;
+    vector<PacketPriority> priorityVector;
+
+    ConvertAStringSequenceOfANumericTypeIntoAVector<PacketPriority>(
+        prioritiesInAString,
+        success,
+        priorityVector);
+
+    if (!success) {
+        cerr << "Error: Configuration: Bad Priority sequence: " << prioritiesInAString << endl;
+        exit(1);
+    }//if//
+
+    EdcaAccessCategoryInfo& accessCategory = accessCategories.at(accessCategoryIndex);
+
+    accessCategory.listOfPriorities.clear();
+
+    for(unsigned int i = 0; (i < priorityVector.size()); i++) {
+        accessCategory.listOfPriorities.push_back(priorityVector[i]);
+    }//for//
+
+}//AddPrioritiesToAnAccessCategory//
+
+inline
+void Dot11Mac::CheckPriorityToAccessCategoryMapping() const
+{
+    for(PacketPriority priority = 0; (priority <= maxPacketPriority); priority++) {
+        bool found = false;
+        for(unsigned int cat = 0; (cat < numberAccessCategories); cat++) {
+            for(unsigned int i = 0; (i < accessCategories[cat].listOfPriorities.size()); i++) {
+                if (priority == accessCategories[cat].listOfPriorities[i]) {
+                    if (found) {
+                        cerr << "Error: Duplicate access category to priority mapping for "
+                             << "priority = " << priority << endl;
+                        exit(1);
+                    }//if//
+                    found = true;
+                }//if//
+                if (accessCategories[cat].listOfPriorities[i] > maxPacketPriority) {
+                    cerr << "Error: Unexpected priority mapping for "
+                         << "priority = " << int(accessCategories[cat].listOfPriorities[i])
+                         << ", max priority = " << static_cast<int>(maxPacketPriority) << endl;
+                    exit(1);
+                }//if//
+            }//for//
+        }//for//
+        if (!found) {
+            cerr << "Error: No access category to priority mapping for priority = "
+                 << priority << endl;
+            exit(1);
+        }//if//
+    }//for//
+
+}//CheckPriorityToAccessCategoryMapping//
+
+
+
+
+inline
+void Dot11Mac::InitializeAccessCategories(const ParameterDatabaseReader& theParameterDatabaseReader)
+{
+    string qosTypeString = "edca";
+
+    if (theParameterDatabaseReader.ParameterExists(
+            "dot11-qos-type", theNodeId, theInterfaceId)) {
+
+        qosTypeString =  MakeLowerCaseString(
+            theParameterDatabaseReader.ReadString("dot11-qos-type", theNodeId, theInterfaceId));
+
+    }//if//
+
+    if (qosTypeString == "edca") {
+        (*this).SetAccessCategoriesAsEdca(theParameterDatabaseReader);
+    }
+    else if (qosTypeString == "dcf") {
+        (*this).SetAccessCategoriesAsDcf(theParameterDatabaseReader);
+    }
+    else {
+        cerr << "Error: Unknown dot11-qos-type: " << qosTypeString << endl;
+        exit(1);
+    }//if//
+
+    CheckPriorityToAccessCategoryMapping();
+
+    accessCategoryIndexForPriority.assign(maxPacketPriority + 1, 0);
+    allPrioritiesBitMask = 0;
+
+    for(unsigned int i = 0; (i < accessCategories.size()); i++) {
+        EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[i];
+
+        accessCategoryInfo.currentContentionWindowSlots = accessCategoryInfo.minContentionWindowSlots;
+
+        if (accessCategoryInfo.contentionWindowControllerPtr == nullptr) {
+            accessCategoryInfo.contentionWindowControllerPtr.reset(
+                new BinaryExponentialContentionWindowController());
+        }//if//
+
+        accessCategoryInfo.priorityBitMask = 0;
+        for(unsigned int j = 0; (j < accessCategoryInfo.listOfPriorities.size()); j++) {
+            const PacketPriority priority = accessCategoryInfo.listOfPriorities[j];
+
+            accessCategoryInfo.priorityBitMask |= (1U << priority);
+            accessCategoryIndexForPriority[priority] = i;
+        }//for//
+
+        allPrioritiesBitMask |= accessCategoryInfo.priorityBitMask;
+    }//for//
+
+    possiblyNonEmptyPriorityBitMask = allPrioritiesBitMask;
+
+    accessCategoryIndexForManagementFrames = static_cast<unsigned int>(accessCategories.size() - 1);
+
+}//InitializeAccessCategories//
+
+//EDCAの時はここを通る.
+inline
+void Dot11Mac::SetAccessCategoriesAsEdca(const ParameterDatabaseReader& theParameterDatabaseReader)
+{
+    // Set defaults for WAVE.  Maybe overidden.
+
+    accessCategories.clear();
+    accessCategories.resize(4);
+
+    //仮
+    //cout << "SetAccessCategories" << endl;
+    //最初通る
+
+    //デフォルトのコンテンションウィンドウ
+    accessCategories.at(0).minContentionWindowSlots = contentionWindowSlotsMin;
+    accessCategories.at(0).maxContentionWindowSlots = contentionWindowSlotsMax;
+    accessCategories.at(0).arbitrationInterframeSpaceDurationSlots = 9;
+
+    accessCategories.at(1).minContentionWindowSlots = (contentionWindowSlotsMin+1)/2 - 1;
+    accessCategories.at(1).maxContentionWindowSlots = contentionWindowSlotsMax;
+    accessCategories.at(1).arbitrationInterframeSpaceDurationSlots = 6;
+
+    accessCategories.at(2).minContentionWindowSlots = (contentionWindowSlotsMin+1)/4 - 1;
+    accessCategories.at(2).maxContentionWindowSlots = (contentionWindowSlotsMin+1)/2 - 1;
+    accessCategories.at(2).arbitrationInterframeSpaceDurationSlots = 3;
+
+    accessCategories.at(3).minContentionWindowSlots = (contentionWindowSlotsMin+1)/4 - 1;
+    accessCategories.at(3).maxContentionWindowSlots = (contentionWindowSlotsMin+1)/2 - 1;
+    accessCategories.at(3).arbitrationInterframeSpaceDurationSlots = 2;
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "num-edca-access-categories"), theNodeId, theInterfaceId)) {
+
+        numberAccessCategories =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                (parameterNamePrefix + "num-edca-access-categories"),
+                theNodeId,
+                theInterfaceId);
+
+        if (numberAccessCategories > MaxNumberAccessCategories) {
+            cerr << "Error: the number of 802.11 access categories is greater than: "
+                 << MaxNumberAccessCategories << endl;
+            exit(1);
+        }//if//
+
+        accessCategories.resize(numberAccessCategories);
+
+    }//if//
+
+    assert(maxPacketPriority == 3);
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "max-packet-priority"), theNodeId, theInterfaceId)) {
+
+        unsigned int readMaxPacketPriority =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                (parameterNamePrefix + "max-packet-priority"),
+                theNodeId,
+                theInterfaceId);
+
+        if (readMaxPacketPriority > 7) {
+            cerr << "Error in parameter \"" << (parameterNamePrefix + "max-packet-priority")
+                 << "\",  maximum 802.11 priority is 7." << endl;
+            exit(1);
+        }//if//
+
+        maxPacketPriority = static_cast<PacketPriority>(readMaxPacketPriority);
+
+    }//if//
+
+
+    // Default simple priority mapping: Distribute priorities across categories,
+    // excess priorities in the front (low priority access categories).
+
+    //?????
+
+    const unsigned int minPriPerCategory = (maxPacketPriority+1) / numberAccessCategories;
+    //priority / accessCategory
+
+    assert(minPriPerCategory >= 1);
+
+    const unsigned int excessPriorities = (maxPacketPriority+1) % numberAccessCategories;
+    //余剰priority??
+
+    PacketPriority priority = 0;
+    for(unsigned int i = 0; (i < numberAccessCategories); i++) {
+        unsigned int numberPriorities = minPriPerCategory;
+        if (i < excessPriorities) {
+            numberPriorities++;
+        }//if//
+
+        for(unsigned int j = 0; (j < numberPriorities); j++) {
+            accessCategories[i].listOfPriorities.push_back(priority);
+            //push_backは末尾に要素を追加する.
+            priority++;
+        }//for//
+    }//for//
+
+
+    // Override defaults if parameters exist.
+
+    for(unsigned int i = 0; (i < accessCategories.size()); i++) {
+        const EdcaCategoryParameterNames& parameterNames = GetEdcaCategoryParameterNames(i);
+        const string& prefix = parameterNames.prefix;
+
+        if (theParameterDatabaseReader.ParameterExists(parameterNames.numAifsSlots, theNodeId, theInterfaceId)) {
+            accessCategories[i].arbitrationInterframeSpaceDurationSlots =
+                theParameterDatabaseReader.ReadNonNegativeInt(
+                    parameterNames.numAifsSlots, theNodeId, theInterfaceId);
+        }//if//
+
+        //contentionwindowをobjtypeの設定から読み取っていく
+
+        if (theParameterDatabaseReader.ParameterExists(parameterNames.contentionWindowMinSlots, theNodeId, theInterfaceId)) {
+            accessCategories[i].minContentionWindowSlots =
+                theParameterDatabaseReader.ReadNonNegativeInt(
+                    parameterNames.contentionWindowMinSlots, theNodeId, theInterfaceId);
+        }//if//
+
+        if (theParameterDatabaseReader.ParameterExists(parameterNames.contentionWindowMaxSlots, theNodeId, theInterfaceId)) {
+            accessCategories[i].maxContentionWindowSlots =
+                theParameterDatabaseReader.ReadNonNegativeInt(
+                    parameterNames.contentionWindowMaxSlots, theNodeId, theInterfaceId);
+        }//if//
+
+        //objtypeのpriorityを読み込んでいる.
+        if (theParameterDatabaseReader.ParameterExists(parameterNames.priorityList, theNodeId, theInterfaceId)) {
+            string prioritiesInAString =
+                theParameterDatabaseReader.ReadString(parameterNames.priorityList, theNodeId, theInterfaceId);
+            DeleteTrailingSpaces(prioritiesInAString);
+            (*this).AddPrioritiesToAnAccessCategory(prioritiesInAString, i);
+        }//if//
+
+        if (theParameterDatabaseReader.ParameterExists(parameterNames.frameLifetime, theNodeId, theInterfaceId)) {
+            accessCategories[i].frameLifetime =
+                theParameterDatabaseReader.ReadTime(parameterNames.frameLifetime, theNodeId, theInterfaceId);
+        }//if//
+
+        if (theParameterDatabaseReader.ParameterExists(
+            parameterNames.contentionWindowController, theNodeId, theInterfaceId)) {
+
+            const string controllerName =
+                MakeLowerCaseString(
+                    theParameterDatabaseReader.ReadString(
+                        parameterNames.contentionWindowController, theNodeId, theInterfaceId));
+
+            if (controllerName == "binaryexponential") {
+                accessCategories[i].contentionWindowControllerPtr.reset(
+                    new BinaryExponentialContentionWindowController());
+            }
+            else if (controllerName == "channelbusyratio") {
+                double lowBusyRatio = 0.3;
+                double highBusyRatio = 0.8;
+
+                if (theParameterDatabaseReader.ParameterExists(
+                    parameterNames.contentionWindowControllerLowBusyRatio, theNodeId, theInterfaceId)) {
+
+                    lowBusyRatio =
+                        theParameterDatabaseReader.ReadDouble(
+                            parameterNames.contentionWindowControllerLowBusyRatio, theNodeId, theInterfaceId);
+                }//if//
+
+                if (theParameterDatabaseReader.ParameterExists(
+                    parameterNames.contentionWindowControllerHighBusyRatio, theNodeId, theInterfaceId)) {
+
+                    highBusyRatio =
+                        theParameterDatabaseReader.ReadDouble(
+                            parameterNames.contentionWindowControllerHighBusyRatio, theNodeId, theInterfaceId);
+                }//if//
+
+                if (lowBusyRatio >= highBusyRatio) {
+                    cerr << "Error: " << prefix << "contention-window-controller-low-busy-ratio must be less than "
+                         << prefix << "contention-window-controller-high-busy-ratio." << endl;
+                    exit(1);
+                }//if//
+
+                accessCategories[i].contentionWindowControllerPtr.reset(
+                    new ChannelBusyRatioContentionWindowController(lowBusyRatio, highBusyRatio));
+            }
+            else {
+                cerr << "Error: Unknown " << prefix << "contention-window-controller: " << controllerName << endl;
+                exit(1);
+            }//if//
+        }//if//
+
+    }//for//
+
+}//SetAccessCategoriesAsEdca//
+
+
+inline
+void Dot11Mac::SetAccessCategoriesAsDcf(const ParameterDatabaseReader& theParameterDatabaseReader)
+{
+    //Set defaults for DCF. Maybe overidden.
+
+    accessCategories.clear();
+    accessCategories.resize(1);
+
+    EdcaAccessCategoryInfo& accessCategoryForDcf = accessCategories.at(0);
+    accessCategoryForDcf.minContentionWindowSlots = contentionWindowSlotsMin;
+    accessCategoryForDcf.maxContentionWindowSlots = contentionWindowSlotsMax;
+    accessCategoryForDcf.arbitrationInterframeSpaceDurationSlots = 2;
+
+    numberAccessCategories = 1;
+    maxPacketPriority = 0;
+
+    accessCategoryForDcf.listOfPriorities.push_back(0);
+
+    // Override defaults if parameters exist.
+
+    if (theParameterDatabaseReader.ParameterExists("dot11-dcf-num-difs-slots", theNodeId, theInterfaceId)) {
+        accessCategoryForDcf.arbitrationInterframeSpaceDurationSlots =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                "dot11-dcf-num-difs-slots", theNodeId, theInterfaceId);
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists("dot11-dcf-contention-window-min-slots", theNodeId, theInterfaceId)) {
+        accessCategoryForDcf.minContentionWindowSlots  =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                "dot11-dcf-contention-window-min-slots", theNodeId, theInterfaceId);
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists("dot11-dcf-contention-window-max-slots", theNodeId, theInterfaceId)) {
+        accessCategoryForDcf.maxContentionWindowSlots =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                "dot11-dcf-contention-window-max-slots", theNodeId, theInterfaceId);
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists("dot11-dcf-frame-lifetime", theNodeId, theInterfaceId)) {
+        accessCategoryForDcf.frameLifetime =
+            theParameterDatabaseReader.ReadTime("dot11-dcf-frame-lifetime", theNodeId, theInterfaceId);
+    }//if//
+
+}//SetAccessCategoriesAsDcf//
+
+
+inline
+void Dot11Mac::ReadBondedChannelList(
+    const string& bondedChannelListString,
+    const string& parameterNameForErrorOutput,
+    vector<unsigned int>& bondedChannelList)
+{
+    bool success;
+    ConvertAStringSequenceOfANumericTypeIntoAVector<unsigned int>(
+        bondedChannelListString,
+        success,
+        bondedChannelList);
+
+    if ((!success) || (bondedChannelList.empty())) {
+        cerr << "Error in configuration parameter: " << parameterNameForErrorOutput << ":" << endl;
+        cerr << "     " << bondedChannelListString << endl;
+        exit(1);
+    }//if//
+
+    for(unsigned int i = 0; (i < bondedChannelList.size()); i++) {
+        if (bondedChannelList[i] >= GetNumberOfChannels()) {
+            cerr << "Error: invalid channel number: " << bondedChannelList[i] << endl;
+            exit(1);
+        }//if//
+    }//for//
+
+}//InitBondedChannel//
+
+
+
+inline
+void Dot11Mac::ReadInMulticastGroupNumberList(
+    const ParameterDatabaseReader& theParameterDatabaseReader)
+{
+    (*this).ipMulticastAddressToMacAddressMappingIsEnabled = false;
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "map-ip-multicast-addresses"), theNodeId, theInterfaceId)) {
+
+        (*this).ipMulticastAddressToMacAddressMappingIsEnabled =
+            theParameterDatabaseReader.ReadBool(
+                (parameterNamePrefix + "map-ip-multicast-addresses"), theNodeId, theInterfaceId);
+    }//if//
+
+    const string parameterName = parameterNamePrefix + "multicast-group-number-list";
+
+    if (theParameterDatabaseReader.ParameterExists(parameterName, theNodeId, theInterfaceId)) {
+
+        if (!ipMulticastAddressToMacAddressMappingIsEnabled) {
+            cerr << "Error: MAC multicast is used but "
+                 << (parameterNamePrefix + "map-ip-multicast-addresses") << " not enabled." << endl;
+            exit(1);
+        }//if//
+
+        string multicastGroupNumberListString =
+            theParameterDatabaseReader.ReadString(parameterName, theNodeId, theInterfaceId);
+
+        DeleteTrailingSpaces(multicastGroupNumberListString);
+
+        istringstream listStream(multicastGroupNumberListString);
+
+        while (!listStream.eof()) {
+            unsigned int multicastGroupNumber;
+
+            listStream >> multicastGroupNumber;
+
+            if (listStream.fail()) {
+                cerr << "Error reading " << parameterName << " parameter:" << endl;
+                cerr << "   " << multicastGroupNumberListString << endl;
+                exit(1);
+            }//if//
+
+            if (multicastGroupNumber > NetworkAddress::maxMulticastGroupNumber) {
+                cerr << "Error in " << parameterName << ": group number too large:" << endl;
+                cerr << "     " << multicastGroupNumberListString << endl;
+                exit(1);
+            }//if//
+
+            MacAddress multicastMacAddress;
+            multicastMacAddress.SetToAMulticastAddress(multicastGroupNumber);
+
+            (*this).myMulticastMacAddresses.insert(multicastMacAddress);
+
+        }//while//
+    }//if//
+
+}//ReadInMulticastGroupNumberList//
+
+
+#pragma warning(disable:4355)
+
+inline
+Dot11Mac::Dot11Mac(
+    const ParameterDatabaseReader& theParameterDatabaseReader,
+    const shared_ptr<SimulationEngineInterface>& simulationEngineInterfacePtr,
+    const NodeId& initNodeId,
+    const InterfaceId& initInterfaceId,
+    const unsigned int initInterfaceIndex,
+    const shared_ptr<NetworkLayer>& initNetworkLayerPtr,
+    const shared_ptr<Dot11Phy>& initPhysicalLayerPtr,
+    const RandomNumberGeneratorSeed& nodeSeed)
+    :
+    simEngineInterfacePtr(simulationEngineInterfacePtr),
+    theNodeId(initNodeId),
+    theInterfaceId(initInterfaceId),
+    operationMode(AdhocMode),
+    networkLayerPtr(initNetworkLayerPtr),
+    possiblyNonEmptyPriorityBitMask(0),
+    allPrioritiesBitMask(0),
+    refreshNextHopOnDequeueModeIsOn(false),
+    interfaceIndex(initInterfaceIndex),
+    rtsThresholdSizeBytes(DefaultRtsThresholdSizeBytes),
+    shortFrameRetryLimit(DefaultShortFrameRetryLimit),
+    longFrameRetryLimit(DefaultLongFrameRetryLimit),
+    contentionWindowSlotsMin(DefaultContentionWindowSlotsMin),
+    contentionWindowSlotsMax(DefaultContentionWindowSlotsMax),
+    aShortInterframeSpaceTime(INFINITE_TIME),
+    aSlotTime(INFINITE_TIME),
+    aRxTxTurnaroundTime(INFINITE_TIME),
+    additionalDelayForExtendedInterframeSpaceMode(INFINITE_TIME),
+    maxPacketPriority(DefaultMaxPacketPriority),
+    numberAccessCategories(MaxNumberAccessCategories),
+    ackDatarateSelection(SameAsData),
+    macState(IdleState),
+    mediumReservedUntilTimeAkaNAV(ZERO_TIME),
+    frameLifetimeWheelIsEnabled(false),
+    frameLifetimeWheelSlotDuration(ZERO_TIME),
+    frameLifetimeWheelEventTime(INFINITE_TIME),
+    mediumBecameIdleTime(ZERO_TIME),
+    currentWakeupTimerExpirationTime(INFINITE_TIME),
+    lastFrameReceivedWasCorrupt(false),
+    transmissionPermissionEndTime(INFINITE_TIME),
+    heldAccessCategoryRestartIsEnabled(false),
+    heldAccessCategoryBitMask(0),
+    numSubframesReceivedFromCurrentAggregateFrame(0),
+    accessCategoryIndexForLastSentFrame(0),
     currentTransmitOpportunityAkaTxopStartTime(ZERO_TIME),
     currentTransmitOpportunityAkaTxopEndTime(ZERO_TIME),
     currentTransmitOpportunityAckedFrameCount(0),
@@ -1665,11 +2674,16 @@ Dot11Mac::Dot11Mac(
     maxAggregateMpduSizeBytes(0),
     ipMulticastAddressToMacAddressMappingIsEnabled(false),
     physicalLayerPtr(initPhysicalLayerPtr),
+    physicalChannelIsBusy(false),
+    physicalChannelBusyStartTime(ZERO_TIME),
+    accumulatedPhysicalChannelBusyDuration(ZERO_TIME),
     aRandomNumberGenerator(
         HashInputsToMakeSeed(nodeSeed, initInterfaceIndex)),
     droppedPacketsStatPtr(
         simulationEngineInterfacePtr->CreateCounterStat(
             (modelName + '_' + theInterfaceId + "_FramesDropped"))),
+    macLatencyBreakdownIsEnabled(false),
+    transmissionSuspendedTime(INFINITE_TIME),
     unicastDataFramesSentStatPtr(
         simulationEngineInterfacePtr->CreateCounterStat(
             (modelName + '_' + theInterfaceId + "_Data_UnicastFramesSent"))),
@@ -1682,15 +2696,6 @@ Dot11Mac::Dot11Mac(
     dataFramesReceivedStatPtr(
         simulationEngineInterfacePtr->CreateCounterStat(
             (modelName + '_' + theInterfaceId + "_Data_FramesReceived"))),
-    dataAggregateFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_Data_AggregateFramesSent"))),
-    dataAggregateFramesResentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_Data_AggregateFramesResent"))),
-    dataAggregatedSubframesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_Data_AggregatedSubframesReceived"))),
     dataDuplicatedFramesReceivedStatPtr(
         simulationEngineInterfacePtr->CreateCounterStat(
             (modelName + '_' + theInterfaceId + "_Data_DuplicatedFramesReceived"))),
@@ -1699,1752 +2704,2393 @@ Dot11Mac::Dot11Mac(
             (modelName + '_' + theInterfaceId + "_ACK_FramesSent"))),
     ackFramesReceivedStatPtr(
         simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_ACK_FramesReceived"))),
-    blockAckFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_BlockACK_FramesSent"))),
-    blockAckFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_BlockACK_FramesReceived"))),
-    rtsFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_RTS_FramesSent"))),
-    rtsFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_RTS_FramesReceived"))),
-    ctsFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_CTS_FramesSent"))),
-    ctsFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_CTS_FramesReceived"))),
-    beaconFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_Beacon_FramesSent"))),
-    beaconFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_Beacon_FramesReceived"))),
-    associationRequestFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_AssociationRequest_FramesSent"))),
-    associationRequestFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_AssociationRequest_FramesReceived"))),
-    associationResponseFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_AssociationResponse_FramesSent"))),
-    associationResponseFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_AssociationResponse_FramesReceived"))),
-    reassociationRequestFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_ReassociationRequest_FramesSent"))),
-    reassociationRequestFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_ReassociationRequest_FramesReceived"))),
-    reassociationResponseFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_ReassociationResponse_FramesSent"))),
-    reassociationResponseFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_ReassociationResponse_FramesReceived"))),
-    disassociationFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_Disassociation_FramesSent"))),
-    disassociationFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_Disassociation_FramesReceived"))),
-    authenticationFramesSentStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_Authentication_FramesSent"))),
-    authenticationFramesReceivedStatPtr(
-        simulationEngineInterfacePtr->CreateCounterStat(
-            (modelName + '_' + theInterfaceId + "_Authentication_FramesReceived")))
+            (modelName + '_' + theInterfaceId + "_ACK_FramesReceived")))
+{
+    physicalLayerPtr->SetMacInterfaceForPhy((*this).CreateInterfaceForPhy());
+
+    shared_ptr<NetworkInterfaceManager> networkInterfaceManagerPtr =
+        networkLayerPtr->GetNetworkInterfaceManagerPtr(interfaceIndex);
+
+    if (networkInterfaceManagerPtr != nullptr) {
+        theMacAddressResolverPtr.reset(
+            networkInterfaceManagerPtr->CreateMacAddressResolver());
+    }//if//
+
+    if (theMacAddressResolverPtr.get() == nullptr) {
+        theMacAddressResolverPtr.reset(new SimpleMacAddressResolver(this));
+    }//if//
+
+    aShortInterframeSpaceTime = physicalLayerPtr->GetShortInterframeSpaceDuration();
+    aSlotTime = physicalLayerPtr->GetSlotDuration();
+    aRxTxTurnaroundTime = physicalLayerPtr->GetRxTxTurnaroundTime();
+    SimTime aPhyRxStartDelay = physicalLayerPtr->GetPhyRxStartDelay();
+    clearToSendTimeoutDuration = aShortInterframeSpaceTime + aSlotTime + aPhyRxStartDelay;
+    ackTimeoutDuration = clearToSendTimeoutDuration;
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "rts-threshold-size-bytes"), theNodeId, theInterfaceId)) {
+
+        rtsThresholdSizeBytes =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                (parameterNamePrefix + "rts-threshold-size-bytes"), theNodeId, theInterfaceId);
+
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "short-frame-retry-limit"), theNodeId, theInterfaceId)) {
+
+        shortFrameRetryLimit =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                (parameterNamePrefix + "short-frame-retry-limit"), theNodeId, theInterfaceId);
+
+        if (shortFrameRetryLimit < 1) {
+            cerr << "Error: "<< parameterNamePrefix
+                << "short-frame-retry-limit must be greater than or equal to 1: "
+                << shortFrameRetryLimit << endl;
+            exit(1);
+        }//if//
+
+    }//if//
+
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "long-frame-retry-limit"), theNodeId, theInterfaceId)) {
+
+        longFrameRetryLimit =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                (parameterNamePrefix + "long-frame-retry-limit"), theNodeId, theInterfaceId);
+
+        if (longFrameRetryLimit < 1) {
+            cerr << "Error: "<< parameterNamePrefix
+                << "long-frame-retry-limit must be greater than or equal to 1: "
+                << longFrameRetryLimit << endl;
+            exit(1);
+        }//if//
+
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "contention-window-min-slots"), theNodeId, theInterfaceId)) {
+
+        contentionWindowSlotsMin =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                (parameterNamePrefix + "contention-window-min-slots"), theNodeId, theInterfaceId);
+
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "contention-window-max-slots"), theNodeId, theInterfaceId)) {
+
+        contentionWindowSlotsMax =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                (parameterNamePrefix + "contention-window-max-slots"), theNodeId, theInterfaceId);
+
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "disabled-to-jump-on-medium-without-backoff"), theNodeId, theInterfaceId)) {
+
+        disabledToJumpOnMediumWithoutBackoff =
+            theParameterDatabaseReader.ReadBool(
+                (parameterNamePrefix + "disabled-to-jump-on-medium-without-backoff"), theNodeId, theInterfaceId);
+
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "max-aggregate-mpdu-size-bytes"), theNodeId, theInterfaceId)) {
+
+        maxAggregateMpduSizeBytes =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                (parameterNamePrefix + "max-aggregate-mpdu-size-bytes"), theNodeId, theInterfaceId);
+
+    }//if//
+
+    protectAggregateFramesWithSingleAckedFrame = true;
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "protect-aggregate-frames-with-single-acked-frame"), theNodeId, theInterfaceId)) {
+
+        protectAggregateFramesWithSingleAckedFrame =
+            theParameterDatabaseReader.ReadBool(
+                (parameterNamePrefix + "protect-aggregate-frames-with-single-acked-frame"),
+                theNodeId, theInterfaceId);
+    }//if//
+
+
+    allowFrameAggregationWithTxopZero = false;
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "allow-frame-aggregation-with-txop-zero"), theNodeId, theInterfaceId)) {
+
+        allowFrameAggregationWithTxopZero =
+            theParameterDatabaseReader.ReadBool(
+                (parameterNamePrefix + "allow-frame-aggregation-with-txop-zero"), theNodeId, theInterfaceId);
+
+    }//if//
+
+
+    const shared_ptr<SimplePropagationModelForNode<PropFrame> > propModelInterfacePtr =
+        physicalLayerPtr->GetPropModelInterface();
+
+    //rate controller
+    theAdaptiveRateControllerPtr =
+        CreateAdaptiveRateController(
+            simulationEngineInterfacePtr,
+            theParameterDatabaseReader,
+            theNodeId,
+            theInterfaceId,
+            physicalLayerPtr->GetBaseChannelBandwidthMhz());
+
+    theAdaptiveRateControllerPtr->SetModulationAndCondingMapForDatarateSpecifiedFrame(
+        physicalLayerPtr->GetModulationAndCodingShemeMap());
+
+    //power controller
+    theAdaptiveTxPowerControllerPtr =
+        CreateAdaptiveTxPowerController(
+            simulationEngineInterfacePtr,
+            theParameterDatabaseReader,
+            theNodeId,
+           physicalLayerPtr->GetInterfaceId());
+
+    additionalDelayForExtendedInterframeSpaceMode = CalculateAdditionalDelayForExtendedInterframeSpace();
+
+    (*this).InitializeAccessCategories(theParameterDatabaseReader);
+
+    wakeupTimerEventPtr = shared_ptr<WakeupTimerEvent>(new WakeupTimerEvent(this));
+
+    numberFramesDroppedByLifetimeExpiration.assign(accessCategories.size(), 0);
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "frame-lifetime-expiration-wheel-slot-duration"), theNodeId, theInterfaceId)) {
+
+        frameLifetimeWheelSlotDuration =
+            theParameterDatabaseReader.ReadTime(
+                (parameterNamePrefix + "frame-lifetime-expiration-wheel-slot-duration"), theNodeId, theInterfaceId);
+
+        if (frameLifetimeWheelSlotDuration <= ZERO_TIME) {
+            cerr << "Error: "<< parameterNamePrefix
+                 << "frame-lifetime-expiration-wheel-slot-duration must be greater than 0." << endl;
+            exit(1);
+        }//if//
+
+        frameLifetimeWheelIsEnabled = true;
+        frameLifetimeWheelSlots.assign(numberFrameLifetimeWheelSlots, 0);
+        frameLifetimeWheelEventPtr.reset(new FrameLifetimeWheelEvent(this));
+
+        for(unsigned int i = 0; (i < accessCategories.size()); i++) {
+            ostringstream statNameStream;
+            statNameStream << modelName << '_' << theInterfaceId << "_AC" << i
+                           << "_FramesDroppedByLifetimeExpiration";
+
+            lifetimeExpiredFramesDroppedStatPtrs.push_back(
+                simulationEngineInterfacePtr->CreateCounterStat(statNameStream.str()));
+        }//for//
+
+    }//if//
+
+    bool optionalFrameStatisticsAreEnabled = true;
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "enable-optional-frame-statistics"), theNodeId, theInterfaceId)) {
+
+        optionalFrameStatisticsAreEnabled =
+            theParameterDatabaseReader.ReadBool(
+                (parameterNamePrefix + "enable-optional-frame-statistics"), theNodeId, theInterfaceId);
+
+    }//if//
+
+    if (optionalFrameStatisticsAreEnabled) {
+        for(unsigned int i = 0; (i < NumberOptionalMacCounters); i++) {
+            optionalMacCounterStatPtrs[i] =
+                simulationEngineInterfacePtr->CreateCounterStat(
+                    (modelName + '_' + theInterfaceId +
+                     GetOptionalMacCounterStatNameSuffix(static_cast<OptionalMacCounterType>(i))));
+        }//for//
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "enable-latency-breakdown-histograms"), theNodeId, theInterfaceId)) {
+
+        macLatencyBreakdownIsEnabled =
+            theParameterDatabaseReader.ReadBool(
+                (parameterNamePrefix + "enable-latency-breakdown-histograms"), theNodeId, theInterfaceId);
+
+    }//if//
+
+    if (macLatencyBreakdownIsEnabled) {
+        (*this).CreateMacLatencyHistogramStats();
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+            (parameterNamePrefix + "random-backoff-after-transmission-permission-end"), theNodeId, theInterfaceId)) {
+
+        heldAccessCategoryRestartIsEnabled =
+            theParameterDatabaseReader.ReadBool(
+                (parameterNamePrefix + "random-backoff-after-transmission-permission-end"), theNodeId, theInterfaceId);
+    }//if//
+
+    if ((theParameterDatabaseReader.ParameterExists(
+            (parameterNamePrefix + "use-backoff-random-number-pool"), theNodeId, theInterfaceId)) &&
+        (theParameterDatabaseReader.ReadBool(
+            (parameterNamePrefix + "use-backoff-random-number-pool"), theNodeId, theInterfaceId))) {
+
+        backoffRandomNumberPoolPtr.reset(
+            new BackoffRandomNumberPool(
+                HashInputsToMakeSeed(
+                    HashInputsToMakeSeed(nodeSeed, initInterfaceIndex),
+                    backoffRandomNumberPoolSeedHash)));
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "channel-busy-ratio-window-duration"), theNodeId, theInterfaceId)) {
+
+        const SimTime windowDuration =
+            theParameterDatabaseReader.ReadTime(
+                (parameterNamePrefix + "channel-busy-ratio-window-duration"), theNodeId, theInterfaceId);
+
+        unsigned int numberBins = 10;
+
+        if (theParameterDatabaseReader.ParameterExists(
+            (parameterNamePrefix + "channel-busy-ratio-window-number-bins"), theNodeId, theInterfaceId)) {
+
+            numberBins =
+                theParameterDatabaseReader.ReadNonNegativeInt(
+                    (parameterNamePrefix + "channel-busy-ratio-window-number-bins"), theNodeId, theInterfaceId);
+        }//if//
+
+        if ((numberBins == 0) || ((windowDuration / numberBins) <= ZERO_TIME)) {
+            cerr << "Error: "<< parameterNamePrefix
+                 << "channel-busy-ratio-window-duration must be positive and at least "
+                 << parameterNamePrefix << "channel-busy-ratio-window-number-bins (> 0) nanoseconds." << endl;
+            exit(1);
+        }//if//
+
+        channelBusyRatioEstimatorPtr.reset(
+            new ChannelBusyRatioEstimator(windowDuration, numberBins));
+
+    }//if//
+
+    for(unsigned int i = 0; (i < accessCategories.size()); i++) {
+        if ((accessCategories[i].contentionWindowControllerPtr->UsesChannelBusyRatio()) &&
+            (channelBusyRatioEstimatorPtr == nullptr)) {
+
+            cerr << "Error: " << parameterNamePrefix << "edca-category-" << i
+                 << "-contention-window-controller requires "
+                 << parameterNamePrefix << "channel-busy-ratio-window-duration." << endl;
+            exit(1);
+        }//if//
+    }//for//
+
+    networkOutputQueuePtr.reset(
+        new ItsOutputQueueWithPrioritySubqueues(
+            theParameterDatabaseReader,
+            theInterfaceId,
+            simulationEngineInterfacePtr,
+            maxPacketPriority));
+
+    if (networkLayerPtr != nullptr) {
+        networkLayerPtr->SetInterfaceOutputQueue(interfaceIndex, networkOutputQueuePtr);
+    }
+    else {
+        // Only happens with emulation "headless nodes".
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+        (parameterNamePrefix + "bonded-channel-number-list"), theNodeId, theInterfaceId)) {
+
+        const string bondedChannelListString =
+            theParameterDatabaseReader.ReadString(
+                parameterNamePrefix + "bonded-channel-number-list", theNodeId, theInterfaceId);
+
+        vector<unsigned int> bondedChannelList;
+
+        (*this).ReadBondedChannelList(
+            bondedChannelListString,
+            (parameterNamePrefix + "bonded-channel-number-list"),
+            bondedChannelList);
+
+        if (theParameterDatabaseReader.ParameterExists(
+            (parameterNamePrefix + "initial-channel-number"), theNodeId, theInterfaceId)) {
+
+            cerr << "Error in configuration file: both "
+                 << (parameterNamePrefix + "bonded-channel-number-list") << " and "
+                 << (parameterNamePrefix + "initial-channel-number") << " have been specified." << endl;
+
+            exit(1);
+        }//if//
+
+        (*this).SwitchToChannels(bondedChannelList);
+    }
+    else {
+        unsigned int initialChannel = 0;
+
+        if (theParameterDatabaseReader.ParameterExists(
+            (parameterNamePrefix + "initial-channel-number"), theNodeId, theInterfaceId)) {
+
+            initialChannel =
+                theParameterDatabaseReader.ReadNonNegativeInt(
+                    (parameterNamePrefix + "initial-channel-number"), theNodeId, theInterfaceId);
+
+            if (initialChannel >= GetNumberOfChannels()) {
+                cerr << "Error: invalid channel number: " << initialChannel << endl;
+                exit(1);
+            }//if//
+        }//if//
+
+        // Multiple MAC can refere the same PHY device on WAVE.
+
+        if (physicalLayerPtr->GetCurrentBondedChannelList().empty()) {
+            (*this).SwitchToChannel(initialChannel);
+        }//if//
+
+    }//if//
+
+    // Parallelism Stuff
+
+    (*this).lookaheadIndex = (*this).simEngineInterfacePtr->AllocateLookaheadTimeIndex();
+    simEngineInterfacePtr->SetALookaheadTimeForThisNode(
+        physicalLayerPtr->GetRxTxTurnaroundTime(), lookaheadIndex);
+
+    macTraceFilter.ReadParameters(theParameterDatabaseReader, theNodeId, theInterfaceId);
+
+    if (theParameterDatabaseReader.ParameterExists(parameterNamePrefix + "redundant-trace-information-mode")) {
+        redundantTraceInformationModeIsOn =
+            theParameterDatabaseReader.ReadBool(parameterNamePrefix + "redundant-trace-information-mode");
+    }//if//
+
+
+    if (theParameterDatabaseReader.ParameterExists("channel-instance-id", theNodeId, theInterfaceId)) {
+        InterfaceOrInstanceId propModelInstanceId =
+            theParameterDatabaseReader.ReadString("channel-instance-id", theNodeId, theInterfaceId);
+
+        ConvertStringToLowerCase(propModelInstanceId);
+
+        if (propModelInstanceId != propModelInterfacePtr->GetInstanceId()) {
+            cerr << "Error: Declared propagation model instance ID, does not match actual prop model ID." << endl;
+            cerr << "       Node = " << theNodeId << ", Interface = " << theInterfaceId << endl;
+            cerr << "       Declared ID = " << propModelInstanceId << ", Actual ID = "
+                 << propModelInterfacePtr->GetInstanceId() << endl;
+            exit(1);
+        }//if//
+
+    }//if//
+
+
+    // Only not equal to theNodeId in emulation "split node" mode.
+
+    const NodeId primaryNodeId = theParameterDatabaseReader.GetPossibleNodeIdRemap(theNodeId);
+
+    // Mac address related multiple interface restrictions:
+    //   - Only one Adhoc interface on a single propagation environment.
+    //   - Can't have two interfaces associate with same AP.
+
+    myMacAddress.SetLowerBitsWithNodeId(primaryNodeId);
+
+    if (operationMode == AdhocMode) {
+        myMacAddress.SetInterfaceSelectorByte(AdhocModeAddressSelectorByte);
+    }
+    else {
+        myMacAddress.SetInterfaceSelectorByte(static_cast<unsigned char>(interfaceIndex));
+    }//if//
+
+
+    (*this).ReadInMulticastGroupNumberList(theParameterDatabaseReader);
+
+    // Allow STAs to use fixed TXOP durations set in the parameter file
+    // Normally, STA TXOPs are controlled by the AP sent via Beacon frames.
+
+    macSchedulerPtr.reset(
+        new FixedTxopScheduler(
+            theParameterDatabaseReader,
+            theNodeId,
+            theInterfaceId,
+            accessCategories.size()));
+
+}//Dot11Mac()//
+
+
+#pragma warning(default:4355)
+
+
+inline
+void Dot11Mac::CompleteInitialization(
+    const ParameterDatabaseReader& theParameterDatabaseReader,
+    const RandomNumberGeneratorSeed& nodeSeed)
+{
+    //default
+
+    string nodeTypeString = "ad-hoc";
+
+    if (theParameterDatabaseReader.ParameterExists(parameterNamePrefix + "node-type", theNodeId, theInterfaceId)) {
+
+        nodeTypeString = theParameterDatabaseReader.ReadString(parameterNamePrefix + "node-type", theNodeId, theInterfaceId);
+        ConvertStringToLowerCase(nodeTypeString);
+    }//if//
+
+    if (nodeTypeString == "access-point") {
+        operationMode = ApMode;
+        apControllerPtr.reset(
+            new Dot11ApManagementController(
+                shared_from_this(),
+                simEngineInterfacePtr,
+                theParameterDatabaseReader,
+                theNodeId,
+                theInterfaceId,
+                HashInputsToMakeSeed(nodeSeed, interfaceIndex)));
+    }
+    else if (nodeTypeString == "mobile-sta") {
+
+        operationMode = InfrastructureMode;
+
+        staControllerPtr.reset(
+            new Dot11StaManagementController(
+                shared_from_this(),
+                simEngineInterfacePtr,
+                theParameterDatabaseReader,
+                theNodeId,
+                theInterfaceId,
+                HashInputsToMakeSeed(nodeSeed, interfaceIndex)));
+    }
+    else if (nodeTypeString == "ad-hoc") {
+
+        operationMode = AdhocMode;
+
+        // No controller needed
+    }
+    else {
+        cerr << parameterNamePrefix << "node-type \"" << nodeTypeString << "\" is not defined." << endl;
+        exit(1);
+    }//if//
+
+    assert((apControllerPtr == nullptr) || (staControllerPtr == nullptr));
+
+}//CompleteInitialization//
+
+
+
+inline
+bool Dot11Mac::FrameIsForThisNode(const Packet& aFrame) const
 {
-    physicalLayerPtr->SetMacInterfaceForPhy((*this).CreateInterfaceForPhy());
+    const CommonFrameHeader& header = aFrame.GetAndReinterpretPayloadData<CommonFrameHeader>();
 
-    shared_ptr<NetworkInterfaceManager> networkInterfaceManagerPtr =
-        networkLayerPtr->GetNetworkInterfaceManagerPtr(interfaceIndex);
+    bool isForMe = false;
+
+    if ((header.receiverAddress == myMacAddress) ||
+        (header.receiverAddress.IsABroadcastAddress()) ||
+        ((header.receiverAddress.IsAMulticastAddress() &&
+         (myMulticastMacAddresses.count(header.receiverAddress) == 1)))) {
+
+        // For me or broadcast
+
+        switch (GetOperationMode()) {
+        case AdhocMode:
+            isForMe = true;
+            break;
+
+        case InfrastructureMode:
+        {
+            if (header.theFrameControlField.frameTypeAndSubtype == QOS_DATA_FRAME_TYPE_CODE) {
+
+                // Data frame
+
+                const QosDataFrameHeader& dataFrameHeader =
+                    aFrame.GetAndReinterpretPayloadData<QosDataFrameHeader>();
+
+                bool wasFound = false;
+                MacAddress apMacAddress;
+                staControllerPtr->GetCurrentAccessPointAddress(wasFound, apMacAddress);
+
+                // Receive only from associated ap
+
+                isForMe = ((wasFound) && (dataFrameHeader.transmitterAddress == apMacAddress));
+            }
+            else {
+                //Control and managment frames
+
+                isForMe = true;
+            }//if//
+            break;
+        }
+
+        case ApMode:
+        {
+            if (header.theFrameControlField.frameTypeAndSubtype == QOS_DATA_FRAME_TYPE_CODE) {
+
+                // Data frame
+
+                const QosDataFrameHeader& dataFrameHeader =
+                    aFrame.GetAndReinterpretPayloadData<QosDataFrameHeader>();
+
+                // Receive only from associated sta
+                isForMe = apControllerPtr->IsAnAssociatedStaAddress(dataFrameHeader.transmitterAddress);
+
+            }
+            else {
+                // Control and managment frames
+
+                isForMe = true;
+            }//if//
+            break;
+        }
+        default:
+            assert(false); abort(); break;
+        }//switch//
+    }
+    else {
+        // For others
+        // Need to receive frames for others if mac supports link level multi-hop
 
-    if (networkInterfaceManagerPtr != nullptr) {
-        theMacAddressResolverPtr.reset(
-            networkInterfaceManagerPtr->CreateMacAddressResolver());
     }//if//
 
-    if (theMacAddressResolverPtr.get() == nullptr) {
-        theMacAddressResolverPtr.reset(new SimpleMacAddressResolver(this));
+    if ((!isForMe) && (header.receiverAddress == myMacAddress)) {
+        // Delete this if it starts (correctly) spewing too many messages .
+        cerr << "Warning: 802.11 Frame addressed to node is unreceivable (not associated): frame dropped" << endl;
     }//if//
 
-    aShortInterframeSpaceTime = physicalLayerPtr->GetShortInterframeSpaceDuration();
-    aSlotTime = physicalLayerPtr->GetSlotDuration();
-    aRxTxTurnaroundTime = physicalLayerPtr->GetRxTxTurnaroundTime();
-    SimTime aPhyRxStartDelay = physicalLayerPtr->GetPhyRxStartDelay();
-    clearToSendTimeoutDuration = aShortInterframeSpaceTime + aSlotTime + aPhyRxStartDelay;
-    ackTimeoutDuration = clearToSendTimeoutDuration;
+    return (isForMe);
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "rts-threshold-size-bytes"), theNodeId, theInterfaceId)) {
+}//FrameIsForThisNode//
 
-        rtsThresholdSizeBytes =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                (parameterNamePrefix + "rts-threshold-size-bytes"), theNodeId, theInterfaceId);
+
+inline
+bool Dot11Mac::AggregatedSubframeIsForThisNode(const Packet& frame) const
+{
+    const CommonFrameHeader& header =
+        frame.GetAndReinterpretPayloadData<CommonFrameHeader>(sizeof(MpduDelimiterFrame));
+
+    assert(!header.receiverAddress.IsABroadcastOrAMulticastAddress());
+
+    return (header.receiverAddress == myMacAddress);
+}
+
+
+
+inline
+void Dot11Mac::ScheduleWakeupTimer(const SimTime& wakeupTime)
+{
+    (*this).currentWakeupTimerExpirationTime = wakeupTime;
+
+    if (wakeupTimerEventTicket.IsNull()) {
+        simEngineInterfacePtr->ScheduleEvent(
+            wakeupTimerEventPtr, wakeupTime, wakeupTimerEventTicket);
+    }
+    else {
+        simEngineInterfacePtr->RescheduleEvent(wakeupTimerEventTicket, wakeupTime);
 
     }//if//
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "short-frame-retry-limit"), theNodeId, theInterfaceId)) {
+}//ScheduleWakeupTimer//
 
-        shortFrameRetryLimit =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                (parameterNamePrefix + "short-frame-retry-limit"), theNodeId, theInterfaceId);
 
-        if (shortFrameRetryLimit < 1) {
-            cerr << "Error: "<< parameterNamePrefix
-                << "short-frame-retry-limit must be greater than or equal to 1: "
-                << shortFrameRetryLimit << endl;
-            exit(1);
-        }//if//
+inline
+void Dot11Mac::CancelWakeupTimer()
+{
+    assert(!wakeupTimerEventTicket.IsNull());
+    (*this).currentWakeupTimerExpirationTime = INFINITE_TIME;
+    simEngineInterfacePtr->CancelEvent(wakeupTimerEventTicket);
+}
+
+
+
+inline
+SimTime Dot11Mac::CalculateNonExtendedBackoffDuration(
+    const EdcaAccessCategoryInfo& accessCategory) const
+{
+    const int totalSlots =
+        (accessCategory.arbitrationInterframeSpaceDurationSlots + accessCategory.currentNumOfBackoffSlots);
+
+    return (aShortInterframeSpaceTime + (aSlotTime * totalSlots) - aRxTxTurnaroundTime);
+
+}//CalculateNonExtendedBackoffDuration//
+
+
+inline
+SimTime Dot11Mac::CalculateNonExtendedDurationForJumpingOnMediumWithNoBackoff(
+    const EdcaAccessCategoryInfo& accessCategory) const
+{
+    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+
+    SimTime ifsDuration = aShortInterframeSpaceTime +
+        (aSlotTime * accessCategory.arbitrationInterframeSpaceDurationSlots) - aRxTxTurnaroundTime;
+
+    if ((mediumBecameIdleTime + ifsDuration) >= currentTime) {
+
+        // Wait for the interframe space.
+
+        return (mediumBecameIdleTime + ifsDuration - currentTime);
+    } else {
+        // Wait until next slot start.
 
+        return (aSlotTime - ((currentTime - mediumBecameIdleTime - ifsDuration) % aSlotTime));
     }//if//
 
+}//CalculateNonExtendedDurationForJumpingOnMediumWithNoBackoff//
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "long-frame-retry-limit"), theNodeId, theInterfaceId)) {
 
-        longFrameRetryLimit =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                (parameterNamePrefix + "long-frame-retry-limit"), theNodeId, theInterfaceId);
+inline
+bool Dot11Mac::AccessCategoryIsActive(const unsigned int accessCategoryIndex) const
+{
+    const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-        if (longFrameRetryLimit < 1) {
-            cerr << "Error: "<< parameterNamePrefix
-                << "long-frame-retry-limit must be greater than or equal to 1: "
-                << longFrameRetryLimit << endl;
-            exit(1);
+    return ((accessCategoryInfo.currentNonExtendedBackoffDuration != INFINITE_TIME) ||
+            (accessCategoryInfo.hasPacketToSend));
+}
+
+inline
+unsigned int Dot11Mac::FindIndexOfAccessCategoryWithEarliestBackoffExpiration() const
+{
+    unsigned int shortestIndex = static_cast<unsigned int>(accessCategories.size());
+    SimTime earliestExpirationTime = INFINITE_TIME;
+
+    // Higher Access Indices have higher priority
+
+    for(int i = (numberAccessCategories - 1); (i >= 0); i--) {
+        const EdcaAccessCategoryInfo& accessCategoryInfo =
+            accessCategories[i];
+
+        if ((accessCategoryInfo.ifsAndBackoffStartTime != INFINITE_TIME) &&
+            (accessCategoryInfo.currentNonExtendedBackoffDuration != INFINITE_TIME)) {
+
+            const SimTime expirationTime =
+                (accessCategories[i].ifsAndBackoffStartTime +
+                 accessCategories[i].currentNonExtendedBackoffDuration);
+
+            if (expirationTime < earliestExpirationTime) {
+                earliestExpirationTime = expirationTime;
+                shortestIndex = i;
+            }//if//
         }//if//
+    }//for//
 
-    }//if//
+    return shortestIndex;
+
+}//FindIndexOfAccessCategoryWithEarliestBackoffExpiration//
+
+inline
+unsigned int Dot11Mac::FindIndexOfAccessCategoryWithShortestBackoff() const
+{
+    unsigned int shortestIndex = static_cast<unsigned int>(accessCategories.size());
+    SimTime shortestBackoff = INFINITE_TIME;
+
+    // Higher Access Indices have higher priority
+
+    for(int i = (numberAccessCategories - 1); (i >= 0); i--) {
+        if (shortestBackoff > accessCategories[i].currentNonExtendedBackoffDuration) {
+            shortestBackoff = accessCategories[i].currentNonExtendedBackoffDuration;
+            shortestIndex = i;
+        }//if//
+    }//for//
+
+    return shortestIndex;
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "contention-window-min-slots"), theNodeId, theInterfaceId)) {
+}//FindIndexOfAccessCategoryWithShortestBackoff//
 
-        contentionWindowSlotsMin =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                (parameterNamePrefix + "contention-window-min-slots"), theNodeId, theInterfaceId);
+//
+inline
+SimTime Dot11Mac::CurrentBackoffDuration() const
+{
+    unsigned int accessCategoryIndex = FindIndexOfAccessCategoryWithShortestBackoff();
 
+    if (accessCategoryIndex == accessCategories.size()) {
+        return INFINITE_TIME;
     }//if//
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "contention-window-max-slots"), theNodeId, theInterfaceId)) {
-
-        contentionWindowSlotsMax =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                (parameterNamePrefix + "contention-window-max-slots"), theNodeId, theInterfaceId);
+    const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
+    //std::cout << "additional = " << (int)additionalDelayForExtendedInterframeSpaceMode << endl;
+    //バックオフはちゃんと優先度が高いと短い
+    //std::cout << "BackoffDuration = " << (int)accessCategoryInfo.currentNonExtendedBackoffDuration << endl;
+    //前回の送信が失敗していれば
+    if (lastFrameReceivedWasCorrupt) {
+        //待ち時間追加
+        
+        return (additionalDelayForExtendedInterframeSpaceMode +
+                accessCategoryInfo.currentNonExtendedBackoffDuration);
+    }
+    else {
+        return accessCategoryInfo.currentNonExtendedBackoffDuration;
     }//if//
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "disabled-to-jump-on-medium-without-backoff"), theNodeId, theInterfaceId)) {
+}//CurrentBackoffDuration//
 
-        disabledToJumpOnMediumWithoutBackoff =
-            theParameterDatabaseReader.ReadBool(
-                (parameterNamePrefix + "disabled-to-jump-on-medium-without-backoff"), theNodeId, theInterfaceId);
 
-    }//if//
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "max-aggregate-mpdu-size-bytes"), theNodeId, theInterfaceId)) {
+inline
+SimTime Dot11Mac::CurrentBackoffExpirationTime() const
+{
+    assert(macState == WaitingForIfsAndBackoffState);
 
-        maxAggregateMpduSizeBytes =
-            theParameterDatabaseReader.ReadNonNegativeInt(
-                (parameterNamePrefix + "max-aggregate-mpdu-size-bytes"), theNodeId, theInterfaceId);
+    unsigned int accessCategoryIndex = FindIndexOfAccessCategoryWithEarliestBackoffExpiration();
 
+    if (accessCategoryIndex == accessCategories.size()) {
+        return INFINITE_TIME;
     }//if//
 
-    protectAggregateFramesWithSingleAckedFrame = true;
-
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "protect-aggregate-frames-with-single-acked-frame"), theNodeId, theInterfaceId)) {
+    const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-        protectAggregateFramesWithSingleAckedFrame =
-            theParameterDatabaseReader.ReadBool(
-                (parameterNamePrefix + "protect-aggregate-frames-with-single-acked-frame"),
-                theNodeId, theInterfaceId);
+    if (lastFrameReceivedWasCorrupt) {
+        return (additionalDelayForExtendedInterframeSpaceMode +
+                accessCategoryInfo.ifsAndBackoffStartTime +
+                accessCategoryInfo.currentNonExtendedBackoffDuration);
+    }
+    else {
+        return (accessCategoryInfo.ifsAndBackoffStartTime +
+                accessCategoryInfo.currentNonExtendedBackoffDuration);
     }//if//
 
+}//CurrentBackoffExpirationTime//
 
-    allowFrameAggregationWithTxopZero = false;
-
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "allow-frame-aggregation-with-txop-zero"), theNodeId, theInterfaceId)) {
 
-        allowFrameAggregationWithTxopZero =
-            theParameterDatabaseReader.ReadBool(
-                (parameterNamePrefix + "allow-frame-aggregation-with-txop-zero"), theNodeId, theInterfaceId);
+//-------------------------------------------------------------------------------------------------
 
+//ランダムバックオフの乱数再生成
+inline
+void Dot11Mac::RecalcRandomBackoff(EdcaAccessCategoryInfo& accessCategoryInfo)
+{
+    if (backoffRandomNumberPoolPtr != nullptr) {
+        accessCategoryInfo.currentNumOfBackoffSlots =
+            backoffRandomNumberPoolPtr->GenerateRandomInt(accessCategoryInfo.currentContentionWindowSlots);
+    }
+    else {
+        accessCategoryInfo.currentNumOfBackoffSlots =
+            aRandomNumberGenerator.GenerateRandomInt(0, accessCategoryInfo.currentContentionWindowSlots);
     }//if//
 
+    accessCategoryInfo.currentNonExtendedBackoffDuration =
+        CalculateNonExtendedBackoffDuration(accessCategoryInfo);
+}
 
-    const shared_ptr<SimplePropagationModelForNode<PropFrame> > propModelInterfacePtr =
-        physicalLayerPtr->GetPropModelInterface();
+//バックオフ実行
+inline
+void Dot11Mac::StartBackoffIfNecessary()
+{
+    assert(macState != WaitingForIfsAndBackoffState);
 
-    //rate controller
-    theAdaptiveRateControllerPtr =
-        CreateAdaptiveRateController(
-            simulationEngineInterfacePtr,
-            theParameterDatabaseReader,
-            theNodeId,
-            theInterfaceId,
-            physicalLayerPtr->GetBaseChannelBandwidthMhz());
+    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
 
-    theAdaptiveRateControllerPtr->SetModulationAndCondingMapForDatarateSpecifiedFrame(
-        physicalLayerPtr->GetModulationAndCodingShemeMap());
+    if (currentTime >= transmissionPermissionEndTime) {
+        macState = IdleState;
+        return;
+    }
 
-    //power controller
-    theAdaptiveTxPowerControllerPtr =
-        CreateAdaptiveTxPowerController(
-            simulationEngineInterfacePtr,
-            theParameterDatabaseReader,
-            theNodeId,
-           physicalLayerPtr->GetInterfaceId());
+    const SimTime backoffDuration = CurrentBackoffDuration();
 
-    additionalDelayForExtendedInterframeSpaceMode = CalculateAdditionalDelayForExtendedInterframeSpace();
+    if (backoffDuration == INFINITE_TIME) {
+        macState = IdleState;
+        return;
+    }//if//
 
-    (*this).InitializeAccessCategories(theParameterDatabaseReader);
+    macState = WaitingForIfsAndBackoffState;
 
-    wakeupTimerEventPtr = shared_ptr<WakeupTimerEvent>(new WakeupTimerEvent(this));
+    for(unsigned int i = 0; (i < accessCategories.size()); i++) {
+        EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[i];
+        if (accessCategoryInfo.currentNonExtendedBackoffDuration != INFINITE_TIME) {
+            accessCategoryInfo.ifsAndBackoffStartTime = currentTime;
 
-    networkOutputQueuePtr.reset(
-        new ItsOutputQueueWithPrioritySubqueues(
-            theParameterDatabaseReader,
-            theInterfaceId,
-            simulationEngineInterfacePtr,
-            maxPacketPriority));
+            if (macLatencyBreakdownIsEnabled) {
+                (*this).StartMacLatencyChannelAccessIfNecessary(i);
+            }//if//
+        }
+        else {
+            accessCategoryInfo.ifsAndBackoffStartTime = INFINITE_TIME;
+        }//if//
+    }//for//
 
-    if (networkLayerPtr != nullptr) {
-        networkLayerPtr->SetInterfaceOutputQueue(interfaceIndex, networkOutputQueuePtr);
+    //バックオフ表示意外とムラがある
+    //追加テスト用
+    /*const NodeId SourceId = simEngineInterfacePtr -> GetNodeId();;
+    if(SourceId == 1){
+        std::cout << "バックオフ時間1 = " << (int)backoffDuration << endl;
     }
-    else {
-        // Only happens with emulation "headless nodes".
-    }//if//
+    if(SourceId == 2){
+        std::cout << "バックオフ時間2 = " << (int)backoffDuration << endl;
+    }*/
+    //現在の時間＋バックオフの時間
 
-    if (theParameterDatabaseReader.ParameterExists(
-        (parameterNamePrefix + "bonded-channel-number-list"), theNodeId, theInterfaceId)) {
+    //ここで優先度or速度を取れれば連続送信可能か
 
-        const string bondedChannelListString =
-            theParameterDatabaseReader.ReadString(
-                parameterNamePrefix + "bonded-channel-number-list", theNodeId, theInterfaceId);
+    //std::cout << "2" << endl;
+    //while(1);
+    //sendbasicmessageよりあとに通る.
 
-        vector<unsigned int> bondedChannelList;
+    (*this).ScheduleWakeupTimer(currentTime + backoffDuration);
 
-        (*this).ReadBondedChannelList(
-            bondedChannelListString,
-            (parameterNamePrefix + "bonded-channel-number-list"),
-            bondedChannelList);
+    OutputTraceForIfsAndBackoffStart(backoffDuration);
 
-        if (theParameterDatabaseReader.ParameterExists(
-            (parameterNamePrefix + "initial-channel-number"), theNodeId, theInterfaceId)) {
+}//StartBackoffIfNecessary//
 
-            cerr << "Error in configuration file: both "
-                 << (parameterNamePrefix + "bonded-channel-number-list") << " and "
-                 << (parameterNamePrefix + "initial-channel-number") << " have been specified." << endl;
 
-            exit(1);
-        }//if//
+inline
+void Dot11Mac::StartBackoffForCategory(const unsigned int accessCategoryIndex)
+{
+    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
 
-        (*this).SwitchToChannels(bondedChannelList);
+    if (currentTime >= transmissionPermissionEndTime) {
+        macState = IdleState;
+        return;
     }
-    else {
-        unsigned int initialChannel = 0;
 
-        if (theParameterDatabaseReader.ParameterExists(
-            (parameterNamePrefix + "initial-channel-number"), theNodeId, theInterfaceId)) {
+    assert((macState == IdleState) || (macState == WaitingForIfsAndBackoffState));
+    (*this).macState = WaitingForIfsAndBackoffState;
 
-            initialChannel =
-                theParameterDatabaseReader.ReadNonNegativeInt(
-                    (parameterNamePrefix + "initial-channel-number"), theNodeId, theInterfaceId);
+    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
+    accessCategoryInfo.ifsAndBackoffStartTime = currentTime;
 
-            if (initialChannel >= GetNumberOfChannels()) {
-                cerr << "Error: invalid channel number: " << initialChannel << endl;
-                exit(1);
-            }//if//
-        }//if//
+    if (macLatencyBreakdownIsEnabled) {
+        (*this).StartMacLatencyChannelAccessIfNecessary(accessCategoryIndex);
+    }//if//
 
-        // Multiple MAC can refere the same PHY device on WAVE.
+    //exporation...期限とか満了とか
+    const SimTime wakeupTime = CurrentBackoffExpirationTime();
 
-        if (physicalLayerPtr->GetCurrentBondedChannelList().empty()) {
-            (*this).SwitchToChannel(initialChannel);
-        }//if//
+    //通ってなさそう
+    //std::cout << "wakeuptime = " << (int)wakeupTime << endl; 
 
+    if (wakeupTime != currentWakeupTimerExpirationTime) {
+        (*this).ScheduleWakeupTimer(wakeupTime);
+
+        OutputTraceForIfsAndBackoffStart(wakeupTime - currentTime);
     }//if//
 
-    // Parallelism Stuff
+    assert(macState == WaitingForIfsAndBackoffState);
 
-    (*this).lookaheadIndex = (*this).simEngineInterfacePtr->AllocateLookaheadTimeIndex();
-    simEngineInterfacePtr->SetALookaheadTimeForThisNode(
-        physicalLayerPtr->GetRxTxTurnaroundTime(), lookaheadIndex);
+}//StartBackoffForCategory//
 
-    if (theParameterDatabaseReader.ParameterExists(parameterNamePrefix + "redundant-trace-information-mode")) {
-        redundantTraceInformationModeIsOn =
-            theParameterDatabaseReader.ReadBool(parameterNamePrefix + "redundant-trace-information-mode");
-    }//if//
 
 
-    if (theParameterDatabaseReader.ParameterExists("channel-instance-id", theNodeId, theInterfaceId)) {
-        InterfaceOrInstanceId propModelInstanceId =
-            theParameterDatabaseReader.ReadString("channel-instance-id", theNodeId, theInterfaceId);
 
-        ConvertStringToLowerCase(propModelInstanceId);
+//-------------------------------------------------------------------------------------------------
+//
+// The following routines are for when a new packet appears at the Network Layer and a
+// access category goes from idle to active.
+//
 
-        if (propModelInstanceId != propModelInterfacePtr->GetInstanceId()) {
-            cerr << "Error: Declared propagation model instance ID, does not match actual prop model ID." << endl;
-            cerr << "       Node = " << theNodeId << ", Interface = " << theInterfaceId << endl;
-            cerr << "       Declared ID = " << propModelInstanceId << ", Actual ID = "
-                 << propModelInterfacePtr->GetInstanceId() << endl;
-            exit(1);
-        }//if//
+
+inline
+void Dot11Mac::StartPacketSendProcessForAnAccessCategory(
+    const unsigned int accessCategoryIndex,
+    const bool forceBackoff)
+{
+    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
+
+    accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff = false;
+
+    if ((accessCategoryInfo.currentPacketPtr == nullptr) &&
+        (accessCategoryInfo.currentAggregateFramePtr == nullptr)) {
+
+        accessCategoryInfo.hasPacketToSend =
+            ThereAreQueuedPacketsForAccessCategory(accessCategoryIndex);
 
     }//if//
 
+    if ((!forceBackoff) && (!accessCategoryInfo.hasPacketToSend)) {
+        accessCategoryInfo.currentNonExtendedBackoffDuration = INFINITE_TIME;
 
-    // Only not equal to theNodeId in emulation "split node" mode.
+        return;
 
-    const NodeId primaryNodeId = theParameterDatabaseReader.GetPossibleNodeIdRemap(theNodeId);
+    }//if//
 
-    // Mac address related multiple interface restrictions:
-    //   - Only one Adhoc interface on a single propagation environment.
-    //   - Can't have two interfaces associate with same AP.
+    assert(accessCategoryInfo.currentNonExtendedBackoffDuration == INFINITE_TIME);
 
-    myMacAddress.SetLowerBitsWithNodeId(primaryNodeId);
+    switch (macState) {
+    case BusyMediumState:
+    case CtsOrAckTransmissionState:
+    case WaitingForNavExpirationState:
+    case WaitingForCtsState:
+    case WaitingForAckState:
+    case ChangingChannelsState:
+    {
+        (*this).RecalcRandomBackoff(accessCategoryInfo);
 
-    if (operationMode == AdhocMode) {
-        myMacAddress.SetInterfaceSelectorByte(AdhocModeAddressSelectorByte);
+        break;
     }
-    else {
-        myMacAddress.SetInterfaceSelectorByte(static_cast<unsigned char>(interfaceIndex));
-    }//if//
+    case IdleState:
+    case WaitingForIfsAndBackoffState:
+    {
+        if (disabledToJumpOnMediumWithoutBackoff) {
 
+            // Note: Add complete IFS even if channel is completely idle.
 
-    (*this).ReadInMulticastGroupNumberList(theParameterDatabaseReader);
+            (*this).RecalcRandomBackoff(accessCategoryInfo);
 
-    // Allow STAs to use fixed TXOP durations set in the parameter file
-    // Normally, STA TXOPs are controlled by the AP sent via Beacon frames.
+            accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff = false;
+        }
+        else {
+            assert(!forceBackoff);
 
-    macSchedulerPtr.reset(
-        new FixedTxopScheduler(
-            theParameterDatabaseReader,
-            theNodeId,
-            theInterfaceId,
-            accessCategories.size()));
+            accessCategoryInfo.currentNumOfBackoffSlots = 0;
+            accessCategoryInfo.currentNonExtendedBackoffDuration =
+                CalculateNonExtendedDurationForJumpingOnMediumWithNoBackoff(accessCategoryInfo);
+            accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff = true;
+        }
 
-}//Dot11Mac()//
+        (*this).StartBackoffForCategory(accessCategoryIndex);
 
+        break;
+    }
+    default:
+        assert(false); abort(); break;
+    }//switch//
 
-#pragma warning(default:4355)
+}//StartPacketSendProcessForAnAccessCategory//
 
 
 inline
-void Dot11Mac::CompleteInitialization(
-    const ParameterDatabaseReader& theParameterDatabaseReader,
-    const RandomNumberGeneratorSeed& nodeSeed)
+bool Dot11Mac::FindNonEmptyPrioritySubqueueForAccessCategory(
+    const unsigned int accessCategoryIndex,
+    PacketPriority& priority) const
 {
-    //default
+    const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-    string nodeTypeString = "ad-hoc";
+    if ((possiblyNonEmptyPriorityBitMask & accessCategoryInfo.priorityBitMask) == 0) {
+        return false;
+    }//if//
 
-    if (theParameterDatabaseReader.ParameterExists(parameterNamePrefix + "node-type", theNodeId, theInterfaceId)) {
+    for(unsigned int i = 0; (i < accessCategoryInfo.listOfPriorities.size()); i++) {
+        const PacketPriority listedPriority = accessCategoryInfo.listOfPriorities[i];
+        const unsigned int priorityBit = (1U << listedPriority);
 
-        nodeTypeString = theParameterDatabaseReader.ReadString(parameterNamePrefix + "node-type", theNodeId, theInterfaceId);
-        ConvertStringToLowerCase(nodeTypeString);
-    }//if//
+        if ((possiblyNonEmptyPriorityBitMask & priorityBit) == 0) {
+            continue;
+        }//if//
 
-    if (nodeTypeString == "access-point") {
-        operationMode = ApMode;
-        apControllerPtr.reset(
-            new Dot11ApManagementController(
-                shared_from_this(),
-                simEngineInterfacePtr,
-                theParameterDatabaseReader,
-                theNodeId,
-                theInterfaceId,
-                HashInputsToMakeSeed(nodeSeed, interfaceIndex)));
-    }
-    else if (nodeTypeString == "mobile-sta") {
+        if (networkOutputQueuePtr->HasPacketWithPriority(listedPriority)) {
+            priority = listedPriority;
+            return true;
+        }//if//
 
-        operationMode = InfrastructureMode;
+        // Stale bit: subqueue has been emptied.
 
-        staControllerPtr.reset(
-            new Dot11StaManagementController(
-                shared_from_this(),
-                simEngineInterfacePtr,
-                theParameterDatabaseReader,
-                theNodeId,
-                theInterfaceId,
-                HashInputsToMakeSeed(nodeSeed, interfaceIndex)));
-    }
-    else if (nodeTypeString == "ad-hoc") {
+        possiblyNonEmptyPriorityBitMask &= ~priorityBit;
+    }//for//
 
-        operationMode = AdhocMode;
+    return false;
 
-        // No controller needed
-    }
-    else {
-        cerr << parameterNamePrefix << "node-type \"" << nodeTypeString << "\" is not defined." << endl;
-        exit(1);
-    }//if//
+}//FindNonEmptyPrioritySubqueueForAccessCategory//
 
-    assert((apControllerPtr == nullptr) || (staControllerPtr == nullptr));
 
-}//CompleteInitialization//
+inline
+bool Dot11Mac::NetworkLayerHasPacketForAccessCategory(const unsigned int accessCategoryIndex) const
+{
+    PacketPriority priorityNotUsed;
+
+    return (FindNonEmptyPrioritySubqueueForAccessCategory(accessCategoryIndex, priorityNotUsed));
+
+}//NetworkLayerHasPacketForAccessCategory//
 
 
 
 inline
-bool Dot11Mac::FrameIsForThisNode(const Packet& aFrame) const
+void Dot11Mac::NetworkLayerQueueChangeNotification()
 {
-    const CommonFrameHeader& header = aFrame.GetAndReinterpretPayloadData<CommonFrameHeader>();
+    // Inserted priorities are unknown.
 
-    bool isForMe = false;
+    possiblyNonEmptyPriorityBitMask = allPrioritiesBitMask;
 
-    if ((header.receiverAddress == myMacAddress) ||
-        (header.receiverAddress.IsABroadcastAddress()) ||
-        ((header.receiverAddress.IsAMulticastAddress() &&
-         (myMulticastMacAddresses.count(header.receiverAddress) == 1)))) {
+    if (frameLifetimeWheelIsEnabled) {
+        const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
 
-        // For me or broadcast
+        for(unsigned int i = 0; (i < accessCategories.size()); i++) {
+            const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[i];
 
-        switch (GetOperationMode()) {
-        case AdhocMode:
-            isForMe = true;
-            break;
+            if (accessCategoryInfo.frameLifetime != INFINITE_TIME) {
+                (*this).AddPrioritiesToFrameLifetimeWheel(
+                    accessCategoryInfo.priorityBitMask,
+                    (currentTime + accessCategoryInfo.frameLifetime));
+            }//if//
+        }//for//
+    }//if//
 
-        case InfrastructureMode:
-        {
-            if (header.theFrameControlField.frameTypeAndSubtype == QOS_DATA_FRAME_TYPE_CODE) {
+    // High Priority to Low priority category order:
 
-                // Data frame
+    for(int i = (numberAccessCategories-1); (i >= 0); i--) {
+        if (!AccessCategoryIsActive(i)) {
 
-                const QosDataFrameHeader& dataFrameHeader =
-                    aFrame.GetAndReinterpretPayloadData<QosDataFrameHeader>();
+            (*this).StartPacketSendProcessForAnAccessCategory(i);
 
-                bool wasFound = false;
-                MacAddress apMacAddress;
-                staControllerPtr->GetCurrentAccessPointAddress(wasFound, apMacAddress);
+        }//if//
+    }//for//
 
-                // Receive only from associated ap
+}//NetworkLayerQueueChangeNotification//
 
-                isForMe = ((wasFound) && (dataFrameHeader.transmitterAddress == apMacAddress));
-            }
-            else {
-                //Control and managment frames
 
-                isForMe = true;
-            }//if//
-            break;
-        }
+inline
+void Dot11Mac::NetworkLayerQueueChangeNotificationForPriority(const PacketPriority& priority)
+{
+    assert(priority <= maxPacketPriority);
 
-        case ApMode:
-        {
-            if (header.theFrameControlField.frameTypeAndSubtype == QOS_DATA_FRAME_TYPE_CODE) {
+    possiblyNonEmptyPriorityBitMask |= (1U << priority);
 
-                // Data frame
+    const unsigned int accessCategoryIndex = accessCategoryIndexForPriority[priority];
 
-                const QosDataFrameHeader& dataFrameHeader =
-                    aFrame.GetAndReinterpretPayloadData<QosDataFrameHeader>();
+    if ((frameLifetimeWheelIsEnabled) &&
+        (accessCategories[accessCategoryIndex].frameLifetime != INFINITE_TIME)) {
 
-                // Receive only from associated sta
-                isForMe = apControllerPtr->IsAnAssociatedStaAddress(dataFrameHeader.transmitterAddress);
+        (*this).AddPrioritiesToFrameLifetimeWheel(
+            (1U << priority),
+            (simEngineInterfacePtr->CurrentTime() +
+             accessCategories[accessCategoryIndex].frameLifetime));
+    }//if//
 
-            }
-            else {
-                // Control and managment frames
+    if (!AccessCategoryIsActive(accessCategoryIndex)) {
 
-                isForMe = true;
-            }//if//
-            break;
-        }
-        default:
-            assert(false); abort(); break;
-        }//switch//
-    }
-    else {
-        // For others
-        // Need to receive frames for others if mac supports link level multi-hop
+        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndex);
 
     }//if//
 
-    if ((!isForMe) && (header.receiverAddress == myMacAddress)) {
-        // Delete this if it starts (correctly) spewing too many messages .
-        cerr << "Warning: 802.11 Frame addressed to node is unreceivable (not associated): frame dropped" << endl;
-    }//if//
+}//NetworkLayerQueueChangeNotificationForPriority//
 
-    return (isForMe);
 
-}//FrameIsForThisNode//
 
 
 inline
-bool Dot11Mac::AggregatedSubframeIsForThisNode(const Packet& frame) const
+bool Dot11Mac::ThereAreQueuedPacketsForAccessCategory(const unsigned int accessCategoryIndex) const
 {
-    const CommonFrameHeader& header =
-        frame.GetAndReinterpretPayloadData<CommonFrameHeader>(sizeof(MpduDelimiterFrame));
-
-    assert(!header.receiverAddress.IsABroadcastOrAMulticastAddress());
-
-    return (header.receiverAddress == myMacAddress);
+    return (((accessCategoryIndex == accessCategoryIndexForManagementFrames) &&
+             (!managementFrameQueue.empty())) ||
+            (NetworkLayerHasPacketForAccessCategory(accessCategoryIndex)));
 }
 
 
-
 inline
-void Dot11Mac::ScheduleWakeupTimer(const SimTime& wakeupTime)
+bool Dot11Mac::HasQueuedPacketsToSend() const
 {
-    (*this).currentWakeupTimerExpirationTime = wakeupTime;
-
-    if (wakeupTimerEventTicket.IsNull()) {
-        simEngineInterfacePtr->ScheduleEvent(
-            wakeupTimerEventPtr, wakeupTime, wakeupTimerEventTicket);
-    }
-    else {
-        simEngineInterfacePtr->RescheduleEvent(wakeupTimerEventTicket, wakeupTime);
+    for(unsigned int i = 0; (i < numberAccessCategories); i++) {
+        if ((AccessCategoryIsActive(i)) || (ThereAreQueuedPacketsForAccessCategory(i))) {
+            return true;
+        }//if//
+    }//for//
 
-    }//if//
+    return false;
 
-}//ScheduleWakeupTimer//
+}//HasQueuedPacketsToSend//
 
 
 inline
-void Dot11Mac::CancelWakeupTimer()
+void Dot11Mac::SuspendTransmissionFunction()
 {
-    assert(!wakeupTimerEventTicket.IsNull());
-    (*this).currentWakeupTimerExpirationTime = INFINITE_TIME;
-    simEngineInterfacePtr->CancelEvent(wakeupTimerEventTicket);
-}
+    assert(macState != CtsOrAckTransmissionState &&
+           macState != TransientState &&
+           macState != ChangingChannelsState);
 
+    assert(!physicalLayerPtr->IsTransmittingAFrame());
 
+    switch (macState) {
+    case WaitingForCtsState:
+    case WaitingForAckState:
+        if ((*this).WakeupTimerIsActive()) {
+            simEngineInterfacePtr->CancelEvent(wakeupTimerEventTicket);
+        }//if//
+        if (!physicalLayerPtr->IsReceivingAFrame()) {
+            macState = BusyMediumState;
+        }//if//
+        break;
 
-inline
-SimTime Dot11Mac::CalculateNonExtendedBackoffDuration(
-    const EdcaAccessCategoryInfo& accessCategory) const
-{
-    const int totalSlots =
-        (accessCategory.arbitrationInterframeSpaceDurationSlots + accessCategory.currentNumOfBackoffSlots);
+    case WaitingForIfsAndBackoffState: {
+        const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+
+        for(unsigned int i = 0; (i < accessCategories.size()); i++) {
+            SimTime elapsedTime = (currentTime - accessCategories[i].ifsAndBackoffStartTime);
+
+            (*this).SubtractElapsedTimeFromBackoffDuration(i, elapsedTime);
+        }//for//
+        if ((*this).WakeupTimerIsActive()) {
+            simEngineInterfacePtr->CancelEvent(wakeupTimerEventTicket);
+        }//if//
+        macState = IdleState;
+        break;
+    }
 
-    return (aShortInterframeSpaceTime + (aSlotTime * totalSlots) - aRxTxTurnaroundTime);
+    case IdleState:
+    case BusyMediumState:
+    case WaitingForNavExpirationState:
+    default:
+        break;
+    }//switch//
 
-}//CalculateNonExtendedBackoffDuration//
+    transmissionPermissionEndTime = simEngineInterfacePtr->CurrentTime();
 
+    if (macLatencyBreakdownIsEnabled) {
+        transmissionSuspendedTime = transmissionPermissionEndTime;
+    }//if//
+
+    // receiving only mode
+}//SuspendTransmissionFunction//
 
+//送信関数を再び始める？
 inline
-SimTime Dot11Mac::CalculateNonExtendedDurationForJumpingOnMediumWithNoBackoff(
-    const EdcaAccessCategoryInfo& accessCategory) const
+void Dot11Mac::ResumeTransmissionFunction(const SimTime& initTransmissionPermissionEndTime)
 {
-    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+    transmissionPermissionEndTime = initTransmissionPermissionEndTime;
+    assert(transmissionPermissionEndTime > simEngineInterfacePtr->CurrentTime());
 
-    SimTime ifsDuration = aShortInterframeSpaceTime +
-        (aSlotTime * accessCategory.arbitrationInterframeSpaceDurationSlots) - aRxTxTurnaroundTime;
+    if ((macLatencyBreakdownIsEnabled) && (transmissionSuspendedTime != INFINITE_TIME)) {
+        const SimTime suspendedDuration =
+            (simEngineInterfacePtr->CurrentTime() - transmissionSuspendedTime);
 
-    if ((mediumBecameIdleTime + ifsDuration) >= currentTime) {
+        for(unsigned int i = 0; (i < macLatencyBreakdownInfos.size()); i++) {
+            if (macLatencyBreakdownInfos[i].channelAccessStartTime != INFINITE_TIME) {
+                macLatencyBreakdownInfos[i].suspendedDuration += suspendedDuration;
+            }//if//
+        }//for//
 
-        // Wait for the interframe space.
+        transmissionSuspendedTime = INFINITE_TIME;
+    }//if//
 
-        return (mediumBecameIdleTime + ifsDuration - currentTime);
-    } else {
-        // Wait until next slot start.
+    if (heldAccessCategoryBitMask != 0) {
+        (*this).RestartHeldAccessCategories();
+    }//if//
 
-        return (aSlotTime - ((currentTime - mediumBecameIdleTime - ifsDuration) % aSlotTime));
+    if (macState == IdleState) {
+        //通る
+        //std::cout << "a" << endl;
+        (*this).StartBackoffIfNecessary();;
     }//if//
 
-}//CalculateNonExtendedDurationForJumpingOnMediumWithNoBackoff//
+}//ResumeTransmissionFunction//
 
 
 inline
-bool Dot11Mac::AccessCategoryIsActive(const unsigned int accessCategoryIndex) const
+void Dot11Mac::RestartHeldAccessCategories()
 {
-    const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
+    while (heldAccessCategoryBitMask != 0) {
+        const unsigned int accessCategoryIndex = LowestSetBitPosition(heldAccessCategoryBitMask);
 
-    return ((accessCategoryInfo.currentNonExtendedBackoffDuration != INFINITE_TIME) ||
-            (accessCategoryInfo.hasPacketToSend));
-}
+        heldAccessCategoryBitMask &= ~(1U << accessCategoryIndex);
 
-inline
-unsigned int Dot11Mac::FindIndexOfAccessCategoryWithEarliestBackoffExpiration() const
-{
-    unsigned int shortestIndex = static_cast<unsigned int>(accessCategories.size());
-    SimTime earliestExpirationTime = INFINITE_TIME;
+        EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-    // Higher Access Indices have higher priority
+        if (((accessCategoryInfo.currentPacketPtr == nullptr) &&
+             (accessCategoryInfo.currentAggregateFramePtr == nullptr)) ||
+            (AccessCategoryIsActive(accessCategoryIndex))) {
+            continue;
+        }//if//
 
-    for(int i = (numberAccessCategories - 1); (i >= 0); i--) {
-        const EdcaAccessCategoryInfo& accessCategoryInfo =
-            accessCategories[i];
+        accessCategoryInfo.hasPacketToSend = true;
 
-        if ((accessCategoryInfo.ifsAndBackoffStartTime != INFINITE_TIME) &&
-            (accessCategoryInfo.currentNonExtendedBackoffDuration != INFINITE_TIME)) {
+        // Random deferral spreads the interval start burst.
 
-            const SimTime expirationTime =
-                (accessCategories[i].ifsAndBackoffStartTime +
-                 accessCategories[i].currentNonExtendedBackoffDuration);
+        (*this).RecalcRandomBackoff(accessCategoryInfo);
 
-            if (expirationTime < earliestExpirationTime) {
-                earliestExpirationTime = expirationTime;
-                shortestIndex = i;
-            }//if//
+        if (macState == WaitingForIfsAndBackoffState) {
+            (*this).StartBackoffForCategory(accessCategoryIndex);
         }//if//
-    }//for//
+    }//while//
+
+}//RestartHeldAccessCategories//
 
-    return shortestIndex;
 
-}//FindIndexOfAccessCategoryWithEarliestBackoffExpiration//
+
+//--------------------------------------------------------------------------------------------------
+//
+// The following routines have to do with effect of on/off transitions of carrier sense
+// and virtual carrier sense (NAV) on the backoff of the EDCA access categories.
+//
+
 
 inline
-unsigned int Dot11Mac::FindIndexOfAccessCategoryWithShortestBackoff() const
+void Dot11Mac::ProcessVirtualCarrierSenseAkaNavExpiration()
 {
-    unsigned int shortestIndex = static_cast<unsigned int>(accessCategories.size());
-    SimTime shortestBackoff = INFINITE_TIME;
+    assert(macState == WaitingForNavExpirationState);
 
-    // Higher Access Indices have higher priority
+    OutputTraceForNavExpiration();
 
-    for(int i = (numberAccessCategories - 1); (i >= 0); i--) {
-        if (shortestBackoff > accessCategories[i].currentNonExtendedBackoffDuration) {
-            shortestBackoff = accessCategories[i].currentNonExtendedBackoffDuration;
-            shortestIndex = i;
-        }//if//
-    }//for//
+    macState = TransientState;
+    mediumBecameIdleTime = simEngineInterfacePtr->CurrentTime();
+    //通らなさそう
+    //std::cout << "b" << endl;
+    (*this).StartBackoffIfNecessary();
+}
 
-    return shortestIndex;
 
-}//FindIndexOfAccessCategoryWithShortestBackoff//
 
-//
 inline
-SimTime Dot11Mac::CurrentBackoffDuration() const
+int Dot11Mac::NumberBackoffSlotsUsedDuringElapsedTime(
+    const EdcaAccessCategoryInfo& accessCategory,
+    const SimTime& elapsedTime) const
 {
-    unsigned int accessCategoryIndex = FindIndexOfAccessCategoryWithShortestBackoff();
+    SimTime interframeSpaceDuration =
+        aShortInterframeSpaceTime + (aSlotTime * accessCategory.arbitrationInterframeSpaceDurationSlots);
 
-    if (accessCategoryIndex == accessCategories.size()) {
-        return INFINITE_TIME;
+    if (lastFrameReceivedWasCorrupt) {
+        interframeSpaceDuration += additionalDelayForExtendedInterframeSpaceMode;
     }//if//
 
-    const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-    //std::cout << "additional = " << (int)additionalDelayForExtendedInterframeSpaceMode << endl;
-    //バックオフはちゃんと優先度が高いと短い
-    //std::cout << "BackoffDuration = " << (int)accessCategoryInfo.currentNonExtendedBackoffDuration << endl;
-    //前回の送信が失敗していれば
-    if (lastFrameReceivedWasCorrupt) {
-        //待ち時間追加
-        
-        return (additionalDelayForExtendedInterframeSpaceMode +
-                accessCategoryInfo.currentNonExtendedBackoffDuration);
-    }
-    else {
-        return accessCategoryInfo.currentNonExtendedBackoffDuration;
+    if (elapsedTime <= interframeSpaceDuration) {
+        return 0;
     }//if//
 
-}//CurrentBackoffDuration//
+    return int((elapsedTime + aRxTxTurnaroundTime - interframeSpaceDuration) / aSlotTime);
 
+}//NumberBackoffSlotsUsedDuringElapsedTime//
 
 
 inline
-SimTime Dot11Mac::CurrentBackoffExpirationTime() const
+void Dot11Mac::PauseBackoffForAnAccessCategory(
+    const unsigned int accessCategoryIndex,
+    const SimTime& elapsedTime)
 {
-    assert(macState == WaitingForIfsAndBackoffState);
-
-    unsigned int accessCategoryIndex = FindIndexOfAccessCategoryWithEarliestBackoffExpiration();
+    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-    if (accessCategoryIndex == accessCategories.size()) {
-        return INFINITE_TIME;
-    }//if//
+    if (accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff) {
+        // Interrupted in Interframe space (IFS), must start backoff process.
 
-    const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
+        accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff = false;
+        accessCategoryInfo.currentNonExtendedBackoffDuration = INFINITE_TIME;
 
-    if (lastFrameReceivedWasCorrupt) {
-        return (additionalDelayForExtendedInterframeSpaceMode +
-                accessCategoryInfo.ifsAndBackoffStartTime +
-                accessCategoryInfo.currentNonExtendedBackoffDuration);
+        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndex, true);
     }
     else {
-        return (accessCategoryInfo.ifsAndBackoffStartTime +
-                accessCategoryInfo.currentNonExtendedBackoffDuration);
-    }//if//
 
-}//CurrentBackoffExpirationTime//
+        (*this).SubtractElapsedTimeFromBackoffDuration(accessCategoryIndex, elapsedTime);
 
+    }//if//
+
+}//PauseBackoffForAnAccessCategory//
 
-//-------------------------------------------------------------------------------------------------
 
-//ランダムバックオフの乱数再生成
 inline
-void Dot11Mac::RecalcRandomBackoff(EdcaAccessCategoryInfo& accessCategoryInfo)
+void Dot11Mac::SubtractElapsedTimeFromBackoffDuration(
+    const unsigned int accessCategoryIndex,
+    const SimTime& elapsedTime)
 {
-    //追加
-    const NodeId SourceId = simEngineInterfacePtr -> GetNodeId();
-    
-    //多分ここでcontentionwindow変えれてる
-    //if(SourceId == 1){
-        //std::cout << "ID = " << SourceId << endl;
-        //std::cout << "contention = " << accessCategoryInfo.currentContentionWindowSlots << endl;
-        /*if(accessCategoryInfo.currentContentionWindowSlots != accessCategoryInfo.maxContentionWindowSlots){
-            accessCategoryInfo.currentContentionWindowSlots = accessCategoryInfo.maxContentionWindowSlots;
-        }*/
-        //std::cout << "contention = " << accessCategoryInfo.currentContentionWindowSlots << endl;
-    //}else if(SourceId == 2){
-        //std::cout << "ID = " << SourceId << endl;
-   //}
+    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-    for(unsigned int i = 0; (i < accessCategories.size()); i++) {
-        //書き込み
-        //成功した
-        char fname[30];
-        sprintf(fname,"tmpCW_%d_%d.txt", i, SourceId);
-        std::ofstream outputfile(fname);
-        outputfile << (int)accessCategories[i].currentContentionWindowSlots << std::endl;
-        outputfile.close();
-        
-    }//for//
+    if (!accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff &&
+        (accessCategoryInfo.currentNonExtendedBackoffDuration != INFINITE_TIME)) {
+        accessCategoryInfo.currentNumOfBackoffSlots -=
+            NumberBackoffSlotsUsedDuringElapsedTime(accessCategoryInfo, elapsedTime);
+
+        assert(accessCategoryInfo.currentNumOfBackoffSlots >= 0);
 
-    
+        accessCategoryInfo.currentNonExtendedBackoffDuration =
+            CalculateNonExtendedBackoffDuration(accessCategoryInfo);
 
-    accessCategoryInfo.currentNumOfBackoffSlots =
-        aRandomNumberGenerator.GenerateRandomInt(0, accessCategoryInfo.currentContentionWindowSlots);
+        OutputTraceForInterruptedIfsAndBackoff(
+            accessCategoryIndex,
+            accessCategoryInfo.currentNonExtendedBackoffDuration);
+    }//if//
 
-    accessCategoryInfo.currentNonExtendedBackoffDuration =
-        CalculateNonExtendedBackoffDuration(accessCategoryInfo);
-}
+}//SubtractElapsedTimeFromBackoffDuration//
 
-//バックオフ実行
 inline
-void Dot11Mac::StartBackoffIfNecessary()
+void Dot11Mac::BusyChannelAtPhysicalLayerNotification()
 {
-    assert(macState != WaitingForIfsAndBackoffState);
-
     const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
 
-    if (currentTime >= transmissionPermissionEndTime) {
-        macState = IdleState;
-        return;
-    }
+    OutputTraceForBusyChannel();
 
-    const SimTime backoffDuration = CurrentBackoffDuration();
+    if (!physicalChannelIsBusy) {
+        physicalChannelIsBusy = true;
+        physicalChannelBusyStartTime = currentTime;
+    }//if//
 
-    if (backoffDuration == INFINITE_TIME) {
-        macState = IdleState;
-        return;
+    if (channelBusyRatioEstimatorPtr != nullptr) {
+        channelBusyRatioEstimatorPtr->ChannelBecameBusy(currentTime);
     }//if//
 
-    macState = WaitingForIfsAndBackoffState;
+    if (congestionMonitoringHandlerPtr != nullptr) {
+        congestionMonitoringHandlerPtr->ChannelBecameBusy(currentTime);
+    }//if//
 
-    for(unsigned int i = 0; (i < accessCategories.size()); i++) {
-        EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[i];
-        if (accessCategoryInfo.currentNonExtendedBackoffDuration != INFINITE_TIME) {
-            accessCategoryInfo.ifsAndBackoffStartTime = currentTime;
-        }
-        else {
-            accessCategoryInfo.ifsAndBackoffStartTime = INFINITE_TIME;
-        }//if//
-    }//for//
+    switch (macState) {
+    case WaitingForNavExpirationState:
+        (*this).CancelWakeupTimer();
+        macState = BusyMediumState;
 
-    //バックオフ表示意外とムラがある
-    //追加テスト用
-    /*const NodeId SourceId = simEngineInterfacePtr -> GetNodeId();;
-    if(SourceId == 1){
-        std::cout << "バックオフ時間1 = " << (int)backoffDuration << endl;
+        break;
+
+    case WaitingForIfsAndBackoffState: {
+
+        macState = BusyMediumState;
+
+        for(unsigned int i = 0; (i < accessCategories.size()); i++) {
+            SimTime elapsedTime = (currentTime - accessCategories[i].ifsAndBackoffStartTime);
+
+            (*this).PauseBackoffForAnAccessCategory(i, elapsedTime);
+        }//for//
+
+        (*this).CancelWakeupTimer();
+
+        break;
     }
-    if(SourceId == 2){
-        std::cout << "バックオフ時間2 = " << (int)backoffDuration << endl;
-    }*/
-    //現在の時間＋バックオフの時間
+    case IdleState:
+        macState = BusyMediumState;
+        break;
+
+    case WaitingForCtsState:
+    case WaitingForAckState:
+
+        // Ignore (incoming frame could be for this station).
+        break;
+
+    case BusyMediumState:
+    case CtsOrAckTransmissionState:
+
+        // Ignore: Still busy
+        //assert(false && "PHY sending duplicate notifications, should not happen."); abort();
+        break;
 
-    //ここで優先度or速度を取れれば連続送信可能か
+    default:
+        assert(false); abort(); break;
+    }//switch//
 
-    //std::cout << "2" << endl;
-    //while(1);
-    //sendbasicmessageよりあとに通る.
+}//BusyChannelAtPhysicalLayerNotification//
 
-    (*this).ScheduleWakeupTimer(currentTime + backoffDuration);
 
-    OutputTraceForIfsAndBackoffStart(backoffDuration);
+inline
+void Dot11Mac::GoIntoWaitForExpirationOfVirtualCarrierSenseAkaNavState()
+{
+    assert((macState == BusyMediumState) || (macState == TransientState));
+    assert(wakeupTimerEventTicket.IsNull());
 
-}//StartBackoffIfNecessary//
+    macState = WaitingForNavExpirationState;
+
+    (*this).ScheduleWakeupTimer(mediumReservedUntilTimeAkaNAV);
+
+    OutputTraceForNavStart(mediumReservedUntilTimeAkaNAV);
+}
 
 
 inline
-void Dot11Mac::StartBackoffForCategory(const unsigned int accessCategoryIndex)
+void Dot11Mac::ClearChannelAtPhysicalLayerNotification()
 {
-    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+    OutputTraceForClearChannel();
 
-    if (currentTime >= transmissionPermissionEndTime) {
-        macState = IdleState;
-        return;
-    }
+    if (physicalChannelIsBusy) {
+        accumulatedPhysicalChannelBusyDuration +=
+            (simEngineInterfacePtr->CurrentTime() - physicalChannelBusyStartTime);
+        physicalChannelIsBusy = false;
+    }//if//
 
-    assert((macState == IdleState) || (macState == WaitingForIfsAndBackoffState));
-    (*this).macState = WaitingForIfsAndBackoffState;
+    if (channelBusyRatioEstimatorPtr != nullptr) {
+        channelBusyRatioEstimatorPtr->ChannelBecameClear(simEngineInterfacePtr->CurrentTime());
+    }//if//
 
-    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
-    accessCategoryInfo.ifsAndBackoffStartTime = currentTime;
+    if (congestionMonitoringHandlerPtr != nullptr) {
+        congestionMonitoringHandlerPtr->ChannelBecameClear(simEngineInterfacePtr->CurrentTime());
+    }//if//
 
-    //exporation...期限とか満了とか
-    const SimTime wakeupTime = CurrentBackoffExpirationTime();
+    if ((macState == WaitingForCtsState) || (macState == WaitingForAckState)) {
+        if (WakeupTimerIsActive()) {
+            // Wait until the CTS/ACK timeout completes before taking action.
+            return;
+        }
+        else {
+            // Get out of the ACK/CTS timeout state.
+            macState = TransientState;
 
-    //通ってなさそう
-    //std::cout << "wakeuptime = " << (int)wakeupTime << endl; 
+            (*this).NeverReceivedClearToSendOrAcknowledgementAction();
+        }//if//
 
-    if (wakeupTime != currentWakeupTimerExpirationTime) {
-        (*this).ScheduleWakeupTimer(wakeupTime);
+    }//if//
 
-        OutputTraceForIfsAndBackoffStart(wakeupTime - currentTime);
+    if (macState == WaitingForNavExpirationState) {
+        return;
     }//if//
 
-    assert(macState == WaitingForIfsAndBackoffState);
+    assert((macState == BusyMediumState) || (macState == TransientState));
 
-}//StartBackoffForCategory//
+    if (simEngineInterfacePtr->CurrentTime() < mediumReservedUntilTimeAkaNAV) {
+        (*this).GoIntoWaitForExpirationOfVirtualCarrierSenseAkaNavState();
+    }
+    else {
+        mediumBecameIdleTime = simEngineInterfacePtr->CurrentTime();
+        //通る
+        //std::cout << "c" << endl;
+        (*this).StartBackoffIfNecessary();
+
+    }//if//
 
+    assert((macState != BusyMediumState) && (macState != TransientState));
 
+}//ClearChannelAtPhysicalLayerNotification//
 
 
-//-------------------------------------------------------------------------------------------------
-//
-// The following routines are for when a new packet appears at the Network Layer and a
-// access category goes from idle to active.
-//
 
 
+//txopについて
 inline
-void Dot11Mac::StartPacketSendProcessForAnAccessCategory(
-    const unsigned int accessCategoryIndex,
-    const bool forceBackoff)
+void Dot11Mac::DoSuccessfulTransmissionPostProcessing(const bool wasJustTransmitting)
 {
-    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
+    if (currentTransmitOpportunityAkaTxopEndTime == ZERO_TIME) {
 
-    accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff = false;
+        // TXOP is not being used (1 frame per medium access).
+        // or number packet limit is exhausted.
 
-    if ((accessCategoryInfo.currentPacketPtr == nullptr) &&
-        (accessCategoryInfo.currentAggregateFramePtr == nullptr)) {
+        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndexForLastSentFrame, true);
+        return;
+    }//if//
 
-        accessCategoryInfo.hasPacketToSend =
-            ThereAreQueuedPacketsForAccessCategory(accessCategoryIndex);
+    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+    const SimTime nextFrameSequenceDuration =
+        CalculateNextFrameSequenceDuration(accessCategoryIndexForLastSentFrame);
 
-    }//if//
+    if (nextFrameSequenceDuration == ZERO_TIME) {
 
-    if ((!forceBackoff) && (!accessCategoryInfo.hasPacketToSend)) {
-        accessCategoryInfo.currentNonExtendedBackoffDuration = INFINITE_TIME;
+        // Nothing To Send
 
-        return;
+        currentTransmitOpportunityAkaTxopEndTime = ZERO_TIME;
+        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndexForLastSentFrame, true);
 
+        return;
     }//if//
 
-    assert(accessCategoryInfo.currentNonExtendedBackoffDuration == INFINITE_TIME);
+    if ((currentTime + nextFrameSequenceDuration) > currentTransmitOpportunityAkaTxopEndTime) {
 
-    switch (macState) {
-    case BusyMediumState:
-    case CtsOrAckTransmissionState:
-    case WaitingForNavExpirationState:
-    case WaitingForCtsState:
-    case WaitingForAckState:
-    case ChangingChannelsState:
-    {
-        (*this).RecalcRandomBackoff(accessCategoryInfo);
+        // Not enough time left in the TXOP for next packet.
 
-        break;
+        currentTransmitOpportunityAkaTxopEndTime = ZERO_TIME;
+        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndexForLastSentFrame, true);
     }
-    case IdleState:
-    case WaitingForIfsAndBackoffState:
-    {
-        if (disabledToJumpOnMediumWithoutBackoff) {
+    else {
+        // Send another packet in the TXOP (Transmit opportunity).
 
-            // Note: Add complete IFS even if channel is completely idle.
+        bool packetHasBeenSentToPhy;
 
-            (*this).RecalcRandomBackoff(accessCategoryInfo);
+        SimTime transmitDelay = ZERO_TIME;
+        if (!wasJustTransmitting) {
+            transmitDelay = aShortInterframeSpaceTime;
+        }//if//
 
-            accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff = false;
-        }
-        else {
-            assert(!forceBackoff);
+        (*this).TransmitAFrame(
+            accessCategoryIndexForLastSentFrame,
+            true,
+            transmitDelay,
+            packetHasBeenSentToPhy);
 
-            accessCategoryInfo.currentNumOfBackoffSlots = 0;
-            accessCategoryInfo.currentNonExtendedBackoffDuration =
-                CalculateNonExtendedDurationForJumpingOnMediumWithNoBackoff(accessCategoryInfo);
-            accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff = true;
-        }
+        assert(packetHasBeenSentToPhy);
+    }//if//
 
-        (*this).StartBackoffForCategory(accessCategoryIndex);
+}//DoSuccessfulTransmissionPostProcessing//
 
-        break;
-    }
-    default:
-        assert(false); abort(); break;
-    }//switch//
 
-}//StartPacketSendProcessForAnAccessCategory//
 
+// Could infer this functionality from Carrier/No Carrier notifications
+// but added for clarity.
 
 inline
-bool Dot11Mac::NetworkLayerHasPacketForAccessCategory(const unsigned int accessCategoryIndex) const
+void Dot11Mac::TransmissionIsCompleteNotification()
 {
-    const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
-
-    for(unsigned int i = 0; (i < accessCategoryInfo.listOfPriorities.size()); i++) {
-        if (networkOutputQueuePtr->HasPacketWithPriority(accessCategoryInfo.listOfPriorities[i])) {
-            return true;
-        }//if//
-    }//for//
-
-    return false;
+    if (macLatencyBreakdownIsEnabled) {
+        (*this).RecordMacLatencyForTransmissionEnd(accessCategoryIndexForLastSentFrame);
+    }//if//
 
-}//NetworkLayerHasPacketForAccessCategory//
+    if (macState == WaitingForCtsState) {
 
+        (*this).ScheduleWakeupTimer(
+            simEngineInterfacePtr->CurrentTime() + clearToSendTimeoutDuration);
+    }
+    else if (macState == WaitingForAckState) {
 
+        (*this).ScheduleWakeupTimer(simEngineInterfacePtr->CurrentTime() + ackTimeoutDuration);
+    }
+    else if (macState == CtsOrAckTransmissionState) {
+        macState = BusyMediumState;
+    }
+    else if (macState == ChangingChannelsState) {
 
-inline
-void Dot11Mac::NetworkLayerQueueChangeNotification()
-{
-    // High Priority to Low priority category order:
+        // Assume the medium is busy, but if it is idle the PHY will notify the MAC at channel
+        // switch.
 
-    for(int i = (numberAccessCategories-1); (i >= 0); i--) {
-        if (!AccessCategoryIsActive(i)) {
+        macState = BusyMediumState;
 
-            (*this).StartPacketSendProcessForAnAccessCategory(i);
+        // Assume last transmission failed (unless it was a broadcast).
 
-        }//if//
-    }//for//
+        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndexForLastSentFrame);
+        (*this).SwitchToChannels(switchingToThisChannelList);
+    }
+    else {
+        assert(macState == BusyMediumState);
 
-}//NetworkLayerQueueChangeNotification//
+        (*this).DoSuccessfulTransmissionPostProcessing(true);
 
+    }//if//
 
+}//TransmissionIsCompleteNotification//
 
 
-inline
-bool Dot11Mac::ThereAreQueuedPacketsForAccessCategory(const unsigned int accessCategoryIndex) const
-{
-    return (((accessCategoryIndex == accessCategoryIndexForManagementFrames) &&
-             (!managementFrameQueue.empty())) ||
-            (NetworkLayerHasPacketForAccessCategory(accessCategoryIndex)));
-}
 
+//--------------------------------------------------------------------------------------------------
 
 inline
-void Dot11Mac::SuspendTransmissionFunction()
+void Dot11Mac::SetMpduFrameAggregationIsEnabledFor(const MacAddress& destinationAddress)
 {
-    assert(macState != CtsOrAckTransmissionState &&
-           macState != TransientState &&
-           macState != ChangingChannelsState);
-
-    assert(!physicalLayerPtr->IsTransmittingAFrame());
-
-    switch (macState) {
-    case WaitingForCtsState:
-    case WaitingForAckState:
-        if ((*this).WakeupTimerIsActive()) {
-            simEngineInterfacePtr->CancelEvent(wakeupTimerEventTicket);
-        }//if//
-        if (!physicalLayerPtr->IsReceivingAFrame()) {
-            macState = BusyMediumState;
-        }//if//
-        break;
-
-    case WaitingForIfsAndBackoffState: {
-        const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
-
-        for(unsigned int i = 0; (i < accessCategories.size()); i++) {
-            SimTime elapsedTime = (currentTime - accessCategories[i].ifsAndBackoffStartTime);
-
-            (*this).SubtractElapsedTimeFromBackoffDuration(i, elapsedTime);
-        }//for//
-        if ((*this).WakeupTimerIsActive()) {
-            simEngineInterfacePtr->CancelEvent(wakeupTimerEventTicket);
-        }//if//
-        macState = IdleState;
-        break;
-    }
-
-    case IdleState:
-    case BusyMediumState:
-    case WaitingForNavExpirationState:
-    default:
-        break;
-    }//switch//
-
-    transmissionPermissionEndTime = simEngineInterfacePtr->CurrentTime();
+    neighborCapabilitiesMap[destinationAddress].mpduFrameAggregationIsEnabled = true;
+}
 
-    // receiving only mode
-}//SuspendTransmissionFunction//
 
-//送信関数を再び始める？
 inline
-void Dot11Mac::ResumeTransmissionFunction(const SimTime& initTransmissionPermissionEndTime)
+bool Dot11Mac::FrameAggregationIsEnabledFor(const MacAddress& destinationAddress) const
 {
-    transmissionPermissionEndTime = initTransmissionPermissionEndTime;
-    assert(transmissionPermissionEndTime > simEngineInterfacePtr->CurrentTime());
+    typedef map<MacAddress, NeighborCapabilities>::const_iterator IterType;
 
-    if (macState == IdleState) {
-        //通る
-        //std::cout << "a" << endl;
-        (*this).StartBackoffIfNecessary();;
+    if (neighborCapabilitiesMap.empty()) {
+        return false;
     }//if//
 
-}//ResumeTransmissionFunction//
+    IterType iter = neighborCapabilitiesMap.find(destinationAddress);
 
+    if (iter == neighborCapabilitiesMap.end()) {
+        return false;
+    }//if//
 
+    const NeighborCapabilities& capabilities = iter->second;
+
+    return (capabilities.mpduFrameAggregationIsEnabled);
+
+}//FrameAggregationIsEnabledForLink//
 
-//--------------------------------------------------------------------------------------------------
-//
-// The following routines have to do with effect of on/off transitions of carrier sense
-// and virtual carrier sense (NAV) on the backoff of the EDCA access categories.
-//
 
 
 inline
-void Dot11Mac::ProcessVirtualCarrierSenseAkaNavExpiration()
+bool Dot11Mac::MpduFrameAggregationIsEnabledFor(const MacAddress& destinationAddress) const
 {
-    assert(macState == WaitingForNavExpirationState);
+    typedef map<MacAddress, NeighborCapabilities>::const_iterator IterType;
 
-    OutputTraceForNavExpiration();
+    if (neighborCapabilitiesMap.empty()) {
+        return false;
+    }//if//
 
-    macState = TransientState;
-    mediumBecameIdleTime = simEngineInterfacePtr->CurrentTime();
-    //通らなさそう
-    //std::cout << "b" << endl;
-    (*this).StartBackoffIfNecessary();
-}
+    IterType iter = neighborCapabilitiesMap.find(destinationAddress);
+
+    if (iter == neighborCapabilitiesMap.end()) {
+        return false;
+    }//if//
+
+    const NeighborCapabilities& capabilities = iter->second;
+
+    return (capabilities.mpduFrameAggregationIsEnabled);
+
+}//MpduFrameAggregationIsEnabledForLink//
 
 
 
 inline
-int Dot11Mac::NumberBackoffSlotsUsedDuringElapsedTime(
-    const EdcaAccessCategoryInfo& accessCategory,
-    const SimTime& elapsedTime) const
+bool Dot11Mac::NeedToSendABlockAckRequest(
+    const MacAddress& destinationAddress,
+    const PacketPriority& trafficId) const
 {
-    SimTime interframeSpaceDuration =
-        aShortInterframeSpaceTime + (aSlotTime * accessCategory.arbitrationInterframeSpaceDurationSlots);
-
-    if (lastFrameReceivedWasCorrupt) {
-        interframeSpaceDuration += additionalDelayForExtendedInterframeSpaceMode;
-    }//if//
+    typedef map<AddressAndTrafficIdMapKey, OutgoingLinkInfo>::const_iterator IterType;
 
+    IterType iter =
+        outgoingLinkInfoMap.find(AddressAndTrafficIdMapKey(destinationAddress, trafficId));
 
-    if (elapsedTime <= interframeSpaceDuration) {
-        return 0;
+    if (iter == outgoingLinkInfoMap.end()) {
+        return false;
     }//if//
 
-    return int((elapsedTime + aRxTxTurnaroundTime - interframeSpaceDuration) / aSlotTime);
+    return ((*iter).second.blockAckRequestNeedsToBeSent);
+
+}//NeedToSendBlockAckRequest//
 
-}//NumberBackoffSlotsUsedDuringElapsedTime//
 
 
 inline
-void Dot11Mac::PauseBackoffForAnAccessCategory(
-    const unsigned int accessCategoryIndex,
-    const SimTime& elapsedTime)
+void Dot11Mac::BuildAggregateFrameFromCurrentFrame(const unsigned int accessCategoryIndex)
 {
+    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+
+    assert((allowFrameAggregationWithTxopZero) ||
+           (currentTransmitOpportunityAkaTxopEndTime != ZERO_TIME));
+
     EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-    if (accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff) {
-        // Interrupted in Interframe space (IFS), must start backoff process.
+    const bool useMpduAggregation =
+        MpduFrameAggregationIsEnabledFor(accessCategoryInfo.currentPacketsDestinationMacAddress);
 
-        accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff = false;
-        accessCategoryInfo.currentNonExtendedBackoffDuration = INFINITE_TIME;
+    accessCategoryInfo.currentAggregateFrameIsAMpduAggregate = useMpduAggregation;
 
-        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndex, true);
-    }
-    else {
+    (*this).AllocateAggregateFrameContainer(accessCategoryInfo);
 
-        (*this).SubtractElapsedTimeFromBackoffDuration(accessCategoryIndex, elapsedTime);
+    accessCategoryInfo.currentAggregateFramePtr->push_back(move(accessCategoryInfo.currentPacketPtr));
 
-    }//if//
+    accessCategoryInfo.currentShortFrameRetryCount = 0;
+    accessCategoryInfo.currentLongFrameRetryCount = 0;
+    accessCategoryInfo.currentAggregateFrameRetryCount = 0;
 
-}//PauseBackoffForAnAccessCategory//
+    vector<unique_ptr<Packet> >& frameList = *accessCategoryInfo.currentAggregateFramePtr;
 
+    const QosDataFrameHeader copyOfOriginalFrameHeader =
+        frameList[0]->GetAndReinterpretPayloadData<QosDataFrameHeader>();
 
-inline
-void Dot11Mac::SubtractElapsedTimeFromBackoffDuration(
-    const unsigned int accessCategoryIndex,
-    const SimTime& elapsedTime)
-{
-    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
+    AddMpduDelimiterAndPaddingToFrame(*frameList[0]);
 
-    if (!accessCategoryInfo.tryingToJumpOnMediumWithoutABackoff &&
-        (accessCategoryInfo.currentNonExtendedBackoffDuration != INFINITE_TIME)) {
-        accessCategoryInfo.currentNumOfBackoffSlots -=
-            NumberBackoffSlotsUsedDuringElapsedTime(accessCategoryInfo, elapsedTime);
+    // Assuming No RTS/CTS for aggregated frames ("Greenfield" not supported).
 
-        assert(accessCategoryInfo.currentNumOfBackoffSlots >= 0);
+    TransmissionParameters txParameters;
 
-        accessCategoryInfo.currentNonExtendedBackoffDuration =
-            CalculateNonExtendedBackoffDuration(accessCategoryInfo);
+    theAdaptiveRateControllerPtr->GetDataRateInfoForDataFrameToStation(
+        accessCategoryInfo.currentPacketsDestinationMacAddress,
+        txParameters);
 
-        OutputTraceForInterruptedIfsAndBackoff(
-            accessCategoryIndex,
-            accessCategoryInfo.currentNonExtendedBackoffDuration);
-    }//if//
+    unsigned int totalBytes = frameList[0]->LengthBytes();
 
-}//SubtractElapsedTimeFromBackoffDuration//
+    SimTime endTime =
+        currentTime +
+        CalculateFrameDuration(frameList[0]->LengthBytes(), txParameters);
 
-inline
-void Dot11Mac::BusyChannelAtPhysicalLayerNotification()
-{
-    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+    endTime += aShortInterframeSpaceTime;
+    endTime += CalculateFrameDuration(sizeof(BlockAcknowledgementFrame), txParameters);
 
-    OutputTraceForBusyChannel();
+    const PacketPriority& priority = accessCategoryInfo.currentPacketPriorityAkaTrafficId;
 
-    switch (macState) {
-    case WaitingForNavExpirationState:
-        (*this).CancelWakeupTimer();
-        macState = BusyMediumState;
+    const unsigned int maxNumSubframes =
+        CalcNumberFramesLeftInSequenceNumWindow(
+            accessCategoryInfo.currentPacketsDestinationMacAddress,
+            accessCategoryInfo.currentPacketPriorityAkaTrafficId) + 1;
 
-        break;
+    while ((accessCategoryInfo.currentAggregateFramePtr->size() < maxNumSubframes) &&
+           (((allowFrameAggregationWithTxopZero) &&
+             (currentTransmitOpportunityAkaTxopEndTime == ZERO_TIME)) ||
+            (endTime < currentTransmitOpportunityAkaTxopEndTime)) &&
+           (networkOutputQueuePtr->HasPacketWithPriority(priority)) &&
+           (networkOutputQueuePtr->NextHopForTopPacket(priority) ==
+            accessCategoryInfo.currentPacketsNextHopNetworkAddress)) {
 
-    case WaitingForIfsAndBackoffState: {
+        unsigned int packetLengthBytes;
 
-        macState = BusyMediumState;
+        packetLengthBytes =
+            (networkOutputQueuePtr->TopPacket(priority).LengthBytes() +
+            sizeof(QosDataFrameHeader) +
+            sizeof(MpduDelimiterFrame));
 
-        for(unsigned int i = 0; (i < accessCategories.size()); i++) {
-            SimTime elapsedTime = (currentTime - accessCategories[i].ifsAndBackoffStartTime);
+        if ((totalBytes + packetLengthBytes) > maxAggregateMpduSizeBytes) {
+            break;
+        }//if//
 
-            (*this).PauseBackoffForAnAccessCategory(i, elapsedTime);
-        }//for//
+        // Only first frame of aggregate has Phy header.
 
-        (*this).CancelWakeupTimer();
+        endTime += CalculateFrameDurationWithoutPhyHeader(packetLengthBytes, txParameters);
 
-        break;
+        if ((!allowFrameAggregationWithTxopZero) &&
+            (endTime >= currentTransmitOpportunityAkaTxopEndTime)) {
+
+            break;
+        }//if//
+
+        NetworkAddress nextHopAddress;
+        EtherTypeField etherType;
+        SimTime timestamp;
+        unsigned int retryTxCount;
+
+        unique_ptr<Packet> framePtr;
+
+        networkOutputQueuePtr->DequeuePacketWithPriority(
+            priority,
+            framePtr,
+            nextHopAddress,
+            etherType,
+            timestamp,
+            retryTxCount);
+
+        assert(nextHopAddress == accessCategoryInfo.currentPacketsNextHopNetworkAddress);
+        assert(retryTxCount == 0);
+        assert(etherType == accessCategoryInfo.currentPacketsEtherType);
+
+        unsigned short int newSequenceNumber;
+        (*this).GetNewSequenceNumber(
+            accessCategoryInfo.currentPacketsDestinationMacAddress,
+            priority, false, newSequenceNumber);
+
+        QosDataFrameHeader dataFrameHeader = copyOfOriginalFrameHeader;
+        dataFrameHeader.theSequenceControlField.sequenceNumber = newSequenceNumber;
+
+        framePtr->AddPlainStructHeader(dataFrameHeader);
+        AddMpduDelimiterAndPaddingToFrame(*framePtr);
+
+        totalBytes += framePtr->LengthBytes();
+
+        accessCategoryInfo.currentAggregateFramePtr->push_back(move(framePtr));
+
+    }//while//
+
+    if (accessCategoryInfo.currentAggregateFramePtr->size() > 1) {
+        // No padding needed on last frame.
+        RemoveMpduAggregationPaddingFromFrame(
+            *accessCategoryInfo.currentAggregateFramePtr->back());
     }
-    case IdleState:
-        macState = BusyMediumState;
-        break;
+    else {
+        // Aggregation Failure (Back to single frame).
 
-    case WaitingForCtsState:
-    case WaitingForAckState:
+        accessCategoryInfo.currentPacketPtr =
+            move(accessCategoryInfo.currentAggregateFramePtr->front());
 
-        // Ignore (incoming frame could be for this station).
-        break;
+        (*this).RecycleAggregateFrameContainer(accessCategoryInfo);
 
-    case BusyMediumState:
-    case CtsOrAckTransmissionState:
+        RemoveMpduDelimiterAndPaddingFromFrame(*accessCategoryInfo.currentPacketPtr);
+    }//if//
 
-        // Ignore: Still busy
-        //assert(false && "PHY sending duplicate notifications, should not happen."); abort();
-        break;
+}//BuildAggregateFrameFromCurrentFrame//
 
-    default:
-        assert(false); abort(); break;
-    }//switch//
 
-}//BusyChannelAtPhysicalLayerNotification//
 
+inline
+void Dot11Mac::AllocateAggregateFrameContainer(EdcaAccessCategoryInfo& accessCategoryInfo) const
+{
+    assert(accessCategoryInfo.currentAggregateFramePtr == nullptr);
+
+    if (accessCategoryInfo.spareAggregateFrameContainerPtr != nullptr) {
+        accessCategoryInfo.currentAggregateFramePtr =
+            move(accessCategoryInfo.spareAggregateFrameContainerPtr);
+
+        assert(accessCategoryInfo.currentAggregateFramePtr->empty());
+        return;
+    }//if//
+
+    // Capacity for the largest aggregate: bounded by both the A-MPDU size limit
+    // (smallest possible subframe) and the Block Ack window.
+
+    const unsigned int minSubframeSizeBytes =
+        static_cast<unsigned int>(sizeof(QosDataFrameHeader) + sizeof(MpduDelimiterFrame));
 
-inline
-void Dot11Mac::GoIntoWaitForExpirationOfVirtualCarrierSenseAkaNavState()
-{
-    assert((macState == BusyMediumState) || (macState == TransientState));
-    assert(wakeupTimerEventTicket.IsNull());
+    const unsigned int maxNumSubframes =
+        std::max(
+            1U,
+            std::min(
+                (maxAggregateMpduSizeBytes / minSubframeSizeBytes),
+                static_cast<unsigned int>(BlockAckBitMapNumBits)));
 
-    macState = WaitingForNavExpirationState;
+    accessCategoryInfo.currentAggregateFramePtr.reset(new vector<unique_ptr<Packet> >());
+    accessCategoryInfo.currentAggregateFramePtr->reserve(maxNumSubframes);
 
-    (*this).ScheduleWakeupTimer(mediumReservedUntilTimeAkaNAV);
+}//AllocateAggregateFrameContainer//
 
-    OutputTraceForNavStart(mediumReservedUntilTimeAkaNAV);
-}
 
 
 inline
-void Dot11Mac::ClearChannelAtPhysicalLayerNotification()
+void Dot11Mac::RecycleAggregateFrameContainer(EdcaAccessCategoryInfo& accessCategoryInfo) const
 {
-    OutputTraceForClearChannel();
+    assert(accessCategoryInfo.currentAggregateFramePtr != nullptr);
 
-    if ((macState == WaitingForCtsState) || (macState == WaitingForAckState)) {
-        if (WakeupTimerIsActive()) {
-            // Wait until the CTS/ACK timeout completes before taking action.
-            return;
-        }
-        else {
-            // Get out of the ACK/CTS timeout state.
-            macState = TransientState;
+    // Frees any remaining subframes; the vector's capacity is retained.
 
-            (*this).NeverReceivedClearToSendOrAcknowledgementAction();
-        }//if//
+    accessCategoryInfo.currentAggregateFramePtr->clear();
 
-    }//if//
+    accessCategoryInfo.spareAggregateFrameContainerPtr =
+        move(accessCategoryInfo.currentAggregateFramePtr);
 
-    if (macState == WaitingForNavExpirationState) {
-        return;
-    }//if//
+}//RecycleAggregateFrameContainer//
 
-    assert((macState == BusyMediumState) || (macState == TransientState));
 
-    if (simEngineInterfacePtr->CurrentTime() < mediumReservedUntilTimeAkaNAV) {
-        (*this).GoIntoWaitForExpirationOfVirtualCarrierSenseAkaNavState();
-    }
-    else {
-        mediumBecameIdleTime = simEngineInterfacePtr->CurrentTime();
-        //通る
-        //std::cout << "c" << endl;
-        (*this).StartBackoffIfNecessary();
 
-    }//if//
+inline
+void Dot11Mac::RetrievePacketFromNetworkLayerForAccessCategory(
+    const unsigned int accessCategoryIndex,
+    bool& wasRetrieved)
+{
+    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-    assert((macState != BusyMediumState) && (macState != TransientState));
+    assert(accessCategoryInfo.currentPacketPtr == nullptr);
 
-}//ClearChannelAtPhysicalLayerNotification//
+    wasRetrieved = false;
 
+    PacketPriority priority;
 
+    while ((!wasRetrieved) &&
+           (FindNonEmptyPrioritySubqueueForAccessCategory(accessCategoryIndex, priority))) {
 
+        NetworkAddress nextHopAddress;
+        EtherTypeField etherType;
+        SimTime timestamp;
+        unsigned int retryTxCount;
+        bool datarateAndTxPowerAreSpecified;
+        DatarateBitsPerSec specifiedPacketDatarateBitsPerSec;
+        double specifiedPacketTxPowerDbm;
 
-//txopについて
-inline
-void Dot11Mac::DoSuccessfulTransmissionPostProcessing(const bool wasJustTransmitting)
-{
-    if (currentTransmitOpportunityAkaTxopEndTime == ZERO_TIME) {
+        networkOutputQueuePtr->DequeuePacketWithEtherTypeAndDatarateAndTxPower(
+            priority,
+            accessCategoryInfo.currentPacketPtr,
+            nextHopAddress,
+            timestamp,
+            retryTxCount,
+            etherType,
+            datarateAndTxPowerAreSpecified,
+            specifiedPacketDatarateBitsPerSec,
+            specifiedPacketTxPowerDbm);
 
-        // TXOP is not being used (1 frame per medium access).
-        // or number packet limit is exhausted.
+        assert((nextHopAddress.IsTheBroadcastAddress()) ||
+               !(nextHopAddress.IsABroadcastAddress(networkLayerPtr->GetSubnetMask(interfaceIndex))) &&
+               "Make sure no mask dependent broadcast address from network layer");
 
-        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndexForLastSentFrame, true);
-        return;
-    }//if//
+        const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+        if (accessCategoryInfo.frameLifetime < (currentTime - timestamp)) {
+            //lifetime expired
+            (*this).DropLifetimeExpiredFrame(
+                accessCategoryIndex,
+                accessCategoryInfo.currentPacketPtr);
 
-    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
-    const SimTime nextFrameSequenceDuration =
-        CalculateNextFrameSequenceDuration(accessCategoryIndexForLastSentFrame);
+            // Loop again to get another packet.
+            continue;
+        }//if//
 
-    if (nextFrameSequenceDuration == ZERO_TIME) {
+        accessCategoryInfo.currentPacketPriorityAkaTrafficId = priority;
+        accessCategoryInfo.currentPacketsNextHopNetworkAddress = nextHopAddress;
+        accessCategoryInfo.currentPacketsEtherType = etherType;
+        accessCategoryInfo.currentPacketsTimestamp = timestamp;
 
-        // Nothing To Send
+        accessCategoryInfo.currentPacketDatarateAndTxPowerAreSpecified = datarateAndTxPowerAreSpecified;
+        accessCategoryInfo.specifiedPacketDatarateBitsPerSec = specifiedPacketDatarateBitsPerSec;
+        accessCategoryInfo.specifiedPacketTxPowerDbm = specifiedPacketTxPowerDbm;
 
-        currentTransmitOpportunityAkaTxopEndTime = ZERO_TIME;
-        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndexForLastSentFrame, true);
+        const unsigned int adjustedFrameLengthBytes =
+            accessCategoryInfo.currentPacketPtr->LengthBytes() +
+            sizeof(QosDataFrameHeader);
 
-        return;
-    }//if//
+        if (adjustedFrameLengthBytes < rtsThresholdSizeBytes) {
+            accessCategoryInfo.currentShortFrameRetryCount = retryTxCount;
+            accessCategoryInfo.currentLongFrameRetryCount = 0;
+        }
+        else {
+            accessCategoryInfo.currentShortFrameRetryCount = 0;
+            accessCategoryInfo.currentLongFrameRetryCount = retryTxCount;
+        }//if//
 
-    if ((currentTime + nextFrameSequenceDuration) > currentTransmitOpportunityAkaTxopEndTime) {
+        if (redundantTraceInformationModeIsOn) {
+            OutputTraceForPacketDequeue(accessCategoryIndex, aRxTxTurnaroundTime);
+        } else {
+            OutputTraceForPacketDequeue(accessCategoryIndex);
+        }//if//
 
-        // Not enough time left in the TXOP for next packet.
+        if ((refreshNextHopOnDequeueModeIsOn) && (!nextHopAddress.IsTheBroadcastAddress())) {
+            // Update the next hop to latest.
 
-        currentTransmitOpportunityAkaTxopEndTime = ZERO_TIME;
-        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndexForLastSentFrame, true);
-    }
-    else {
-        // Send another packet in the TXOP (Transmit opportunity).
+            bool nextHopWasFound;
+            unsigned int nextHopInterfaceIndex;
 
-        bool packetHasBeenSentToPhy;
+            networkLayerPtr->GetNextHopAddressAndInterfaceIndexForNetworkPacket(
+                *accessCategoryInfo.currentPacketPtr,
+                nextHopWasFound,
+                accessCategoryInfo.currentPacketsNextHopNetworkAddress,
+                nextHopInterfaceIndex);
 
-        SimTime transmitDelay = ZERO_TIME;
-        if (!wasJustTransmitting) {
-            transmitDelay = aShortInterframeSpaceTime;
+           if ((!nextHopWasFound) || (nextHopInterfaceIndex != interfaceIndex)) {
+                // Next hop is no longer valid (dynamic routing).
+
+                networkLayerPtr->ReceiveUndeliveredPacketFromMac(
+                    interfaceIndex,
+                    accessCategoryInfo.currentPacketPtr,
+                    NetworkAddress());
+
+                // Loop to get another packet.
+                continue;
+           }//if//
         }//if//
 
-        (*this).TransmitAFrame(
-            accessCategoryIndexForLastSentFrame,
-            true,
-            transmitDelay,
-            packetHasBeenSentToPhy);
+        wasRetrieved = false;
 
-        assert(packetHasBeenSentToPhy);
-    }//if//
+        theMacAddressResolverPtr->GetMacAddress(
+            nextHopAddress,
+            networkLayerPtr->GetSubnetMask(interfaceIndex),
+            wasRetrieved,
+            accessCategoryInfo.currentPacketsDestinationMacAddress);
 
-}//DoSuccessfulTransmissionPostProcessing//
+        if (!wasRetrieved) {
+            // There is not a mac address entry.
 
+            networkLayerPtr->ReceiveUndeliveredPacketFromMac(
+                interfaceIndex,
+                accessCategoryInfo.currentPacketPtr,
+                NetworkAddress());
 
+            // Loop to get another packet.
+            continue;
 
-// Could infer this functionality from Carrier/No Carrier notifications
-// but added for clarity.
+        }//if//
 
-inline
-void Dot11Mac::TransmissionIsCompleteNotification()
-{
-    if (macState == WaitingForCtsState) {
+        (*this).GetNewSequenceNumber(
+            accessCategoryInfo.currentPacketsDestinationMacAddress,
+            accessCategoryInfo.currentPacketPriorityAkaTrafficId,
+            true,
+            /*out*/accessCategoryInfo.currentPacketSequenceNumber);
 
-        (*this).ScheduleWakeupTimer(
-            simEngineInterfacePtr->CurrentTime() + clearToSendTimeoutDuration);
-    }
-    else if (macState == WaitingForAckState) {
+        // Check for Power Saving destination.
 
-        (*this).ScheduleWakeupTimer(simEngineInterfacePtr->CurrentTime() + ackTimeoutDuration);
-    }
-    else if (macState == CtsOrAckTransmissionState) {
-        macState = BusyMediumState;
-    }
-    else if (macState == ChangingChannelsState) {
+        if ((GetOperationMode() == ApMode) &&
+            (apControllerPtr->StationIsAsleep(
+                accessCategoryInfo.currentPacketsDestinationMacAddress))) {
 
-        // Assume the medium is busy, but if it is idle the PHY will notify the MAC at channel
-        // switch.
+            apControllerPtr->BufferPacketForSleepingStation(
+                accessCategoryInfo.currentPacketsDestinationMacAddress,
+                accessCategoryInfo.currentPacketPtr,
+                accessCategoryInfo.currentPacketsNextHopNetworkAddress,
+                priority,
+                etherType,
+                timestamp,
+                accessCategoryInfo.currentPacketDatarateAndTxPowerAreSpecified,
+                accessCategoryInfo.specifiedPacketDatarateBitsPerSec,
+                accessCategoryInfo.specifiedPacketTxPowerDbm);
 
-        macState = BusyMediumState;
+            wasRetrieved = false;
+            // Loop to get another packet.
+            continue;
+        }//if//
 
-        // Assume last transmission failed (unless it was a broadcast).
+        assert(wasRetrieved);
 
-        (*this).StartPacketSendProcessForAnAccessCategory(accessCategoryIndexForLastSentFrame);
-        (*this).SwitchToChannels(switchingToThisChannelList);
-    }
-    else {
-        assert(macState == BusyMediumState);
+        if (macLatencyBreakdownIsEnabled) {
+            (*this).RecordMacLatencyForPacketDequeue(accessCategoryIndex, timestamp);
+        }//if//
 
-        (*this).DoSuccessfulTransmissionPostProcessing(true);
+        QosDataFrameHeader dataFrameHeader;
 
-    }//if//
+        dataFrameHeader.header.theFrameControlField.frameTypeAndSubtype = QOS_DATA_FRAME_TYPE_CODE;
+        dataFrameHeader.header.theFrameControlField.isRetry = 0;
+        dataFrameHeader.header.duration = 0;
+        dataFrameHeader.header.receiverAddress = accessCategoryInfo.currentPacketsDestinationMacAddress;
+        dataFrameHeader.theSequenceControlField.sequenceNumber = accessCategoryInfo.currentPacketSequenceNumber;
+        dataFrameHeader.transmitterAddress = myMacAddress;
+        dataFrameHeader.qosControlField.trafficId = accessCategoryInfo.currentPacketPriorityAkaTrafficId;
+        dataFrameHeader.linkLayerHeader.etherType = HostToNet16(accessCategoryInfo.currentPacketsEtherType);
 
-}//TransmissionIsCompleteNotification//
+        accessCategoryInfo.currentPacketPtr->AddPlainStructHeader(dataFrameHeader);
 
+        if (((FrameAggregationIsEnabledFor(
+                accessCategoryInfo.currentPacketsDestinationMacAddress)) &&
+             (!NeedToSendABlockAckRequest(
+                accessCategoryInfo.currentPacketsDestinationMacAddress,
+                accessCategoryInfo.currentPacketPriorityAkaTrafficId))) &&
+            ((allowFrameAggregationWithTxopZero) ||
+             (currentTransmitOpportunityAkaTxopEndTime != ZERO_TIME)) &&
+            ((!protectAggregateFramesWithSingleAckedFrame) ||
+             (currentTransmitOpportunityAckedFrameCount > 0) ||
+             (dataFrameHeader.header.receiverAddress.IsABroadcastOrAMulticastAddress()))) {
+
+            if (!BlockAckSessionIsEnabled(
+                accessCategoryInfo.currentPacketsDestinationMacAddress,
+                accessCategoryInfo.currentPacketPriorityAkaTrafficId)) {
 
+                OutgoingLinkInfo& linkInfo =
+                    outgoingLinkInfoMap[
+                        AddressAndTrafficIdMapKey(
+                            accessCategoryInfo.currentPacketsDestinationMacAddress,
+                            accessCategoryInfo.currentPacketPriorityAkaTrafficId)];
 
-//--------------------------------------------------------------------------------------------------
+                // Using Block Ack Request as ADDBA (Add Block Ack Session Request)
 
-inline
-void Dot11Mac::SetMpduFrameAggregationIsEnabledFor(const MacAddress& destinationAddress)
-{
-    neighborCapabilitiesMap[destinationAddress].mpduFrameAggregationIsEnabled = true;
-}
+                linkInfo.blockAckRequestNeedsToBeSent = true;
+                linkInfo.blockAckSessionIsEnabled = true;
 
+                // This makes the initial Block Ack Request to start the session
+                // Block Ack window on the next data/management frame.
 
-inline
-bool Dot11Mac::FrameAggregationIsEnabledFor(const MacAddress& destinationAddress) const
-{
-    typedef map<MacAddress, NeighborCapabilities>::const_iterator IterType;
+                linkInfo.lastDroppedFrameSequenceNumber = linkInfo.outgoingSequenceNumber;
 
-    if (neighborCapabilitiesMap.empty()) {
-        return false;
-    }//if//
+                return;
+            }//if//
 
-    IterType iter = neighborCapabilitiesMap.find(destinationAddress);
+            (*this).BuildAggregateFrameFromCurrentFrame(accessCategoryIndex);
 
-    if (iter == neighborCapabilitiesMap.end()) {
-        return false;
-    }//if//
+        }//if//
 
-    const NeighborCapabilities& capabilities = iter->second;
+        return;
 
-    return (capabilities.mpduFrameAggregationIsEnabled);
+    }//while//
 
-}//FrameAggregationIsEnabledForLink//
+    assert(!wasRetrieved);
+
+}//RetrievePacketFromNetworkLayerForAccessCategory//
 
 
 
 inline
-bool Dot11Mac::MpduFrameAggregationIsEnabledFor(const MacAddress& destinationAddress) const
+void Dot11Mac::RequeueBufferedPacket(
+    unique_ptr<Packet>& packetPtr,
+    const NetworkAddress& nextHopAddress,
+    const PacketPriority priority,
+    const EtherTypeField etherType,
+    const SimTime& timestamp,
+    const unsigned int txRetryCount,
+    const bool datarateAndTxPowerAreaSpecified,
+    const DatarateBitsPerSec& theDatarateBitsPerSec,
+    const double& txPowerDbm)
 {
-    typedef map<MacAddress, NeighborCapabilities>::const_iterator IterType;
-
-    if (neighborCapabilitiesMap.empty()) {
-        return false;
-    }//if//
+    packetPtr->DeleteHeader(sizeof(QosDataFrameHeader));
 
-    IterType iter = neighborCapabilitiesMap.find(destinationAddress);
+    networkOutputQueuePtr->RequeueAtFront(
+        packetPtr,
+        nextHopAddress,
+        priority,
+        etherType,
+        timestamp,
+        txRetryCount,
+        datarateAndTxPowerAreaSpecified,
+        theDatarateBitsPerSec,
+        txPowerDbm);
 
-    if (iter == neighborCapabilitiesMap.end()) {
-        return false;
-    }//if//
+    possiblyNonEmptyPriorityBitMask |= (1U << priority);
 
-    const NeighborCapabilities& capabilities = iter->second;
+    const EdcaAccessCategoryInfo& accessCategoryInfo =
+        accessCategories[accessCategoryIndexForPriority[priority]];
 
-    return (capabilities.mpduFrameAggregationIsEnabled);
+    if ((frameLifetimeWheelIsEnabled) && (accessCategoryInfo.frameLifetime != INFINITE_TIME)) {
+        (*this).AddPrioritiesToFrameLifetimeWheel(
+            (1U << priority), (timestamp + accessCategoryInfo.frameLifetime));
+    }//if//
 
-}//MpduFrameAggregationIsEnabledForLink//
+}//RequeueBufferedPacket//
 
 
 
 inline
-bool Dot11Mac::NeedToSendABlockAckRequest(
-    const MacAddress& destinationAddress,
-    const PacketPriority& trafficId) const
+void Dot11Mac::DropLifetimeExpiredFrame(
+    const unsigned int accessCategoryIndex,
+    unique_ptr<Packet>& packetPtr)
 {
-    typedef map<AddressAndTrafficIdMapKey, OutgoingLinkInfo>::const_iterator IterType;
-
-    IterType iter =
-        outgoingLinkInfoMap.find(AddressAndTrafficIdMapKey(destinationAddress, trafficId));
+    numberFramesDroppedByLifetimeExpiration[accessCategoryIndex]++;
 
-    if (iter == outgoingLinkInfoMap.end()) {
-        return false;
+    if (frameLifetimeWheelIsEnabled) {
+        lifetimeExpiredFramesDroppedStatPtrs[accessCategoryIndex]->IncrementCounter();
     }//if//
 
-    return ((*iter).second.blockAckRequestNeedsToBeSent);
+    networkLayerPtr->ReceiveUndeliveredPacketFromMac(
+        interfaceIndex,
+        packetPtr,
+        NetworkAddress());
 
-}//NeedToSendBlockAckRequest//
+}//DropLifetimeExpiredFrame//
 
 
 
 inline
-void Dot11Mac::BuildAggregateFrameFromCurrentFrame(const unsigned int accessCategoryIndex)
+void Dot11Mac::AddPrioritiesToFrameLifetimeWheel(
+    const unsigned int priorityBitMask,
+    const SimTime& expirationTime)
 {
-    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+    assert(frameLifetimeWheelIsEnabled);
 
-    assert((allowFrameAggregationWithTxopZero) ||
-           (currentTransmitOpportunityAkaTxopEndTime != ZERO_TIME));
+    const long long int currentSlotNumber =
+        (simEngineInterfacePtr->CurrentTime() / frameLifetimeWheelSlotDuration);
 
-    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
+    // A frame is expired strictly after expirationTime: check at the end of its slot.
+    // Expirations beyond one revolution are revisited after one revolution.
 
-    const bool useMpduAggregation =
-        MpduFrameAggregationIsEnabledFor(accessCategoryInfo.currentPacketsDestinationMacAddress);
+    long long int slotNumber = (expirationTime / frameLifetimeWheelSlotDuration) + 1;
 
-    accessCategoryInfo.currentAggregateFrameIsAMpduAggregate = useMpduAggregation;
+    slotNumber = std::max(slotNumber, (currentSlotNumber + 1));
+    slotNumber = std::min(slotNumber, (currentSlotNumber + numberFrameLifetimeWheelSlots));
 
-    assert(accessCategoryInfo.currentAggregateFramePtr == nullptr);
-    accessCategoryInfo.currentAggregateFramePtr.reset(new vector<unique_ptr<Packet> >());
+    frameLifetimeWheelSlots[slotNumber % numberFrameLifetimeWheelSlots] |= priorityBitMask;
 
-    accessCategoryInfo.currentAggregateFramePtr->push_back(move(accessCategoryInfo.currentPacketPtr));
+    (*this).ScheduleFrameLifetimeWheelEvent(slotNumber * frameLifetimeWheelSlotDuration);
 
-    accessCategoryInfo.currentShortFrameRetryCount = 0;
-    accessCategoryInfo.currentLongFrameRetryCount = 0;
-    accessCategoryInfo.currentAggregateFrameRetryCount = 0;
+}//AddPrioritiesToFrameLifetimeWheel//
 
-    vector<unique_ptr<Packet> >& frameList = *accessCategoryInfo.currentAggregateFramePtr;
 
-    const QosDataFrameHeader copyOfOriginalFrameHeader =
-        frameList[0]->GetAndReinterpretPayloadData<QosDataFrameHeader>();
 
-    AddMpduDelimiterAndPaddingToFrame(*frameList[0]);
+inline
+void Dot11Mac::ScheduleFrameLifetimeWheelEvent(const SimTime& eventTime)
+{
+    if (frameLifetimeWheelEventTicket.IsNull()) {
+        simEngineInterfacePtr->ScheduleEvent(
+            frameLifetimeWheelEventPtr, eventTime, frameLifetimeWheelEventTicket);
+        frameLifetimeWheelEventTime = eventTime;
+    }
+    else if (eventTime < frameLifetimeWheelEventTime) {
+        simEngineInterfacePtr->RescheduleEvent(frameLifetimeWheelEventTicket, eventTime);
+        frameLifetimeWheelEventTime = eventTime;
+    }//if//
 
-    // Assuming No RTS/CTS for aggregated frames ("Greenfield" not supported).
+}//ScheduleFrameLifetimeWheelEvent//
 
-    TransmissionParameters txParameters;
 
-    theAdaptiveRateControllerPtr->GetDataRateInfoForDataFrameToStation(
-        accessCategoryInfo.currentPacketsDestinationMacAddress,
-        txParameters);
 
-    unsigned int totalBytes = frameList[0]->LengthBytes();
+inline
+void Dot11Mac::ProcessFrameLifetimeWheelEvent()
+{
+    (*this).frameLifetimeWheelEventTicket.Clear();
+    (*this).frameLifetimeWheelEventTime = INFINITE_TIME;
 
-    SimTime endTime =
-        currentTime +
-        CalculateFrameDuration(frameList[0]->LengthBytes(), txParameters);
+    const long long int currentSlotNumber =
+        (simEngineInterfacePtr->CurrentTime() / frameLifetimeWheelSlotDuration);
 
-    endTime += aShortInterframeSpaceTime;
-    endTime += CalculateFrameDuration(sizeof(BlockAcknowledgementFrame), txParameters);
+    unsigned int& currentSlot =
+        frameLifetimeWheelSlots[currentSlotNumber % numberFrameLifetimeWheelSlots];
 
-    const PacketPriority& priority = accessCategoryInfo.currentPacketPriorityAkaTrafficId;
+    unsigned int expiringPriorityBitMask = currentSlot;
+    currentSlot = 0;
 
-    const unsigned int maxNumSubframes =
-        CalcNumberFramesLeftInSequenceNumWindow(
-            accessCategoryInfo.currentPacketsDestinationMacAddress,
-            accessCategoryInfo.currentPacketPriorityAkaTrafficId) + 1;
+    while (expiringPriorityBitMask != 0) {
+        const unsigned int bitPosition = LowestSetBitPosition(expiringPriorityBitMask);
 
-    while ((accessCategoryInfo.currentAggregateFramePtr->size() < maxNumSubframes) &&
-           (((allowFrameAggregationWithTxopZero) &&
-             (currentTransmitOpportunityAkaTxopEndTime == ZERO_TIME)) ||
-            (endTime < currentTransmitOpportunityAkaTxopEndTime)) &&
-           (networkOutputQueuePtr->HasPacketWithPriority(priority)) &&
-           (networkOutputQueuePtr->NextHopForTopPacket(priority) ==
-            accessCategoryInfo.currentPacketsNextHopNetworkAddress)) {
+        (*this).DropExpiredFramesFromPrioritySubqueue(static_cast<PacketPriority>(bitPosition));
 
-        unsigned int packetLengthBytes;
+        expiringPriorityBitMask &= ~(1U << bitPosition);
+    }//while//
 
-        packetLengthBytes =
-            (networkOutputQueuePtr->TopPacket(priority).LengthBytes() +
-            sizeof(QosDataFrameHeader) +
-            sizeof(MpduDelimiterFrame));
+    for(unsigned int i = 1; (i <= numberFrameLifetimeWheelSlots); i++) {
+        if (frameLifetimeWheelSlots[(currentSlotNumber + i) % numberFrameLifetimeWheelSlots] != 0) {
+
+            (*this).ScheduleFrameLifetimeWheelEvent(
+                (currentSlotNumber + i) * frameLifetimeWheelSlotDuration);
 
-        if ((totalBytes + packetLengthBytes) > maxAggregateMpduSizeBytes) {
             break;
         }//if//
+    }//for//
 
-        // Only first frame of aggregate has Phy header.
+}//ProcessFrameLifetimeWheelEvent//
 
-        endTime += CalculateFrameDurationWithoutPhyHeader(packetLengthBytes, txParameters);
 
-        if ((!allowFrameAggregationWithTxopZero) &&
-            (endTime >= currentTransmitOpportunityAkaTxopEndTime)) {
 
-            break;
-        }//if//
+inline
+void Dot11Mac::DropExpiredFramesFromPrioritySubqueue(const PacketPriority& priority)
+{
+    const unsigned int accessCategoryIndex = accessCategoryIndexForPriority[priority];
+    const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
+    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
+
+    while (networkOutputQueuePtr->HasPacketWithPriority(priority)) {
 
+        unique_ptr<Packet> packetPtr;
         NetworkAddress nextHopAddress;
         EtherTypeField etherType;
         SimTime timestamp;
         unsigned int retryTxCount;
+        bool datarateAndTxPowerAreSpecified;
+        DatarateBitsPerSec specifiedPacketDatarateBitsPerSec;
+        double specifiedPacketTxPowerDbm;
 
-        unique_ptr<Packet> framePtr;
-
-        networkOutputQueuePtr->DequeuePacketWithPriority(
+        networkOutputQueuePtr->DequeuePacketWithEtherTypeAndDatarateAndTxPower(
             priority,
-            framePtr,
+            packetPtr,
             nextHopAddress,
-            etherType,
             timestamp,
-            retryTxCount);
+            retryTxCount,
+            etherType,
+            datarateAndTxPowerAreSpecified,
+            specifiedPacketDatarateBitsPerSec,
+            specifiedPacketTxPowerDbm);
 
-        assert(nextHopAddress == accessCategoryInfo.currentPacketsNextHopNetworkAddress);
-        assert(retryTxCount == 0);
-        assert(etherType == accessCategoryInfo.currentPacketsEtherType);
+        if (accessCategoryInfo.frameLifetime < (currentTime - timestamp)) {
+            (*this).DropLifetimeExpiredFrame(accessCategoryIndex, packetPtr);
+            continue;
+        }//if//
 
-        unsigned short int newSequenceNumber;
-        (*this).GetNewSequenceNumber(
-            accessCategoryInfo.currentPacketsDestinationMacAddress,
-            priority, false, newSequenceNumber);
+        // Head is still alive: put it back and revisit when it expires.
 
-        QosDataFrameHeader dataFrameHeader = copyOfOriginalFrameHeader;
-        dataFrameHeader.theSequenceControlField.sequenceNumber = newSequenceNumber;
+        networkOutputQueuePtr->RequeueAtFront(
+            packetPtr,
+            nextHopAddress,
+            priority,
+            etherType,
+            timestamp,
+            retryTxCount,
+            datarateAndTxPowerAreSpecified,
+            specifiedPacketDatarateBitsPerSec,
+            specifiedPacketTxPowerDbm);
 
-        framePtr->AddPlainStructHeader(dataFrameHeader);
-        AddMpduDelimiterAndPaddingToFrame(*framePtr);
+        (*this).AddPrioritiesToFrameLifetimeWheel(
+            (1U << priority), (timestamp + accessCategoryInfo.frameLifetime));
 
-        totalBytes += framePtr->LengthBytes();
+        break;
+    }//while//
 
-        accessCategoryInfo.currentAggregateFramePtr->push_back(move(framePtr));
+}//DropExpiredFramesFromPrioritySubqueue//
 
-    }//while//
 
-    if (accessCategoryInfo.currentAggregateFramePtr->size() > 1) {
-        // No padding needed on last frame.
-        RemoveMpduAggregationPaddingFromFrame(
-            *accessCategoryInfo.currentAggregateFramePtr->back());
-    }
-    else {
-        // Aggregation Failure (Back to single frame).
 
-        accessCategoryInfo.currentPacketPtr =
-            move(accessCategoryInfo.currentAggregateFramePtr->front());
+inline
+const char* Dot11Mac::GetMacLatencyStageName(const unsigned int latencyStage)
+{
+    static const char* latencyStageNames[NumberMacLatencyStages] =
+        { "Queueing", "ChannelAccess", "Suspension", "Airtime" };
 
-        accessCategoryInfo.currentAggregateFramePtr.reset();
+    assert(latencyStage < NumberMacLatencyStages);
 
-        RemoveMpduDelimiterAndPaddingFromFrame(*accessCategoryInfo.currentPacketPtr);
-    }//if//
+    return latencyStageNames[latencyStage];
 
-}//BuildAggregateFrameFromCurrentFrame//
+}//GetMacLatencyStageName//
 
 
 
 inline
-void Dot11Mac::RetrievePacketFromNetworkLayerForAccessCategory(
-    const unsigned int accessCategoryIndex,
-    bool& wasRetrieved)
+void Dot11Mac::CreateMacLatencyHistogramStats()
 {
-    EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
+    macLatencyBreakdownInfos.resize(accessCategories.size());
 
-    assert(accessCategoryInfo.currentPacketPtr == nullptr);
+    for(unsigned int i = 0; (i < macLatencyBreakdownInfos.size()); i++) {
+        MacLatencyBreakdownInfo& latencyInfo = macLatencyBreakdownInfos[i];
 
-    wasRetrieved = false;
+        for(unsigned int stage = 0; (stage < NumberMacLatencyStages); stage++) {
+            ostringstream statNameStream;
+            statNameStream << modelName << '_' << theInterfaceId << "_AC" << i << '_'
+                           << GetMacLatencyStageName(stage) << "Latency";
 
-    for(unsigned int i = 0; (i < accessCategoryInfo.listOfPriorities.size()); i++) {
-        PacketPriority priority = accessCategoryInfo.listOfPriorities[i];
+            latencyInfo.latencyStatPtrs[stage] =
+                simEngineInterfacePtr->CreateRealStat(statNameStream.str());
+        }//for//
+    }//for//
 
-        while ((!wasRetrieved) && (networkOutputQueuePtr->HasPacketWithPriority(priority))) {
+}//CreateMacLatencyHistogramStats//
 
-            NetworkAddress nextHopAddress;
-            EtherTypeField etherType;
-            SimTime timestamp;
-            unsigned int retryTxCount;
-            bool datarateAndTxPowerAreSpecified;
-            DatarateBitsPerSec specifiedPacketDatarateBitsPerSec;
-            double specifiedPacketTxPowerDbm;
 
-            networkOutputQueuePtr->DequeuePacketWithEtherTypeAndDatarateAndTxPower(
-                priority,
-                accessCategoryInfo.currentPacketPtr,
-                nextHopAddress,
-                timestamp,
-                retryTxCount,
-                etherType,
-                datarateAndTxPowerAreSpecified,
-                specifiedPacketDatarateBitsPerSec,
-                specifiedPacketTxPowerDbm);
 
-            assert((nextHopAddress.IsTheBroadcastAddress()) ||
-                   !(nextHopAddress.IsABroadcastAddress(networkLayerPtr->GetSubnetMask(interfaceIndex))) &&
-                   "Make sure no mask dependent broadcast address from network layer");
+inline
+void Dot11Mac::OutputMacLatencyHistogramStats()
+{
+    if (!macLatencyBreakdownIsEnabled) {
+        return;
+    }//if//
 
-            const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
-            if (accessCategoryInfo.frameLifetime < (currentTime - timestamp)) {
-                //lifetime expired
-                networkLayerPtr->ReceiveUndeliveredPacketFromMac(
-                    interfaceIndex,
-                    accessCategoryInfo.currentPacketPtr,
-                    NetworkAddress());
+    for(unsigned int i = 0; (i < macLatencyBreakdownInfos.size()); i++) {
+        MacLatencyBreakdownInfo& latencyInfo = macLatencyBreakdownInfos[i];
 
-                // Loop again to get another packet.
-                continue;
-            }//if//
+        for(unsigned int stage = 0; (stage < NumberMacLatencyStages); stage++) {
+            for(unsigned int bucket = 0; (bucket < numberMacLatencyHistogramBuckets); bucket++) {
+                const unsigned long long int binCount = latencyInfo.histogramBinCounts[stage][bucket];
 
-            accessCategoryInfo.currentPacketPriorityAkaTrafficId = priority;
-            accessCategoryInfo.currentPacketsNextHopNetworkAddress = nextHopAddress;
-            accessCategoryInfo.currentPacketsEtherType = etherType;
-            accessCategoryInfo.currentPacketsTimestamp = timestamp;
+                if (binCount == 0) {
+                    continue;
+                }//if//
 
-            accessCategoryInfo.currentPacketDatarateAndTxPowerAreSpecified = datarateAndTxPowerAreSpecified;
-            accessCategoryInfo.specifiedPacketDatarateBitsPerSec = specifiedPacketDatarateBitsPerSec;
-            accessCategoryInfo.specifiedPacketTxPowerDbm = specifiedPacketTxPowerDbm;
+                ostringstream statNameStream;
+                statNameStream << modelName << '_' << theInterfaceId << "_AC" << i << '_'
+                               << GetMacLatencyStageName(stage) << "Latency_";
 
-            const unsigned int adjustedFrameLengthBytes =
-                accessCategoryInfo.currentPacketPtr->LengthBytes() +
-                sizeof(QosDataFrameHeader);
+                if (bucket == 0) {
+                    statNameStream << "0To1us";
+                }
+                else if (bucket < (numberMacLatencyHistogramBuckets - 1)) {
+                    statNameStream << (1ULL << (bucket - 1)) << "To" << (1ULL << bucket) << "us";
+                }
+                else {
+                    statNameStream << (1ULL << (bucket - 1)) << "usOrMore";
+                }//if//
 
-            if (adjustedFrameLengthBytes < rtsThresholdSizeBytes) {
-                accessCategoryInfo.currentShortFrameRetryCount = retryTxCount;
-                accessCategoryInfo.currentLongFrameRetryCount = 0;
-            }
-            else {
-                accessCategoryInfo.currentShortFrameRetryCount = 0;
-                accessCategoryInfo.currentLongFrameRetryCount = retryTxCount;
-            }//if//
+                simEngineInterfacePtr->CreateCounterStat(statNameStream.str())->IncrementCounter(binCount);
 
-            if (redundantTraceInformationModeIsOn) {
-                OutputTraceForPacketDequeue(accessCategoryIndex, aRxTxTurnaroundTime);
-            } else {
-                OutputTraceForPacketDequeue(accessCategoryIndex);
-            }//if//
+                // Export each bin once, even if disconnected again.
 
-            if ((refreshNextHopOnDequeueModeIsOn) && (!nextHopAddress.IsTheBroadcastAddress())) {
-                // Update the next hop to latest.
+                latencyInfo.histogramBinCounts[stage][bucket] = 0;
+            }//for//
+        }//for//
+    }//for//
 
-                bool nextHopWasFound;
-                unsigned int nextHopInterfaceIndex;
+}//OutputMacLatencyHistogramStats//
 
-                networkLayerPtr->GetNextHopAddressAndInterfaceIndexForNetworkPacket(
-                    *accessCategoryInfo.currentPacketPtr,
-                    nextHopWasFound,
-                    accessCategoryInfo.currentPacketsNextHopNetworkAddress,
-                    nextHopInterfaceIndex);
 
-               if ((!nextHopWasFound) || (nextHopInterfaceIndex != interfaceIndex)) {
-                    // Next hop is no longer valid (dynamic routing).
 
-                    networkLayerPtr->ReceiveUndeliveredPacketFromMac(
-                        interfaceIndex,
-                        accessCategoryInfo.currentPacketPtr,
-                        NetworkAddress());
+inline
+void Dot11Mac::RecordMacLatency(
+    const unsigned int accessCategoryIndex,
+    const MacLatencyStageType& latencyStage,
+    const SimTime& latency)
+{
+    assert(latency >= ZERO_TIME);
 
-                    // Loop to get another packet.
-                    continue;
-               }//if//
-            }//if//
+    unsigned int bucket = 0;
+    long long int latencyUs = (latency / MICRO_SECOND);
 
-            wasRetrieved = false;
+    while ((latencyUs > 0) && (bucket < (numberMacLatencyHistogramBuckets - 1))) {
+        latencyUs >>= 1;
+        bucket++;
+    }//while//
 
-            theMacAddressResolverPtr->GetMacAddress(
-                nextHopAddress,
-                networkLayerPtr->GetSubnetMask(interfaceIndex),
-                wasRetrieved,
-                accessCategoryInfo.currentPacketsDestinationMacAddress);
+    MacLatencyBreakdownInfo& latencyInfo = macLatencyBreakdownInfos[accessCategoryIndex];
 
-            if (!wasRetrieved) {
-                // There is not a mac address entry.
+    latencyInfo.histogramBinCounts[latencyStage][bucket]++;
+    latencyInfo.latencyStatPtrs[latencyStage]->RecordStatValue(ConvertTimeToDoubleSecs(latency));
 
-                networkLayerPtr->ReceiveUndeliveredPacketFromMac(
-                    interfaceIndex,
-                    accessCategoryInfo.currentPacketPtr,
-                    NetworkAddress());
+}//RecordMacLatency//
 
-                // Loop to get another packet.
-                continue;
 
-            }//if//
 
-            (*this).GetNewSequenceNumber(
-                accessCategoryInfo.currentPacketsDestinationMacAddress,
-                accessCategoryInfo.currentPacketPriorityAkaTrafficId,
-                true,
-                /*out*/accessCategoryInfo.currentPacketSequenceNumber);
+inline
+void Dot11Mac::StartMacLatencyChannelAccessIfNecessary(const unsigned int accessCategoryIndex)
+{
+    MacLatencyBreakdownInfo& latencyInfo = macLatencyBreakdownInfos[accessCategoryIndex];
+
+    // Backoff restarts (after busy medium or suspension) belong to the same channel access.
 
-            // Check for Power Saving destination.
+    if (latencyInfo.channelAccessStartTime == INFINITE_TIME) {
+        latencyInfo.channelAccessStartTime = simEngineInterfacePtr->CurrentTime();
+        latencyInfo.suspendedDuration = ZERO_TIME;
+    }//if//
 
-            if ((GetOperationMode() == ApMode) &&
-                (apControllerPtr->StationIsAsleep(
-                    accessCategoryInfo.currentPacketsDestinationMacAddress))) {
+}//StartMacLatencyChannelAccessIfNecessary//
 
-                apControllerPtr->BufferPacketForSleepingStation(
-                    accessCategoryInfo.currentPacketsDestinationMacAddress,
-                    accessCategoryInfo.currentPacketPtr,
-                    accessCategoryInfo.currentPacketsNextHopNetworkAddress,
-                    priority,
-                    etherType,
-                    timestamp,
-                    accessCategoryInfo.currentPacketDatarateAndTxPowerAreSpecified,
-                    accessCategoryInfo.specifiedPacketDatarateBitsPerSec,
-                    accessCategoryInfo.specifiedPacketTxPowerDbm);
-
-                wasRetrieved = false;
-                // Loop to get another packet.
-                continue;
-            }//if//
 
-            assert(wasRetrieved);
 
-            QosDataFrameHeader dataFrameHeader;
+inline
+void Dot11Mac::RecordMacLatencyForPacketDequeue(
+    const unsigned int accessCategoryIndex,
+    const SimTime& enqueueTime)
+{
+    MacLatencyBreakdownInfo& latencyInfo = macLatencyBreakdownInfos[accessCategoryIndex];
+
+    // Packets are dequeued at backoff expiration, channel access for a packet
+    // starts when both the packet and the access category backoff exist.
+
+    SimTime frameChannelAccessStartTime = simEngineInterfacePtr->CurrentTime();
+
+    if (latencyInfo.channelAccessStartTime != INFINITE_TIME) {
+        frameChannelAccessStartTime =
+            std::max(enqueueTime, latencyInfo.channelAccessStartTime);
+    }//if//
 
-            dataFrameHeader.header.theFrameControlField.frameTypeAndSubtype = QOS_DATA_FRAME_TYPE_CODE;
-            dataFrameHeader.header.theFrameControlField.isRetry = 0;
-            dataFrameHeader.header.duration = 0;
-            dataFrameHeader.header.receiverAddress = accessCategoryInfo.currentPacketsDestinationMacAddress;
-            dataFrameHeader.theSequenceControlField.sequenceNumber = accessCategoryInfo.currentPacketSequenceNumber;
-            dataFrameHeader.transmitterAddress = myMacAddress;
-            dataFrameHeader.qosControlField.trafficId = accessCategoryInfo.currentPacketPriorityAkaTrafficId;
-            dataFrameHeader.linkLayerHeader.etherType = HostToNet16(accessCategoryInfo.currentPacketsEtherType);
+    latencyInfo.frameChannelAccessStartTime = frameChannelAccessStartTime;
 
-            accessCategoryInfo.currentPacketPtr->AddPlainStructHeader(dataFrameHeader);
+    (*this).RecordMacLatency(
+        accessCategoryIndex, QueueingLatencyStage, (frameChannelAccessStartTime - enqueueTime));
 
-            if (((FrameAggregationIsEnabledFor(
-                    accessCategoryInfo.currentPacketsDestinationMacAddress)) &&
-                 (!NeedToSendABlockAckRequest(
-                    accessCategoryInfo.currentPacketsDestinationMacAddress,
-                    accessCategoryInfo.currentPacketPriorityAkaTrafficId))) &&
-                ((allowFrameAggregationWithTxopZero) ||
-                 (currentTransmitOpportunityAkaTxopEndTime != ZERO_TIME)) &&
-                ((!protectAggregateFramesWithSingleAckedFrame) ||
-                 (currentTransmitOpportunityAckedFrameCount > 0) ||
-                 (dataFrameHeader.header.receiverAddress.IsABroadcastOrAMulticastAddress()))) {
+}//RecordMacLatencyForPacketDequeue//
 
-                if (!BlockAckSessionIsEnabled(
-                    accessCategoryInfo.currentPacketsDestinationMacAddress,
-                    accessCategoryInfo.currentPacketPriorityAkaTrafficId)) {
 
-                    OutgoingLinkInfo& linkInfo =
-                        outgoingLinkInfoMap[
-                            AddressAndTrafficIdMapKey(
-                                accessCategoryInfo.currentPacketsDestinationMacAddress,
-                                accessCategoryInfo.currentPacketPriorityAkaTrafficId)];
 
-                    // Using Block Ack Request as ADDBA (Add Block Ack Session Request)
+inline
+void Dot11Mac::RecordMacLatencyForBackoffExpiration(const unsigned int accessCategoryIndex)
+{
+    MacLatencyBreakdownInfo& latencyInfo = macLatencyBreakdownInfos[accessCategoryIndex];
+    const SimTime currentTime = simEngineInterfacePtr->CurrentTime();
 
-                    linkInfo.blockAckRequestNeedsToBeSent = true;
-                    linkInfo.blockAckSessionIsEnabled = true;
+    if (latencyInfo.channelAccessStartTime != INFINITE_TIME) {
 
-                    // This makes the initial Block Ack Request to start the session
-                    // Block Ack window on the next data/management frame.
+        // Retransmissions do not dequeue, so take the later of the two.
 
-                    linkInfo.lastDroppedFrameSequenceNumber = linkInfo.outgoingSequenceNumber;
+        SimTime startTime = latencyInfo.channelAccessStartTime;
 
-                    return;
-                }//if//
+        if (latencyInfo.frameChannelAccessStartTime != INFINITE_TIME) {
+            startTime = std::max(startTime, latencyInfo.frameChannelAccessStartTime);
+        }//if//
 
-                (*this).BuildAggregateFrameFromCurrentFrame(accessCategoryIndex);
+        const SimTime suspendedDuration =
+            std::min(latencyInfo.suspendedDuration, (currentTime - startTime));
 
-            }//if//
+        (*this).RecordMacLatency(
+            accessCategoryIndex, ChannelAccessLatencyStage,
+            ((currentTime - startTime) - suspendedDuration));
 
-            return;
+        (*this).RecordMacLatency(
+            accessCategoryIndex, SuspensionLatencyStage, suspendedDuration);
 
-        }//while//
-    }//for//
+    }//if//
 
-    assert(!wasRetrieved);
+    latencyInfo.channelAccessStartTime = INFINITE_TIME;
+    latencyInfo.frameChannelAccessStartTime = INFINITE_TIME;
+    latencyInfo.suspendedDuration = ZERO_TIME;
+    latencyInfo.phyStartTime = currentTime;
 
-}//RetrievePacketFromNetworkLayerForAccessCategory//
+}//RecordMacLatencyForBackoffExpiration//
 
 
 
 inline
-void Dot11Mac::RequeueBufferedPacket(
-    unique_ptr<Packet>& packetPtr,
-    const NetworkAddress& nextHopAddress,
-    const PacketPriority priority,
-    const EtherTypeField etherType,
-    const SimTime& timestamp,
-    const unsigned int txRetryCount,
-    const bool datarateAndTxPowerAreaSpecified,
-    const DatarateBitsPerSec& theDatarateBitsPerSec,
-    const double& txPowerDbm)
+void Dot11Mac::RecordMacLatencyForTransmissionEnd(const unsigned int accessCategoryIndex)
 {
-    packetPtr->DeleteHeader(sizeof(QosDataFrameHeader));
+    MacLatencyBreakdownInfo& latencyInfo = macLatencyBreakdownInfos[accessCategoryIndex];
 
-    networkOutputQueuePtr->RequeueAtFront(
-        packetPtr,
-        nextHopAddress,
-        priority,
-        etherType,
-        timestamp,
-        txRetryCount,
-        datarateAndTxPowerAreaSpecified,
-        theDatarateBitsPerSec,
-        txPowerDbm);
+    // Only the first transmission after a backoff (not ACK/CTS/TXOP continuation).
 
-}//RequeueBufferedPacket//
+    if (latencyInfo.phyStartTime != INFINITE_TIME) {
+        (*this).RecordMacLatency(
+            accessCategoryIndex, AirtimeLatencyStage,
+            (simEngineInterfacePtr->CurrentTime() - latencyInfo.phyStartTime));
+
+        latencyInfo.phyStartTime = INFINITE_TIME;
+    }//if//
+
+}//RecordMacLatencyForTransmissionEnd//
 
 
 
@@ -3491,20 +5137,40 @@ void Dot11Mac::RequeueBufferedPackets()
 //--------------------------------------------------------------------------------------------------
 
 inline
-void Dot11Mac::DoubleTheContentionWindowAndPickANewBackoff(const unsigned int accessCategoryIndex)
+void Dot11Mac::UpdateContentionWindow(
+    const unsigned int accessCategoryIndex,
+    const ContentionWindowEventType& contentionWindowEvent)
 {
-    using std::min;
-
     EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories[accessCategoryIndex];
 
-    // Double contention window up to the maximum size.
-    // (Actual sequence is CW(n) = (2^n - 1) ) {1,3,7,15,31,63,...}
+    double channelBusyRatio = 0.0;
+
+    if (channelBusyRatioEstimatorPtr != nullptr) {
+        channelBusyRatio =
+            channelBusyRatioEstimatorPtr->GetChannelBusyRatio(simEngineInterfacePtr->CurrentTime());
+    }//if//
 
     accessCategoryInfo.currentContentionWindowSlots =
-        min(((accessCategoryInfo.currentContentionWindowSlots * 2) + 1) ,
-            accessCategoryInfo.maxContentionWindowSlots);
+        accessCategoryInfo.contentionWindowControllerPtr->CalcNextContentionWindowSlots(
+            contentionWindowEvent,
+            accessCategoryInfo.currentContentionWindowSlots,
+            accessCategoryInfo.minContentionWindowSlots,
+            accessCategoryInfo.maxContentionWindowSlots,
+            channelBusyRatio);
 
-    (*this).RecalcRandomBackoff(accessCategoryInfo);
+}//UpdateContentionWindow//
+
+
+//--------------------------------------------------------------------------------------------------
+
+inline
+void Dot11Mac::DoubleTheContentionWindowAndPickANewBackoff(const unsigned int accessCategoryIndex)
+{
+    // Binary exponential doubling unless another contention window controller is configured.
+
+    (*this).UpdateContentionWindow(accessCategoryIndex, ContentionWindowTransmissionFailed);
+
+    (*this).RecalcRandomBackoff(accessCategories[accessCategoryIndex]);
 
 }//DoubleTheContentionWindowAndPickANewBackoff//
 
@@ -3514,7 +5180,9 @@ void Dot11Mac::DoubleTheContentionWindowAndPickANewBackoff(const unsigned int ac
 inline
 void Dot11Mac::PerformInternalCollisionBackoff(const unsigned int accessCategoryIndex)
 {
-    (*this).DoubleTheContentionWindowAndPickANewBackoff(accessCategoryIndex);
+    (*this).UpdateContentionWindow(accessCategoryIndex, ContentionWindowInternalCollision);
+
+    (*this).RecalcRandomBackoff(accessCategories[accessCategoryIndex]);
 
 }//PerformInternalCollisionBackoff//
 
@@ -3692,33 +5360,29 @@ SimTime Dot11Mac::CalculateNextFrameSequenceDuration(const unsigned int accessCa
             destinationMacAddress, txParameters);
     }
     else {
-        for(unsigned int i = 0; (i < accessCategoryInfo.listOfPriorities.size()); i++) {
-            PacketPriority priority = accessCategoryInfo.listOfPriorities[i];
-
-            if (networkOutputQueuePtr->HasPacketWithPriority(priority)) {
-                frameSizeBytes =
-                    (networkOutputQueuePtr->TopPacket(priority).LengthBytes() +
-                     sizeof(QosDataFrameHeader));
-
-                bool macAddressWasResolved;
+        PacketPriority priority;
 
-                theMacAddressResolverPtr->GetMacAddress(
-                    networkOutputQueuePtr->NextHopForTopPacket(priority),
-                    networkLayerPtr->GetSubnetMask(interfaceIndex),
-                    macAddressWasResolved,
-                    destinationMacAddress);
+        if (FindNonEmptyPrioritySubqueueForAccessCategory(accessCategoryIndex, priority)) {
+            frameSizeBytes =
+                (networkOutputQueuePtr->TopPacket(priority).LengthBytes() +
+                 sizeof(QosDataFrameHeader));
 
-                if (!macAddressWasResolved) {
-                    // Next packet is not deliverable so give up.
-                    frameSizeBytes = 0;
-                }//if//
+            bool macAddressWasResolved;
 
-                theAdaptiveRateControllerPtr->GetDataRateInfoForDataFrameToStation(
-                    destinationMacAddress, txParameters);
+            theMacAddressResolverPtr->GetMacAddress(
+                networkOutputQueuePtr->NextHopForTopPacket(priority),
+                networkLayerPtr->GetSubnetMask(interfaceIndex),
+                macAddressWasResolved,
+                destinationMacAddress);
 
-                break;
+            if (!macAddressWasResolved) {
+                // Next packet is not deliverable so give up.
+                frameSizeBytes = 0;
             }//if//
-        }//for//
+
+            theAdaptiveRateControllerPtr->GetDataRateInfoForDataFrameToStation(
+                destinationMacAddress, txParameters);
+        }//if//
     }//if//
 
     if (frameSizeBytes == 0) {
@@ -4031,7 +5695,7 @@ void Dot11Mac::TransmitAFrame(
                 accessCategoryInfo.currentAggregateFramePtr->begin());
 
             if (accessCategoryInfo.currentAggregateFramePtr->empty()) {
-                accessCategoryInfo.currentAggregateFramePtr.reset();
+                (*this).RecycleAggregateFrameContainer(accessCategoryInfo);
             }//if//
 
             if (accessCategoryInfo.currentAggregateFrameIsAMpduAggregate) {
@@ -4144,6 +5808,12 @@ void Dot11Mac::TransmitAFrame(
             delayUntilTransmitting)) {
         packetHasBeenSentToPhy = false;
         accessCategoryInfo.hasPacketToSend = false;
+
+        // Held until the next transmission permission (ResumeTransmissionFunction).
+
+        if (heldAccessCategoryRestartIsEnabled) {
+            heldAccessCategoryBitMask |= (1U << accessCategoryIndex);
+        }//if//
         return;
     }//if//
 
@@ -4168,7 +5838,7 @@ void Dot11Mac::TransmitAFrame(
         // A transmission that does not require an immediate frame as a response is defined as a successful transmission.
         // Next Packet => Reset Contention window.
 
-        accessCategoryInfo.currentContentionWindowSlots = accessCategoryInfo.minContentionWindowSlots;
+        (*this).UpdateContentionWindow(accessCategoryIndex, ContentionWindowTransmissionSucceeded);
 
         macState = BusyMediumState;
     }
@@ -4348,6 +6018,10 @@ void Dot11Mac::ProcessInterframeSpaceAndBackoffTimeout()
 
                    (*this).TransmitAFrame(
                        accessCategoryIndex, false, aRxTxTurnaroundTime, packetHasBeenSentToThePhy);
+
+                   if ((macLatencyBreakdownIsEnabled) && (packetHasBeenSentToThePhy)) {
+                       (*this).RecordMacLatencyForBackoffExpiration(accessCategoryIndex);
+                   }//if//
                 }
                 else {
                     // Post-transmission forced backoff only, no packets to send.
@@ -4437,7 +6111,7 @@ void Dot11Mac::DropCurrentPacketAndGoToNextPacket(const unsigned int accessCateg
     // Next Packet => Reset Contention window.
     // Always do backoff procedure regardless of whether there is a packet to send.
 
-    accessCategoryInfo.currentContentionWindowSlots = accessCategoryInfo.minContentionWindowSlots;
+    (*this).UpdateContentionWindow(accessCategoryIndex, ContentionWindowPacketDropped);
 
     (*this).RecalcRandomBackoff(accessCategoryInfo);
 
@@ -4471,7 +6145,7 @@ void Dot11Mac::DropCurrentAggregateFrameAndGoToNextPacket(const unsigned int acc
         subframes[i].reset();
     }//for//
 
-    accessCategoryInfo.currentAggregateFramePtr.reset();
+    (*this).RecycleAggregateFrameContainer(accessCategoryInfo);
 
     // Send Block Ack to shift sequence number
     // window at destination for dropped frame.
@@ -4961,19 +6635,17 @@ void Dot11Mac::ProcessAcknowledgementFrame(const AcknowledgementAkaAckFrame& ack
 
     if (lastSentFrameWasAn != SentFrameType::PowerSavePollResponse) {
 
-        EdcaAccessCategoryInfo& accessCategoryInfo =
-            accessCategories[accessCategoryIndexForLastSentFrame];
-
         // Success => Reset Contention window.
 
-        accessCategoryInfo.currentContentionWindowSlots = accessCategoryInfo.minContentionWindowSlots;
+        (*this).UpdateContentionWindow(
+            accessCategoryIndexForLastSentFrame, ContentionWindowTransmissionSucceeded);
 
         // Ownership of packet was given to PHY.
 
-        assert(accessCategoryInfo.currentPacketPtr == nullptr);
+        assert(accessCategories[accessCategoryIndexForLastSentFrame].currentPacketPtr == nullptr);
 
         assert(lastSentDataFrameDestinationMacAddress ==
-               accessCategoryInfo.currentPacketsDestinationMacAddress);
+               accessCategories[accessCategoryIndexForLastSentFrame].currentPacketsDestinationMacAddress);
 
     }//if//
 
@@ -5062,7 +6734,7 @@ void Dot11Mac::ProcessBlockAckFrame(const BlockAcknowledgementFrame& blockAckFra
         accessCategoryInfo.currentAggregateFrameRetryCount++;
 
         if (numberAckedSubframes == sentSubframes.size()) {
-            accessCategoryInfo.currentAggregateFramePtr.reset();
+            (*this).RecycleAggregateFrameContainer(accessCategoryInfo);
             accessCategoryInfo.currentAggregateFrameRetryCount = 0;
         }
         else if (accessCategoryInfo.currentAggregateFrameRetryCount >= shortFrameRetryLimit) {
@@ -5082,7 +6754,7 @@ void Dot11Mac::ProcessBlockAckFrame(const BlockAcknowledgementFrame& blockAckFra
                 }//if//
             }//for//
 
-            accessCategoryInfo.currentAggregateFramePtr.reset();
+            (*this).RecycleAggregateFrameContainer(accessCategoryInfo);
             accessCategoryInfo.currentAggregateFrameRetryCount = 0;
 
             // Send Block Ack Request as a "management frame" to shift sequence number
@@ -5118,11 +6790,8 @@ void Dot11Mac::ProcessBlockAckFrame(const BlockAcknowledgementFrame& blockAckFra
             }//while//
         }//if//
 
-        assert((!protectAggregateFramesWithSingleAckedFrame) ||
-            (accessCategoryInfo.currentContentionWindowSlots ==
-               accessCategoryInfo.minContentionWindowSlots));
-
-        accessCategoryInfo.currentContentionWindowSlots = accessCategoryInfo.minContentionWindowSlots;
+        (*this).UpdateContentionWindow(
+            accessCategoryIndexForLastSentFrame, ContentionWindowTransmissionSucceeded);
 
         (*this).DoSuccessfulTransmissionPostProcessing(false);
     }
@@ -5136,7 +6805,8 @@ void Dot11Mac::ProcessBlockAckFrame(const BlockAcknowledgementFrame& blockAckFra
 
         // Success => Reset Contention window.
 
-        accessCategoryInfo.currentContentionWindowSlots = accessCategoryInfo.minContentionWindowSlots;
+        (*this).UpdateContentionWindow(
+            accessCategoryIndexForLastSentFrame, ContentionWindowTransmissionSucceeded);
 
         assert(lastSentDataFrameDestinationMacAddress == accessCategoryInfo.currentPacketsDestinationMacAddress);
 
@@ -5481,7 +7151,7 @@ void Dot11Mac::OutputTraceAndStatsForFrameReceive(const Packet& aFrame) const
 {
     const CommonFrameHeader& header = aFrame.GetAndReinterpretPayloadData<CommonFrameHeader>();
 
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             MacFrameReceiveTraceRecord traceData;
 
@@ -5516,11 +7186,11 @@ void Dot11Mac::OutputTraceAndStatsForFrameReceive(const Packet& aFrame) const
 
     switch (header.theFrameControlField.frameTypeAndSubtype) {
     case RTS_FRAME_TYPE_CODE: {
-        rtsFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(RtsFramesReceivedCounter);
         break;
     }
     case CTS_FRAME_TYPE_CODE: {
-        ctsFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(CtsFramesReceivedCounter);
         break;
     }
 
@@ -5533,35 +7203,35 @@ void Dot11Mac::OutputTraceAndStatsForFrameReceive(const Packet& aFrame) const
         break;
     }
     case BEACON_FRAME_TYPE_CODE: {
-        beaconFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(BeaconFramesReceivedCounter);
         break;
     }
     case ASSOCIATION_REQUEST_FRAME_TYPE_CODE: {
-        associationRequestFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(AssociationRequestFramesReceivedCounter);
         break;
     }
     case ASSOCIATION_RESPONSE_FRAME_TYPE_CODE: {
-        associationResponseFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(AssociationResponseFramesReceivedCounter);
         break;
     }
     case REASSOCIATION_REQUEST_FRAME_TYPE_CODE: {
-        reassociationRequestFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(ReassociationRequestFramesReceivedCounter);
         break;
     }
     case REASSOCIATION_RESPONSE_FRAME_TYPE_CODE: {
-        reassociationResponseFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(ReassociationResponseFramesReceivedCounter);
         break;
     }
     case DISASSOCIATION_FRAME_TYPE_CODE: {
-        disassociationFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(DisassociationFramesReceivedCounter);
         break;
     }
     case AUTHENTICATION_FRAME_TYPE_CODE: {
-        authenticationFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(AuthenticationFramesReceivedCounter);
         break;
     }
     case BLOCK_ACK_FRAME_TYPE_CODE: {
-        blockAckFramesReceivedStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(BlockAckFramesReceivedCounter);
         break;
     }
     case BLOCK_ACK_REQUEST_FRAME_TYPE_CODE: {
@@ -5581,7 +7251,7 @@ void Dot11Mac::OutputTraceAndStatsForAggregateSubframeReceive(
     const Packet& aFrame,
     const QosDataFrameHeader& dataFrameHeader)
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             MacFrameReceiveTraceRecord traceData;
 
@@ -5615,7 +7285,7 @@ void Dot11Mac::OutputTraceAndStatsForAggregateSubframeReceive(
         }//if//
     }//if//
 
-    dataAggregatedSubframesReceivedStatPtr->IncrementCounter();
+    (*this).IncrementOptionalMacCounter(DataAggregatedSubframesReceivedCounter);
 
 }//OutputTraceAndStatsForAggregateSubframeReceive//
 
@@ -5624,7 +7294,7 @@ void Dot11Mac::OutputTraceAndStatsForAggregateSubframeReceive(
 inline
 void Dot11Mac::OutputTraceForClearChannel() const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             simEngineInterfacePtr->OutputTraceInBinary(modelName, theInterfaceId, "ClearCh");
         }
@@ -5638,7 +7308,7 @@ void Dot11Mac::OutputTraceForClearChannel() const
 inline
 void Dot11Mac::OutputTraceForBusyChannel() const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             simEngineInterfacePtr->OutputTraceInBinary(modelName, theInterfaceId, "BusyCh");
         }
@@ -5652,7 +7322,7 @@ void Dot11Mac::OutputTraceForBusyChannel() const
 inline
 void Dot11Mac::OutputTraceForNavStart(const SimTime& expirationTime) const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             SimTime currentTime = simEngineInterfacePtr->CurrentTime();
 
@@ -5675,7 +7345,7 @@ void Dot11Mac::OutputTraceForNavStart(const SimTime& expirationTime) const
 inline
 void Dot11Mac::OutputTraceForNavExpiration() const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             simEngineInterfacePtr->OutputTraceInBinary(modelName, theInterfaceId, "NAV-End");
         }
@@ -5688,7 +7358,7 @@ void Dot11Mac::OutputTraceForNavExpiration() const
 inline
 void Dot11Mac::OutputTraceForIfsAndBackoffStart(const SimTime& backoffDuration) const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             MacIfsAndBackoffStartTraceRecord traceData;
@@ -5727,7 +7397,7 @@ void Dot11Mac::OutputTraceForInterruptedIfsAndBackoff(
     const unsigned int accessCategoryIndex,
     const SimTime nonExtendedDurationLeft) const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn(accessCategoryIndex)) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             MacIfsAndBackoffPauseTraceRecord traceData;
@@ -5755,7 +7425,7 @@ void Dot11Mac::OutputTraceForInterruptedIfsAndBackoff(
 inline
 void Dot11Mac::OutputTraceForIfsAndBackoffExpiration() const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             simEngineInterfacePtr->OutputTraceInBinary(modelName, theInterfaceId, "IFSAndBackoffEnd");
         }
@@ -5768,7 +7438,7 @@ void Dot11Mac::OutputTraceForIfsAndBackoffExpiration() const
 inline
 void Dot11Mac::OutputTraceForPacketDequeue(const unsigned int accessCategoryIndex, const SimTime delayUntilAirBorne) const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn(accessCategoryIndex)) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             MacPacketDequeueTraceRecord traceData;
@@ -5806,7 +7476,7 @@ void Dot11Mac::OutputTraceForPacketDequeue(const unsigned int accessCategoryInde
 inline
 void Dot11Mac::OutputTraceAndStatsForRtsFrameTransmission(const unsigned int accessCategoryIndex) const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn(accessCategoryIndex)) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             MacTxRtsTraceRecord traceData;
@@ -5832,7 +7502,7 @@ void Dot11Mac::OutputTraceAndStatsForRtsFrameTransmission(const unsigned int acc
         }//if//
     }//if//
 
-    rtsFramesSentStatPtr->IncrementCounter();
+    (*this).IncrementOptionalMacCounter(RtsFramesSentCounter);
 
 }//OutputTraceAndStatsForRtsFrameTransmission//
 
@@ -5840,7 +7510,7 @@ void Dot11Mac::OutputTraceAndStatsForRtsFrameTransmission(const unsigned int acc
 inline
 void Dot11Mac::OutputTraceForCtsFrameTransmission() const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             simEngineInterfacePtr->OutputTraceInBinary(modelName, theInterfaceId, "Tx-CTS");
         }
@@ -5849,7 +7519,7 @@ void Dot11Mac::OutputTraceForCtsFrameTransmission() const
         }//if//
     }//if//
 
-    ctsFramesSentStatPtr->IncrementCounter();
+    (*this).IncrementOptionalMacCounter(CtsFramesSentCounter);
 
 }//OutputTraceForCtsFrameTransmission//
 
@@ -5859,7 +7529,7 @@ void Dot11Mac::OutputTraceAndStatsForAggregatedFrameTransmission(const unsigned
 {
     const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories.at(accessCategoryIndex);
 
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn(accessCategoryIndex)) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             MacTxUnicastDataTraceRecord traceData;
@@ -5889,10 +7559,10 @@ void Dot11Mac::OutputTraceAndStatsForAggregatedFrameTransmission(const unsigned
         }//if//
     }//if//
 
-    dataAggregateFramesSentStatPtr->IncrementCounter();
+    (*this).IncrementOptionalMacCounter(DataAggregateFramesSentCounter);
 
     if (accessCategoryInfo.currentAggregateFrameRetryCount > 0) {
-        dataAggregateFramesResentStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(DataAggregateFramesResentCounter);
     }//if//
 
 }//OutputTraceAndStatsForAggregatedFrameTransmission//
@@ -5901,7 +7571,7 @@ void Dot11Mac::OutputTraceAndStatsForAggregatedFrameTransmission(const unsigned
 inline
 void Dot11Mac::OutputTraceAndStatsForBroadcastDataFrameTransmission(const unsigned int accessCategoryIndex) const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn(accessCategoryIndex)) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             MacTxBroadcastDataTraceRecord traceData;
@@ -5939,7 +7609,7 @@ void Dot11Mac::OutputTraceAndStatsForUnicastDataFrameTransmission(const unsigned
 {
     const EdcaAccessCategoryInfo& accessCategoryInfo = accessCategories.at(accessCategoryIndex);
 
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn(accessCategoryIndex)) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             MacTxUnicastDataTraceRecord traceData;
@@ -5986,7 +7656,7 @@ void Dot11Mac::OutputTraceAndStatsForManagementFrameTransmission(const unsigned
                 accessCategoryInfo.currentPacketPtr->GetAndReinterpretPayloadData<CommonFrameHeader>();
     const unsigned char frameType = header.theFrameControlField.frameTypeAndSubtype;
 
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn(accessCategoryIndex)) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             Dot11MacTxManagementTraceRecord traceData;
@@ -6020,31 +7690,31 @@ void Dot11Mac::OutputTraceAndStatsForManagementFrameTransmission(const unsigned
     //stat
     switch (frameType) {
     case BEACON_FRAME_TYPE_CODE: {
-        beaconFramesSentStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(BeaconFramesSentCounter);
         break;
     }
     case ASSOCIATION_REQUEST_FRAME_TYPE_CODE: {
-        associationRequestFramesSentStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(AssociationRequestFramesSentCounter);
         break;
     }
     case ASSOCIATION_RESPONSE_FRAME_TYPE_CODE: {
-        associationResponseFramesSentStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(AssociationResponseFramesSentCounter);
         break;
     }
     case REASSOCIATION_REQUEST_FRAME_TYPE_CODE: {
-        reassociationRequestFramesSentStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(ReassociationRequestFramesSentCounter);
         break;
     }
     case REASSOCIATION_RESPONSE_FRAME_TYPE_CODE: {
-        reassociationResponseFramesSentStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(ReassociationResponseFramesSentCounter);
         break;
     }
     case DISASSOCIATION_FRAME_TYPE_CODE: {
-        disassociationFramesSentStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(DisassociationFramesSentCounter);
         break;
     }
     case AUTHENTICATION_FRAME_TYPE_CODE: {
-        authenticationFramesSentStatPtr->IncrementCounter();
+        (*this).IncrementOptionalMacCounter(AuthenticationFramesSentCounter);
         break;
     }
     case BLOCK_ACK_REQUEST_FRAME_TYPE_CODE:
@@ -6066,7 +7736,7 @@ void Dot11Mac::OutputTraceAndStatsForManagementFrameTransmission(const unsigned
 inline
 void Dot11Mac::OutputTraceForAckFrameTransmission() const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             simEngineInterfacePtr->OutputTraceInBinary(modelName, theInterfaceId, "Tx-ACK");
         }
@@ -6083,7 +7753,7 @@ void Dot11Mac::OutputTraceForAckFrameTransmission() const
 inline
 void Dot11Mac::OutputTraceAndStatsForBlockAckFrameTransmission() const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
             simEngineInterfacePtr->OutputTraceInBinary(modelName, theInterfaceId, "Tx-BlockACK");
         }
@@ -6092,7 +7762,7 @@ void Dot11Mac::OutputTraceAndStatsForBlockAckFrameTransmission() const
         }//if//
     }//if//
 
-     blockAckFramesSentStatPtr->IncrementCounter();
+     (*this).IncrementOptionalMacCounter(BlockAckFramesSentCounter);
 
 }//OutputTraceAndStatsForBlockAckFrameTransmission//
 
@@ -6101,7 +7771,7 @@ void Dot11Mac::OutputTraceAndStatsForBlockAckFrameTransmission() const
 inline
 void Dot11Mac::OutputTraceForCtsOrAckTimeout() const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn()) {
 
         const bool lastTransmissionWasAShortFrame =
             ((lastSentFrameWasAn == SentFrameType::ShortFrame) || (lastSentFrameWasAn == SentFrameType::RequestToSendFrame) ||
@@ -6150,7 +7820,7 @@ void Dot11Mac::OutputTraceForCtsOrAckTimeout() const
 inline
 void Dot11Mac::OutputTraceAndStatsForPacketRetriesExceeded(const unsigned int accessCategoryIndex) const
 {
-    if (simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((*this).MacTraceIsOn(accessCategoryIndex)) {
         if (simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             MacPacketRetryExceededTraceRecord traceData;
@@ -6467,6 +8137,10 @@ void Dot11Mac::ReceiveFrameFromPhy(
         congestionMonitoringHandlerPtr->ScanAReceivedFrame(aFrame, simEngineInterfacePtr->CurrentTime());
     }
 
+    if (channelBusyRatioEstimatorPtr != nullptr) {
+        channelBusyRatioEstimatorPtr->ScanAReceivedFrame(aFrame, simEngineInterfacePtr->CurrentTime());
+    }//if//
+
     (*this).lastFrameReceivedWasCorrupt = false;
 
     const CommonFrameHeader& header = aFrame.GetAndReinterpretPayloadData<CommonFrameHeader>();
@@ -6771,7 +8445,7 @@ void Dot11Mac::QueueOutgoingPacket(
         packetToDrop = nullptr;
     }//if//
 
-    (*this).NetworkLayerQueueChangeNotification();
+    (*this).NetworkLayerQueueChangeNotificationForPriority(priority);
 
 }//QueueOutgoingPacket//
 
@@ -1119,31 +1119,22 @@ void DsrcMessageApplication::PeriodicallyTransmitBasicSafetyMessage()
         */
    
         //priority調整
-        unsigned int currentCW[4];
+        //DCF or fewer EDCA categories: missing categories keep the 15,15,7,3 defaults.
+        unsigned int currentCW[4] = {15, 15, 7, 3};
 
-        for(int i = 0; i < 4; i++){
-            char fname7[30];
-            std::string myCWS;
-            sprintf(fname7,"tmpCW_%d_%d.txt", i, basicSafetyMessageInfo.MyNodeId);
-            std::ifstream inputfile7(fname7);
-            //今のところ優先度を取得
-            inputfile7 >> myCWS;
-            currentCW[i] = atoi(myCWS.c_str());
-            if(!inputfile7){
-                //std::cout << "ファイルが開けませんでした" << endl;
-                //std::cin.get();
-                currentCW[0] = 15;
-                currentCW[1] = 15;
-                currentCW[2] = 7;
-                currentCW[3] = 3;
-            }
+        const unsigned int numberAccessCategories =
+            wsmpLayerPtr->GetNumberAccessCategories(basicSafetyMessageInfo.channelNumberId);
+
+        for(unsigned int i = 0; (i < 4) && (i < numberAccessCategories); i++){
+            //今のところ優先度を取得 (BSMチャネルのMACから直接取得)
+            currentCW[i] =
+                wsmpLayerPtr->GetCurrentContentionWindowSlots(basicSafetyMessageInfo.channelNumberId, i);
             /*
             if(basicSafetyMessageInfo.MyNodeId == 1){
                 std::cout << "CW" << i << " = " << currentCW[i] << endl;
             }
             */
             //15,15,7,3
-            inputfile7.close();
         }
 
         
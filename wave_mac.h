@@ -93,6 +93,7 @@ using ScenSim::Application;
 using ScenSim::EtherTypeField;
 using ScenSim::ETHERTYPE_WSMP;
 using ScenSim::EnqueueResultType;
+using ScenSim::ENQUEUE_SUCCESS;
 
 using Dot11::ItsOutputQueueWithPrioritySubqueues;
 using Dot11::DatarateBitsPerSec;
@@ -137,6 +138,30 @@ enum {
 
 static const char* CHANNEL_CATEGORY_NAMES[] = {"cch", "sch", /*ext*/};
 
+// One bit per channel number index (NUMBER_CHANNELS <= 8) or channel category.
+
+typedef uint8_t ChannelNumberBitMaskType;
+typedef uint8_t ChannelCategoryBitMaskType;
+
+static_assert(NUMBER_CHANNELS <= (8 * sizeof(ChannelNumberBitMaskType)),
+              "ChannelNumberBitMaskType is too small for NUMBER_CHANNELS");
+static_assert(NUMBER_CHANNEL_CATEGORIES <= (8 * sizeof(ChannelCategoryBitMaskType)),
+              "ChannelCategoryBitMaskType is too small for NUMBER_CHANNEL_CATEGORIES");
+
+static inline
+ChannelNumberBitMaskType ConvertToChannelNumberBit(const ChannelNumberIndexType& channelNumberId)
+{
+    assert(channelNumberId < NUMBER_CHANNELS);
+    return ChannelNumberBitMaskType(1U << channelNumberId);
+}
+
+static inline
+ChannelCategoryBitMaskType ConvertToChannelCategoryBit(const ChannelCategoryType& channelCategory)
+{
+    assert(channelCategory < NUMBER_CHANNEL_CATEGORIES);
+    return ChannelCategoryBitMaskType(1U << channelCategory);
+}
+
 
 enum ChannelAccessType {
     CHANNEL_ACCESS_CONTINUE,
@@ -150,9 +175,51 @@ struct WaveMacPhyInput {
 };//WaveMacPhyInput
 
 class WaveMac : public MacLayer {
+private:
+    class PhyEntity;
+
 public:
     static const string modelName;
 
+    // Simulation wide clock for the common CCH/SCH interval instants. Timer events
+    // of all subscribed phy entities due at the same time are dispatched from a
+    // single engine event.
+    // Create one clock from an engine interface of a non-node context and pass it
+    // to every WaveMac ("its-wave-use-global-interval-clock" = true). All WaveMacs
+    // then run on that context, so this is only valid for a sequential
+    // (non-partitioned) simulation engine.
+
+    class IntervalClock {
+    public:
+        IntervalClock(const shared_ptr<SimulationEngineInterface>& initSimEngineInterfacePtr);
+        ~IntervalClock();
+
+        // A phy entity has at most one subscription; it unsubscribes the
+        // superseded time on rescheduling and on destruction.
+
+        void Subscribe(PhyEntity* phyEntityPtr, const SimTime time);
+        void Unsubscribe(const PhyEntity* phyEntityPtr, const SimTime time);
+
+    private:
+        class ClockEvent : public SimulationEvent {
+        public:
+            ClockEvent(IntervalClock* initIntervalClockPtr) : intervalClockPtr(initIntervalClockPtr) {}
+            virtual void ExecuteEvent() { intervalClockPtr->DispatchEarliestSubscribers(); }
+        private:
+            IntervalClock* intervalClockPtr;
+        };
+
+        shared_ptr<SimulationEngineInterface> simEngineInterfacePtr;
+        shared_ptr<ClockEvent> clockEventPtr;
+        EventRescheduleTicket clockEventTicket;
+        SimTime clockEventTime;
+
+        map<SimTime, vector<PhyEntity*> > subscriberPtrsPerTime;
+
+        void DispatchEarliestSubscribers();
+        void ScheduleClockEventIfNecessary();
+    };
+
     WaveMac(
         const ParameterDatabaseReader& theParameterDatabaseReader,
         const shared_ptr<SimulationEngineInterface>& initSimulationEngineInterfacePtr,
@@ -161,7 +228,8 @@ public:
         const unsigned int initInterfaceIndex,
         const shared_ptr<NetworkLayer>& initNetworkLayerPtr,
         const vector<WaveMacPhyInput>& initPhyInputs,
-        const RandomNumberGeneratorSeed& nodeSeed);
+        const RandomNumberGeneratorSeed& nodeSeed,
+        const shared_ptr<IntervalClock>& initSharedIntervalClockPtr = shared_ptr<IntervalClock>());
 
     void SetEdcaParameter(
         const ChannelNumberIndexType& channelNumberId,
@@ -172,6 +240,17 @@ public:
         const int contentionWindowMax,
         const SimTime& txopDuration);
 
+    unsigned int GetNumberAccessCategories(const ChannelNumberIndexType& channelNumberId) const;
+
+    unsigned int GetCurrentContentionWindowSlots(
+        const ChannelNumberIndexType& channelNumberId,
+        const size_t accessCategoryIndex) const;
+
+    // Null unless dot11-channel-busy-ratio-window-duration is set.
+
+    shared_ptr<Dot11::ChannelBusyRatioEstimator> GetChannelBusyRatioEstimator(
+        const ChannelNumberIndexType& channelNumberId) const;
+
     void SetWsmpPacketHandler(
         const shared_ptr<SimpleMacPacketHandler>& initWsmpPacketHandlerPtr);
 
@@ -225,6 +304,12 @@ private:
             const WaveMacPhyInput& initPhyInput,
             const vector<shared_ptr<Dot11Mac> > initMacPtrsPerCategory);
 
+        ~PhyEntity();
+
+        void OutputEndOfRunIntervalStats();
+
+        void ExecuteIntervalClockTimerEvent(const SimTime time);
+
         void SetContinuousAccess(
             const ChannelNumberIndexType& channelNumberId);
         void SetAlternatingAccess();
@@ -244,12 +329,24 @@ private:
 
         shared_ptr<Dot11Phy> phyPtr;
         shared_ptr<Dot11Mac> macPtrs[NUMBER_CHANNEL_CATEGORIES];
-        set<ChannelNumberIndexType> availableChannelNumberIds[NUMBER_CHANNEL_CATEGORIES];
+        ChannelNumberBitMaskType availableChannelNumberBitMasks[NUMBER_CHANNEL_CATEGORIES];
+
+        // NUMBER_CHANNEL_CATEGORIES for channels not supported by the phy.
+        ChannelCategoryType channelCategoryPerChannelNumberId[NUMBER_CHANNELS];
 
         size_t numberExtendedSchAccessSlots;
         ChannelCategoryType currentCategory;
         ChannelNumberIndexType channelNumberPerCategory[NUMBER_CHANNEL_CATEGORIES];
         vector<ChannelCategoryType> alternatingChannelCategories;
+        ChannelCategoryBitMaskType alternatingChannelCategoryBitMask;
+
+        bool ChannelIsAvailableFor(
+            const ChannelCategoryType& channelCategory,
+            const ChannelNumberIndexType& channelNumberId) const
+        {
+            return ((availableChannelNumberBitMasks[channelCategory] &
+                     ConvertToChannelNumberBit(channelNumberId)) != 0);
+        }
 
         ChannelNumberIndexType nextChannelNumberIdInWaitingTransmissionSuspensionState;
 
@@ -275,8 +372,17 @@ private:
         };
         shared_ptr<TimerEvent> timerEventPtr;
         EventRescheduleTicket timerEventTicket;
+        SimTime intervalClockTimerEventTime;
+
+        void CancelTimerEvent();
+        void CancelIntervalClockTimerEvent();
+
+        size_t numberAutoExtendedSchAccessSlots;
+
+        bool SchAccessShouldBeAutomaticallyExtended() const;
 
         bool CurrentChannelOrNextSwitchingChannelIs(const ChannelNumberIndexType& channelNumberId) const;
+        SimTime CalculateSyncInterval() const;
         SimTime CalculateCurrentTxRxOperationEndTime() const;
         ChannelCategoryType CalculateNonExtendedChannelCategoryAt(const SimTime time) const;
 
@@ -297,21 +403,67 @@ private:
 
         void OutputTraceAndStatsForChannelChange(
             const ChannelNumberIndexType& channelNumberId) const;
+
+        // Time buckets of each channel interval (run summary stats).
+        // One sample per phase and interval; TX/RX time is split into medium
+        // busy and idle time by the physical carrier sense of the channel MAC.
+
+        enum IntervalPhaseType {
+            INTERVAL_PHASE_TX_RX,
+            INTERVAL_PHASE_SUSPENDED,
+            INTERVAL_PHASE_SWITCHING,
+            NUMBER_INTERVAL_PHASES,
+        };
+
+        enum IntervalStatType {
+            INTERVAL_STAT_TX_RX_BUSY,
+            INTERVAL_STAT_TX_RX_IDLE,
+            INTERVAL_STAT_SUSPENDED,
+            INTERVAL_STAT_SWITCHING,
+            NUMBER_INTERVAL_STATS,
+        };
+
+        IntervalPhaseType currentIntervalPhase;
+        ChannelNumberIndexType currentIntervalPhaseChannelNumberId;
+        SimTime currentIntervalPhaseStartTime;
+        SimTime currentIntervalPhaseStartBusyDuration;
+
+        shared_ptr<RealStatistic> intervalDurationStatPtrs[NUMBER_CHANNELS][NUMBER_INTERVAL_STATS];
+
+        void EnterIntervalPhase(
+            const IntervalPhaseType& intervalPhase,
+            const ChannelNumberIndexType& channelNumberId);
+
+        void RecordCurrentIntervalPhase();
     };
 
     struct ChannelEntity {
         shared_ptr<PhyEntity> phyEntityPtr;
         shared_ptr<Dot11Mac> macPtr;
         shared_ptr<ItsOutputQueueWithPrioritySubqueues> outputQueuePtr;
+        shared_ptr<CounterStatistic> queueDropsStatPtr;
     };
 
     shared_ptr<SimulationEngineInterface> simEngineInterfacePtr;
+    shared_ptr<IntervalClock> intervalClockPtr;
     vector<ChannelEntity> channelEntities;
 
     SimTime channelIntervals[NUMBER_CHANNEL_CATEGORIES];
     SimTime syncTolerance;
     SimTime maxChannelSwitchingTime;
 
+    Dot11::MacTraceFilter macTraceFilter;
+
+    bool channelIntervalStatsAreEnabled;
+
+    // Consecutive sync intervals an alternating access phy may stay on SCH
+    // while the SCH queue is backlogged and CCH has nothing to send (0: off).
+    // Staying on SCH over a CCH interval also means not receiving CCH (safety)
+    // messages of other nodes in it, so CCH intervals are only skipped when
+    // "its-wave-auto-extended-sch-access-may-skip-cch-interval" is true.
+    size_t maxAutoExtendedSchAccessSlots;
+    bool autoExtendedSchAccessMaySkipCchInterval;
+
     void CreateDot11MacAndOutputQueueForChannelCategory(
         const ChannelCategoryType& channelCategory,
         const ParameterDatabaseReader& theParameterDatabaseReader,
@@ -409,7 +561,8 @@ WaveMac::WaveMac(
     const unsigned int initInterfaceIndex,
     const shared_ptr<NetworkLayer>& initNetworkLayerPtr,
     const vector<WaveMacPhyInput>& initPhyInputs,
-    const RandomNumberGeneratorSeed& nodeSeed)
+    const RandomNumberGeneratorSeed& nodeSeed,
+    const shared_ptr<IntervalClock>& initSharedIntervalClockPtr)
     :
     simEngineInterfacePtr(initSimulationEngineInterfacePtr),
     channelEntities(NUMBER_CHANNELS),
@@ -418,8 +571,51 @@ WaveMac::WaveMac(
             "its-wave-sync-tolerance", theNodeId, theInterfaceId)),
     maxChannelSwitchingTime(
         theParameterDatabaseReader.ReadTime(
-            "its-wave-max-channel-switching-time", theNodeId, theInterfaceId))
+            "its-wave-max-channel-switching-time", theNodeId, theInterfaceId)),
+    channelIntervalStatsAreEnabled(false),
+    maxAutoExtendedSchAccessSlots(0),
+    autoExtendedSchAccessMaySkipCchInterval(false)
 {
+    macTraceFilter.ReadParameters(theParameterDatabaseReader, theNodeId, theInterfaceId);
+
+    if (theParameterDatabaseReader.ParameterExists(
+            "its-wave-enable-channel-interval-stats", theNodeId, theInterfaceId)) {
+
+        channelIntervalStatsAreEnabled =
+            theParameterDatabaseReader.ReadBool(
+                "its-wave-enable-channel-interval-stats", theNodeId, theInterfaceId);
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+            "its-wave-max-auto-extended-sch-access-slots", theNodeId, theInterfaceId)) {
+
+        maxAutoExtendedSchAccessSlots =
+            theParameterDatabaseReader.ReadNonNegativeInt(
+                "its-wave-max-auto-extended-sch-access-slots", theNodeId, theInterfaceId);
+    }//if//
+
+    if (theParameterDatabaseReader.ParameterExists(
+            "its-wave-auto-extended-sch-access-may-skip-cch-interval", theNodeId, theInterfaceId)) {
+
+        autoExtendedSchAccessMaySkipCchInterval =
+            theParameterDatabaseReader.ReadBool(
+                "its-wave-auto-extended-sch-access-may-skip-cch-interval", theNodeId, theInterfaceId);
+    }//if//
+
+    if ((theParameterDatabaseReader.ParameterExists(
+            "its-wave-use-global-interval-clock", theNodeId, theInterfaceId)) &&
+        (theParameterDatabaseReader.ReadBool(
+            "its-wave-use-global-interval-clock", theNodeId, theInterfaceId))) {
+
+        if (initSharedIntervalClockPtr == nullptr) {
+            cerr << "Error: its-wave-use-global-interval-clock requires a shared interval clock" << endl
+                 << "created from a non-node engine context (sequential engine only)." << endl;
+            exit(1);
+        }//if//
+
+        intervalClockPtr = initSharedIntervalClockPtr;
+    }//if//
+
     for(ChannelCategoryType i = 0; i < NUMBER_CHANNEL_CATEGORIES; i++) {
         channelIntervals[i] =
             theParameterDatabaseReader.ReadTime(
@@ -467,6 +663,13 @@ WaveMac::WaveMac(
                 channelEntity.phyEntityPtr = phyEntityPtr;
                 channelEntity.macPtr = macPtrs[category];
                 channelEntity.outputQueuePtr = outputQueuePtrs[category];
+
+                if (channelIntervalStatsAreEnabled) {
+                    channelEntity.queueDropsStatPtr =
+                        simEngineInterfacePtr->CreateCounterStat(
+                            modelName + '_' + phyInput.phyDeviceName + "_Ch" +
+                            ConvertChannelNumberIdToString(channelNumberId) + "_QueueDrops");
+                }//if//
             }//for//
         }//for//
     }//for//
@@ -536,6 +739,49 @@ void WaveMac::CreateDot11MacAndOutputQueueForChannelCategory(
     macPtr->SetNetworkOutputQueue(outputQueuePtr);
 }//CreateDot11MacAndOutputQueueForChannelCategory//
 
+inline
+unsigned int WaveMac::GetNumberAccessCategories(const ChannelNumberIndexType& channelNumberId) const
+{
+    if (channelEntities.at(channelNumberId).macPtr == nullptr) {
+        cerr << "Error: no mac for channel "
+             << ConvertChannelNumberIdToString(channelNumberId) << endl;
+        exit(1);
+    }//if//
+
+    return channelEntities.at(channelNumberId).macPtr->GetNumberAccessCategories();
+
+}//GetNumberAccessCategories//
+
+inline
+unsigned int WaveMac::GetCurrentContentionWindowSlots(
+    const ChannelNumberIndexType& channelNumberId,
+    const size_t accessCategoryIndex) const
+{
+    if (channelEntities.at(channelNumberId).macPtr == nullptr) {
+        cerr << "Error: no mac for channel "
+             << ConvertChannelNumberIdToString(channelNumberId) << endl;
+        exit(1);
+    }//if//
+
+    return channelEntities.at(channelNumberId).macPtr->GetCurrentContentionWindowSlots(
+        static_cast<unsigned int>(accessCategoryIndex));
+
+}//GetCurrentContentionWindowSlots//
+
+inline
+shared_ptr<Dot11::ChannelBusyRatioEstimator> WaveMac::GetChannelBusyRatioEstimator(
+    const ChannelNumberIndexType& channelNumberId) const
+{
+    if (channelEntities.at(channelNumberId).macPtr == nullptr) {
+        cerr << "Error: no mac for channel "
+             << ConvertChannelNumberIdToString(channelNumberId) << endl;
+        exit(1);
+    }//if//
+
+    return channelEntities.at(channelNumberId).macPtr->GetChannelBusyRatioEstimator();
+
+}//GetChannelBusyRatioEstimator//
+
 inline
 void WaveMac::SetEdcaParameter(
     const ChannelNumberIndexType& channelNumberId,
@@ -614,9 +860,17 @@ void WaveMac::InsertPacektIntoCchOrSchQueueWhichSupportsChannelIdOf(
             enqueueResult,
             packetToDropPtr);
 
-    channelEntities.at(channelNumberId).macPtr->NetworkLayerQueueChangeNotification();
+    if ((enqueueResult != ENQUEUE_SUCCESS) &&
+        (channelEntities.at(channelNumberId).queueDropsStatPtr != nullptr)) {
+        channelEntities.at(channelNumberId).queueDropsStatPtr->IncrementCounter();
+    }//if//
+
+    channelEntities.at(channelNumberId).macPtr->NetworkLayerQueueChangeNotificationForPriority(priority);
 }//InsertPacektIntoCchOrSchQueueWhichSupportsChannelIdOf//
 
+// Only for queue changes of unknown channel (e.g. IP packets via the network layer).
+// WSMP insertions notify the channel MAC directly.
+
 inline
 void WaveMac::NetworkLayerQueueChangeNotification()
 {
@@ -641,6 +895,29 @@ void WaveMac::SetWsmpPacketHandler(
 inline
 void WaveMac::DisconnectFromOtherLayers()
 {
+    // Phy entities and channel MACs are shared by several channel entities;
+    // flush and disconnect each once so that their end of run statistics are
+    // output.
+
+    set<PhyEntity*> flushedPhyEntityPtrs;
+    set<Dot11Mac*> disconnectedMacPtrs;
+
+    for(size_t i = 0; i < channelEntities.size(); i++) {
+        PhyEntity* phyEntityPtr = channelEntities[i].phyEntityPtr.get();
+
+        if ((phyEntityPtr != nullptr) && (flushedPhyEntityPtrs.insert(phyEntityPtr).second)) {
+            phyEntityPtr->OutputEndOfRunIntervalStats();
+        }//if//
+    }//for//
+
+    for(size_t i = 0; i < channelEntities.size(); i++) {
+        Dot11Mac* macPtr = channelEntities[i].macPtr.get();
+
+        if ((macPtr != nullptr) && (disconnectedMacPtrs.insert(macPtr).second)) {
+            macPtr->DisconnectFromOtherLayers();
+        }//if//
+    }//for//
+
     channelEntities.clear();
 }//DisconnectFromOtherLayers//
 
@@ -709,6 +986,103 @@ void WaveMac::SetExtendedSchAccess(
 
 #pragma warning(disable:4355)
 
+inline
+WaveMac::IntervalClock::IntervalClock(
+    const shared_ptr<SimulationEngineInterface>& initSimEngineInterfacePtr)
+    :
+    simEngineInterfacePtr(initSimEngineInterfacePtr),
+    clockEventPtr(new ClockEvent(this)),
+    clockEventTime(INFINITE_TIME)
+{
+}
+
+#pragma warning(default:4355)
+
+inline
+WaveMac::IntervalClock::~IntervalClock()
+{
+    if (!clockEventTicket.IsNull()) {
+        simEngineInterfacePtr->CancelEvent(clockEventTicket);
+    }//if//
+}//~IntervalClock//
+
+inline
+void WaveMac::IntervalClock::Subscribe(PhyEntity* phyEntityPtr, const SimTime time)
+{
+    subscriberPtrsPerTime[time].push_back(phyEntityPtr);
+
+    (*this).ScheduleClockEventIfNecessary();
+}//Subscribe//
+
+inline
+void WaveMac::IntervalClock::Unsubscribe(const PhyEntity* phyEntityPtr, const SimTime time)
+{
+    // The clock event is left as is; a dispatch without subscribers at its
+    // time only reschedules it.
+
+    typedef map<SimTime, vector<PhyEntity*> >::iterator IterType;
+
+    IterType iter = subscriberPtrsPerTime.find(time);
+
+    if (iter == subscriberPtrsPerTime.end()) {
+        // Already dispatched.
+        return;
+    }//if//
+
+    vector<PhyEntity*>& subscriberPtrs = iter->second;
+
+    subscriberPtrs.erase(
+        std::remove(subscriberPtrs.begin(), subscriberPtrs.end(), phyEntityPtr),
+        subscriberPtrs.end());
+
+    if (subscriberPtrs.empty()) {
+        subscriberPtrsPerTime.erase(iter);
+    }//if//
+}//Unsubscribe//
+
+inline
+void WaveMac::IntervalClock::ScheduleClockEventIfNecessary()
+{
+    if (subscriberPtrsPerTime.empty()) {
+        return;
+    }//if//
+
+    const SimTime earliestTime = subscriberPtrsPerTime.begin()->first;
+
+    if (clockEventTicket.IsNull()) {
+        simEngineInterfacePtr->ScheduleEvent(clockEventPtr, earliestTime, clockEventTicket);
+        clockEventTime = earliestTime;
+    }
+    else if (earliestTime < clockEventTime) {
+        simEngineInterfacePtr->RescheduleEvent(clockEventTicket, earliestTime);
+        clockEventTime = earliestTime;
+    }//if//
+}//ScheduleClockEventIfNecessary//
+
+inline
+void WaveMac::IntervalClock::DispatchEarliestSubscribers()
+{
+    clockEventTicket.Clear();
+
+    const SimTime time = simEngineInterfacePtr->CurrentTime();
+
+    if ((!subscriberPtrsPerTime.empty()) &&
+        (subscriberPtrsPerTime.begin()->first == time)) {
+
+        vector<PhyEntity*> subscriberPtrs;
+        subscriberPtrs.swap(subscriberPtrsPerTime.begin()->second);
+        subscriberPtrsPerTime.erase(subscriberPtrsPerTime.begin());
+
+        for(size_t i = 0; i < subscriberPtrs.size(); i++) {
+            subscriberPtrs[i]->ExecuteIntervalClockTimerEvent(time);
+        }//for//
+    }//if//
+
+    (*this).ScheduleClockEventIfNecessary();
+}//DispatchEarliestSubscribers//
+
+#pragma warning(disable:4355)
+
 inline
 WaveMac::PhyEntity::PhyEntity(
     const WaveMac& initWaveMac,
@@ -719,11 +1093,26 @@ WaveMac::PhyEntity::PhyEntity(
     phyDeviceName(initPhyInput.phyDeviceName),
     phyPtr(initPhyInput.phyPtr),
     numberExtendedSchAccessSlots(0),
+    alternatingChannelCategoryBitMask(0),
     nextChannelNumberIdInWaitingTransmissionSuspensionState(CHANNEL_NUMBER_UNKNOWN),
-    timerEventPtr(new TimerEvent(this))
+    timerEventPtr(new TimerEvent(this)),
+    intervalClockTimerEventTime(INFINITE_TIME),
+    numberAutoExtendedSchAccessSlots(0),
+    currentIntervalPhase(NUMBER_INTERVAL_PHASES),
+    currentIntervalPhaseChannelNumberId(CHANNEL_NUMBER_UNKNOWN),
+    currentIntervalPhaseStartTime(ZERO_TIME),
+    currentIntervalPhaseStartBusyDuration(ZERO_TIME)
 {
     set<ChannelNumberIndexType> assignedChannelNumberIds;
 
+    for(ChannelCategoryType i = 0; i < NUMBER_CHANNEL_CATEGORIES; i++) {
+        availableChannelNumberBitMasks[i] = 0;
+    }//for//
+
+    for(ChannelNumberIndexType i = 0; i < NUMBER_CHANNELS; i++) {
+        channelCategoryPerChannelNumberId[i] = NUMBER_CHANNEL_CATEGORIES;
+    }//for//
+
     assert(initMacPtrsPerCategory.size() == NUMBER_CHANNEL_CATEGORIES);
 
     vector<ChannelCategoryAndNumberIdType> availableCategoryAndNumberIds;
@@ -737,7 +1126,11 @@ WaveMac::PhyEntity::PhyEntity(
 
         macPtrs[i] = initMacPtrsPerCategory.at(i);
         macPtrs[i]->SuspendTransmissionFunction();
-        availableChannelNumberIds[i].insert(channelNumberIds.begin(), channelNumberIds.end());
+
+        for(size_t j = 0; j < channelNumberIds.size(); j++) {
+            availableChannelNumberBitMasks[i] |= ConvertToChannelNumberBit(channelNumberIds[j]);
+            channelCategoryPerChannelNumberId[channelNumberIds[j]] = i;
+        }//for//
 
         const size_t numberLastAssignedChannels = assignedChannelNumberIds.size();
 
@@ -748,9 +1141,24 @@ WaveMac::PhyEntity::PhyEntity(
             exit(1);
         }//if//
 
+        if (waveMac.channelIntervalStatsAreEnabled) {
+            static const char* intervalStatNames[NUMBER_INTERVAL_STATS] =
+                {"_TxRxBusyDuration", "_TxRxIdleDuration", "_SuspendedDuration", "_SwitchingDuration"};
+
+            for(size_t j = 0; j < channelNumberIds.size(); j++) {
+                for(int statType = 0; statType < NUMBER_INTERVAL_STATS; statType++) {
+                    intervalDurationStatPtrs[channelNumberIds[j]][statType] =
+                        waveMac.simEngineInterfacePtr->CreateRealStat(
+                            modelName + '_' + phyDeviceName + "_Ch" +
+                            ConvertChannelNumberIdToString(channelNumberIds[j]) + intervalStatNames[statType]);
+                }//for//
+            }//for//
+        }//if//
+
         channelNumberPerCategory[i] = channelNumberIds.front();
         availableCategoryAndNumberIds.push_back(make_pair(i, channelNumberIds.front()));
         alternatingChannelCategories.push_back(i);
+        alternatingChannelCategoryBitMask |= ConvertToChannelCategoryBit(i);
     }//for//
 
     assert(!assignedChannelNumberIds.empty());
@@ -782,15 +1190,54 @@ WaveMac::PhyEntity::PhyEntity(
 
 #pragma warning(default:4355)
 
+inline
+WaveMac::PhyEntity::~PhyEntity()
+{
+    (*this).CancelIntervalClockTimerEvent();
+}//~PhyEntity//
+
+inline
+void WaveMac::PhyEntity::OutputEndOfRunIntervalStats()
+{
+    // Flush the phase open at the end of the run (once).
+
+    (*this).RecordCurrentIntervalPhase();
+
+    currentIntervalPhase = NUMBER_INTERVAL_PHASES;
+}//OutputEndOfRunIntervalStats//
+
+inline
+void WaveMac::PhyEntity::CancelIntervalClockTimerEvent()
+{
+    if (intervalClockTimerEventTime != INFINITE_TIME) {
+        waveMac.intervalClockPtr->Unsubscribe(this, intervalClockTimerEventTime);
+        intervalClockTimerEventTime = INFINITE_TIME;
+    }//if//
+}//CancelIntervalClockTimerEvent//
+
+inline
+void WaveMac::PhyEntity::ExecuteIntervalClockTimerEvent(const SimTime time)
+{
+    if (intervalClockTimerEventTime != time) {
+        return;
+    }//if//
+
+    intervalClockTimerEventTime = INFINITE_TIME;
+
+    timerEventPtr->ExecuteEvent();
+}//ExecuteIntervalClockTimerEvent//
+
 inline
 void WaveMac::PhyEntity::SetContinuousAccess(
     const ChannelNumberIndexType& channelNumberId)
 {
     numberExtendedSchAccessSlots = 0;
 
+    const ChannelCategoryType channelCategory = (*this).GetChannelCategory(channelNumberId);
+
     alternatingChannelCategories.clear();
-    alternatingChannelCategories.push_back(
-        (*this).GetChannelCategory(channelNumberId));
+    alternatingChannelCategories.push_back(channelCategory);
+    alternatingChannelCategoryBitMask = ConvertToChannelCategoryBit(channelCategory);
 
     (*this).SwitchToChannelIfNecessary(channelNumberId);
 }//SetContinuousAccess//
@@ -819,7 +1266,7 @@ void WaveMac::PhyEntity::SetAlternatingAccess(
     for(size_t i = 0; i < channelCategories.size(); i++) {
         const ChannelCategoryType& channelCategory = channelCategories[i];
 
-        assert(!availableChannelNumberIds[channelCategory].empty());
+        assert(availableChannelNumberBitMasks[channelCategory] != 0);
 
         categoryAndNumberIds.push_back(
             make_pair(channelCategory,
@@ -839,8 +1286,7 @@ void WaveMac::PhyEntity::SetAlternatingAccess(
         const ChannelCategoryType channelCategory = categoryAndNumberId.first;
         const ChannelNumberIndexType channelNumberId = categoryAndNumberId.second;
 
-        assert(availableChannelNumberIds[channelCategory].find(channelNumberId) !=
-               availableChannelNumberIds[channelCategory].end());
+        assert((*this).ChannelIsAvailableFor(channelCategory, channelNumberId));
 
         assert(specifiedChannelCategories.find(channelCategory) == specifiedChannelCategories.end() &&
                "Duplicated channel accesses are specified for a channel category in alternaing access.");
@@ -852,6 +1298,11 @@ void WaveMac::PhyEntity::SetAlternatingAccess(
 
     alternatingChannelCategories.assign(specifiedChannelCategories.begin(), specifiedChannelCategories.end());
 
+    alternatingChannelCategoryBitMask = 0;
+    for(size_t i = 0; i < alternatingChannelCategories.size(); i++) {
+        alternatingChannelCategoryBitMask |= ConvertToChannelCategoryBit(alternatingChannelCategories[i]);
+    }//for//
+
     // The change is applicable at the begining of next interval.
     (*this).ResumeTxRxOperationAndScheduleEndEventIfNecessary();
 }//SetAlternatingAccess//
@@ -865,8 +1316,7 @@ void WaveMac::PhyEntity::SetImmediateSchAccess(
 
     assert((*this).CurrentAlternatingChannelAccessSupports(CHANNEL_CATEGORY_SCH));
 
-    assert(availableChannelNumberIds[CHANNEL_CATEGORY_SCH].find(schChannelNumberId) !=
-           availableChannelNumberIds[CHANNEL_CATEGORY_SCH].end() &&
+    assert((*this).ChannelIsAvailableFor(CHANNEL_CATEGORY_SCH, schChannelNumberId) &&
            "Specified channel number is not SCH or the phy doesn't support this channel.");
 
     channelNumberPerCategory[CHANNEL_CATEGORY_SCH] = schChannelNumberId;
@@ -879,8 +1329,7 @@ void WaveMac::PhyEntity::SetExtendedSchAccess(
     const ChannelNumberIndexType& schChannelNumberId,
     const size_t initNumberExtendedAccessSlots)
 {
-    assert(availableChannelNumberIds[CHANNEL_CATEGORY_SCH].find(schChannelNumberId) !=
-           availableChannelNumberIds[CHANNEL_CATEGORY_SCH].end() &&
+    assert((*this).ChannelIsAvailableFor(CHANNEL_CATEGORY_SCH, schChannelNumberId) &&
            "Specified channel number is not SCH or the phy doesn't support this channel.");
 
     numberExtendedSchAccessSlots = initNumberExtendedAccessSlots;
@@ -906,17 +1355,25 @@ bool WaveMac::PhyEntity::CurrentChannelOrNextSwitchingChannelIs(
 }//CurrentChannelOrNextSwitchingChannelIs//
 
 inline
-SimTime WaveMac::PhyEntity::CalculateCurrentTxRxOperationEndTime() const
+SimTime WaveMac::PhyEntity::CalculateSyncInterval() const
 {
-    assert(alternatingChannelCategories.size() >= 1);
-
-    const SimTime currentTime = waveMac.simEngineInterfacePtr->CurrentTime();
     SimTime syncInterval = ZERO_TIME;
 
     for(size_t i = 0; i < alternatingChannelCategories.size(); i++) {
         syncInterval += waveMac.channelIntervals[alternatingChannelCategories[i]];
     }//for//
 
+    return syncInterval;
+}//CalculateSyncInterval//
+
+inline
+SimTime WaveMac::PhyEntity::CalculateCurrentTxRxOperationEndTime() const
+{
+    assert(alternatingChannelCategories.size() >= 1);
+
+    const SimTime currentTime = waveMac.simEngineInterfacePtr->CurrentTime();
+    const SimTime syncInterval = (*this).CalculateSyncInterval();
+
     SimTime timeFromStart = (currentTime % syncInterval);
     ChannelCategoryType channelCategory = NUMBER_CHANNEL_CATEGORIES;
     SimTime operationEndTime = currentTime;
@@ -963,11 +1420,7 @@ ChannelCategoryType WaveMac::PhyEntity::CalculateNonExtendedChannelCategoryAt(co
         }//if//
     }//if//
 
-    SimTime syncInterval = ZERO_TIME;
-
-    for(size_t i = 0; i < alternatingChannelCategories.size(); i++) {
-        syncInterval += waveMac.channelIntervals[alternatingChannelCategories[i]];
-    }//for//
+    const SimTime syncInterval = (*this).CalculateSyncInterval();
 
     SimTime timeFromStart = (time % syncInterval);
 
@@ -985,10 +1438,52 @@ ChannelCategoryType WaveMac::PhyEntity::CalculateNonExtendedChannelCategoryAt(co
     return CHANNEL_CATEGORY_CCH;
 }//CalculateNonExtendedChannelCategoryAt//
 
+inline
+bool WaveMac::PhyEntity::SchAccessShouldBeAutomaticallyExtended() const
+{
+    if ((currentCategory != CHANNEL_CATEGORY_SCH) ||
+        (alternatingChannelCategories.size() < 2) ||
+        (numberAutoExtendedSchAccessSlots >= waveMac.maxAutoExtendedSchAccessSlots)) {
+        return false;
+    }//if//
+
+    // Only this node's own CCH queue is visible here; CCH messages of other
+    // nodes in a skipped CCH interval are not received.
+
+    if ((!waveMac.autoExtendedSchAccessMaySkipCchInterval) &&
+        ((*this).CalculateNonExtendedChannelCategoryAt(
+            waveMac.simEngineInterfacePtr->CurrentTime()) == CHANNEL_CATEGORY_CCH)) {
+        return false;
+    }//if//
+
+    // Never hold back pending CCH (safety) traffic.
+
+    if ((macPtrs[CHANNEL_CATEGORY_CCH] != nullptr) &&
+        (macPtrs[CHANNEL_CATEGORY_CCH]->HasQueuedPacketsToSend())) {
+        return false;
+    }//if//
+
+    return (macPtrs[CHANNEL_CATEGORY_SCH]->HasQueuedPacketsToSend());
+}//SchAccessShouldBeAutomaticallyExtended//
+
 inline
 void WaveMac::PhyEntity::SwitchToCurrentIntervalChannel()
 {
     const SimTime currentTime = waveMac.simEngineInterfacePtr->CurrentTime();
+
+    if ((*this).SchAccessShouldBeAutomaticallyExtended()) {
+        const SimTime txRxOperationEndTime = currentTime + (*this).CalculateSyncInterval();
+
+        numberAutoExtendedSchAccessSlots++;
+
+        (*this).EnterIntervalPhase(INTERVAL_PHASE_TX_RX, channelNumberPerCategory[currentCategory]);
+
+        (*this).RescheduleTimerEvent(EVENT_TX_RX_END, txRxOperationEndTime);
+        macPtrs[currentCategory]->ResumeTransmissionFunction(txRxOperationEndTime);
+        return;
+    }//if//
+
+    numberAutoExtendedSchAccessSlots = 0;
     const ChannelCategoryType channdlCategory =
         (*this).CalculateNonExtendedChannelCategoryAt(currentTime);
 
@@ -1036,17 +1531,80 @@ void WaveMac::PhyEntity::TimerEvent::ExecuteEvent()
     }//switch//
 }//ExecuteEvent//
 
+inline
+void WaveMac::PhyEntity::RecordCurrentIntervalPhase()
+{
+    if ((currentIntervalPhase == NUMBER_INTERVAL_PHASES) ||
+        (intervalDurationStatPtrs[currentIntervalPhaseChannelNumberId][INTERVAL_STAT_TX_RX_BUSY] == nullptr)) {
+        return;
+    }//if//
+
+    shared_ptr<RealStatistic>* statPtrs = intervalDurationStatPtrs[currentIntervalPhaseChannelNumberId];
+
+    const SimTime phaseDuration =
+        (waveMac.simEngineInterfacePtr->CurrentTime() - currentIntervalPhaseStartTime);
+
+    switch(currentIntervalPhase) {
+    case INTERVAL_PHASE_TX_RX: {
+        const shared_ptr<Dot11Mac>& macPtr =
+            macPtrs[(*this).GetChannelCategory(currentIntervalPhaseChannelNumberId)];
+
+        const SimTime busyDuration =
+            std::min(
+                phaseDuration,
+                (macPtr->GetAccumulatedPhysicalChannelBusyDuration() - currentIntervalPhaseStartBusyDuration));
+
+        statPtrs[INTERVAL_STAT_TX_RX_BUSY]->RecordStatValue(ConvertTimeToDoubleSecs(busyDuration));
+        statPtrs[INTERVAL_STAT_TX_RX_IDLE]->RecordStatValue(ConvertTimeToDoubleSecs(phaseDuration - busyDuration));
+        break;
+    }
+    case INTERVAL_PHASE_SUSPENDED:
+        statPtrs[INTERVAL_STAT_SUSPENDED]->RecordStatValue(ConvertTimeToDoubleSecs(phaseDuration));
+        break;
+
+    case INTERVAL_PHASE_SWITCHING:
+        statPtrs[INTERVAL_STAT_SWITCHING]->RecordStatValue(ConvertTimeToDoubleSecs(phaseDuration));
+        break;
+
+    default:
+        assert(false);
+        break;
+    }//switch//
+}//RecordCurrentIntervalPhase//
+
+inline
+void WaveMac::PhyEntity::EnterIntervalPhase(
+    const IntervalPhaseType& intervalPhase,
+    const ChannelNumberIndexType& channelNumberId)
+{
+    // A sample is recorded at every interval boundary, also when the phase
+    // and channel stay the same (e.g. extended or auto-extended SCH access).
+
+    (*this).RecordCurrentIntervalPhase();
+
+    currentIntervalPhase = intervalPhase;
+    currentIntervalPhaseChannelNumberId = channelNumberId;
+    currentIntervalPhaseStartTime = waveMac.simEngineInterfacePtr->CurrentTime();
+
+    if ((intervalPhase == INTERVAL_PHASE_TX_RX) &&
+        (intervalDurationStatPtrs[channelNumberId][INTERVAL_STAT_TX_RX_BUSY] != nullptr)) {
+
+        currentIntervalPhaseStartBusyDuration =
+            macPtrs[(*this).GetChannelCategory(channelNumberId)]->GetAccumulatedPhysicalChannelBusyDuration();
+    }//if//
+}//EnterIntervalPhase//
+
 inline
 void WaveMac::PhyEntity::ResumeTxRxOperationAndScheduleEndEventIfNecessary()
 {
     const shared_ptr<Dot11Mac> macPtr = macPtrs[currentCategory];
 
+    (*this).EnterIntervalPhase(INTERVAL_PHASE_TX_RX, channelNumberPerCategory[currentCategory]);
+
     if (alternatingChannelCategories.size() == 1 &&
         numberExtendedSchAccessSlots == 0) {
 
-        if (!timerEventTicket.IsNull()) {
-            waveMac.simEngineInterfacePtr->CancelEvent(timerEventTicket);
-        }//if//
+        (*this).CancelTimerEvent();
         
         //バックオフ実行
         macPtr->ResumeTransmissionFunction(INFINITE_TIME);
@@ -1118,6 +1676,8 @@ void WaveMac::PhyEntity::SuspendTransmissionAndRescheduleChannelSwitchingEvent(
 
         macPtr->SuspendTransmissionFunction();
 
+        (*this).EnterIntervalPhase(INTERVAL_PHASE_SUSPENDED, prevChannelNumberId);
+
         assert(prevChannelNumberId != channelNumberId &&
                "No need to swtich channel!");
 
@@ -1139,6 +1699,16 @@ void WaveMac::PhyEntity::StartChannelSwitchngTime()
 
     (*this).OutputTraceAndStatsForChannelChange(channelNumberPerCategory[currentCategory]);
 
+    (*this).EnterIntervalPhase(INTERVAL_PHASE_SWITCHING, channelNumberPerCategory[currentCategory]);
+
+    // Busy/clear notifications of the previous channel are lost after the switch.
+
+    for(ChannelCategoryType i = 0; i < NUMBER_CHANNEL_CATEGORIES; i++) {
+        if (macPtrs[i] != nullptr) {
+            macPtrs[i]->EndPhysicalChannelBusyPeriod();
+        }//if//
+    }//for//
+
     // receive only
     phyPtr->SetMacInterfaceForPhy(macPtr->CreateInterfaceForPhy());
     phyPtr->SwitchToChannelNumber(channelNumberPerCategory[currentCategory]);
@@ -1150,12 +1720,44 @@ void WaveMac::PhyEntity::StartChannelSwitchngTime()
         currentTime + waveMac.maxChannelSwitchingTime + waveMac.syncTolerance/2);
 }//StartChannelSwitchngTime//
 
+inline
+void WaveMac::PhyEntity::CancelTimerEvent()
+{
+    if (!timerEventTicket.IsNull()) {
+        waveMac.simEngineInterfacePtr->CancelEvent(timerEventTicket);
+    }//if//
+
+    (*this).CancelIntervalClockTimerEvent();
+}//CancelTimerEvent//
+
 inline
 void WaveMac::PhyEntity::RescheduleTimerEvent(
     const EventType& event, const SimTime time)
 {
     timerEventPtr->SetNextEventType(event);
 
+    // Interval boundary, channel switch and tx/rx start instants are common to
+    // all nodes; transmission suspension waits on this node's own transmission.
+
+    if ((waveMac.intervalClockPtr != nullptr) &&
+        (event != EVENT_SUSPEND_TRANSMISSION)) {
+
+        if (!timerEventTicket.IsNull()) {
+            waveMac.simEngineInterfacePtr->CancelEvent(timerEventTicket);
+        }//if//
+
+        if (intervalClockTimerEventTime != time) {
+            (*this).CancelIntervalClockTimerEvent();
+
+            intervalClockTimerEventTime = time;
+            waveMac.intervalClockPtr->Subscribe(this, time);
+        }//if//
+
+        return;
+    }//if//
+
+    (*this).CancelIntervalClockTimerEvent();
+
     //最初は1と2が交互に、あとは１のみ
     if (timerEventTicket.IsNull()) {
         //std::cout << "1" << endl;
@@ -1171,18 +1773,9 @@ void WaveMac::PhyEntity::RescheduleTimerEvent(
 inline
 ChannelCategoryType WaveMac::PhyEntity::GetChannelCategory(const ChannelNumberIndexType& channelNumberId) const
 {
-    ChannelCategoryType channelCategory;
-
-    for(channelCategory = CHANNEL_CATEGORY_CCH;
-        channelCategory < NUMBER_CHANNEL_CATEGORIES;
-        channelCategory++) {
-
-        const set<ChannelNumberIndexType>& channelNumberIds = availableChannelNumberIds[channelCategory];
-
-        if (channelNumberIds.find(channelNumberId) != channelNumberIds.end()) {
-            break;
-        }//if//
-    }//for//
+    const ChannelCategoryType channelCategory =
+        ((channelNumberId < NUMBER_CHANNELS) ?
+         channelCategoryPerChannelNumberId[channelNumberId] : ChannelCategoryType(NUMBER_CHANNEL_CATEGORIES));
 
     if (channelCategory >= NUMBER_CHANNEL_CATEGORIES) {
         cerr << "Error: " << waveMac.simEngineInterfacePtr->GetNodeId() << ":"
@@ -1196,13 +1789,7 @@ ChannelCategoryType WaveMac::PhyEntity::GetChannelCategory(const ChannelNumberIn
 inline
 bool WaveMac::PhyEntity::CurrentAlternatingChannelAccessSupports(const ChannelCategoryType& channelCategory) const
 {
-    for(size_t i = 0; i < alternatingChannelCategories.size(); i++) {
-        if (alternatingChannelCategories[i] == channelCategory) {
-            return true;
-        }//if//
-    }//for//
-
-    return false;
+    return ((alternatingChannelCategoryBitMask & ConvertToChannelCategoryBit(channelCategory)) != 0);
 }//CurrentAlternatingChannelAccessSupports//
 
 inline
@@ -1210,7 +1797,8 @@ void WaveMac::PhyEntity::OutputTraceAndStatsForNewChannelInterval(
     const ChannelNumberIndexType& prevChannelNumberId,
     const ChannelNumberIndexType& nextChannelNumberId) const
 {
-    if (waveMac.simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((waveMac.simEngineInterfacePtr->TraceIsOn(TraceMac)) &&
+        (waveMac.macTraceFilter.IsOn(waveMac.simEngineInterfacePtr->CurrentTime()))) {
         if (waveMac.simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             WaveNewChIntervalTraceRecord traceData;
@@ -1250,7 +1838,8 @@ inline
 void WaveMac::PhyEntity::OutputTraceAndStatsForChannelChange(
     const ChannelNumberIndexType& channelNumberId) const
 {
-    if (waveMac.simEngineInterfacePtr->TraceIsOn(TraceMac)) {
+    if ((waveMac.simEngineInterfacePtr->TraceIsOn(TraceMac)) &&
+        (waveMac.macTraceFilter.IsOn(waveMac.simEngineInterfacePtr->CurrentTime()))) {
         if (waveMac.simEngineInterfacePtr->BinaryOutputIsOn()) {
 
             WavePhyChSwitchTraceRecord traceData;
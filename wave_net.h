@@ -165,6 +165,24 @@ public:
     DatarateBitsPerSec GetDatarateBps(const ChannelNumberIndexType& channelNumberId);
     double GetTxPowerDbm(const ChannelNumberIndexType& channelNumberId);
 
+    unsigned int GetNumberAccessCategories(const ChannelNumberIndexType& channelNumberId) const
+    {
+        return waveMacPtr->GetNumberAccessCategories(channelNumberId);
+    }
+
+    unsigned int GetCurrentContentionWindowSlots(
+        const ChannelNumberIndexType& channelNumberId,
+        const size_t accessCategoryIndex) const
+    {
+        return waveMacPtr->GetCurrentContentionWindowSlots(channelNumberId, accessCategoryIndex);
+    }
+
+    shared_ptr<Dot11::ChannelBusyRatioEstimator> GetChannelBusyRatioEstimator(
+        const ChannelNumberIndexType& channelNumberId) const
+    {
+        return waveMacPtr->GetChannelBusyRatioEstimator(channelNumberId);
+    }
+
 private:
     shared_ptr<SimulationEngineInterface> simEngineInterfacePtr;
     shared_ptr<ObjectMobilityModel> mobilityModelPtr;
@@ -172,7 +190,14 @@ private:
     shared_ptr<NetworkLayer> networkLayerPtr;
     shared_ptr<WaveMac> waveMacPtr;
 
-    map<string, shared_ptr<WsmApplicationHandler> > wsmApplicationHandlerPtrs;
+    // Provider service ids in integer form (1-4 octets, big endian) and handlers.
+    // Only a few services are registered, so a linear scan of a flat table is used.
+
+    typedef pair<uint32_t, shared_ptr<WsmApplicationHandler> > WsmApplicationHandlerEntryType;
+
+    vector<WsmApplicationHandlerEntryType> wsmApplicationHandlerTable;
+
+    WsmApplicationHandler* FindWsmApplicationHandler(const uint32_t providerServiceIdValue) const;
 
     struct ServiceInfo {
         string providerServiceId;
@@ -192,6 +217,9 @@ private:
         uint8_t wsaCountThreshold;
         uint8_t wsaCountThresholdInterval;
 
+        // Encoded service info element (empty: needs encoding).
+        vector<unsigned char> encodedBytes;
+
         ServiceInfo()
             :
             servicePriority(0),
@@ -207,6 +235,27 @@ private:
         {}
 
         bool IsEnabled() const { return !providerServiceId.empty(); }
+
+        // Same as assigning ServiceInfo() but keeps the string and
+        // encoded byte buffers allocated for the next parse.
+
+        void ResetKeepingBuffers()
+        {
+            providerServiceId.clear();
+            servicePriority = 0;
+            channelNumberId = CHANNEL_NUMBER_172;
+            numberTransmissionsPer5sec = 0;
+            earliestNextTransmissionTime = ZERO_TIME;
+            enabledWaveElementExtensionBitSet = 0;
+            providerServiceContext.clear();
+            ipv6Address = NetworkAddress();
+            portNumber = 0;
+            providerMacAddress = 0;
+            rcpiThreshold = 0;
+            wsaCountThreshold = 0;
+            wsaCountThresholdInterval = 0;
+            encodedBytes.clear();
+        }
     };//ServiceInfo//
 
     struct ChannelInfo {
@@ -273,6 +322,17 @@ private:
     int wsaChangeCount;
     ChannelNumberIndexType wsaChannelNumberId;
 
+    static const int maxWsaSizeBytes = 2312;
+
+    // Channel info and routing advertisement elements only change with
+    // configuration, so they are encoded once and copied into each WSA.
+
+    vector<unsigned char> encodedWsaChannelAndRoutingBytes;
+    bool encodedWsaChannelAndRoutingBytesAreValid;
+
+    void EncodeWsaServiceInfo(ServiceInfo& serviceInfo);
+    void EncodeWsaChannelAndRoutingInfo();
+
     struct WsaReceptionInfo {
         uint8_t waveVersionAndChangeCount;
 
@@ -300,6 +360,15 @@ private:
 
     WsaReceptionInfo currentWsaReceptionInfo;
 
+    // Element bytes of the last parsed WSA. The parsed elements (service,
+    // channel and routing info) are shared by all providers, so only a
+    // repeated WSA of the same provider skips parsing. Invalidated whenever
+    // serviceInfos is changed outside of ReceiveWsa.
+
+    bool lastParsedWsaElementsAreValid;
+    GenericMacAddress lastParsedWsaProviderMacAddress;
+    vector<unsigned char> lastParsedWsaElementBytes;
+
     class PeriodicWsaTransmissionEvent : public SimulationEvent {
     public:
         PeriodicWsaTransmissionEvent(WsmpLayer* initWsmpLayer) : wsmpLayer(initWsmpLayer) {}
@@ -512,6 +581,17 @@ void WriteStringField(
     currentWriteBytes += aString.length();
 }//WriteStringField//
 
+static inline
+void WriteEncodedBytes(
+    const vector<unsigned char>& encodedBytes,
+    size_t& currentWriteBytes,
+    unsigned char buf[])
+{
+    std::copy(encodedBytes.begin(), encodedBytes.end(), &buf[currentWriteBytes]);
+
+    currentWriteBytes += encodedBytes.size();
+}//WriteEncodedBytes//
+
 static inline
 void WriteStringExtensionFieldIfNecessary(
     const uint64_t enabledWaveElementExtensionBitSet,
@@ -656,6 +736,42 @@ void ReadBasicField(
     currentReadBytes += valueSize;
 }//ReadBasicField//
 
+static inline
+uint32_t ConvertToProviderServiceIdValue(const string& providerServiceId)
+{
+    assert(ProviderServiceIdIsCorrectFormat(providerServiceId));
+
+    uint32_t providerServiceIdValue = 0;
+
+    for(size_t i = 0; i < providerServiceId.length(); i++) {
+        providerServiceIdValue = ((providerServiceIdValue << 8) | uint8_t(providerServiceId[i]));
+    }//for//
+
+    return providerServiceIdValue;
+}//ConvertToProviderServiceIdValue//
+
+static inline
+void ReadProviderServiceIdValue(
+    const unsigned char buf[],
+    uint32_t& providerServiceIdValue,
+    size_t& currentReadBytes)
+{
+    const unsigned char firstOctet = buf[currentReadBytes];
+
+    int serviceIdLength = 1;
+    while ((serviceIdLength < 4) && (firstOctet & (1 << (8 - (serviceIdLength))))) {
+        serviceIdLength++;
+    }//while//
+
+    providerServiceIdValue = 0;
+
+    for(int i = 0; i < serviceIdLength; i++) {
+        providerServiceIdValue = ((providerServiceIdValue << 8) | buf[currentReadBytes+i]);
+    }//for//
+
+    currentReadBytes += serviceIdLength;
+}//ReadProviderServiceIdValue//
+
 static inline
 void ReadProviderServiceId(
     const unsigned char buf[],
@@ -937,6 +1053,38 @@ SimTime ConvertToTranssmisionInterval(const int numberTransmissionsPer5sec)
     return static_cast<SimTime>((5*SECOND) / numberTransmissionsPer5sec);
 }//ConvertToTranssmisionInterval//
 
+// Per channel "its-wsmp-ch<N>-*" parameter names are built once and shared by all nodes.
+
+struct WsmpChannelParameterNames {
+    string defaultDatarateBitsPerSecond;
+    string defaultTxPower;
+};
+
+static inline
+vector<WsmpChannelParameterNames> MakeWsmpChannelParameterNames()
+{
+    vector<WsmpChannelParameterNames> parameterNames(NUMBER_CHANNELS);
+
+    for(size_t i = 0; i < parameterNames.size(); i++) {
+        const string channelNumberString = ConvertChannelNumberIdToString(ChannelNumberIndexType(i));
+
+        parameterNames[i].defaultDatarateBitsPerSecond =
+            "its-wsmp-ch" + channelNumberString + "-default-datarate-bits-per-second";
+        parameterNames[i].defaultTxPower =
+            "its-wsmp-ch" + channelNumberString + "-default-tx-power";
+    }//for//
+
+    return parameterNames;
+}//MakeWsmpChannelParameterNames//
+
+static inline
+const WsmpChannelParameterNames& GetWsmpChannelParameterNames(const ChannelNumberIndexType& channelNumberId)
+{
+    static const vector<WsmpChannelParameterNames> parameterNames = MakeWsmpChannelParameterNames();
+
+    return parameterNames.at(channelNumberId);
+}//GetWsmpChannelParameterNames//
+
 //--------------------------------------------------------------------------
 
 #pragma warning(disable:4355)
@@ -964,6 +1112,9 @@ WsmpLayer::WsmpLayer(
     enabledWsaHeaderExtensionBitSet(0),
     wsaChangeCount(0),
     wsaChannelNumberId(CHANNEL_NUMBER_178),
+    encodedWsaChannelAndRoutingBytesAreValid(false),
+    lastParsedWsaElementsAreValid(false),
+    lastParsedWsaProviderMacAddress(0),
     wsaTransmissionTimerPtr(
         new PeriodicWsaTransmissionEvent(this)),
     bytesSentStatPtr(
@@ -999,45 +1150,64 @@ WsmpLayer::WsmpLayer(
                     "its-wsmp-wsa-packet-channel-number", initNodeId, initInterfaceId));
     }//if//
 
+    // "its-wsmp-default-*" fallbacks are looked up at most once (not once per channel).
+
+    bool defaultDatarateWasRead = false;
+    long long int defaultDatarateBitsPerSec = 0;
+    bool defaultTxPowerWasRead = false;
+    double defaultTxPowerDbm = 0.0;
+
     for(size_t i = 0; i < channelInfos.size(); i++) {
         ChannelInfo& channelInfo = channelInfos[i];
-        const string channelNumberString = ConvertChannelNumberIdToString(ChannelNumberIndexType(i));
+        const WsmpChannelParameterNames& parameterNames =
+            GetWsmpChannelParameterNames(ChannelNumberIndexType(i));
 
         if (theParameterDatabaseReader.ParameterExists(
-                "its-wsmp-ch" + channelNumberString + "-default-datarate-bits-per-second", initNodeId, initInterfaceId)) {
+                parameterNames.defaultDatarateBitsPerSecond, initNodeId, initInterfaceId)) {
 
             channelInfo.datarate500Kbps = static_cast<uint8_t>(
                 theParameterDatabaseReader.ReadBigInt(
-                    "its-wsmp-ch" + channelNumberString + "-default-datarate-bits-per-second", initNodeId, initInterfaceId) / 500000);
+                    parameterNames.defaultDatarateBitsPerSecond, initNodeId, initInterfaceId) / 500000);
         } else {
-            channelInfo.datarate500Kbps = static_cast<uint8_t>(
-                theParameterDatabaseReader.ReadBigInt(
-                    "its-wsmp-default-datarate-bits-per-second", initNodeId, initInterfaceId) / 500000);
+            if (!defaultDatarateWasRead) {
+                defaultDatarateBitsPerSec =
+                    theParameterDatabaseReader.ReadBigInt(
+                        "its-wsmp-default-datarate-bits-per-second", initNodeId, initInterfaceId);
+                defaultDatarateWasRead = true;
+            }//if//
+
+            channelInfo.datarate500Kbps = static_cast<uint8_t>(defaultDatarateBitsPerSec / 500000);
         }//if//
 
         double txPowerDbm;
 
         if (theParameterDatabaseReader.ParameterExists(
-                "its-wsmp-ch" + channelNumberString + "-default-tx-power", initNodeId, initInterfaceId)) {
+                parameterNames.defaultTxPower, initNodeId, initInterfaceId)) {
 
             txPowerDbm =
                 theParameterDatabaseReader.ReadDouble(
-                    "its-wsmp-ch" + channelNumberString + "-default-tx-power", initNodeId, initInterfaceId);
+                    parameterNames.defaultTxPower, initNodeId, initInterfaceId);
 
             if (txPowerDbm < -127. || 127. < txPowerDbm) {
-                cerr << "Set: its-wsmp-ch" << channelNumberString << "-default-tx-power range is -127 to 127" << endl;
+                cerr << "Set: " << parameterNames.defaultTxPower << " range is -127 to 127" << endl;
                 exit(1);
             }
 
         } else {
-            txPowerDbm =
-                theParameterDatabaseReader.ReadDouble(
-                    "its-wsmp-default-tx-power", initNodeId, initInterfaceId);
+            if (!defaultTxPowerWasRead) {
+                defaultTxPowerDbm =
+                    theParameterDatabaseReader.ReadDouble(
+                        "its-wsmp-default-tx-power", initNodeId, initInterfaceId);
 
-            if (txPowerDbm < -127. || 127. < txPowerDbm) {
-                cerr << "Set: its-wsmp-default-tx-power range is -127 to 127" << endl;
-                exit(1);
-            }
+                if (defaultTxPowerDbm < -127. || 127. < defaultTxPowerDbm) {
+                    cerr << "Set: its-wsmp-default-tx-power range is -127 to 127" << endl;
+                    exit(1);
+                }
+
+                defaultTxPowerWasRead = true;
+            }//if//
+
+            txPowerDbm = defaultTxPowerDbm;
 
         }//if//
 
@@ -1092,7 +1262,13 @@ void WsmpLayer::AddOrUpdateWsaServiceInfo(
     serviceInfo.wsaCountThreshold = wsaCountThreshold;
     serviceInfo.wsaCountThresholdInterval = wsaCountThresholdInterval;
 
-    channelInfos.at(channelNumberId).channelAccess = channelAccess;
+    serviceInfo.encodedBytes.clear();
+    lastParsedWsaElementsAreValid = false;
+
+    if (channelInfos.at(channelNumberId).channelAccess != channelAccess) {
+        channelInfos.at(channelNumberId).channelAccess = channelAccess;
+        encodedWsaChannelAndRoutingBytesAreValid = false;
+    }//if//
 
     (*this).UpdateWsaMaxTransmissionInterval();
     (*this).PeriodicallyTransmitWsa();
@@ -1103,6 +1279,8 @@ void WsmpLayer::DeleteWsaServiceInfo(const int localServiceId)
 {
     assert(localServiceId < int(serviceInfos.size()));
     serviceInfos[localServiceId].providerServiceId.clear();
+    serviceInfos[localServiceId].encodedBytes.clear();
+    lastParsedWsaElementsAreValid = false;
 
     (*this).UpdateWsaMaxTransmissionInterval();
     (*this).RescheduleNextWsaTransmission();
@@ -1186,7 +1364,6 @@ void WsmpLayer::PeriodicallyTransmitWsa()
     ObjectMobilityPosition position;
     mobilityModelPtr->GetPositionForTime(currentTime, position);
 
-    static const int maxWsaSizeBytes = 2312;
     static const uint8_t wsmpHeaderVersion = (1 << 2);
 
     unsigned char wsaBuf[maxWsaSizeBytes];
@@ -1238,71 +1415,118 @@ void WsmpLayer::PeriodicallyTransmitWsa()
             continue;
         }//if//
 
-        WriteBasicField(uint8_t(WSA_SERVICE_INFO), currentWriteBytes, wsaBuf);
-        WriteProviderServiceId(serviceInfo.providerServiceId, currentWriteBytes, wsaBuf);
-        WriteBasicField(uint8_t(serviceInfo.servicePriority), currentWriteBytes, wsaBuf);
-        WriteBasicField(uint8_t(serviceInfo.channelNumberId), currentWriteBytes, wsaBuf);
+        if (serviceInfo.encodedBytes.empty()) {
+            (*this).EncodeWsaServiceInfo(serviceInfo);
+        }//if//
 
-        WriteStringExtensionFieldIfNecessary(
-            serviceInfo.enabledWaveElementExtensionBitSet,
-            EXTENSION_PROVIDER_SERVICE_CONTEXT, serviceInfo.providerServiceContext,
-            currentWriteBytes, wsaBuf);
+        WriteEncodedBytes(serviceInfo.encodedBytes, currentWriteBytes, wsaBuf);
 
-        WriteIpv6AddressExtensionFieldIfNecessary(
-            serviceInfo.enabledWaveElementExtensionBitSet,
-            EXTENSION_IPV6_ADDRESS, serviceInfo.ipv6Address,
-            currentWriteBytes, wsaBuf);
+        serviceInfo.earliestNextTransmissionTime =
+            currentTime + ConvertToTranssmisionInterval(serviceInfo.numberTransmissionsPer5sec);
 
-        WriteBasicExtensionFieldIfNecessary(
-            serviceInfo.enabledWaveElementExtensionBitSet,
-            EXTENSION_SERVICE_PORT, uint16_t(serviceInfo.portNumber),
-            currentWriteBytes, wsaBuf);
+        // A repeated WSA must be parsed again to reset the transmission time.
+        lastParsedWsaElementsAreValid = false;
+    }//for//
 
-        WriteMacAddressExtensionFieldIfNecessary(
-            serviceInfo.enabledWaveElementExtensionBitSet,
-            EXTENSION_PROVIDER_MAC_ADDRESS, serviceInfo.providerMacAddress,
-            currentWriteBytes, wsaBuf);
+    // channel information and WAVE Routing Advertisement
 
-        WriteBasicExtensionFieldIfNecessary(
-            serviceInfo.enabledWaveElementExtensionBitSet,
-            EXTENSION_RCPI_THRESHOLD, uint8_t(serviceInfo.rcpiThreshold),
-            currentWriteBytes, wsaBuf);
+    if (!encodedWsaChannelAndRoutingBytesAreValid) {
+        (*this).EncodeWsaChannelAndRoutingInfo();
+    }//if//
 
-        WriteBasicExtensionFieldIfNecessary(
-            serviceInfo.enabledWaveElementExtensionBitSet,
-            EXTENSION_WSA_COUNT_THRESHOLD, uint8_t(serviceInfo.wsaCountThreshold),
-            currentWriteBytes, wsaBuf);
+    assert((currentWriteBytes + encodedWsaChannelAndRoutingBytes.size()) <= size_t(maxWsaSizeBytes));
 
-        WriteBasicExtensionFieldIfNecessary(
-            serviceInfo.enabledWaveElementExtensionBitSet,
-            EXTENSION_WSA_COUNT_THRESHOLD_INTERVAL, uint8_t(serviceInfo.wsaCountThresholdInterval),
-            currentWriteBytes, wsaBuf);
+    WriteEncodedBytes(encodedWsaChannelAndRoutingBytes, currentWriteBytes, wsaBuf);
 
-        serviceInfo.earliestNextTransmissionTime =
-            currentTime + ConvertToTranssmisionInterval(serviceInfo.numberTransmissionsPer5sec);
-    }//for//
+    unique_ptr<Packet> packetPtr = Packet::CreatePacket(*simEngineInterfacePtr, wsaBuf, static_cast<unsigned int>(currentWriteBytes));
+
+    (*this).InsertPacketIntoQueue(
+        packetPtr,
+        NetworkAddress::broadcastAddress,
+        wsaChannelNumberId,
+        wsaPriority,
+        static_cast<DatarateBitsPerSec>(cchInfo.datarate500Kbps) * 500000,
+        static_cast<double>(cchInfo.txPowerDbm));
+
+    (*this).RescheduleNextWsaTransmission();
+}//PeriodicallyTransmitWsa//
+
+inline
+void WsmpLayer::EncodeWsaServiceInfo(ServiceInfo& serviceInfo)
+{
+    unsigned char elementBuf[maxWsaSizeBytes];
+    size_t currentWriteBytes = 0;
+
+    WriteBasicField(uint8_t(WSA_SERVICE_INFO), currentWriteBytes, elementBuf);
+    WriteProviderServiceId(serviceInfo.providerServiceId, currentWriteBytes, elementBuf);
+    WriteBasicField(uint8_t(serviceInfo.servicePriority), currentWriteBytes, elementBuf);
+    WriteBasicField(uint8_t(serviceInfo.channelNumberId), currentWriteBytes, elementBuf);
+
+    WriteStringExtensionFieldIfNecessary(
+        serviceInfo.enabledWaveElementExtensionBitSet,
+        EXTENSION_PROVIDER_SERVICE_CONTEXT, serviceInfo.providerServiceContext,
+        currentWriteBytes, elementBuf);
+
+    WriteIpv6AddressExtensionFieldIfNecessary(
+        serviceInfo.enabledWaveElementExtensionBitSet,
+        EXTENSION_IPV6_ADDRESS, serviceInfo.ipv6Address,
+        currentWriteBytes, elementBuf);
+
+    WriteBasicExtensionFieldIfNecessary(
+        serviceInfo.enabledWaveElementExtensionBitSet,
+        EXTENSION_SERVICE_PORT, uint16_t(serviceInfo.portNumber),
+        currentWriteBytes, elementBuf);
+
+    WriteMacAddressExtensionFieldIfNecessary(
+        serviceInfo.enabledWaveElementExtensionBitSet,
+        EXTENSION_PROVIDER_MAC_ADDRESS, serviceInfo.providerMacAddress,
+        currentWriteBytes, elementBuf);
+
+    WriteBasicExtensionFieldIfNecessary(
+        serviceInfo.enabledWaveElementExtensionBitSet,
+        EXTENSION_RCPI_THRESHOLD, uint8_t(serviceInfo.rcpiThreshold),
+        currentWriteBytes, elementBuf);
+
+    WriteBasicExtensionFieldIfNecessary(
+        serviceInfo.enabledWaveElementExtensionBitSet,
+        EXTENSION_WSA_COUNT_THRESHOLD, uint8_t(serviceInfo.wsaCountThreshold),
+        currentWriteBytes, elementBuf);
+
+    WriteBasicExtensionFieldIfNecessary(
+        serviceInfo.enabledWaveElementExtensionBitSet,
+        EXTENSION_WSA_COUNT_THRESHOLD_INTERVAL, uint8_t(serviceInfo.wsaCountThresholdInterval),
+        currentWriteBytes, elementBuf);
+
+    serviceInfo.encodedBytes.assign(elementBuf, (elementBuf + currentWriteBytes));
+}//EncodeWsaServiceInfo//
+
+inline
+void WsmpLayer::EncodeWsaChannelAndRoutingInfo()
+{
+    unsigned char elementBuf[maxWsaSizeBytes];
+    size_t currentWriteBytes = 0;
 
     // channel information
 
     for(size_t i = 0; i < channelInfos.size(); i++) {
         const ChannelInfo& channelInfo = channelInfos[i];
 
-        WriteBasicField(uint8_t(WSA_CHANNEL_INFO), currentWriteBytes, wsaBuf);
-        WriteBasicField(uint8_t(channelInfo.operatingClass), currentWriteBytes, wsaBuf);
-        WriteBasicField(uint8_t(i), currentWriteBytes, wsaBuf);
-        WriteBasicField(uint8_t(channelInfo.adaptable), currentWriteBytes, wsaBuf);
-        WriteBasicField(uint8_t(channelInfo.datarate500Kbps), currentWriteBytes, wsaBuf);
-        WriteBasicField(uint8_t(channelInfo.txPowerDbm), currentWriteBytes, wsaBuf);
+        WriteBasicField(uint8_t(WSA_CHANNEL_INFO), currentWriteBytes, elementBuf);
+        WriteBasicField(uint8_t(channelInfo.operatingClass), currentWriteBytes, elementBuf);
+        WriteBasicField(uint8_t(i), currentWriteBytes, elementBuf);
+        WriteBasicField(uint8_t(channelInfo.adaptable), currentWriteBytes, elementBuf);
+        WriteBasicField(uint8_t(channelInfo.datarate500Kbps), currentWriteBytes, elementBuf);
+        WriteBasicField(uint8_t(channelInfo.txPowerDbm), currentWriteBytes, elementBuf);
 
         WriteEdcaExtensionFieldIfNecessary(
             channelInfo.enabledWaveElementExtensionBitSet,
             EXTENSION_EDCA_PARAMETERS_SET, channelInfo.edcaParameters,
-            currentWriteBytes, wsaBuf);
+            currentWriteBytes, elementBuf);
 
         WriteBasicExtensionFieldIfNecessary(
             channelInfo.enabledWaveElementExtensionBitSet,
             EXTENSION_CHANNEL_ACCESS, uint8_t(channelInfo.channelAccess),
-            currentWriteBytes, wsaBuf);
+            currentWriteBytes, elementBuf);
     }//for//
 
     // WAVE Routing Advertisement
@@ -1310,36 +1534,27 @@ void WsmpLayer::PeriodicallyTransmitWsa()
     for(size_t i = 0; i < routingAdvertisements.size(); i++) {
         const RoutingAdvertisement& routingAdvertisement = routingAdvertisements[i];
 
-        WriteBasicField(uint8_t(WSA_WRA), currentWriteBytes, wsaBuf);
-        WriteBasicField(uint16_t(routingAdvertisement.lifeTime), currentWriteBytes, wsaBuf);
-        WriteIpv6AddressField(routingAdvertisement.ipv6PrefixNetworkAddress, currentWriteBytes, wsaBuf);
-        WriteBasicField(uint8_t(routingAdvertisement.prefixLength), currentWriteBytes, wsaBuf);
-        WriteIpv6AddressField(routingAdvertisement.defaultGatewayNetworkAddress, currentWriteBytes, wsaBuf);
-        WriteIpv6AddressField(routingAdvertisement.primaryDnsNetworkAddress, currentWriteBytes, wsaBuf);
+        WriteBasicField(uint8_t(WSA_WRA), currentWriteBytes, elementBuf);
+        WriteBasicField(uint16_t(routingAdvertisement.lifeTime), currentWriteBytes, elementBuf);
+        WriteIpv6AddressField(routingAdvertisement.ipv6PrefixNetworkAddress, currentWriteBytes, elementBuf);
+        WriteBasicField(uint8_t(routingAdvertisement.prefixLength), currentWriteBytes, elementBuf);
+        WriteIpv6AddressField(routingAdvertisement.defaultGatewayNetworkAddress, currentWriteBytes, elementBuf);
+        WriteIpv6AddressField(routingAdvertisement.primaryDnsNetworkAddress, currentWriteBytes, elementBuf);
 
         WriteIpv6AddressExtensionFieldIfNecessary(
             routingAdvertisement.enabledWaveElementExtensionBitSet,
             EXTENSION_SECONDARY_DNS, routingAdvertisement.secondaryDnsNetworkAddress,
-            currentWriteBytes, wsaBuf);
+            currentWriteBytes, elementBuf);
 
         WriteMacAddressExtensionFieldIfNecessary(
             routingAdvertisement.enabledWaveElementExtensionBitSet,
             EXTENSION_GATEWAY_MAC_ADDRESS, routingAdvertisement.defaultGatewayMacAddress,
-            currentWriteBytes, wsaBuf);
+            currentWriteBytes, elementBuf);
     }//for//
 
-    unique_ptr<Packet> packetPtr = Packet::CreatePacket(*simEngineInterfacePtr, wsaBuf, static_cast<unsigned int>(currentWriteBytes));
-
-    (*this).InsertPacketIntoQueue(
-        packetPtr,
-        NetworkAddress::broadcastAddress,
-        wsaChannelNumberId,
-        wsaPriority,
-        static_cast<DatarateBitsPerSec>(cchInfo.datarate500Kbps) * 500000,
-        static_cast<double>(cchInfo.txPowerDbm));
-
-    (*this).RescheduleNextWsaTransmission();
-}//PeriodicallyTransmitWsa//
+    encodedWsaChannelAndRoutingBytes.assign(elementBuf, (elementBuf + currentWriteBytes));
+    encodedWsaChannelAndRoutingBytesAreValid = true;
+}//EncodeWsaChannelAndRoutingInfo//
 
 inline
 void WsmpLayer::InsertPacketIntoQueue(
@@ -1376,7 +1591,8 @@ void WsmpLayer::InsertPacketIntoQueue(
 
     }//if//
 
-    waveMacPtr->NetworkLayerQueueChangeNotification();
+    // Note: The MAC of the inserted channel has already been notified
+    //       for this priority by WaveMac.
 
 }//InsertPacketIntoQueue//
 
@@ -1523,7 +1739,7 @@ void WsmpLayer::ReceiveWsm(
     size_t currentReadBytes = 0;
 
     uint8_t headerVersion;
-    string providerServiceId;
+    uint32_t providerServiceIdValue;
     uint8_t channelNumberId = 0;
     uint8_t datarate500KBps = 0;
     uint8_t txPowerDbm = 0;
@@ -1534,7 +1750,7 @@ void WsmpLayer::ReceiveWsm(
     ReadBasicField(header, headerVersion, currentReadBytes);
     assert(headerVersion == 2);
 
-    ReadProviderServiceId(header, providerServiceId, currentReadBytes);
+    ReadProviderServiceIdValue(header, providerServiceIdValue, currentReadBytes);
 
     ReadBasicExtensionFieldIfNecessary(
         header,
@@ -1564,8 +1780,11 @@ void WsmpLayer::ReceiveWsm(
     assert(packetPtr->LengthBytes() > payloadLengthBytes);
     packetPtr->DeleteHeader(packetPtr->LengthBytes() - payloadLengthBytes);
 
-    if (wsmApplicationHandlerPtrs.find(providerServiceId) != wsmApplicationHandlerPtrs.end()) {
-        wsmApplicationHandlerPtrs[providerServiceId]->ReceiveWsm(packetPtr);
+    WsmApplicationHandler* wsmApplicationHandlerPtr =
+        (*this).FindWsmApplicationHandler(providerServiceIdValue);
+
+    if (wsmApplicationHandlerPtr != nullptr) {
+        wsmApplicationHandlerPtr->ReceiveWsm(packetPtr);
     }
     else {
         packetPtr = nullptr;
@@ -1631,14 +1850,40 @@ void WsmpLayer::ReceiveWsa(
 
     const size_t packetLengthBytes = packetPtr->LengthBytes();
 
+    assert(currentReadBytes <= packetLengthBytes);
+
+    const unsigned char* elementBytesBegin = (payload + currentReadBytes);
+    const unsigned char* elementBytesEnd = (payload + packetLengthBytes);
+
+    if ((lastParsedWsaElementsAreValid) &&
+        (providerMacAddress == lastParsedWsaProviderMacAddress) &&
+        (lastParsedWsaElementBytes.size() == (packetLengthBytes - currentReadBytes)) &&
+        (std::equal(elementBytesBegin, elementBytesEnd, lastParsedWsaElementBytes.begin()))) {
+        return;
+    }//if//
+
+    lastParsedWsaElementBytes.assign(elementBytesBegin, elementBytesEnd);
+    lastParsedWsaElementsAreValid = true;
+    lastParsedWsaProviderMacAddress = providerMacAddress;
+
+    // Note: Elements are parsed into the existing entries and reset with
+    //       ResetKeepingBuffers() so that their string and encoded byte
+    //       buffers are reused.
+
     // service information
 
-    serviceInfos.clear();
+    size_t numberServiceInfos = 0;
     while (currentReadBytes < packetLengthBytes &&
            PeekElementIdField(payload, currentReadBytes) == WSA_SERVICE_INFO) {
 
-        serviceInfos.push_back(ServiceInfo());
-        ServiceInfo& serviceInfo = serviceInfos.back();
+        if (numberServiceInfos == serviceInfos.size()) {
+            serviceInfos.push_back(ServiceInfo());
+        }//if//
+
+        ServiceInfo& serviceInfo = serviceInfos[numberServiceInfos];
+        numberServiceInfos++;
+
+        serviceInfo.ResetKeepingBuffers();
 
         uint8_t serviceInfoElementId;
         ReadBasicField(payload, serviceInfoElementId, currentReadBytes);
@@ -1696,7 +1941,12 @@ void WsmpLayer::ReceiveWsa(
             currentReadBytes);
     }//while//
 
-    // channel information
+    serviceInfos.resize(numberServiceInfos);
+
+    // channel information (also overwrites the own advertised channel info)
+
+    encodedWsaChannelAndRoutingBytesAreValid = false;
+
     while (currentReadBytes < packetLengthBytes &&
            PeekElementIdField(payload, currentReadBytes) == WSA_CHANNEL_INFO) {
 
@@ -1732,12 +1982,18 @@ void WsmpLayer::ReceiveWsa(
 
     // WAVE Routing Advertisement
 
-    routingAdvertisements.clear();
+    size_t numberRoutingAdvertisements = 0;
     while (currentReadBytes < packetLengthBytes &&
            PeekElementIdField(payload, currentReadBytes) == WSA_WRA) {
 
-        routingAdvertisements.push_back(RoutingAdvertisement());
-        RoutingAdvertisement& routingAdvertisement = routingAdvertisements.back();
+        if (numberRoutingAdvertisements == routingAdvertisements.size()) {
+            routingAdvertisements.push_back(RoutingAdvertisement());
+        }//if//
+
+        RoutingAdvertisement& routingAdvertisement = routingAdvertisements[numberRoutingAdvertisements];
+        numberRoutingAdvertisements++;
+
+        routingAdvertisement = RoutingAdvertisement();
 
         uint8_t routingAdvertisementElementId;
         ReadBasicField(payload, routingAdvertisementElementId, currentReadBytes);
@@ -1761,6 +2017,8 @@ void WsmpLayer::ReceiveWsa(
             routingAdvertisement.defaultGatewayMacAddress,
             currentReadBytes);
     }//while//
+
+    routingAdvertisements.resize(numberRoutingAdvertisements);
 }//ReceiveWsa//
 
 inline
@@ -1768,9 +2026,31 @@ void WsmpLayer::SetWsmApplicationHandler(
     const string& providerServiceId,
     const shared_ptr<WsmApplicationHandler>& wsmApplicationHandlerPtr)
 {
-    wsmApplicationHandlerPtrs[providerServiceId] = wsmApplicationHandlerPtr;
+    const uint32_t providerServiceIdValue = ConvertToProviderServiceIdValue(providerServiceId);
+
+    for(size_t i = 0; i < wsmApplicationHandlerTable.size(); i++) {
+        if (wsmApplicationHandlerTable[i].first == providerServiceIdValue) {
+            wsmApplicationHandlerTable[i].second = wsmApplicationHandlerPtr;
+            return;
+        }//if//
+    }//for//
+
+    wsmApplicationHandlerTable.push_back(make_pair(providerServiceIdValue, wsmApplicationHandlerPtr));
 }//SetWsmApplicationHandler//
 
+inline
+WsmpLayer::WsmApplicationHandler* WsmpLayer::FindWsmApplicationHandler(
+    const uint32_t providerServiceIdValue) const
+{
+    for(size_t i = 0; i < wsmApplicationHandlerTable.size(); i++) {
+        if (wsmApplicationHandlerTable[i].first == providerServiceIdValue) {
+            return wsmApplicationHandlerTable[i].second.get();
+        }//if//
+    }//for//
+
+    return nullptr;
+}//FindWsmApplicationHandler//
+
 
 inline
 void WsmpLayer::OutputTraceAndStatsForInsertPacketIntoQueue(const Packet& packet) const